@@ -0,0 +1,118 @@
+// Copyright (C) 2004-2012 Per-Olof Persson. See COPYRIGHT.TXT for details.
+
+#include "mex.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+#define p(i,j) p[(i)+np*(j)]
+#define p0(i,j) p0[(i)+np*(j)]
+#define Ftot(i,j) Ftot[(i)+np*(j)]
+#define bars(i,j) bars[(i)+nb*(j)]
+
+template<class T> inline T sqr(T x) { return x*x; }
+
+// Number of bars in the blocks of the sums in barupdate
+const int sumblock=4096;
+
+// [p,Ftot]=barupdate(p,bars,barptr,barinc,hbars,nfix,Fscale,deltat)
+//
+// One force step of distmesh2d, the same as
+//   barvec=p(bars(:,1),:)-p(bars(:,2),:);
+//   L=sqrt(sum(barvec.^2,2));
+//   L0=hbars*Fscale*sqrt(sum(L.^2)/sum(hbars.^2));
+//   F=max(L0-L,0);
+//   Fvec=F./L*[1,1].*barvec;
+//   Ftot=full(sparse(bars(:,[1,1,2,2]),ones(size(F))*[1,2,1,2],[Fvec,-Fvec],N,2));
+//   Ftot(1:nfix,:)=0;
+//   p=p+deltat*Ftot;
+// with bars, barptr and barinc from meshbars. The bar forces are summed at
+// each node over its bars in barinc, so the nodes are independent and no
+// sparse matrix is formed.
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  int np=mxGetM(prhs[0]);
+  int nb=mxGetM(prhs[1]);
+  double *p0=mxGetPr(prhs[0]);
+  double *bars=mxGetPr(prhs[1]);
+  int *barptr=(int*)mxGetData(prhs[2]);
+  int *barinc=(int*)mxGetData(prhs[3]);
+  double *hbars=mxGetPr(prhs[4]);
+  int nfix=(int)mxGetScalar(prhs[5]);
+  double Fscale=mxGetScalar(prhs[6]);
+  double deltat=mxGetScalar(prhs[7]);
+
+  if ((int)mxGetNumberOfElements(prhs[2])!=np+1 ||
+      (int)mxGetNumberOfElements(prhs[3])!=2*nb ||
+      (int)mxGetNumberOfElements(prhs[4])!=nb)
+    mexErrMsgTxt("Bars do not match the nodes, run meshbars again.");
+
+  plhs[0]=mxCreateDoubleMatrix(np,2,mxREAL);
+  double *p=mxGetPr(plhs[0]);
+  plhs[1]=mxCreateDoubleMatrix(np,2,mxREAL);
+  double *Ftot=mxGetPr(plhs[1]);
+
+  // Bar vectors, and the scaling of the desired lengths. The sums are taken
+  // over blocks of sumblock bars and the blocks are added in order, so they
+  // do not depend on the number of threads.
+  int nsum=(nb+sumblock-1)/sumblock;
+  vector<double> Fvec(2*nb+1),sums(2*nsum);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int is=0; is<nsum; is++) {
+    double sL2=0.0,sh2=0.0;
+    for (int ib=is*sumblock; ib<min(nb,(is+1)*sumblock); ib++) {
+      int i=(int)bars(ib,0)-1,j=(int)bars(ib,1)-1;
+      Fvec[2*ib]=p0(i,0)-p0(j,0);
+      Fvec[2*ib+1]=p0(i,1)-p0(j,1);
+      sL2+=sqr(Fvec[2*ib])+sqr(Fvec[2*ib+1]);
+      sh2+=sqr(hbars[ib]);
+    }
+    sums[2*is]=sL2;
+    sums[2*is+1]=sh2;
+  }
+  double sumL2=0.0,sumh2=0.0;
+  for (int is=0; is<nsum; is++) {
+    sumL2+=sums[2*is];
+    sumh2+=sums[2*is+1];
+  }
+  double scale=sqrt(sumL2/sumh2);
+
+  // Bar forces
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int ib=0; ib<nb; ib++) {
+    double L=sqrt(sqr(Fvec[2*ib])+sqr(Fvec[2*ib+1]));
+    double F=max(hbars[ib]*Fscale*scale-L,0.0);
+    Fvec[2*ib]*=F/L;
+    Fvec[2*ib+1]*=F/L;
+  }
+
+  // Node forces and update
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int i=0; i<np; i++) {
+    double f[2]={0.0,0.0};
+    if (i>=nfix)
+      for (int k=barptr[i]; k<barptr[i+1]; k++) {
+        int ib=barinc[k]>>1;
+        if (barinc[k]&1) {
+          f[0]-=Fvec[2*ib];
+          f[1]-=Fvec[2*ib+1];
+        }
+        else {
+          f[0]+=Fvec[2*ib];
+          f[1]+=Fvec[2*ib+1];
+        }
+      }
+    Ftot(i,0)=f[0];
+    Ftot(i,1)=f[1];
+    p(i,0)=p0(i,0)+deltat*f[0];
+    p(i,1)=p0(i,1)+deltat*f[1];
+  }
+}
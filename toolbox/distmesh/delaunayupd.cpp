@@ -0,0 +1,170 @@
+// Copyright (C) 2004-2012 Per-Olof Persson. See COPYRIGHT.TXT for details.
+
+#include "mex.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+const int mod3x1[3]={1,2,0};
+const int mod3x2[3]={2,0,1};
+
+// Twice the signed area of p1,p2,p3
+inline double orient2(double *p1,double *p2,double *p3)
+{
+  return (p2[0]-p1[0])*(p3[1]-p1[1])-(p2[1]-p1[1])*(p3[0]-p1[0]);
+}
+
+// Positive if p4 is inside the circumcircle of the counterclockwise
+// p1,p2,p3, and larger than the rounding error of the determinant
+bool incircle(double *p1,double *p2,double *p3,double *p4)
+{
+  double adx=p1[0]-p4[0],ady=p1[1]-p4[1];
+  double bdx=p2[0]-p4[0],bdy=p2[1]-p4[1];
+  double cdx=p3[0]-p4[0],cdy=p3[1]-p4[1];
+  double alift=adx*adx+ady*ady;
+  double blift=bdx*bdx+bdy*bdy;
+  double clift=cdx*cdx+cdy*cdy;
+  double det=alift*(bdx*cdy-cdx*bdy)+blift*(cdx*ady-adx*cdy)+clift*(adx*bdy-bdx*ady);
+  double perm=alift*(fabs(bdx*cdy)+fabs(cdx*bdy))+blift*(fabs(cdx*ady)+fabs(adx*cdy))+
+              clift*(fabs(adx*bdy)+fabs(bdx*ady));
+  return det>1e-14*perm;
+}
+
+// Flips edge n1 of t1 if the opposite node of the neighbor is inside the
+// circumcircle of t1, returns true if flipped
+bool tflipdelaunay(double *p,int *t,int *t2t,char *t2n,int t1,int n1)
+{
+  int t2=t2t[n1+3*t1];
+  if (t2<0)
+    return false;
+  int n2=t2n[n1+3*t1];
+
+  int *v1=t+3*t1,*v2=t+3*t2;
+  if (!incircle(&p[2*v1[0]],&p[2*v1[1]],&p[2*v1[2]],&p[2*v2[n2]]))
+    return false;
+
+  int newt[2][3];
+  for (int i=0; i<3; i++) {
+    newt[0][i]=v1[i];
+    newt[1][i]=v2[i];
+  }
+
+  // Swap edge, if both new triangles are counterclockwise
+  newt[0][mod3x2[n1]]=newt[1][n2];
+  newt[1][mod3x2[n2]]=newt[0][n1];
+  for (int k=0; k<2; k++)
+    if (!(orient2(&p[2*newt[k][0]],&p[2*newt[k][1]],&p[2*newt[k][2]])>0))
+      return false;
+
+  int tix11=mod3x1[n1];
+  int tix21=mod3x1[n2];
+  int nbt;
+  char nbn;
+
+  for (int i=0; i<3; i++) {
+    v1[i]=newt[0][i];
+    v2[i]=newt[1][i];
+  }
+
+  // Update t2t and t2n
+  nbt=t2t[tix21+3*t2];
+  nbn=t2n[tix21+3*t2];
+  t2t[n1+3*t1]=nbt;
+  t2n[n1+3*t1]=nbn;
+  if (nbt>=0) {
+    t2t[nbn+3*nbt]=t1;
+    t2n[nbn+3*nbt]=n1;
+  }
+
+  nbt=t2t[tix11+3*t1];
+  nbn=t2n[tix11+3*t1];
+  t2t[n2+3*t2]=nbt;
+  t2n[n2+3*t2]=nbn;
+  if (nbt>=0) {
+    t2t[nbn+3*nbt]=t2;
+    t2n[nbn+3*nbt]=n2;
+  }
+
+  t2t[tix11+3*t1]=t2;
+  t2n[tix11+3*t1]=tix21;
+  t2t[tix21+3*t2]=t1;
+  t2n[tix21+3*t2]=tix11;
+
+  return true;
+}
+
+// Restores the Delaunay property of the triangulation t of the moved nodes p
+// by edge flips. Returns false, with t partly flipped, if a triangle is
+// inverted or the boundary is no longer convex, since flips can not repair
+// that.
+bool tupdate(double *p,int *t,int *t2t,char *t2n,int np,int nt)
+{
+  // Valid, counterclockwise triangles
+  for (int it=0; it<nt; it++)
+    if (!(orient2(&p[2*t[3*it]],&p[2*t[3*it+1]],&p[2*t[3*it+2]])>0))
+      return false;
+
+  // Convex boundary, traversed counterclockwise
+  vector<int> bnext(np,-1);
+  for (int it=0; it<nt; it++)
+    for (int k=0; k<3; k++)
+      if (t2t[k+3*it]<0)
+        bnext[t[mod3x1[k]+3*it]]=t[mod3x2[k]+3*it];
+  for (int i=0; i<np; i++) {
+    int j=bnext[i];
+    if (j>=0 && bnext[j]>=0 && orient2(&p[2*i],&p[2*j],&p[2*bnext[j]])<0)
+      return false;
+  }
+
+  // Lawson flips, starting from all edges
+  vector<int> stack;
+  stack.reserve(3*nt);
+  for (int it=0; it<nt; it++)
+    for (int k=0; k<3; k++)
+      if (t2t[k+3*it]>it)
+        stack.push_back(3*it+k);
+
+  long nflips=0;
+  while (!stack.empty()) {
+    int t1=stack.back()/3;
+    int n1=stack.back()%3;
+    stack.pop_back();
+    int t2=t2t[n1+3*t1];
+    if (tflipdelaunay(p,t,t2t,t2n,t1,n1)) {
+      if (++nflips>10L*nt+100)
+        return false;
+      for (int k=0; k<3; k++) {
+        stack.push_back(3*t1+k);
+        stack.push_back(3*t2+k);
+      }
+    }
+  }
+
+  return true;
+}
+
+// [t,t2t,t2n,ok]=delaunayupd(t,t2t,t2n,p)  repairs the Delaunay
+//                                          triangulation t after the nodes
+//                                          have moved
+//
+// t, t2t, t2n and p as for trisurfupd, with counterclockwise triangles.
+// ok is false if the triangulation could not be repaired by flips, then it
+// must be recomputed (for example by delaunayn).
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  plhs[0]=mxDuplicateArray(prhs[0]);
+  plhs[1]=mxDuplicateArray(prhs[1]);
+  plhs[2]=mxDuplicateArray(prhs[2]);
+  int *t=(int*)mxGetPr(plhs[0]);
+  int *t2t=(int*)mxGetPr(plhs[1]);
+  char *t2n=(char*)mxGetPr(plhs[2]);
+  int nt=mxGetN(prhs[0]);
+
+  double *p=mxGetPr(prhs[3]);
+  int np=mxGetN(prhs[3]);
+
+  bool ok=tupdate(p,t,t2t,t2n,np,nt);
+  plhs[3]=mxCreateLogicalScalar(ok);
+}
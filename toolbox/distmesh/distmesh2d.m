@@ -75,41 +75,52 @@ N=size(p,1);                                         % Number of points N
 
 count=0;
 pold=inf;                                            % For first iteration
+tall=[];                                             % No triangulation yet
 clf,view(2),axis equal,axis off
 while 1
   count=count+1;
   % 3. Retriangulation by the Delaunay algorithm
   if max(sqrt(sum((p-pold).^2,2))/h0)>ttol           % Any large movement?
     pold=p;                                          % Save current positions
-    t=delaunayn(p);                                  % List of triangles
+    ok=false;
+    if ~isempty(tall)                                % Repair by edge flips
+      [tall,t2t,t2n,ok]=delaunayupd(tall,t2t,t2n,p');
+    end
+    if ~ok                                           % Full retriangulation
+      t=delaunayn(p);                                % List of triangles
+      ix=simpvol(p,t)<0; t(ix,[1,2])=t(ix,[2,1]);    % Counterclockwise
+      [t2t,t2n]=mkt2t(t);                            % Connectivities
+      tall=int32(t-1)'; t2t=int32(t2t-1)'; t2n=int8(t2n-1)';
+    end
+    t=double(tall+1)';
     pmid=(p(t(:,1),:)+p(t(:,2),:)+p(t(:,3),:))/3;    % Compute centroids
     t=t(feval(fd,pmid,varargin{:})<-geps,:);         % Keep interior triangles
-    % 4. Describe each bar by a unique pair of nodes
-    bars=[t(:,[1,2]);t(:,[1,3]);t(:,[2,3])];         % Interior bars duplicated
-    bars=unique(sort(bars,2),'rows');                % Bars as node pairs
+    % 4. Describe each bar by a unique pair of nodes, and list the bars at
+    %    each node, kept until the next retriangulation
+    [bars,barptr,barinc]=meshbars(t,N);              % Bars as node pairs
     % 5. Graphical output of the current mesh
     cla,patch('vertices',p,'faces',t,'edgecol','k','facecol',[.8,.9,1]);
     drawnow
   end
 
   % 6. Move mesh points based on bar lengths L and forces F
-  barvec=p(bars(:,1),:)-p(bars(:,2),:);              % List of bar vectors
-  L=sqrt(sum(barvec.^2,2));                          % L = Bar lengths
   hbars=feval(fh,(p(bars(:,1),:)+p(bars(:,2),:))/2,varargin{:});
-  L0=hbars*Fscale*sqrt(sum(L.^2)/sum(hbars.^2));     % L0 = Desired lengths
   
   % Density control - remove points that are too close
-  if mod(count,densityctrlfreq)==0 & any(L0>2*L)
+  if mod(count,densityctrlfreq)==0
+    barvec=p(bars(:,1),:)-p(bars(:,2),:);            % List of bar vectors
+    L=sqrt(sum(barvec.^2,2));                        % L = Bar lengths
+    L0=hbars*Fscale*sqrt(sum(L.^2)/sum(hbars.^2));   % L0 = Desired lengths
+    if any(L0>2*L)
       p(setdiff(reshape(bars(L0>2*L,:),[],1),1:nfix),:)=[];
-      N=size(p,1); pold=inf;
+      N=size(p,1); pold=inf; tall=[];
       continue;
+    end
   end
   
-  F=max(L0-L,0);                                     % Bar forces (scalars)
-  Fvec=F./L*[1,1].*barvec;                           % Bar forces (x,y components)
-  Ftot=full(sparse(bars(:,[1,1,2,2]),ones(size(F))*[1,2,1,2],[Fvec,-Fvec],N,2));
-  Ftot(1:size(pfix,1),:)=0;                          % Force = 0 at fixed points
-  p=p+deltat*Ftot;                                   % Update node positions
+  % Bar forces summed at the nodes, force = 0 at fixed points, update node
+  % positions
+  [p,Ftot]=barupdate(p,bars,barptr,barinc,hbars,nfix,Fscale,deltat);
 
   % 7. Bring outside points back to the boundary
   d=feval(fd,p,varargin{:}); ix=d>0;                 % Find points outside (d>0)
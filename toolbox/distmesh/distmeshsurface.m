@@ -53,7 +53,7 @@ while 1
   % 3. Retriangulation
   if max(sqrt(sum((p-pold).^2,2))/h0)>ttol           % Any large movement?
     pold=p;                                          % Save current positions
-    [t,t2t,t2n]=trisurfupd(int32(t-1)',t2t,t2n,p');  % Update triangles
+    [t,t2t,t2n]=trisurfupd(int32(t-1)',t2t,t2n,p',0); % Update triangles, all threads
     t=double(t+1)';
     pmid=(p(t(:,1),:)+p(t(:,2),:)+p(t(:,3),:))/3;    % Compute centroids
     % 4. Describe each bar by a unique pair of nodes
@@ -2,20 +2,22 @@ function d=dpoly(p,pv)
 
 %   Copyright (C) 2004-2012 Per-Olof Persson. See COPYRIGHT.TXT for details.
 
-np=size(p,1);
-nvs=size(pv,1)-1;
-
-ds=dsegment(p,pv);
-%ds=zeros(np,nvs);
-%for iv=1:nvs
-%  ds(:,iv)=donesegment(p,pv(iv:iv+1,:));
-%end
-d=min(ds,[],2);
-
-d=(-1).^(inpolygon(p(:,1),p(:,2),pv(:,1),pv(:,2))).*d;
+d=dpolydist(p,pv);
 
 % MEXED
 
+%np=size(p,1);
+%nvs=size(pv,1)-1;
+%
+%ds=dsegment(p,pv);
+%%ds=zeros(np,nvs);
+%%for iv=1:nvs
+%%  ds(:,iv)=donesegment(p,pv(iv:iv+1,:));
+%%end
+%d=min(ds,[],2);
+%
+%d=(-1).^(inpolygon(p(:,1),p(:,2),pv(:,1),pv(:,2))).*d;
+
 %function ds=donesegment(p,pv)
 %
 %e=ones(size(p,1),1);
@@ -0,0 +1,247 @@
+// Copyright (C) 2004-2012 Per-Olof Persson. See COPYRIGHT.TXT for details.
+
+#include "mex.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+#define p(i,j) p[(i)+np*(j)]
+#define pv(i,j) pv[(i)+nvs*(j)]
+
+template<class T> inline T sqr(T x) { return x*x; }
+template<class T> inline T dot2(T *a,T *b) { return a[0]*b[0]+a[1]*b[1]; }
+
+// Squared distance from (x,y) to the segment a-b, as in dsegment
+inline double dseg2(double x,double y,const double *a,const double *b)
+{
+  double v[2]={b[0]-a[0],b[1]-a[1]};
+  double w[2]={x-a[0],y-a[1]};
+
+  double c1=dot2(v,w);
+  double c2=dot2(v,v);
+
+  if (c1<=0)
+    return sqr(x-a[0])+sqr(y-a[1]);
+  else if (c1>=c2)
+    return sqr(x-b[0])+sqr(y-b[1]);
+  else
+    return sqr(x-(a[0]+c1/c2*v[0]))+sqr(y-(a[1]+c1/c2*v[1]));
+}
+
+// Squared distance from (x,y) to the box b=[xmin,xmax,ymin,ymax]
+inline double dbox2(double x,double y,const double *b)
+{
+  return sqr(max(0.0,max(b[0]-x,x-b[1])))+sqr(max(0.0,max(b[2]-y,y-b[3])));
+}
+
+// Bounding volume hierarchy of the segments, node k has the box
+// box[4*k...4*k+3] and the children child[2*k],child[2*k+1], or the
+// segments seg[-child[2*k]-1...child[2*k+1]-1] for a leaf
+struct segbvh {
+  vector<double> box,c;
+  vector<int> child,seg;
+  const double *xy;
+
+  struct cmp {
+    const double *c;
+    int dim;
+    bool operator()(int a,int b) const { return c[2*a+dim]<c[2*b+dim]; }
+  };
+
+  int build(int first,int last) {
+    int k=child.size()/2;
+    double b[4]={HUGE_VAL,-HUGE_VAL,HUGE_VAL,-HUGE_VAL};
+    for (int i=first; i<last; i++) {
+      const double *p1=&xy[2*seg[i]],*p2=p1+2;
+      b[0]=min(b[0],min(p1[0],p2[0])); b[1]=max(b[1],max(p1[0],p2[0]));
+      b[2]=min(b[2],min(p1[1],p2[1])); b[3]=max(b[3],max(p1[1],p2[1]));
+    }
+    box.insert(box.end(),b,b+4);
+    child.push_back(-first-1);
+    child.push_back(last);
+    if (last-first>4) {
+      cmp cm={&c[0],b[1]-b[0]<b[3]-b[2]};
+      int mid=(first+last)/2;
+      nth_element(seg.begin()+first,seg.begin()+mid,seg.begin()+last,cm);
+      int c0=build(first,mid);
+      int c1=build(mid,last);
+      child[2*k]=c0;
+      child[2*k+1]=c1;
+    }
+    return k;
+  }
+
+  segbvh(const double *xy0,const vector<int> &segs) : seg(segs), xy(xy0) {
+    c.resize(2*segs.back()+2);
+    for (size_t k=0; k<segs.size(); k++) {
+      c[2*segs[k]]=xy[2*segs[k]]+xy[2*segs[k]+2];
+      c[2*segs[k]+1]=xy[2*segs[k]+1]+xy[2*segs[k]+3];
+    }
+    build(0,segs.size());
+  }
+
+  // Distance to the nearest segment, descending to the nearest child first
+  // and keeping the other one on the stack
+  double dist(double x,double y,vector<pair<double,int> > &stack) const {
+    double dmin2=HUGE_VAL;
+    stack.clear();
+    stack.push_back(make_pair(dbox2(x,y,&box[0]),0));
+    while (!stack.empty()) {
+      double db=stack.back().first;
+      int k=stack.back().second;
+      stack.pop_back();
+      if (db>=dmin2)
+        continue;
+      while (k>=0 && child[2*k]>=0) {
+        int k0=child[2*k],k1=child[2*k+1];
+        double d0=dbox2(x,y,&box[4*k0]),d1=dbox2(x,y,&box[4*k1]);
+        if (d1<d0) {
+          swap(d0,d1);
+          swap(k0,k1);
+        }
+        if (d1<dmin2)
+          stack.push_back(make_pair(d1,k1));
+        k=d0<dmin2 ? k0 : -1;
+      }
+      if (k<0)
+        continue;
+      for (int i=-child[2*k]-1; i<child[2*k+1]; i++)
+        dmin2=min(dmin2,dseg2(x,y,&xy[2*seg[i]],&xy[2*seg[i]+2]));
+    }
+    return sqrt(dmin2);
+  }
+};
+
+// Edges of a band structure, compressed by cell
+struct cells {
+  vector<int> start,seg;
+  void fill(const vector<int> &cell,const vector<int> &ix,int ncells) {
+    start.assign(ncells+1,0);
+    for (size_t k=0; k<cell.size(); k++)
+      start[cell[k]+1]++;
+    for (int c=0; c<ncells; c++)
+      start[c+1]+=start[c];
+    seg.resize(cell.size());
+    vector<int> pos(start.begin(),start.end()-1);
+    for (size_t k=0; k<cell.size(); k++)
+      seg[pos[cell[k]]++]=ix[k];
+  }
+};
+
+// d=dpolydist(p,pv)  signed distance to the polygon pv, the same as
+//                    min(dsegment(p,pv),[],2) with the sign from inpolygon
+//                    (used by dpoly)
+//
+// The distance is to the segments pv(i,:)-pv(i+1,:), found in a bounding
+// volume hierarchy of the segments. The sign is from the crossing number of
+// a ray in the x direction, with the edges of each NaN-separated loop of pv
+// (closed as in inpolygon) sorted in bands of y. The bands are the leaves of
+// a segment tree, and each edge is stored in the O(log(size(pv,1))) nodes
+// that cover its bands, so the edges crossing the band of a point are in the
+// nodes from its leaf to the root.
+// The memory is O(size(p,1)+size(pv,1)*log(size(pv,1))).
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  int np=mxGetM(prhs[0]);
+  int nvs=mxGetM(prhs[1]);
+  double *p=mxGetPr(prhs[0]);
+  double *pv=mxGetPr(prhs[1]);
+
+  plhs[0]=mxCreateDoubleMatrix(np,1,mxREAL);
+  double *d=mxGetPr(plhs[0]);
+
+  // Vertices, segments and closed loop edges
+  vector<double> xy(2*nvs);
+  vector<char> ok(nvs);
+  double ymin=HUGE_VAL,ymax=-HUGE_VAL;
+  for (int iv=0; iv<nvs; iv++) {
+    xy[2*iv]=pv(iv,0);
+    xy[2*iv+1]=pv(iv,1);
+    ok[iv]=!mxIsNaN(xy[2*iv]) && !mxIsNaN(xy[2*iv+1]);
+    if (ok[iv]) {
+      ymin=min(ymin,xy[2*iv+1]);
+      ymax=max(ymax,xy[2*iv+1]);
+    }
+  }
+  vector<int> segs,edges;
+  for (int iv=0; iv<nvs; iv++) {
+    if (!ok[iv])
+      continue;
+    int i0=iv;
+    while (iv+1<nvs && ok[iv+1]) {
+      segs.push_back(iv);
+      edges.push_back(iv); edges.push_back(iv+1);
+      iv++;
+    }
+    edges.push_back(iv); edges.push_back(i0);
+  }
+  int nseg=segs.size(),ned=edges.size()/2;
+
+  if (nseg==0) {
+    for (int ip=0; ip<np; ip++)
+      d[ip]=HUGE_VAL;
+    return;
+  }
+
+  segbvh bvh(&xy[0],segs);
+  vector<int> cell,ix;
+
+  // Bands of y, each edge in the segment tree nodes that cover the bands
+  // b0...b1 it spans. Node k>=1 has the children 2*k,2*k+1 and band b is the
+  // leaf nb+b.
+  int nb=max(ned,1);
+  double hb=ymax>ymin ? (ymax-ymin)/nb : 1.0;
+  for (int k=0; k<ned; k++) {
+    double ya=xy[2*edges[2*k]+1],yb=xy[2*edges[2*k+1]+1];
+    int b0=min((int)((min(ya,yb)-ymin)/hb),nb-1),b1=min((int)((max(ya,yb)-ymin)/hb),nb-1);
+    for (int l=b0+nb,r=b1+1+nb; l<r; l/=2,r/=2) {
+      if (l&1) {
+        cell.push_back(l++);
+        ix.push_back(k);
+      }
+      if (r&1) {
+        cell.push_back(--r);
+        ix.push_back(k);
+      }
+    }
+  }
+  cells bands;
+  bands.fill(cell,ix,2*nb);
+
+  double nan=mxGetNaN();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+  {
+  vector<pair<double,int> > stack;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,256)
+#endif
+  for (int ip=0; ip<np; ip++) {
+    double x=p(ip,0),y=p(ip,1);
+    if (mxIsNaN(x) || mxIsNaN(y)) {
+      d[ip]=nan;
+      continue;
+    }
+
+    double dmin=bvh.dist(x,y,stack);
+
+    // Crossing number
+    bool in=false;
+    if (y>=ymin && y<=ymax) {
+      for (int n=min((int)((y-ymin)/hb),nb-1)+nb; n>=1; n/=2)
+        for (int k=bands.start[n]; k<bands.start[n+1]; k++) {
+          const double *a=&xy[2*edges[2*bands.seg[k]]];
+          const double *e=&xy[2*edges[2*bands.seg[k]+1]];
+          if ((a[1]>y)!=(e[1]>y) &&
+              x<(e[0]-a[0])*(y-a[1])/(e[1]-a[1])+a[0])
+            in=!in;
+        }
+    }
+
+    d[ip]=in ? -dmin : dmin;
+  }
+  }
+}
@@ -0,0 +1,122 @@
+// Copyright (C) 2004-2012 Per-Olof Persson. See COPYRIGHT.TXT for details.
+
+#include "mex.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+#define p(i,j) p[(i)+np*(j)]
+#define p1(i,j) p1[(i)+np1*(j)]
+#define t(i,j) t[(i)+nt*(j)]
+#define t1(i,j) t1[(i)+nt*(j)]
+
+// Rounding as in MATLAB, half away from zero
+inline double roundm(double x) { return x<0 ? -floor(-x+0.5) : floor(x+0.5); }
+
+// Orders nodes by their snapped coordinates, then by index
+struct snapless {
+  const double *key;
+  int dim;
+  bool same(int a,int b) const {
+    for (int i=0; i<dim; i++)
+      if (key[dim*a+i]!=key[dim*b+i])
+        return false;
+    return true;
+  }
+  bool operator()(int a,int b) const {
+    for (int i=0; i<dim; i++)
+      if (key[dim*a+i]!=key[dim*b+i])
+        return key[dim*a+i]<key[dim*b+i];
+    return a<b;
+  }
+};
+
+// [p,t,pix]=mergenodes(p,t)
+// [p,t,pix]=mergenodes(p,t,ptol)
+//
+// Merges duplicated nodes and removes unused nodes, as fixmesh but without
+// the orientation fix. Nodes are duplicates if round(p/snap) is the same,
+// with snap=ptol (default 1024*eps) times the size of the mesh. The first
+// of the duplicates is kept, and the kept nodes are in their original
+// order, p=p0(pix,:).
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  int np=mxGetM(prhs[0]);
+  int dim=mxGetN(prhs[0]);
+  int nt=mxGetM(prhs[1]);
+  int nv=mxGetN(prhs[1]);
+  double *p=mxGetPr(prhs[0]);
+  double *t=mxGetPr(prhs[1]);
+  double ptol=nrhs>=3 ? mxGetScalar(prhs[2]) : 1024*mxGetEps();
+
+  double snap=0.0;
+  for (int i=0; i<dim; i++) {
+    double pmin=HUGE_VAL,pmax=-HUGE_VAL;
+    for (int ip=0; ip<np; ip++) {
+      pmin=min(pmin,p(ip,i));
+      pmax=max(pmax,p(ip,i));
+    }
+    snap=max(snap,(pmax-pmin)*ptol);
+  }
+  if (!(snap>0))
+    snap=1.0;
+
+  // Duplicates, rep[ip] is the first node with the same snapped coordinates
+  vector<double> key((size_t)dim*np+1);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int ip=0; ip<np; ip++)
+    for (int i=0; i<dim; i++)
+      key[(size_t)dim*ip+i]=roundm(p(ip,i)/snap);
+  vector<int> order(np+1),rep(np+1);
+  for (int ip=0; ip<np; ip++)
+    order[ip]=ip;
+  snapless cmp={&key[0],dim};
+  sort(order.begin(),order.begin()+np,cmp);
+  for (int k=0; k<np; k++) {
+    int ip=order[k];
+    rep[ip]=k>0 && cmp.same(order[k-1],ip) ? rep[order[k-1]] : ip;
+  }
+
+  // Used nodes, numbered in their original order
+  vector<int> newix(np+1,-1);
+  bool bad=false;
+  for (int it=0; it<nt; it++)
+    for (int k=0; k<nv; k++) {
+      int ip=(int)t(it,k)-1;
+      if (ip<0 || ip>=np)
+        bad=true;
+      else
+        newix[rep[ip]]=0;
+    }
+  if (bad)
+    mexErrMsgTxt("Node index out of range.");
+  int np1=0;
+  for (int ip=0; ip<np; ip++)
+    if (newix[ip]==0)
+      newix[ip]=++np1;
+
+  plhs[0]=mxCreateDoubleMatrix(np1,dim,mxREAL);
+  double *p1=mxGetPr(plhs[0]);
+  plhs[1]=mxCreateDoubleMatrix(nt,nv,mxREAL);
+  double *t1=mxGetPr(plhs[1]);
+  plhs[2]=mxCreateDoubleMatrix(np1,1,mxREAL);
+  double *pix=mxGetPr(plhs[2]);
+
+  for (int ip=0; ip<np; ip++)
+    if (newix[ip]>0) {
+      for (int i=0; i<dim; i++)
+        p1(newix[ip]-1,i)=p(ip,i);
+      pix[newix[ip]-1]=ip+1;
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int it=0; it<nt; it++)
+    for (int k=0; k<nv; k++)
+      t1(it,k)=newix[rep[(int)t(it,k)-1]];
+}
@@ -0,0 +1,81 @@
+// Copyright (C) 2004-2012 Per-Olof Persson. See COPYRIGHT.TXT for details.
+
+#include "mex.h"
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+#define t(i,j) t[(i)+nt*(j)]
+#define bars(i,j) bars[(i)+nb*(j)]
+
+// [bars,barptr,barinc]=meshbars(t,N)  unique bars of the triangles t and
+//                                     their incidence, for barupdate
+//
+// bars is the same as unique(sort([t(:,[1,2]);t(:,[1,3]);t(:,[2,3])],2),'rows').
+// The bars at node i (1-based) are barinc(barptr(i)+1:barptr(i+1)), as
+// int32 values 2*b+s with the 0-based bar b and s=0 if i=bars(b+1,1), s=1 if
+// i=bars(b+1,2).
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  int nt=mxGetM(prhs[0]);
+  double *t=mxGetPr(prhs[0]);
+  int np=(int)mxGetScalar(prhs[1]);
+
+  // Neighbors j>i of each node i, compressed by i
+  vector<int> start(np+2,0),nbr(3*nt+1);
+  for (int it=0; it<nt; it++)
+    for (int k=0; k<3; k++) {
+      int i=(int)t(it,k)-1,j=(int)t(it,(k+1)%3)-1;
+      if (i<0 || j<0 || i>=np || j>=np)
+        mexErrMsgTxt("Node index out of range.");
+      start[min(i,j)+2]++;
+    }
+  for (int i=0; i<np; i++)
+    start[i+2]+=start[i+1];
+  for (int it=0; it<nt; it++)
+    for (int k=0; k<3; k++) {
+      int i=(int)t(it,k)-1,j=(int)t(it,(k+1)%3)-1;
+      nbr[start[min(i,j)+1]++]=max(i,j);
+    }
+
+  // Sort and remove duplicates, for the order of unique
+  int nb=0;
+  for (int i=0; i<np; i++) {
+    int *first=&nbr[0]+start[i],*last=&nbr[0]+start[i+1];
+    sort(first,last);
+    for (int *k=first; k<last; k++)
+      if (k==first || *k!=k[-1])
+        nb++;
+  }
+
+  plhs[0]=mxCreateDoubleMatrix(nb,2,mxREAL);
+  double *bars=mxGetPr(plhs[0]);
+  plhs[1]=mxCreateNumericMatrix(np+1,1,mxINT32_CLASS,mxREAL);
+  int *barptr=(int*)mxGetData(plhs[1]);
+  plhs[2]=mxCreateNumericMatrix(2*nb,1,mxINT32_CLASS,mxREAL);
+  int *barinc=(int*)mxGetData(plhs[2]);
+
+  for (int i=0; i<=np; i++)
+    barptr[i]=0;
+  int ib=0;
+  for (int i=0; i<np; i++) {
+    for (int k=start[i]; k<start[i+1]; k++) {
+      if (k>start[i] && nbr[k]==nbr[k-1])
+        continue;
+      bars(ib,0)=i+1;
+      bars(ib,1)=nbr[k]+1;
+      barptr[i+1]++;
+      barptr[nbr[k]+1]++;
+      ib++;
+    }
+  }
+  for (int i=0; i<np; i++)
+    barptr[i+1]+=barptr[i];
+
+  vector<int> pos(barptr,barptr+np);
+  for (int b=0; b<nb; b++) {
+    barinc[pos[(int)bars(b,0)-1]++]=2*b;
+    barinc[pos[(int)bars(b,1)-1]++]=2*b+1;
+  }
+}
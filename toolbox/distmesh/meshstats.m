@@ -0,0 +1,44 @@
+function [p,t,s]=meshstats(p,t,fh,varargin)
+%MESHSTATS Mesh cleanup and quality statistics in one pass.
+%   [P,T,S]=MESHSTATS(P,T)
+%   [P,T,S]=MESHSTATS(P,T,FH,FPARAMS)
+%
+%   Merges duplicated nodes and removes unused nodes (as FIXMESH), then
+%   computes for the triangles or tetrahedra T:
+%      S.q:          Radius ratio quality (as SIMPQUAL)
+%      S.v:          Signed volume before reorientation (as SIMPVOL)
+%      S.r:          Circumradius
+%      S.qmin:       Minimum quality
+%      S.qmean:      Mean quality
+%      S.qhist:      Number of elements with quality in 20 bins on [0,1]
+%      S.inverted:   Number of elements with S.v<0, reoriented in T
+%      S.degenerate: Number of elements with S.v==0
+%   With the size function FH and its parameters FPARAMS, also:
+%      S.u:          Uniformity (as UNIFORMITY)
+%
+%   The nodes are merged by MERGENODES and the elements are computed in
+%   one multithreaded pass by SIMPSTATS.
+%
+%   See also: FIXMESH, SIMPQUAL, SIMPVOL, UNIFORMITY.
+
+%   Copyright (C) 2004-2012 Per-Olof Persson. See COPYRIGHT.TXT for details.
+
+[p,t]=mergenodes(p,t);
+[q,v,r,pc,qhist]=simpstats(p,t);
+
+flip=v<0;
+t(flip,[1,2])=t(flip,[2,1]);
+
+s.q=q;
+s.v=v;
+s.r=r;
+s.qmin=min(q);
+s.qmean=mean(q);
+s.qhist=qhist;
+s.inverted=nnz(flip);
+s.degenerate=nnz(v==0);
+
+if nargin>=3
+  sz=r./feval(fh,pc,varargin{:});
+  s.u=std(sz)/mean(sz);
+end
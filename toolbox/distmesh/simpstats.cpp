@@ -0,0 +1,146 @@
+// Copyright (C) 2004-2012 Per-Olof Persson. See COPYRIGHT.TXT for details.
+
+#include "mex.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+#define p(i,j) p[(i)+np*(j)]
+#define t(i,j) t[(i)+nt*(j)]
+#define pc(i,j) pc[(i)+nt*(j)]
+
+template<class T> inline T sqr(T x) { return x*x; }
+template<class T> inline T dot(T *x,T *y) { return x[0]*y[0]+x[1]*y[1]+x[2]*y[2]; }
+template<class T> inline T length(T *x) { return sqrt(dot(x,x)); }
+template<class T> inline void cross(T *v1,T *v2,T *n) { n[0]=v1[1]*v2[2]-v1[2]*v2[1];
+                                                        n[1]=v1[2]*v2[0]-v1[0]*v2[2];
+                                                        n[2]=v1[0]*v2[1]-v1[1]*v2[0]; }
+
+// Radius ratio quality, signed area, circumradius and circumcenter of the
+// triangle p1,p2,p3 (as simpqual, simpvol and circumcenter)
+double triangle(double *p1,double *p2,double *p3,double *v,double *r,double *pc)
+{
+  double d12[2]={p2[0]-p1[0],p2[1]-p1[1]};
+  double d13[2]={p3[0]-p1[0],p3[1]-p1[1]};
+  double a=sqrt(sqr(d12[0])+sqr(d12[1]));
+  double b=sqrt(sqr(d13[0])+sqr(d13[1]));
+  double c=sqrt(sqr(p3[0]-p2[0])+sqr(p3[1]-p2[1]));
+
+  double det=d12[0]*d13[1]-d12[1]*d13[0];
+  *v=det/2;
+  double ux=(d13[1]*sqr(a)-d12[1]*sqr(b))/(2*det);
+  double uy=(d12[0]*sqr(b)-d13[0]*sqr(a))/(2*det);
+  pc[0]=p1[0]+ux;
+  pc[1]=p1[1]+uy;
+  *r=sqrt(sqr(ux)+sqr(uy));
+
+  return (b+c-a)*(c+a-b)*(a+b-c)/(a*b*c);
+}
+
+// Radius ratio quality, signed volume, circumradius and circumcenter of the
+// tetrahedron p1,p2,p3,p4
+double tetrahedron(double *p1,double *p2,double *p3,double *p4,double *v,double *r,double *pc)
+{
+  double d12[3],d13[3],d14[3],d23[3],d24[3],d34[3];
+  for (int i=0; i<3; i++) {
+    d12[i]=p2[i]-p1[i]; d13[i]=p3[i]-p1[i]; d14[i]=p4[i]-p1[i];
+    d23[i]=p3[i]-p2[i]; d24[i]=p4[i]-p2[i]; d34[i]=p4[i]-p3[i];
+  }
+  double n123[3],n124[3],n134[3],n234[3];
+  cross(d12,d13,n123);
+  cross(d12,d14,n124);
+  cross(d13,d14,n134);
+  cross(d23,d24,n234);
+
+  double det=dot(n123,d14);
+  *v=det/6;
+  double s=length(n123)/2+length(n124)/2+length(n134)/2+length(n234)/2;
+  double q1=length(d12)*length(d34);
+  double q2=length(d23)*length(d14);
+  double q3=length(d13)*length(d24);
+
+  // u=(|d12|^2 d13 x d14 + |d13|^2 d14 x d12 + |d14|^2 d12 x d13)/(2 det)
+  double l12=dot(d12,d12),l13=dot(d13,d13),l14=dot(d14,d14);
+  double u[3];
+  for (int i=0; i<3; i++) {
+    u[i]=(l12*n134[i]-l13*n124[i]+l14*n123[i])/(2*det);
+    pc[i]=p1[i]+u[i];
+  }
+  *r=length(u);
+
+  return 216*sqr(*v)/s/sqrt((q1+q2+q3)*(q1+q2-q3)*(q1+q3-q2)*(q2+q3-q1));
+}
+
+// [q,v,r,pc,qhist]=simpstats(p,t)
+// [q,v,r,pc,qhist]=simpstats(p,t,nbins)
+//
+// Radius ratio quality q (as simpqual), signed volume v (as simpvol),
+// circumradius r and circumcenter pc of the triangles or tetrahedra t, in
+// one pass over the elements, and the histogram qhist of q in nbins
+// (default 20) bins on [0,1]. Elements with NaN quality are not counted.
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  int np=mxGetM(prhs[0]);
+  int dim=mxGetN(prhs[0]);
+  int nt=mxGetM(prhs[1]);
+  double *p=mxGetPr(prhs[0]);
+  double *t=mxGetPr(prhs[1]);
+  int nbins=nrhs>=3 ? (int)mxGetScalar(prhs[2]) : 20;
+
+  if ((dim!=2 && dim!=3) || (int)mxGetN(prhs[1])!=dim+1)
+    mexErrMsgTxt("Dimension not implemented.");
+  if (nbins<1)
+    mexErrMsgTxt("nbins must be positive.");
+
+  plhs[0]=mxCreateDoubleMatrix(nt,1,mxREAL);
+  double *q=mxGetPr(plhs[0]);
+  plhs[1]=mxCreateDoubleMatrix(nt,1,mxREAL);
+  double *v=mxGetPr(plhs[1]);
+  plhs[2]=mxCreateDoubleMatrix(nt,1,mxREAL);
+  double *r=mxGetPr(plhs[2]);
+  plhs[3]=mxCreateDoubleMatrix(nt,dim,mxREAL);
+  double *pc=mxGetPr(plhs[3]);
+  plhs[4]=mxCreateDoubleMatrix(nbins,1,mxREAL);
+  double *qhist=mxGetPr(plhs[4]);
+
+  bool bad=false;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+  {
+    vector<double> hist(nbins,0.0);
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (int it=0; it<nt; it++) {
+      double x[4][3],c[3];
+      for (int k=0; k<=dim; k++) {
+        int ip=(int)t(it,k)-1;
+        if (ip<0 || ip>=np) {
+          bad=true;
+          ip=0;
+        }
+        for (int i=0; i<dim; i++)
+          x[k][i]=p(ip,i);
+      }
+      if (dim==2)
+        q[it]=triangle(x[0],x[1],x[2],&v[it],&r[it],c);
+      else
+        q[it]=tetrahedron(x[0],x[1],x[2],x[3],&v[it],&r[it],c);
+      for (int i=0; i<dim; i++)
+        pc(it,i)=c[i];
+      if (q[it]>=0)
+        hist[min((int)(q[it]*nbins),nbins-1)]++;
+    }
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+    for (int k=0; k<nbins; k++)
+      qhist[k]+=hist[k];
+  }
+
+  if (bad)
+    mexErrMsgTxt("Node index out of range.");
+}
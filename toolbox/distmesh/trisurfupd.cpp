@@ -4,6 +4,11 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <climits>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 template<class T> inline T sqr(T x) { return x*x; }
 template<class T> inline T length(T *x) { return sqrt(sqr(x[0])+sqr(x[1])+sqr(x[2])); }
@@ -11,8 +16,8 @@ template<class T> inline T dot(T *x,T *y) { return x[0]*y[0]+x[1]*y[1]+x[2]*y[2]
 template<class T> inline void cross(T *v1,T *v2,T *n) { n[0]=v1[1]*v2[2]-v1[2]*v2[1];
                                                         n[1]=v1[2]*v2[0]-v1[0]*v2[2];
                                                         n[2]=v1[0]*v2[1]-v1[1]*v2[0]; }
-const char mod3x1[3]={1,2,0};
-const char mod3x2[3]={2,0,1};
+const int mod3x1[3]={1,2,0};
+const int mod3x2[3]={2,0,1};
 
 double triarea(double *p1,double *p2,double *p3)
 {
@@ -23,102 +28,255 @@ double triarea(double *p1,double *p2,double *p3)
   return (d12x*d13y-d12y*d13x)/2.0;
 }
 
-void trinormal3(double *p1,double *p2,double *p3,double *n)
+// Quality of the triangle, and its unit normal in n
+double triqual3(double *p1,double *p2,double *p3,double *n)
 {
   double d12[3]={ p2[0]-p1[0], p2[1]-p1[1], p2[2]-p1[2] };
   double d13[3]={ p3[0]-p1[0], p3[1]-p1[1], p3[2]-p1[2] };
+  double d23[3]={ p3[0]-p2[0], p3[1]-p2[1], p3[2]-p2[2] };
   cross(d12,d13,n);
-
   double nnorm=length(n);
+  double vol=nnorm/2.0;
+  double den=dot(d12,d12)+dot(d13,d13)+dot(d23,d23);
   n[0]/=nnorm; n[1]/=nnorm; n[2]/=nnorm;
+  return 6.928203230275509*vol/den;
 }
 
-double triqual3(double *p1,double *p2,double *p3)
+// Qualities q and unit normals nrm of all triangles, updated by tflip
+void tquality(double *p,int *t,double *q,double *nrm,int nt,int nthreads)
 {
-  double n[3];
-  double d12[3]={ p2[0]-p1[0], p2[1]-p1[1], p2[2]-p1[2] };
-  double d13[3]={ p3[0]-p1[0], p3[1]-p1[1], p3[2]-p1[2] };
-  double d23[3]={ p3[0]-p2[0], p3[1]-p2[1], p3[2]-p2[2] };
-  cross(d12,d13,n);
-  double vol=length(n)/2.0;
-  double den=dot(d12,d12)+dot(d13,d13)+dot(d23,d23);
-  return 6.928203230275509*vol/den;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+#endif
+  for (int tr=0; tr<nt; tr++)
+    q[tr]=triqual3(&p[3*t[0+3*tr]],&p[3*t[1+3*tr]],&p[3*t[2+3*tr]],&nrm[3*tr]);
+}
+
+// Checks the flip of edge n1 of t1, gives the new triangles in newt and their
+// qualities and unit normals in newq and newnrm
+bool tflipgood(double *p,int *t,int *t2t,char *t2n,double *q,double *nrm,
+               int t1,int n1,int newt[2][3],double newq[2],double newnrm[2][3])
+{
+  int t2=t2t[n1+3*t1];
+  if (t2<0)
+    return false;
+
+  double minqold=std::min(q[t1],q[t2]);
+  if (!(minqold<0.9))
+    return false;
+
+  int n2=t2n[n1+3*t1];
+  int tix12=mod3x2[n1];
+  int tix22=mod3x2[n2];
+
+  for (int i=0; i<3; i++) {
+    newt[0][i]=t[i+3*t1];
+    newt[1][i]=t[i+3*t2];
+  }
+
+  // Swap edge
+  newt[0][tix12]=newt[1][n2];
+  newt[1][tix22]=newt[0][n1];
+
+  newq[0]=triqual3(&p[3*newt[0][0]],&p[3*newt[0][1]],&p[3*newt[0][2]],newnrm[0]);
+  newq[1]=triqual3(&p[3*newt[1][0]],&p[3*newt[1][1]],&p[3*newt[1][2]],newnrm[1]);
+  double minqnew=std::min(newq[0],newq[1]);
+  if (!(minqnew>minqold+.025))
+    return false;
+
+  return dot(&nrm[3*t1],&nrm[3*t2])>0 && dot(newnrm[0],newnrm[1])>0;
+}
+
+void tflip(int *t,int *t2t,char *t2n,double *q,double *nrm,
+           int t1,int n1,int newt[2][3],double newq[2],double newnrm[2][3])
+{
+  int t2=t2t[n1+3*t1];
+  int n2=t2n[n1+3*t1];
+  int tix11=mod3x1[n1];
+  int tix21=mod3x1[n2];
+  int nbt;
+  char nbn;
+
+  // Insert new triangles
+  memcpy(t+3*t1,newt[0],3*sizeof(int));
+  memcpy(t+3*t2,newt[1],3*sizeof(int));
+  q[t1]=newq[0];
+  q[t2]=newq[1];
+  memcpy(nrm+3*t1,newnrm[0],3*sizeof(double));
+  memcpy(nrm+3*t2,newnrm[1],3*sizeof(double));
+
+  // Update t2t and t2n
+  nbt=t2t[tix21+3*t2];
+  nbn=t2n[tix21+3*t2];
+  t2t[n1+3*t1]=nbt;
+  t2n[n1+3*t1]=nbn;
+  if (nbt>=0) {
+    t2t[nbn+3*nbt]=t1;
+    t2n[nbn+3*nbt]=n1;
+  }
+
+  nbt=t2t[tix11+3*t1];
+  nbn=t2n[tix11+3*t1];
+  t2t[n2+3*t2]=nbt;
+  t2n[n2+3*t2]=nbn;
+  if (nbt>=0) {
+    t2t[nbn+3*nbt]=t2;
+    t2n[nbn+3*nbt]=n2;
+  }
+
+  t2t[tix11+3*t1]=t2;
+  t2n[tix11+3*t1]=tix21;
+  t2t[tix21+3*t2]=t1;
+  t2n[tix21+3*t2]=tix11;
 }
 
-void tupdate(double *p,int *t,int *t2t,char *t2n,
-             int np,int nt)
+void tupdate(double *p,int *t,int *t2t,char *t2n,int nt)
 {
+  double *q=new double[nt];
+  double *nrm=new double[3*nt];
+  tquality(p,t,q,nrm,nt,1);
+
   for (int t1=0; t1<nt; t1++)
-    for (char n1=0; n1<3; n1++) {
-      int t2=t2t[n1+3*t1];
-      if (t2>=0) {
-        double q1=triqual3(&p[3*t[0+3*t1]],&p[3*t[1+3*t1]],&p[3*t[2+3*t1]]);
-        double q2=triqual3(&p[3*t[0+3*t2]],&p[3*t[1+3*t2]],&p[3*t[2+3*t2]]);
-        double minqold=std::min(q1,q2);
-        if (minqold<0.9) {
-          char n2=t2n[n1+3*t1];
-          char tix11=mod3x1[n1];
-          char tix12=mod3x2[n1];
-          char tix21=mod3x1[n2];
-          char tix22=mod3x2[n2];
-          
-          int newt[2][3]={t[0+3*t1],t[1+3*t1],t[2+3*t1],
-                          t[0+3*t2],t[1+3*t2],t[2+3*t2]};
-          
-          // Swap edge
-          newt[0][tix12]=newt[1][n2];
-          newt[1][tix22]=newt[0][n1];
-          
-          double q3=triqual3(&p[3*newt[0][0]],&p[3*newt[0][1]],&p[3*newt[0][2]]);
-          double q4=triqual3(&p[3*newt[1][0]],&p[3*newt[1][1]],&p[3*newt[1][2]]);
-          double minqnew=std::min(q3,q4);
-
-          if (minqnew>minqold+.025) {
-            bool flip;
-            double normal1[3],normal2[3],normal3[3],normal4[3];
-            trinormal3(&p[3*t[0+3*t1]],&p[3*t[1+3*t1]],&p[3*t[2+3*t1]],normal1);
-            trinormal3(&p[3*t[0+3*t2]],&p[3*t[1+3*t2]],&p[3*t[2+3*t2]],normal2);
-            trinormal3(&p[3*newt[0][0]],&p[3*newt[0][1]],&p[3*newt[0][2]],normal3);
-            trinormal3(&p[3*newt[1][0]],&p[3*newt[1][1]],&p[3*newt[1][2]],normal4);
-            flip=dot(normal1,normal2)>0 && dot(normal3,normal4)>0;
-            if (flip) {
-              int nbt;
-              char nbn;
-              
-              // Insert new triangles
-              memcpy(t+3*t1,newt[0],3*sizeof(int));
-              memcpy(t+3*t2,newt[1],3*sizeof(int));
-              
-              // Update t2t and t2n
-              nbt=t2t[tix21+3*t2];
-              nbn=t2n[tix21+3*t2];
-              t2t[n1+3*t1]=nbt;
-              t2n[n1+3*t1]=nbn;
-              if (nbt>=0) {
-                t2t[nbn+3*nbt]=t1;
-                t2n[nbn+3*nbt]=n1;
-              }
-              
-              nbt=t2t[tix11+3*t1];
-              nbn=t2n[tix11+3*t1];
-              t2t[n2+3*t2]=nbt;
-              t2n[n2+3*t2]=nbn;
-              if (nbt>=0) {
-                t2t[nbn+3*nbt]=t2;
-                t2n[nbn+3*nbt]=n2;
-              }
-              
-              t2t[tix11+3*t1]=t2;
-              t2n[tix11+3*t1]=tix21;
-              t2t[tix21+3*t2]=t1;
-              t2n[tix21+3*t2]=tix11;
-            }
-          }
+    for (int n1=0; n1<3; n1++) {
+      int newt[2][3];
+      double newq[2],newnrm[2][3];
+      if (tflipgood(p,t,t2t,t2n,q,nrm,t1,n1,newt,newq,newnrm))
+        tflip(t,t2t,t2n,q,nrm,t1,n1,newt,newq,newnrm);
+    }
+
+  delete[] q;
+  delete[] nrm;
+}
+
+// Priority of the flips in tupdatepar, a fixed permutation of the edge
+// indices, so that neighboring flips are not ordered along the mesh
+inline unsigned int tflipkey(unsigned int id)
+{
+  id^=id>>16; id*=0x7feb352dU;
+  id^=id>>15; id*=0x846ca68bU;
+  id^=id>>16;
+  return id;
+}
+
+// Priority of the flip of edge n of triangle tr if it improves the triangles,
+// else UINT_MAX. Flips are stored on the side with the lower triangle index.
+inline unsigned int tflipprio(int *t2t,char *t2n,char *good,int tr,int n)
+{
+  int nb=t2t[n+3*tr];
+  if (nb<0)
+    return UINT_MAX;
+  if (good[n+3*tr])
+    return tflipkey(n+3*tr);
+  if (good[t2n[n+3*tr]+3*nb])
+    return tflipkey(t2n[n+3*tr]+3*nb);
+  return UINT_MAX;
+}
+
+// Highest priority (lowest value) of the flips that touch triangle tr, i.e.
+// flips of the edges of tr and of its neighbors
+inline unsigned int tflipowner(int *t2t,char *t2n,char *good,int tr)
+{
+  unsigned int prio=UINT_MAX;
+  for (int n=0; n<3; n++) {
+    prio=std::min(prio,tflipprio(t2t,t2n,good,tr,n));
+    int nb=t2t[n+3*tr];
+    if (nb>=0)
+      for (int m=0; m<3; m++)
+        prio=std::min(prio,tflipprio(t2t,t2n,good,nb,m));
+  }
+  return prio;
+}
+
+// Parallel version of tupdate. Every pass finds all improving flips, and
+// does at once the flips whose triangles and their neighbors are not touched
+// by a flip of higher priority. Passes are repeated until no improving flips
+// remain. The flips done at once change disjoint parts of t, t2t and t2n, so
+// no locking is needed and the result does not depend on nthreads.
+void tupdatepar(double *p,int *t,int *t2t,char *t2n,
+                int nt,int nthreads)
+{
+  char *good=new char[3*nt];
+  int *changed=new int[nt];
+  double *q=new double[nt];
+  double *nrm=new double[3*nt];
+  std::vector<int> flips;
+  std::vector<char> win;
+
+  for (int tr=0; tr<nt; tr++)
+    changed[tr]=0;
+  tquality(p,t,q,nrm,nt,nthreads);
+
+  for (int pass=1; ; pass++) {
+
+    // Improving flips, every edge is checked from its triangle of lower index
+    // and only again if one of its triangles was flipped in the previous pass
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+#endif
+    for (int t1=0; t1<nt; t1++)
+      for (int n1=0; n1<3; n1++) {
+        int t2=t2t[n1+3*t1];
+        if (pass==1 || changed[t1]==pass-1 || (t2>=0 && changed[t2]==pass-1)) {
+          int newt[2][3];
+          double newq[2],newnrm[2][3];
+          good[n1+3*t1]=t2>t1 && tflipgood(p,t,t2t,t2n,q,nrm,t1,n1,newt,newq,newnrm);
         }
       }
+
+    flips.clear();
+    for (int id=0; id<3*nt; id++)
+      if (good[id])
+        flips.push_back(id);
+    if (flips.empty())
+      break;
+    int nflips=flips.size();
+    win.resize(nflips);
+
+    // Flips of highest priority on their triangles and neighbors
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+#endif
+    for (int i=0; i<nflips; i++) {
+      int t1=flips[i]/3;
+      int t2=t2t[flips[i]];
+      unsigned int prio=tflipkey(flips[i]);
+      bool own=tflipowner(t2t,t2n,good,t1)==prio && tflipowner(t2t,t2n,good,t2)==prio;
+      for (int n=0; n<3 && own; n++) {
+        if (t2t[n+3*t1]>=0 && tflipowner(t2t,t2n,good,t2t[n+3*t1])!=prio)
+          own=false;
+        if (t2t[n+3*t2]>=0 && tflipowner(t2t,t2n,good,t2t[n+3*t2])!=prio)
+          own=false;
+      }
+      win[i]=own;
     }
+
+    // Do the flips, they touch disjoint triangles
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+#endif
+    for (int i=0; i<nflips; i++)
+      if (win[i]) {
+        int t1=flips[i]/3;
+        int n1=flips[i]%3;
+        int t2=t2t[flips[i]];
+        int newt[2][3];
+        double newq[2],newnrm[2][3];
+        tflipgood(p,t,t2t,t2n,q,nrm,t1,n1,newt,newq,newnrm);
+        tflip(t,t2t,t2n,q,nrm,t1,n1,newt,newq,newnrm);
+        changed[t1]=pass;
+        changed[t2]=pass;
+      }
+  }
+
+  delete[] good;
+  delete[] changed;
+  delete[] q;
+  delete[] nrm;
 }
   
+// [t,t2t,t2n]=trisurfupd(t,t2t,t2n,p)           one serial pass of flips
+// [t,t2t,t2n]=trisurfupd(t,t2t,t2n,p,nthreads)  flips until no flip improves,
+//                                               nthreads<1 uses all threads
 void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
   plhs[0]=mxDuplicateArray(prhs[0]);
@@ -130,7 +288,17 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
   int nt=mxGetN(prhs[0]);
 
   double *p=mxGetPr(prhs[3]);
-  int np=mxGetN(prhs[3]);
 
-  tupdate(p,t,t2t,t2n,np,nt);
+  if (nrhs>=5) {
+    int nthreads=(int)mxGetScalar(prhs[4]);
+#ifdef _OPENMP
+    if (nthreads<1)
+      nthreads=omp_get_max_threads();
+#else
+    nthreads=1;
+#endif
+    tupdatepar(p,t,t2t,t2n,nt,nthreads);
+  }
+  else
+    tupdate(p,t,t2t,t2n,nt);
 }
@@ -0,0 +1,10 @@
+/* closestNrbLinePointIGES for benchIGES, the mex function is renamed to benchClosestNrbLinePointIGES */
+
+/* FindSpan, BasisFuns and DersBasisFuns are also defined in benchNrbeval.c */
+
+#define mexFunction benchClosestNrbLinePointIGES
+#define FindSpan benchClosestFindSpan
+#define BasisFuns benchClosestBasisFuns
+#define DersBasisFuns benchClosestDersBasisFuns
+
+#include "../closestNrbLinePointIGES.c"
@@ -0,0 +1,823 @@
+/**************************************************************************
+ *
+ * benchIGES [action [baselinefile [folder]]]
+ *
+ * Measures the throughput of the mex functions and compares it with a
+ * baseline, to find performance regressions. benchIGES is a standalone
+ * program: the mex functions are linked with a minimal mx/mex library
+ * (mex.h, mexShim.c), so Matlab is not needed.
+ *
+ * Build in this folder (without -fopenmp for serial evaluation):
+ *
+ * cc -O2 -fopenmp -I. benchIGES.c benchNrbeval.c benchClosest.c benchParse.c mexShim.c -lm -o benchIGES
+ *
+ * Usage:
+ *
+ * benchIGES
+ * benchIGES compare
+ * benchIGES save
+ * benchIGES reference
+ * benchIGES action baselinefile folder
+ *
+ * 'compare' (default) runs the workloads and compares them with the
+ * baseline in baselinefile (default benchIGES.txt), if it exists, and with
+ * the reference results in benchIGES/benchIGESref.txt of folder. 'save'
+ * runs the workloads and stores them as the new baseline. 'reference'
+ * runs the workloads and stores the results, without throughput and for
+ * at most 100 points, as the new reference results. folder is the toolbox
+ * folder, with example.igs and example2.igs (default ..).
+ *
+ * The workloads are run on the surfaces (entity 128) of example.igs and
+ * example2.igs and on two synthetic surfaces, one of high degree (order 8,
+ * 40x40 control points) and one with many knots (order 4, 400x400 control
+ * points):
+ *
+ * eval        - P=nrbevalIGES(srf,UV)
+ * deriv1      - [P,Pu,Pv]=nrbevalIGES(srf,UV)
+ * deriv2      - [P,Pu,Pv,Puu,Puv,Pvv]=nrbevalIGES(srf,UV)
+ * closest     - [P,UV]=closestNrbLinePointIGES(srf,UV0,r0), points off the
+ *               surface
+ * closestline - [P,UV]=closestNrbLinePointIGES(srf,UV0,r0,v), lines through
+ *               the surface
+ *
+ * The surfaces are compiled as nrbCompileIGES(nurbs,[]) does, and the
+ * parameter values and points are the same in every run. Transformation
+ * matrices (entity 124) are not applied to the surfaces of the files.
+ *
+ * For every model and workload benchIGES prints the number of points/lines
+ * per run, the throughput (points/s, best of 3 runs), the ratio against
+ * the baseline and the largest difference of the first output of the
+ * first surface (max 500 points) against the baseline and the reference
+ * results, relative to the size of the model. A workload is reported as a
+ * regression if ratio<0.8 or maxdiff>1e-9, and benchIGES then returns 1.
+ * Throughput depends on the machine, so the baseline must be saved on the
+ * machine it is compared on. The reference results are part of the
+ * toolbox and only change when the results are meant to change.
+ *
+ **************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mex.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define BENCH_NUMMODELS 4
+#define BENCH_NUMWORKLOADS 5
+#define BENCH_NUMRUNS 3
+#define BENCH_MAXKEEP 500
+#define BENCH_NUMREFERENCE 100
+#define BENCH_NUMEVAL 100000
+#define BENCH_NUMCLOSEST 10000
+
+/* The mex functions (benchNrbeval.c, benchClosest.c and benchParse.c) */
+
+void benchNrbevalIGES(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void benchClosestNrbLinePointIGES(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void benchParseIGES(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+static const char *benchModels[BENCH_NUMMODELS] = {"example.igs", "example2.igs", "order8", "knots400"};
+static const char *benchWorkloads[BENCH_NUMWORKLOADS] = {"eval", "deriv1", "deriv2", "closest", "closestline"};
+
+typedef struct {
+    int ordU, ordV;         /* orders */
+    int ncp, kcp;           /* number of control points in u and v */
+    double *knotU, *knotV;  /* knot sequences */
+    double *coefs;          /* 4 x ncp x kcp homogeneous control points */
+} benchNet;
+
+typedef struct {
+    mxArray *srf;           /* compiled NURBS */
+    double u[2], v[2];      /* parameter domain */
+} benchSurface;
+
+typedef struct {
+    mxArray *UV;            /* parameter values, start values for the closest point workloads */
+    mxArray *r0, *v;        /* points/lines for the closest point workloads */
+} benchData;
+
+typedef struct {
+    char model[32], workload[32];
+    int numpnts;
+    double pntspersec;      /* throughput, best of BENCH_NUMRUNS runs */
+    double ratio;           /* pntspersec/(pntspersec of baseline), NaN if no baseline */
+    double maxdiff;         /* largest difference of P against the baseline, NaN if no baseline */
+    int numP;               /* number of points in P */
+    double P[3*BENCH_MAXKEEP];
+} benchResult;
+
+
+static double benchTime(void){
+    /* benchTime returns the wall clock time in seconds (processor time without OpenMP) */
+
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return (double)clock()/CLOCKS_PER_SEC;
+#endif
+
+}
+
+
+static mxArray *benchCompile(const benchNet *nets, int numNets){
+    /* benchCompile returns a compiled NURBS surface, as nrbCompileIGES(nurbs,dnurbs,d2nurbs), see mexSourceFiles/nrbCompiled.c */
+
+    /* benchCompile( nets - nurbs, and du, dv, duu, duv, dvv if numNets is 6, numNets - number of nets, 1 or 6) */
+
+    int k, lenU, lenV, lenC, lenhdr = 4+7*numNets, len, pos;
+    double *hdr;
+    mxArray *srf;
+
+    len = 4*((lenhdr+3)/4);
+    for (k = 0; k < numNets; k++){
+        len += 4*((nets[k].ncp+nets[k].ordU+3)/4)+4*((nets[k].kcp+nets[k].ordV+3)/4)+4*nets[k].ncp*nets[k].kcp;
+    }
+
+    srf = mxCreateDoubleMatrix(1, len, mxREAL);
+    hdr = mxGetPr(srf);
+    hdr[0] = 1128419918.0;
+    hdr[1] = 1.0;
+    hdr[2] = 2.0;
+    hdr[3] = numNets;
+    pos = 4*((lenhdr+3)/4);
+    for (k = 0; k < numNets; k++){
+        lenU = nets[k].ncp+nets[k].ordU;
+        lenV = nets[k].kcp+nets[k].ordV;
+        lenC = 4*nets[k].ncp*nets[k].kcp;
+        hdr[4+7*k] = nets[k].ordU;
+        hdr[5+7*k] = nets[k].ordV;
+        hdr[6+7*k] = nets[k].ncp;
+        hdr[7+7*k] = nets[k].kcp;
+        hdr[8+7*k] = pos;
+        memcpy(&hdr[pos], nets[k].knotU, lenU*sizeof(double));
+        pos += 4*((lenU+3)/4);
+        hdr[9+7*k] = pos;
+        memcpy(&hdr[pos], nets[k].knotV, lenV*sizeof(double));
+        pos += 4*((lenV+3)/4);
+        hdr[10+7*k] = pos;
+        memcpy(&hdr[pos], nets[k].coefs, lenC*sizeof(double));
+        pos += lenC;
+    }
+
+    return srf;
+
+}
+
+
+static void benchDerivative(const benchNet *net, int dir, benchNet *dnet){
+    /* benchDerivative sets up the derivative net of a net in u (dir 0) or v (dir 1), as nrbDerivativesIGES, free dnet->coefs with mxFree */
+
+    int i, j, c, ord = (dir==0) ? net->ordU : net->ordV, step = (dir==0) ? 1 : net->ncp;
+    double *knot = (dir==0) ? net->knotU : net->knotV;
+
+    *dnet = *net;
+    if (ord<=1){
+        /* Order < 1 after derivation, the net is zero and its knots are not read */
+        if (dir==0){
+            dnet->ordU = 0;
+        }
+        else{
+            dnet->ordV = 0;
+        }
+        dnet->coefs = (double*) mxMalloc(4*net->ncp*net->kcp*sizeof(double));
+        memcpy(dnet->coefs, net->coefs, 4*net->ncp*net->kcp*sizeof(double));
+        return;
+    }
+
+    if (dir==0){
+        dnet->ordU = ord-1;
+        dnet->ncp = net->ncp-1;
+        dnet->knotU = net->knotU+1;
+    }
+    else{
+        dnet->ordV = ord-1;
+        dnet->kcp = net->kcp-1;
+        dnet->knotV = net->knotV+1;
+    }
+    dnet->coefs = (double*) mxMalloc(4*dnet->ncp*dnet->kcp*sizeof(double));
+    for (j = 0; j < dnet->kcp; j++){
+        for (i = 0; i < dnet->ncp; i++){
+            for (c = 0; c < 4; c++){
+                dnet->coefs[4*(i+dnet->ncp*j)+c] = (ord-1)*(net->coefs[4*(i+net->ncp*j+step)+c]-net->coefs[4*(i+net->ncp*j)+c])/(knot[((dir==0) ? i : j)+ord]-knot[((dir==0) ? i : j)+1]);
+            }
+        }
+    }
+
+}
+
+
+static double benchCheckNets(void){
+    /* benchCheckNets returns the largest difference, relative to the size of each output, of [P,Pu,Pv,Puu,Puv,Pvv]=nrbevalIGES(srf,UV)
+     * with the derivative nets compiled into srf and without, on a rational patch of order 2 in u and 3 in v, i.e. with derivative nets
+     * of order 1, and of P=nrbevalIGES(srf,UV) and [P,Pu]=nrbevalIGES(srf,UV) on the same control points with order 1 in u */
+
+    int i, j, k, n = 200;
+    double knotU[5] = {0.0, 0.0, 0.4, 1.0, 1.0}, knotU1[4] = {0.0, 0.3, 0.7, 1.0}, knotV[7] = {0.0, 0.0, 0.0, 0.6, 1.0, 1.0, 1.0}, coefs[4*3*4];
+    double w, size, diff, maxdiff = 0.0, *UV, *a, *b;
+    benchNet nets[6], net1;
+    mxArray *arg[2], *srfNets, *srfDers, *srfOrd1, *outNets[6], *outDers[6];
+
+    for (j = 0; j < 4; j++){
+        for (i = 0; i < 3; i++){
+            w = 1.0+0.3*cos(1.0+i+2.0*j);
+            coefs[4*(i+3*j)] = w*i;
+            coefs[4*(i+3*j)+1] = w*j;
+            coefs[4*(i+3*j)+2] = w*0.5*sin(i+2.0*j);
+            coefs[4*(i+3*j)+3] = w;
+        }
+    }
+    nets[0].ordU = 2;
+    nets[0].ordV = 3;
+    nets[0].ncp = 3;
+    nets[0].kcp = 4;
+    nets[0].knotU = knotU;
+    nets[0].knotV = knotV;
+    nets[0].coefs = coefs;
+    benchDerivative(&nets[0], 0, &nets[1]);
+    benchDerivative(&nets[0], 1, &nets[2]);
+    benchDerivative(&nets[1], 0, &nets[3]);
+    benchDerivative(&nets[1], 1, &nets[4]);
+    benchDerivative(&nets[2], 1, &nets[5]);
+    srfNets = benchCompile(nets, 6);
+    srfDers = benchCompile(nets, 1);
+    net1 = nets[0];
+    net1.ordU = 1;
+    net1.knotU = knotU1;
+    srfOrd1 = benchCompile(&net1, 1);
+    for (k = 1; k < 6; k++){
+        mxFree(nets[k].coefs);
+    }
+
+    arg[1] = mxCreateDoubleMatrix(2, n, mxREAL);
+    UV = mxGetPr(arg[1]);
+    for (i = 0; i < n; i++){
+        UV[2*i] = fmod((i+1)*0.7548776662466927, 1.0);
+        UV[2*i+1] = fmod((i+1)*0.5698402909980532, 1.0);
+    }
+    arg[0] = srfNets;
+    benchNrbevalIGES(6, outNets, 2, (const mxArray**)arg);
+    arg[0] = srfDers;
+    benchNrbevalIGES(6, outDers, 2, (const mxArray**)arg);
+
+    for (k = 0; k < 6; k++){
+        a = mxGetPr(outNets[k]);
+        b = mxGetPr(outDers[k]);
+        size = 0.0;
+        for (i = 0; i < 3*n; i++){
+            size = (fabs(b[i])>size) ? fabs(b[i]) : size;
+        }
+        size = (size>0.0) ? size : 1.0;
+        for (i = 0; i < 3*n; i++){
+            diff = fabs(a[i]-b[i])/size;
+            maxdiff = (diff>maxdiff || diff!=diff) ? diff : maxdiff;
+        }
+        mxDestroyArray(outNets[k]);
+        mxDestroyArray(outDers[k]);
+    }
+
+    /* P alone is evaluated by NURBSsurfaceEval, P with Pu by the derivatives of the basis functions */
+    arg[0] = srfOrd1;
+    benchNrbevalIGES(1, outNets, 2, (const mxArray**)arg);
+    benchNrbevalIGES(2, outDers, 2, (const mxArray**)arg);
+    a = mxGetPr(outNets[0]);
+    b = mxGetPr(outDers[0]);
+    for (i = 0; i < 3*n; i++){
+        diff = fabs(a[i]-b[i]);
+        maxdiff = (diff>maxdiff || diff!=diff) ? diff : maxdiff;
+    }
+    mxDestroyArray(outNets[0]);
+    mxDestroyArray(outDers[0]);
+    mxDestroyArray(outDers[1]);
+
+    mxDestroyArray(arg[1]);
+    mxDestroyArray(srfNets);
+    mxDestroyArray(srfDers);
+    mxDestroyArray(srfOrd1);
+
+    return maxdiff;
+
+}
+
+
+static void benchSynthetic(int order, int numcp, benchSurface *srf){
+    /* benchSynthetic sets up a synthetic rational surface on [0,1]x[0,1] with numcp x numcp control points and uniform knots */
+
+    int i, j;
+    double I, J, w, *knots, *coefs;
+    benchNet net;
+
+    knots = (double*) mxMalloc((numcp+order)*sizeof(double));
+    coefs = (double*) mxMalloc(4*numcp*numcp*sizeof(double));
+
+    for (i = 0; i < numcp+order; i++){
+        if (i<order){
+            knots[i] = 0.0;
+        }
+        else if (i>=numcp){
+            knots[i] = 1.0;
+        }
+        else{
+            knots[i] = (double)(i-order+1)/(numcp-order+1);
+        }
+    }
+    for (j = 0; j < numcp; j++){
+        for (i = 0; i < numcp; i++){
+            I = (double)i/(numcp-1);
+            J = (double)j/(numcp-1);
+            w = 1.0+0.25*sin(7.0*I+3.0*J);
+            coefs[4*(i+numcp*j)] = w*I;
+            coefs[4*(i+numcp*j)+1] = w*J;
+            coefs[4*(i+numcp*j)+2] = w*(0.2*sin(11.0*I)*cos(9.0*J));
+            coefs[4*(i+numcp*j)+3] = w;
+        }
+    }
+
+    net.ordU = order;
+    net.ordV = order;
+    net.ncp = numcp;
+    net.kcp = numcp;
+    net.knotU = knots;
+    net.knotV = knots;
+    net.coefs = coefs;
+    srf->srf = benchCompile(&net, 1);
+    srf->u[0] = 0.0;
+    srf->u[1] = 1.0;
+    srf->v[0] = 0.0;
+    srf->v[1] = 1.0;
+
+    mxFree(knots);
+    mxFree(coefs);
+
+}
+
+
+static int benchReadSurfaces(const char *filename, benchSurface **srfs){
+    /* benchReadSurfaces reads the NURBS surfaces (entity 128) of an IGES file with parseIGES, returns the number of surfaces */
+
+    int e, i, k1, k2, m1, m2, A, B, C, numEnt, numSrfs = 0;
+    double *p, *coefs;
+    benchNet net;
+    mxArray *arg, *out[4], *Pdata;
+
+    /* parseIGES sets all 4 outputs */
+    arg = mxCreateString(filename);
+    benchParseIGES(4, out, 1, (const mxArray**)&arg);
+    mxDestroyArray(arg);
+    for (i = 1; i < 4; i++){
+        mxDestroyArray(out[i]);
+    }
+    Pdata = out[0];
+
+    numEnt = (int)mxGetNumberOfElements(Pdata);
+    *srfs = (benchSurface*) mxMalloc((numEnt>0 ? numEnt : 1)*sizeof(benchSurface));
+
+    for (e = 0; e < numEnt; e++){
+        p = mxGetPr(mxGetCell(Pdata, e));
+        if (mxGetNumberOfElements(mxGetCell(Pdata, e))<10 || p[0]!=128.0){
+            continue;
+        }
+        k1 = (int)p[1];
+        k2 = (int)p[2];
+        m1 = (int)p[3];
+        m2 = (int)p[4];
+        A = 1+k1+m1;
+        B = 1+k2+m2;
+        C = (k1+1)*(k2+1);
+        if ((int)mxGetNumberOfElements(mxGetCell(Pdata, e))<16+A+B+4*C){
+            mexErrMsgTxt("Corrupt NURBS surface in IGES file.");
+        }
+
+        /* Pdata: type, K1, K2, M1, M2, PROP1-5, knots S, knots T, weights, control points, U0, U1, V0, V1 */
+        coefs = (double*) mxMalloc(4*C*sizeof(double));
+        for (i = 0; i < C; i++){
+            coefs[4*i] = p[12+A+B+C+3*i]*p[12+A+B+i];
+            coefs[4*i+1] = p[13+A+B+C+3*i]*p[12+A+B+i];
+            coefs[4*i+2] = p[14+A+B+C+3*i]*p[12+A+B+i];
+            coefs[4*i+3] = p[12+A+B+i];
+        }
+        net.ordU = m1+1;
+        net.ordV = m2+1;
+        net.ncp = k1+1;
+        net.kcp = k2+1;
+        net.knotU = &p[10];
+        net.knotV = &p[11+A];
+        net.coefs = coefs;
+        (*srfs)[numSrfs].srf = benchCompile(&net, 1);
+        (*srfs)[numSrfs].u[0] = p[12+A+B+4*C];
+        (*srfs)[numSrfs].u[1] = p[13+A+B+4*C];
+        (*srfs)[numSrfs].v[0] = p[14+A+B+4*C];
+        (*srfs)[numSrfs].v[1] = p[15+A+B+4*C];
+        numSrfs++;
+        mxFree(coefs);
+    }
+
+    mxDestroyArray(Pdata);
+
+    return numSrfs;
+
+}
+
+
+static int benchModel(const char *model, const char *folder, benchSurface **srfs, double *scale, int *numEval, int *numClosest){
+    /* benchModel sets up the compiled surfaces of a model and the number of points per surface in the workloads, returns the number of surfaces */
+
+    /* benchModel( model - name of model, folder - folder with the IGES files, srfs - surfaces, scale - size of the model, for relative differences, numEval, numClosest - number of points per surface) */
+
+    int i, j, k, c, numSrfs;
+    double lo[3], hi[3], *UV, *P;
+    char *filename;
+    mxArray *arg[2], *Pgrid;
+
+    if (strcmp(model, "order8")==0 || strcmp(model, "knots400")==0){
+        numSrfs = 1;
+        *srfs = (benchSurface*) mxMalloc(sizeof(benchSurface));
+        if (strcmp(model, "order8")==0){
+            benchSynthetic(8, 40, *srfs);
+        }
+        else{
+            benchSynthetic(4, 400, *srfs);
+        }
+    }
+    else{
+        filename = (char*) mxMalloc(strlen(folder)+strlen(model)+2);
+        sprintf(filename, "%s/%s", folder, model);
+        numSrfs = benchReadSurfaces(filename, srfs);
+        mxFree(filename);
+        if (numSrfs==0){
+            mexErrMsgTxt("No NURBS surfaces in IGES file.");
+        }
+    }
+    *numEval = (BENCH_NUMEVAL+numSrfs-1)/numSrfs;
+    *numClosest = (BENCH_NUMCLOSEST+numSrfs-1)/numSrfs;
+
+    /* Size of the model from 5x5 points on every surface */
+    for (c = 0; c < 3; c++){
+        lo[c] = HUGE_VAL;
+        hi[c] = -HUGE_VAL;
+    }
+    arg[1] = mxCreateDoubleMatrix(2, 25, mxREAL);
+    UV = mxGetPr(arg[1]);
+    for (k = 0; k < numSrfs; k++){
+        arg[0] = (*srfs)[k].srf;
+        for (j = 0; j < 5; j++){
+            for (i = 0; i < 5; i++){
+                UV[2*(i+5*j)] = (*srfs)[k].u[0]+0.25*i*((*srfs)[k].u[1]-(*srfs)[k].u[0]);
+                UV[2*(i+5*j)+1] = (*srfs)[k].v[0]+0.25*j*((*srfs)[k].v[1]-(*srfs)[k].v[0]);
+            }
+        }
+        benchNrbevalIGES(1, &Pgrid, 2, (const mxArray**)arg);
+        P = mxGetPr(Pgrid);
+        for (i = 0; i < 25; i++){
+            for (c = 0; c < 3; c++){
+                lo[c] = (P[3*i+c]<lo[c]) ? P[3*i+c] : lo[c];
+                hi[c] = (P[3*i+c]>hi[c]) ? P[3*i+c] : hi[c];
+            }
+        }
+        mxDestroyArray(Pgrid);
+    }
+    mxDestroyArray(arg[1]);
+
+    *scale = 0.0;
+    for (c = 0; c < 3; c++){
+        *scale = (hi[c]-lo[c]>*scale) ? hi[c]-lo[c] : *scale;
+    }
+    if (*scale==0.0){
+        *scale = 1.0;
+    }
+
+    return numSrfs;
+
+}
+
+
+static int benchSetData(const benchSurface *srfs, int numSrfs, int closest, int n, benchData *data){
+    /* benchSetData sets up the parameter values, and the points/lines for the closest point workloads, returns the number of points */
+
+    /* benchSetData( srfs - surfaces, numSrfs - number of surfaces, closest - 1 for the closest point workloads, n - number of points per surface, data - data of every surface) */
+
+    int i, k, c;
+    double du, dv, s1, s2, lenN, lenPu, h, N[3], *UV, *UV0, *P, *Pu, *Pv, *r0, *v;
+    mxArray *arg[2], *out[3];
+
+    for (k = 0; k < numSrfs; k++){
+        du = srfs[k].u[1]-srfs[k].u[0];
+        dv = srfs[k].v[1]-srfs[k].v[0];
+
+        /* Low discrepancy sequence, the same in every run */
+        data[k].UV = mxCreateDoubleMatrix(2, n, mxREAL);
+        UV = mxGetPr(data[k].UV);
+        for (i = 0; i < n; i++){
+            UV[2*i] = srfs[k].u[0]+du*fmod((i+1)*0.7548776662466927, 1.0);
+            UV[2*i+1] = srfs[k].v[0]+dv*fmod((i+1)*0.5698402909980532, 1.0);
+        }
+        data[k].r0 = NULL;
+        data[k].v = NULL;
+        if (!closest){
+            continue;
+        }
+
+        arg[0] = srfs[k].srf;
+        arg[1] = data[k].UV;
+        benchNrbevalIGES(3, out, 2, (const mxArray**)arg);
+        P = mxGetPr(out[0]);
+        Pu = mxGetPr(out[1]);
+        Pv = mxGetPr(out[2]);
+
+        data[k].r0 = mxCreateDoubleMatrix(3, n, mxREAL);
+        data[k].v = mxCreateDoubleMatrix(3, n, mxREAL);
+        r0 = mxGetPr(data[k].r0);
+        v = mxGetPr(data[k].v);
+        for (i = 0; i < n; i++){
+            N[0] = Pu[3*i+1]*Pv[3*i+2]-Pu[3*i+2]*Pv[3*i+1];
+            N[1] = Pu[3*i+2]*Pv[3*i]-Pu[3*i]*Pv[3*i+2];
+            N[2] = Pu[3*i]*Pv[3*i+1]-Pu[3*i+1]*Pv[3*i];
+            lenN = sqrt(N[0]*N[0]+N[1]*N[1]+N[2]*N[2]);
+            lenN = (lenN==0.0) ? 1.0 : lenN;
+            lenPu = sqrt(Pu[3*i]*Pu[3*i]+Pu[3*i+1]*Pu[3*i+1]+Pu[3*i+2]*Pu[3*i+2]);
+            h = sqrt(Pv[3*i]*Pv[3*i]+Pv[3*i+1]*Pv[3*i+1]+Pv[3*i+2]*Pv[3*i+2])*dv;
+            h = 0.01*((lenPu*du>h) ? lenPu*du : h);
+            lenPu = (lenPu>2.220446049250313e-16) ? lenPu : 2.220446049250313e-16;
+            for (c = 0; c < 3; c++){
+                r0[3*i+c] = P[3*i+c]+h*N[c]/lenN;
+                v[3*i+c] = N[c]/lenN+0.3*Pu[3*i+c]/lenPu;
+            }
+        }
+        for (c = 0; c < 3; c++){
+            mxDestroyArray(out[c]);
+        }
+
+        /* Start values off the solution, clamped to the parameter domain */
+        UV0 = mxGetPr(data[k].UV);
+        for (i = 0; i < n; i++){
+            s1 = fmod((i+1)*0.7548776662466927, 1.0);
+            s2 = fmod((i+1)*0.5698402909980532, 1.0);
+            UV0[2*i] += 0.05*du*cos(20.0*s2);
+            UV0[2*i+1] += 0.05*dv*sin(20.0*s1);
+            UV0[2*i] = (UV0[2*i]<srfs[k].u[0]) ? srfs[k].u[0] : ((UV0[2*i]>srfs[k].u[1]) ? srfs[k].u[1] : UV0[2*i]);
+            UV0[2*i+1] = (UV0[2*i+1]<srfs[k].v[0]) ? srfs[k].v[0] : ((UV0[2*i+1]>srfs[k].v[1]) ? srfs[k].v[1] : UV0[2*i+1]);
+        }
+    }
+
+    return n*numSrfs;
+
+}
+
+
+static double benchRun(const benchSurface *srfs, int numSrfs, const benchData *data, int workload, benchResult *res){
+    /* benchRun runs a workload on all surfaces, returns the time and keeps the first output of the first surface in res */
+
+    int k, j, nlhs;
+    double t;
+    mxArray *arg[4], *out[6];
+
+    t = benchTime();
+    for (k = 0; k < numSrfs; k++){
+        arg[0] = srfs[k].srf;
+        arg[1] = data[k].UV;
+        arg[2] = data[k].r0;
+        arg[3] = data[k].v;
+        switch (workload){
+            case 0:
+                nlhs = 1;
+                benchNrbevalIGES(nlhs, out, 2, (const mxArray**)arg);
+                break;
+            case 1:
+                nlhs = 3;
+                benchNrbevalIGES(nlhs, out, 2, (const mxArray**)arg);
+                break;
+            case 2:
+                nlhs = 6;
+                benchNrbevalIGES(nlhs, out, 2, (const mxArray**)arg);
+                break;
+            case 3:
+                nlhs = 2;
+                benchClosestNrbLinePointIGES(nlhs, out, 3, (const mxArray**)arg);
+                break;
+            default:
+                nlhs = 2;
+                benchClosestNrbLinePointIGES(nlhs, out, 4, (const mxArray**)arg);
+                break;
+        }
+        if (k==0){
+            res->numP = (int)mxGetN(out[0]);
+            res->numP = (res->numP<BENCH_MAXKEEP) ? res->numP : BENCH_MAXKEEP;
+            memcpy(res->P, mxGetPr(out[0]), 3*res->numP*sizeof(double));
+        }
+        for (j = 0; j < nlhs; j++){
+            mxDestroyArray(out[j]);
+        }
+    }
+
+    return benchTime()-t;
+
+}
+
+
+static int benchLoad(const char *baselinefile, benchResult **base){
+    /* benchLoad reads a baseline saved by benchSave, returns the number of results or -1 if there is no baseline */
+
+    int k, i, num = 0, ok = 1;
+    FILE *fp = fopen(baselinefile, "r");
+
+    if (fp==NULL){
+        return -1;
+    }
+    if (fscanf(fp, " benchIGES %d", &num)!=1 || num<0){
+        fclose(fp);
+        mexErrMsgTxt("Corrupt baseline file.");
+    }
+    *base = (benchResult*) mxCalloc(num>0 ? num : 1, sizeof(benchResult));
+    for (k = 0; k < num && ok; k++){
+        ok = (fscanf(fp, " %31s %31s %d %lg %d", (*base)[k].model, (*base)[k].workload, &(*base)[k].numpnts, &(*base)[k].pntspersec, &(*base)[k].numP)==5);
+        ok = ok && (*base)[k].numP>=0 && (*base)[k].numP<=BENCH_MAXKEEP;
+        for (i = 0; i < 3*(*base)[k].numP && ok; i++){
+            ok = (fscanf(fp, " %lg", &(*base)[k].P[i])==1);
+        }
+    }
+    fclose(fp);
+    if (!ok){
+        mexErrMsgTxt("Corrupt baseline file.");
+    }
+    return num;
+
+}
+
+
+static void benchCompare(benchResult *res, int numRes, const benchResult *base, int numBase, const double *scale){
+    /* benchCompare sets the ratio against base and raises the maxdiff of the results to their difference against base,
+     * a base without throughput (points/s 0) gives no ratio and a base may have fewer points than the results */
+
+    int k, j, i;
+    double diff;
+
+    for (k = 0; k < numRes; k++){
+        for (j = 0; j < numBase; j++){
+            if (strcmp(base[j].model, res[k].model)==0 && strcmp(base[j].workload, res[k].workload)==0){
+                if (base[j].pntspersec>0.0){
+                    res[k].ratio = res[k].pntspersec/base[j].pntspersec;
+                }
+                if (res[k].maxdiff!=res[k].maxdiff){
+                    res[k].maxdiff = 0.0;
+                }
+                if (base[j].numP>res[k].numP){
+                    res[k].maxdiff = HUGE_VAL;
+                    continue;
+                }
+                for (i = 0; i < 3*base[j].numP; i++){
+                    diff = fabs(base[j].P[i]-res[k].P[i])/scale[k/BENCH_NUMWORKLOADS];
+                    res[k].maxdiff = (diff>res[k].maxdiff || diff!=diff) ? diff : res[k].maxdiff;
+                }
+            }
+        }
+    }
+
+}
+
+
+static void benchSave(const char *baselinefile, const benchResult *res, int num, int reference){
+    /* benchSave writes the results as a baseline, a text file with one header line per model and workload followed by its points,
+     * or if reference is 1 as reference results, with points/s 0, at most BENCH_NUMREFERENCE points and 13 digits */
+
+    int k, i, numP;
+    FILE *fp = fopen(baselinefile, "w");
+
+    if (fp==NULL){
+        mexErrMsgTxt("Could not open baseline file.");
+    }
+    fprintf(fp, "benchIGES %d\n", num);
+    for (k = 0; k < num; k++){
+        numP = (reference && res[k].numP>BENCH_NUMREFERENCE) ? BENCH_NUMREFERENCE : res[k].numP;
+        fprintf(fp, "%s %s %d %.17g %d\n", res[k].model, res[k].workload, res[k].numpnts, reference ? 0.0 : res[k].pntspersec, numP);
+        for (i = 0; i < numP; i++){
+            if (reference){
+                fprintf(fp, "%.13g %.13g %.13g\n", res[k].P[3*i], res[k].P[3*i+1], res[k].P[3*i+2]);
+            }
+            else{
+                fprintf(fp, "%.17g %.17g %.17g\n", res[k].P[3*i], res[k].P[3*i+1], res[k].P[3*i+2]);
+            }
+        }
+    }
+    if (fclose(fp)!=0){
+        mexErrMsgTxt("Could not write baseline file.");
+    }
+
+}
+
+
+int main(int argc, char *argv[]){
+
+    int m, w, r, k, numSrfs, numEval, numClosest, numRes = 0, numBase, regression = 0;
+    double t, best, scale[BENCH_NUMMODELS], netdiff;
+    const char *action = "compare", *baselinefile = "benchIGES.txt", *folder = "..";
+    char *referencefile;
+    benchSurface *srfs;
+    benchData *data;
+    benchResult *res, *base = NULL;
+
+    if (argc>1){
+        action = argv[1];
+    }
+    if (argc>2){
+        baselinefile = argv[2];
+    }
+    if (argc>3){
+        folder = argv[3];
+    }
+    if (argc>4 || (strcmp(action, "compare")!=0 && strcmp(action, "save")!=0 && strcmp(action, "reference")!=0)){
+        fprintf(stderr, "Usage: benchIGES [compare|save|reference [baselinefile [folder]]]\n");
+        return 2;
+    }
+    referencefile = (char*) mxMalloc(strlen(folder)+strlen("/benchIGES/benchIGESref.txt")+1);
+    sprintf(referencefile, "%s/benchIGES/benchIGESref.txt", folder);
+
+    netdiff = benchCheckNets();
+
+    res = (benchResult*) mxCalloc(BENCH_NUMMODELS*BENCH_NUMWORKLOADS, sizeof(benchResult));
+
+    for (m = 0; m < BENCH_NUMMODELS; m++){
+
+        numSrfs = benchModel(benchModels[m], folder, &srfs, &scale[m], &numEval, &numClosest);
+        data = (benchData*) mxMalloc(numSrfs*sizeof(benchData));
+
+        for (w = 0; w < BENCH_NUMWORKLOADS; w++){
+
+            strcpy(res[numRes].model, benchModels[m]);
+            strcpy(res[numRes].workload, benchWorkloads[w]);
+            res[numRes].numpnts = benchSetData(srfs, numSrfs, w>=3, (w>=3) ? numClosest : numEval, data);
+
+            best = HUGE_VAL;
+            for (r = 0; r < BENCH_NUMRUNS; r++){
+                t = benchRun(srfs, numSrfs, data, w, &res[numRes]);
+                best = (t<best) ? t : best;
+            }
+            best = (best>0.0) ? best : 1e-9;
+            res[numRes].pntspersec = res[numRes].numpnts/best;
+            res[numRes].ratio = mxGetNaN();
+            res[numRes].maxdiff = mxGetNaN();
+            numRes++;
+
+            for (k = 0; k < numSrfs; k++){
+                mxDestroyArray(data[k].UV);
+                mxDestroyArray(data[k].r0);
+                mxDestroyArray(data[k].v);
+            }
+
+        }
+
+        for (k = 0; k < numSrfs; k++){
+            mxDestroyArray(srfs[k].srf);
+        }
+        mxFree(srfs);
+        mxFree(data);
+
+    }
+
+    if (strcmp(action, "save")==0){
+        benchSave(baselinefile, res, numRes, 0);
+        printf("Baseline saved in %s\n", baselinefile);
+    }
+    else if (strcmp(action, "reference")==0){
+        benchSave(referencefile, res, numRes, 1);
+        printf("Reference results saved in %s\n", referencefile);
+    }
+    else{
+        if ((numBase = benchLoad(referencefile, &base))>=0){
+            benchCompare(res, numRes, base, numBase, scale);
+            mxFree(base);
+        }
+        else{
+            printf("No reference results in %s\n", referencefile);
+        }
+        if ((numBase = benchLoad(baselinefile, &base))>=0){
+            benchCompare(res, numRes, base, numBase, scale);
+            mxFree(base);
+        }
+    }
+
+    printf("%-14s %-12s %9s %14s %8s %10s\n", "model", "workload", "points", "points/s", "ratio", "maxdiff");
+    for (k = 0; k < numRes; k++){
+        printf("%-14s %-12s %9d %14.4g %8.3f %10.2g", res[k].model, res[k].workload, res[k].numpnts, res[k].pntspersec, res[k].ratio, res[k].maxdiff);
+        if (res[k].ratio<0.8 || res[k].maxdiff>1e-9 || (res[k].maxdiff!=res[k].maxdiff && res[k].ratio==res[k].ratio)){
+            printf("  REGRESSION");
+            regression = 1;
+        }
+        printf("\n");
+    }
+    printf("%-14s %-12s %9d %14s %8s %10.2g", "order2x3", "netderivs", 200, "", "", netdiff);
+    if (!(netdiff<=1e-9)){
+        printf("  REGRESSION");
+        regression = 1;
+    }
+    printf("\n");
+
+    mxFree(res);
+    mxFree(referencefile);
+
+    return regression;
+
+}
@@ -0,0 +1,5 @@
+/* nrbevalIGES for benchIGES, the mex function is renamed to benchNrbevalIGES */
+
+#define mexFunction benchNrbevalIGES
+
+#include "../nrbevalIGES.c"
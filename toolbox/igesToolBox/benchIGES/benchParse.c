@@ -0,0 +1,5 @@
+/* parseIGES for benchIGES, the mex function is renamed to benchParseIGES */
+
+#define mexFunction benchParseIGES
+
+#include "../parseIGES.c"
@@ -0,0 +1,83 @@
+/* Minimal mx/mex interface for running the mex functions of the toolbox without Matlab, used by benchIGES */
+
+/* Only the functions used by nrbevalIGES, closestNrbLinePointIGES and parseIGES are declared. Arrays are real, and
+ * struct arrays are not supported (mxGetField returns NULL), so the surfaces must be given as compiled NURBS. */
+
+#ifndef MEXSHIM_H
+#define MEXSHIM_H
+
+#include <stddef.h>
+
+#define MXSHIM_MAXDIMS 8
+
+typedef size_t mwSize;
+typedef size_t mwIndex;
+
+typedef enum {
+    mxUNKNOWN_CLASS, mxCELL_CLASS, mxSTRUCT_CLASS, mxLOGICAL_CLASS, mxCHAR_CLASS, mxVOID_CLASS, mxDOUBLE_CLASS,
+    mxSINGLE_CLASS, mxINT8_CLASS, mxUINT8_CLASS, mxINT16_CLASS, mxUINT16_CLASS, mxINT32_CLASS, mxUINT32_CLASS,
+    mxINT64_CLASS, mxUINT64_CLASS
+} mxClassID;
+
+typedef enum {
+    mxREAL, mxCOMPLEX
+} mxComplexity;
+
+typedef unsigned char mxLogical;
+typedef unsigned short mxChar;
+
+typedef struct {
+    mxClassID classID;
+    mwSize numDims;
+    mwSize dims[MXSHIM_MAXDIMS];
+    void *data;             /* elements, mxArray* for cell arrays */
+} mxArray;
+
+/* Arrays */
+mxArray *mxCreateDoubleMatrix(mwSize m, mwSize n, mxComplexity complexity);
+mxArray *mxCreateUninitNumericMatrix(mwSize m, mwSize n, mxClassID classID, mxComplexity complexity);
+mxArray *mxCreateLogicalMatrix(mwSize m, mwSize n);
+mxArray *mxCreateCellMatrix(mwSize m, mwSize n);
+mxArray *mxCreateCharArray(mwSize numDims, const mwSize *dims);
+mxArray *mxCreateString(const char *str);
+void mxDestroyArray(mxArray *arr);
+
+mwSize mxGetM(const mxArray *arr);
+mwSize mxGetN(const mxArray *arr);
+mwSize mxGetNumberOfDimensions(const mxArray *arr);
+const mwSize *mxGetDimensions(const mxArray *arr);
+mwSize mxGetNumberOfElements(const mxArray *arr);
+mxClassID mxGetClassID(const mxArray *arr);
+
+int mxIsDouble(const mxArray *arr);
+int mxIsNumeric(const mxArray *arr);
+int mxIsChar(const mxArray *arr);
+int mxIsCell(const mxArray *arr);
+int mxIsStruct(const mxArray *arr);
+int mxIsComplex(const mxArray *arr);
+
+double *mxGetPr(const mxArray *arr);
+void *mxGetData(const mxArray *arr);
+mxLogical *mxGetLogicals(const mxArray *arr);
+mxChar *mxGetChars(const mxArray *arr);
+double mxGetScalar(const mxArray *arr);
+int mxGetString(const mxArray *arr, char *buf, mwSize buflen);
+char *mxArrayToString(const mxArray *arr);
+
+mxArray *mxGetCell(const mxArray *arr, mwIndex index);
+void mxSetCell(mxArray *arr, mwIndex index, mxArray *value);
+mxArray *mxGetField(const mxArray *arr, mwIndex index, const char *name);
+
+double mxGetNaN(void);
+
+/* Memory */
+void *mxMalloc(size_t size);
+void *mxCalloc(size_t num, size_t size);
+void mxFree(void *ptr);
+
+/* Messages and exit functions, mexErrMsgTxt exits the program */
+void mexErrMsgTxt(const char *msg);
+int mexPrintf(const char *format, ...);
+int mexAtExit(void (*exitFcn)(void));
+
+#endif
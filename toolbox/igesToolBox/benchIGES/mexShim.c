@@ -0,0 +1,418 @@
+/* Minimal mx/mex library for running the mex functions of the toolbox without Matlab, see mex.h */
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mex.h"
+
+
+static size_t mxShimElementSize(mxClassID classID){
+    /* mxShimElementSize returns the size in bytes of one element of an array of class classID */
+
+    switch (classID){
+        case mxDOUBLE_CLASS: case mxINT64_CLASS: case mxUINT64_CLASS:
+            return 8;
+        case mxSINGLE_CLASS: case mxINT32_CLASS: case mxUINT32_CLASS:
+            return 4;
+        case mxCHAR_CLASS: case mxINT16_CLASS: case mxUINT16_CLASS:
+            return 2;
+        case mxCELL_CLASS:
+            return sizeof(mxArray*);
+        default:
+            return 1;
+    }
+
+}
+
+
+static mxArray *mxShimCreate(mxClassID classID, mwSize numDims, const mwSize *dims, int init){
+    /* mxShimCreate creates an array, with the elements set to 0 if init is 1 */
+
+    /* mxShimCreate( classID - class of the array, numDims - number of dimensions, dims - pointer to dimensions, init - 1 for zero elements, 0 for uninitialized) */
+
+    mwSize k, num = 1;
+    mxArray *arr;
+
+    if (numDims>MXSHIM_MAXDIMS){
+        mexErrMsgTxt("Too many dimensions.");
+    }
+    arr = (mxArray*) malloc(sizeof(mxArray));
+    if (arr==NULL){
+        mexErrMsgTxt("Out of memory.");
+    }
+    arr->classID = classID;
+    arr->numDims = (numDims<2) ? 2 : numDims;
+    arr->dims[0] = 1;
+    arr->dims[1] = 1;
+    for (k = 0; k < numDims; k++){
+        arr->dims[k] = dims[k];
+        num *= dims[k];
+    }
+    while (arr->numDims>2 && arr->dims[arr->numDims-1]==1){
+        arr->numDims--;
+    }
+    num = (num>0) ? num : 1;
+    arr->data = init ? calloc(num, mxShimElementSize(classID)) : malloc(num*mxShimElementSize(classID));
+    if (arr->data==NULL){
+        mexErrMsgTxt("Out of memory.");
+    }
+    return arr;
+
+}
+
+
+mxArray *mxCreateDoubleMatrix(mwSize m, mwSize n, mxComplexity complexity){
+
+    mwSize dims[2];
+
+    if (complexity!=mxREAL){
+        mexErrMsgTxt("Complex arrays are not supported.");
+    }
+    dims[0] = m;
+    dims[1] = n;
+    return mxShimCreate(mxDOUBLE_CLASS, 2, dims, 1);
+
+}
+
+
+mxArray *mxCreateUninitNumericMatrix(mwSize m, mwSize n, mxClassID classID, mxComplexity complexity){
+
+    mwSize dims[2];
+
+    if (complexity!=mxREAL){
+        mexErrMsgTxt("Complex arrays are not supported.");
+    }
+    dims[0] = m;
+    dims[1] = n;
+    return mxShimCreate(classID, 2, dims, 0);
+
+}
+
+
+mxArray *mxCreateLogicalMatrix(mwSize m, mwSize n){
+
+    mwSize dims[2];
+
+    dims[0] = m;
+    dims[1] = n;
+    return mxShimCreate(mxLOGICAL_CLASS, 2, dims, 1);
+
+}
+
+
+mxArray *mxCreateCellMatrix(mwSize m, mwSize n){
+
+    mwSize dims[2];
+
+    dims[0] = m;
+    dims[1] = n;
+    return mxShimCreate(mxCELL_CLASS, 2, dims, 1);
+
+}
+
+
+mxArray *mxCreateCharArray(mwSize numDims, const mwSize *dims){
+
+    return mxShimCreate(mxCHAR_CLASS, numDims, dims, 1);
+
+}
+
+
+mxArray *mxCreateString(const char *str){
+
+    mwSize k, dims[2];
+    mxArray *arr;
+
+    dims[0] = 1;
+    dims[1] = strlen(str);
+    arr = mxShimCreate(mxCHAR_CLASS, 2, dims, 1);
+    for (k = 0; k < dims[1]; k++){
+        ((mxChar*)arr->data)[k] = (unsigned char)str[k];
+    }
+    return arr;
+
+}
+
+
+void mxDestroyArray(mxArray *arr){
+
+    mwSize k, num;
+
+    if (arr==NULL){
+        return;
+    }
+    if (arr->classID==mxCELL_CLASS){
+        num = mxGetNumberOfElements(arr);
+        for (k = 0; k < num; k++){
+            mxDestroyArray(((mxArray**)arr->data)[k]);
+        }
+    }
+    free(arr->data);
+    free(arr);
+
+}
+
+
+mwSize mxGetM(const mxArray *arr){
+
+    return arr->dims[0];
+
+}
+
+
+mwSize mxGetN(const mxArray *arr){
+
+    mwSize k, n = 1;
+
+    for (k = 1; k < arr->numDims; k++){
+        n *= arr->dims[k];
+    }
+    return n;
+
+}
+
+
+mwSize mxGetNumberOfDimensions(const mxArray *arr){
+
+    return arr->numDims;
+
+}
+
+
+const mwSize *mxGetDimensions(const mxArray *arr){
+
+    return arr->dims;
+
+}
+
+
+mwSize mxGetNumberOfElements(const mxArray *arr){
+
+    return arr->dims[0]*mxGetN(arr);
+
+}
+
+
+mxClassID mxGetClassID(const mxArray *arr){
+
+    return arr->classID;
+
+}
+
+
+int mxIsDouble(const mxArray *arr){
+
+    return arr->classID==mxDOUBLE_CLASS;
+
+}
+
+
+int mxIsNumeric(const mxArray *arr){
+
+    return arr->classID>=mxDOUBLE_CLASS;
+
+}
+
+
+int mxIsChar(const mxArray *arr){
+
+    return arr->classID==mxCHAR_CLASS;
+
+}
+
+
+int mxIsCell(const mxArray *arr){
+
+    return arr->classID==mxCELL_CLASS;
+
+}
+
+
+int mxIsStruct(const mxArray *arr){
+
+    return arr->classID==mxSTRUCT_CLASS;
+
+}
+
+
+int mxIsComplex(const mxArray *arr){
+
+    (void)arr;
+    return 0;
+
+}
+
+
+double *mxGetPr(const mxArray *arr){
+
+    return (double*)arr->data;
+
+}
+
+
+void *mxGetData(const mxArray *arr){
+
+    return arr->data;
+
+}
+
+
+mxLogical *mxGetLogicals(const mxArray *arr){
+
+    return (mxLogical*)arr->data;
+
+}
+
+
+mxChar *mxGetChars(const mxArray *arr){
+
+    return (mxChar*)arr->data;
+
+}
+
+
+double mxGetScalar(const mxArray *arr){
+
+    if (mxGetNumberOfElements(arr)==0){
+        return 0.0;
+    }
+    switch (arr->classID){
+        case mxDOUBLE_CLASS:
+            return *(double*)arr->data;
+        case mxSINGLE_CLASS:
+            return *(float*)arr->data;
+        case mxLOGICAL_CLASS:
+            return *(mxLogical*)arr->data;
+        case mxCHAR_CLASS:
+            return *(mxChar*)arr->data;
+        default:
+            mexErrMsgTxt("mxGetScalar: unsupported class.");
+            return 0.0;
+    }
+
+}
+
+
+int mxGetString(const mxArray *arr, char *buf, mwSize buflen){
+    /* mxGetString copies a char array to buf, returns 1 if it is not a char array or buf is too short */
+
+    mwSize k, num = mxGetNumberOfElements(arr);
+
+    if (arr->classID!=mxCHAR_CLASS || buflen==0){
+        return 1;
+    }
+    for (k = 0; k < num && k+1 < buflen; k++){
+        buf[k] = (char)((mxChar*)arr->data)[k];
+    }
+    buf[k] = '\0';
+    return k<num;
+
+}
+
+
+char *mxArrayToString(const mxArray *arr){
+
+    mwSize num = mxGetNumberOfElements(arr);
+    char *str = (char*) mxMalloc(num+1);
+
+    if (mxGetString(arr, str, num+1)!=0){
+        mxFree(str);
+        return NULL;
+    }
+    return str;
+
+}
+
+
+mxArray *mxGetCell(const mxArray *arr, mwIndex index){
+
+    return ((mxArray**)arr->data)[index];
+
+}
+
+
+void mxSetCell(mxArray *arr, mwIndex index, mxArray *value){
+
+    mxDestroyArray(((mxArray**)arr->data)[index]);
+    ((mxArray**)arr->data)[index] = value;
+
+}
+
+
+mxArray *mxGetField(const mxArray *arr, mwIndex index, const char *name){
+
+    (void)arr;
+    (void)index;
+    (void)name;
+    return NULL;
+
+}
+
+
+double mxGetNaN(void){
+
+    return NAN;
+
+}
+
+
+void *mxMalloc(size_t size){
+
+    void *ptr = malloc(size>0 ? size : 1);
+
+    if (ptr==NULL){
+        mexErrMsgTxt("Out of memory.");
+    }
+    return ptr;
+
+}
+
+
+void *mxCalloc(size_t num, size_t size){
+
+    void *ptr = calloc(num>0 ? num : 1, size>0 ? size : 1);
+
+    if (ptr==NULL){
+        mexErrMsgTxt("Out of memory.");
+    }
+    return ptr;
+
+}
+
+
+void mxFree(void *ptr){
+
+    free(ptr);
+
+}
+
+
+void mexErrMsgTxt(const char *msg){
+
+    fprintf(stderr, "Error: %s\n", msg);
+    exit(1);
+
+}
+
+
+int mexPrintf(const char *format, ...){
+
+    int num;
+    va_list args;
+
+    va_start(args, format);
+    num = vprintf(format, args);
+    va_end(args);
+    return num;
+
+}
+
+
+int mexAtExit(void (*exitFcn)(void)){
+    /* The exit functions are called when the program exits, as when Matlab clears the mex functions */
+
+    return atexit(exitFcn);
+
+}
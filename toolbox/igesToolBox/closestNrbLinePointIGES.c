@@ -15,9 +15,44 @@
  *  Closest NURBS-point to point
  * [P,UV]=closestNrbLinePointIGES(nurbs,dnurbs,d2nurbs,UV0,r0)
  *
+ *  Compiled NURBS (output from nrbCompileIGES) instead of nurbs,dnurbs,d2nurbs
+ * [P,UV]=closestNrbLinePointIGES(srf,UV0,r0,v)
+ * [P,UV]=closestNrbLinePointIGES(srf,UV0,r0)
+ *
+ *  Convergence and number of Newton steps for every point/line
+ * [P,UV,converged,iter]=closestNrbLinePointIGES(...)
+ *
+ * Options (after the other inputs):
+ *
+ * [P,UV]=closestNrbLinePointIGES(...,'threads',n)
+ *
+ * n - number of threads, 1 gives serial evaluation, 0 (default) uses
+ *     all available threads. The results do not depend on n. Multiple
+ *     threads are only used if the mex file is compiled with OpenMP
+ *     (see makeIGESmex).
+ *
+ * [P,UV]=closestNrbLinePointIGES(...,'seeds',k)
+ *
+ * k - number of start values for every point/line (default 1). Newton's
+ *     method is started from UV0 and from k-1 parameter values spread
+ *     over the parameter domain, and the result closest to the
+ *     point/line is kept. Use k>1 when UV0 may be far from the closest
+ *     point.
+ *
+ * [P,UV]=closestNrbLinePointIGES(...,'method',m)
+ *
+ * m - 'newton' (default) or 'trust'. 'newton' is the damped Newton's
+ *     method. 'trust' keeps the parameter values inside the parameter
+ *     domain and limits the steps to a trust region that follows how well
+ *     the quadratic model predicts the distance, so it converges in a few
+ *     steps also when the closest point is on the boundary of the patch.
+ *
  * Input:
  * nurbs - NURBS structure
  * dnurbs,d2nurbs - NURBS derivatives (output from nrbDerivativesIGES).
+ * srf - compiled NURBS (output from nrbCompileIGES). If the derivatives are
+ *       not compiled into srf they are evaluated from the derivatives of
+ *       the basis functions.
  * UV0 - Initial start Parameter values
  * r0,(v) - See Line/Point (3D) above. r0 (and v) must have the dimension (3x{1 or N})
  *          If size (3x1) - same point/line is used, if size (3xN) - different point/lines are used.
@@ -31,6 +66,11 @@
  * Output:
  * P - Closest points on NURBS patch.
  * UV - NURBS Parameter values at closest point. (same dimension as UV0)
+ * converged - 1xN logical, true if the steps converged (false if MAXITER
+ *             steps were taken, or for 'newton' if the Hessian was
+ *             singular).
+ * iter - 1xN number of Newton steps, for 'trust' the number of
+ *        evaluations of the NURBS and its derivatives.
  *
  * c-file can be downloaded for free at
  *
@@ -46,6 +86,8 @@
  **************************************************************************/
 
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 #include "mex.h"
 
 /* Input Arguments */
@@ -53,14 +95,13 @@
 #define	nurbsstructure	prhs[0]
 #define	dnrbsstructure	prhs[1]
 #define d2nrbsstructure	prhs[2]
-#define initparamvalues	prhs[3]
-#define point0	prhs[4]
-#define linedirection	prhs[5]
 
 /* Output Arguments */
 
 #define	evaluated_points	plhs[0]
 #define	parametervalues	plhs[1]
+#define	converged_flags	plhs[2]
+#define	iteration_counts	plhs[3]
 
 /* Misc */
 
@@ -70,37 +111,71 @@
 
 #include "mexSourceFiles/FindSpan.c"
 #include "mexSourceFiles/BasisFuns.c"
+#include "mexSourceFiles/DersBasisFuns.c"
 #include "mexSourceFiles/BspEval.c"
 #include "mexSourceFiles/BspEval2.c"
+#include "mexSourceFiles/BspEval2Fixed.c"
+#include "mexSourceFiles/NURBScurveDersEval.c"
+#include "mexSourceFiles/NURBSsurfaceDersEval.c"
+#include "mexSourceFiles/nrbCompiled.c"
+#include "mexSourceFiles/nrbNetEval.c"
+#include "mexSourceFiles/nrbNetEval2.c"
+#include "mexSourceFiles/nrbDersEval.c"
+#include "mexSourceFiles/nrbOptions.c"
 #include "mexSourceFiles/nrbD1D2eval.c"
 #include "mexSourceFiles/nrbD1D2eval2.c"
+#include "mexSourceFiles/nrbClampParam.c"
+#include "mexSourceFiles/nrbClosestPoint.c"
+#include "mexSourceFiles/nrbClosestPointBatch.c"
 
 /* Main function */
 
 void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]){
     
-    int i, j;
-    double t, detH, H11, H12, H13, H22, H23, H33, neggrad1, neggrad2, neggrad3, s1, s2, s3, res[3];
+    int numDirs, nargs, numPnts, numThreads;
     char TrueFalse=0;
-    double paramtmp[2], umin, umax, vmin, vmax, bspPnts[4], pnttmp[3], pderu[3], pderv[3], pderuu[3], pderuv[3], pdervv[3];
+    const mxArray *initparamvalues, *point0, *linedirection;
+    mxLogical *convergedPtr;
+    double *iterationsPtr;
+    nrbCompiled nrb;
+    nrbOptions opt;
     
-    if(nlhs!=2){
-        mexErrMsgTxt("Number of outputs must be 2.");
+    if(nlhs<2 || nlhs>4){
+        mexErrMsgTxt("Number of outputs must be 2, 3 or 4.");
     }
-    if(nrhs>6 || nrhs<5){
-        mexErrMsgTxt("Number of inputs must be 5 or 6.");
+    
+    if(nrhs>0 && nrbIsCompiled(nurbsstructure)){
+        nargs = nrbParseOptions(nrhs, prhs, 3, &opt);
+        if(nargs>4 || nargs<3){
+            mexErrMsgTxt("Number of inputs must be 3 or 4 for compiled NURBS.");
+        }
+        nrbCompiledFromArray(nurbsstructure, &nrb);
+        initparamvalues = prhs[1];
+        point0 = prhs[2];
+        linedirection = (nargs==4) ? prhs[3] : NULL;
+        nargs += 2;
     }
-    if (mxGetM(mxGetField(nurbsstructure, 0, "coefs"))!=4){
-        mexPrintf("Number of rows in nurbs.coefs is %d,\n", mxGetM(mxGetField(nurbsstructure, 0, "coefs")));
-        mexErrMsgTxt("nurbs.coefs must have 4 rows.");
+    else{
+        nargs = nrbParseOptions(nrhs, prhs, 5, &opt);
+        if(nargs>6 || nargs<5){
+            mexErrMsgTxt("Number of inputs must be 5 or 6.");
+        }
+        if (mxGetM(mxGetField(nurbsstructure, 0, "coefs"))!=4){
+            mexPrintf("Number of rows in nurbs.coefs is %d,\n", mxGetM(mxGetField(nurbsstructure, 0, "coefs")));
+            mexErrMsgTxt("nurbs.coefs must have 4 rows.");
+        }
+        initparamvalues = prhs[3];
+        point0 = prhs[4];
+        linedirection = (nargs==6) ? prhs[5] : NULL;
     }
+    
     if(mxGetM(point0)!=3){
         mexErrMsgTxt("r0 must have 3 rows.");
     }    
     if(mxGetM(initparamvalues)>2 || mxGetM(initparamvalues)==0){
         mexErrMsgTxt("UV0 must be of dim 1xN or 2xN.");
     }
-    if(nrhs==6){
+    if(nargs==6){
         if(mxGetM(linedirection)!=3){
             mexErrMsgTxt("v must have 3 rows.");
         }
@@ -113,379 +188,38 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]){
             }
         }
     }
-    else if(nrhs==5){
+    else if(nargs==5){
         if(mxGetN(point0)==mxGetN(initparamvalues)){
             if(mxGetN(point0)>1){
                 TrueFalse=1;
             }
         }
     }
-
-    evaluated_points = mxCreateDoubleMatrix(3, mxGetN(initparamvalues), mxREAL);
-    parametervalues = mxCreateDoubleMatrix(mxGetM(initparamvalues), mxGetN(initparamvalues), mxREAL);
     
-    if (mxGetM(initparamvalues)==2){
-
-        int orderU = (int)mxGetPr(mxGetField(nurbsstructure, 0, "order"))[0];
-        int orderV = (int)mxGetPr(mxGetField(nurbsstructure, 0, "order"))[1];
-        
-        double *leftU  = (double*) malloc(orderU*sizeof(double)+1);
-        double *rightU = (double*) malloc(orderU*sizeof(double)+1);
-        double *NU = (double*) malloc(orderU*sizeof(double)+1);
-        double *leftV  = (double*) malloc(orderV*sizeof(double)+1);
-        double *rightV = (double*) malloc(orderV*sizeof(double)+1);
-        double *NV = (double*) malloc(orderV*sizeof(double)+1);
-        
-        umin = (double)mxGetPr(mxGetCell(mxGetField(nurbsstructure, 0, "knots"), 0))[orderU-1];
-        umax = (double)mxGetPr(mxGetCell(mxGetField(nurbsstructure, 0, "knots"), 0))[((int)mxGetDimensions(mxGetField(nurbsstructure, 0, "coefs"))[1])];
-        vmin = (double)mxGetPr(mxGetCell(mxGetField(nurbsstructure, 0, "knots"), 1))[orderV-1];
-        vmax = (double)mxGetPr(mxGetCell(mxGetField(nurbsstructure, 0, "knots"), 1))[((int)mxGetDimensions(mxGetField(nurbsstructure, 0, "coefs"))[2])];
-        
-        if(nrhs==6){
-            
-            for (i = 0; i < mxGetN(initparamvalues); i++){
-                
-                paramtmp[0] = (double)mxGetPr(initparamvalues)[2*i];
-                paramtmp[1] = (double)mxGetPr(initparamvalues)[2*i+1];
-                
-                t=0.0;
-                for (j = 0; j < MAXITER; j++){
-                    
-                    if(paramtmp[0] <= umin){
-                        paramtmp[0] = umin;
-                    }
-                    else if(paramtmp[0] >= umax){
-                        paramtmp[0] = umax;
-                    }
-                    if(paramtmp[1] <= vmin){
-                        paramtmp[1] = vmin;
-                    }
-                    else if(paramtmp[1] >= vmax){
-                        paramtmp[1] = vmax;
-                    }
-                    
-                    nrbD1D2eval2(nurbsstructure, dnrbsstructure, d2nrbsstructure, &paramtmp[0], &pnttmp[0], &pderu[0], &pderv[0], &pderuu[0], &pderuv[0], &pdervv[0], &bspPnts[0], leftU, rightU, NU, leftV, rightV, NV);
-                    
-                    if(TrueFalse){
-                        res[0]=mxGetPr(point0)[3*i]+t*mxGetPr(linedirection)[3*i]-pnttmp[0];
-                        res[1]=mxGetPr(point0)[3*i+1]+t*mxGetPr(linedirection)[3*i+1]-pnttmp[1];
-                        res[2]=mxGetPr(point0)[3*i+2]+t*mxGetPr(linedirection)[3*i+2]-pnttmp[2];
-                        
-                        H13=-(pderu[0]*mxGetPr(linedirection)[3*i]+pderu[1]*mxGetPr(linedirection)[3*i+1]+pderu[2]*mxGetPr(linedirection)[3*i+2]);
-                        H23=-(pderv[0]*mxGetPr(linedirection)[3*i]+pderv[1]*mxGetPr(linedirection)[3*i+1]+pderv[2]*mxGetPr(linedirection)[3*i+2]);
-                        H33=  mxGetPr(linedirection)[3*i]*mxGetPr(linedirection)[3*i]+mxGetPr(linedirection)[3*i+1]*mxGetPr(linedirection)[3*i+1]+mxGetPr(linedirection)[3*i+2]*mxGetPr(linedirection)[3*i+2];
-                        
-                        neggrad3=res[0]*mxGetPr(linedirection)[3*i]+res[1]*mxGetPr(linedirection)[3*i+1]+res[2]*mxGetPr(linedirection)[3*i+2];
-                    }
-                    else{
-                        res[0]=mxGetPr(point0)[0]+t*mxGetPr(linedirection)[0]-pnttmp[0];
-                        res[1]=mxGetPr(point0)[1]+t*mxGetPr(linedirection)[1]-pnttmp[1];
-                        res[2]=mxGetPr(point0)[2]+t*mxGetPr(linedirection)[2]-pnttmp[2];
-                        
-                        H13=-(pderu[0]*mxGetPr(linedirection)[0]+pderu[1]*mxGetPr(linedirection)[1]+pderu[2]*mxGetPr(linedirection)[2]);
-                        H23=-(pderv[0]*mxGetPr(linedirection)[0]+pderv[1]*mxGetPr(linedirection)[1]+pderv[2]*mxGetPr(linedirection)[2]);
-                        H33=  mxGetPr(linedirection)[0]*mxGetPr(linedirection)[0]+mxGetPr(linedirection)[1]*mxGetPr(linedirection)[1]+mxGetPr(linedirection)[2]*mxGetPr(linedirection)[2];
-                        
-                        neggrad3=res[0]*mxGetPr(linedirection)[0]+res[1]*mxGetPr(linedirection)[1]+res[2]*mxGetPr(linedirection)[2];
-                    }
-                    H11=pderu[0]*pderu[0]+pderu[1]*pderu[1]+pderu[2]*pderu[2]-(pderuu[0]*res[0]+pderuu[1]*res[1]+pderuu[2]*res[2]);
-                    H12=pderu[0]*pderv[0]+pderu[1]*pderv[1]+pderu[2]*pderv[2]-(pderuv[0]*res[0]+pderuv[1]*res[1]+pderuv[2]*res[2]);
-                    H22=pderv[0]*pderv[0]+pderv[1]*pderv[1]+pderv[2]*pderv[2]-(pdervv[0]*res[0]+pdervv[1]*res[1]+pdervv[2]*res[2]);
-                    
-                    neggrad1=pderu[0]*res[0]+pderu[1]*res[1]+pderu[2]*res[2];
-                    neggrad2=pderv[0]*res[0]+pderv[1]*res[1]+pderv[2]*res[2];
-                    
-                    detH = 2*H13*H12*H23-H13*H13*H22-H12*H12*H33+H11*H22*H33-H11*H23*H23;
-                    if(fabs(detH)<1e-10){
-                        break;
-                    }
-                    s1 = ((H22*H33-H23*H23)*neggrad1+(H13*H23-H12*H33)*neggrad2-(H12*H23-H13*H22)*neggrad3)/detH;
-                    s2 = ((H13*H23-H12*H33)*neggrad1+(H11*H33-H13*H13)*neggrad2-(H13*H12-H11*H23)*neggrad3)/detH;
-                    s3 = ((H12*H23-H13*H22)*neggrad1+(H13*H12-H11*H23)*neggrad2-(H11*H22-H12*H12)*neggrad3)/detH;
-                    
-                    paramtmp[0] += 0.7*s1;
-                    paramtmp[1] += 0.7*s2;
-                    t+=0.7*s3;
-                    
-                    if((s1*s1+s2*s2+s3*s3)<1e-20){
-                        break;
-                    }
-                }
-                
-                if(paramtmp[0] <= umin){
-                    paramtmp[0] = umin;
-                }
-                else if(paramtmp[0] >= umax){
-                    paramtmp[0] = umax;
-                }
-                if(paramtmp[1] <= vmin){
-                    paramtmp[1] = vmin;
-                }
-                else if(paramtmp[1] >= vmax){
-                    paramtmp[1] = vmax;
-                }
-                BspEval2(orderU-1, orderV-1, mxGetPr(mxGetField(nurbsstructure, 0, "coefs")), 4, (int)mxGetDimensions(mxGetField(nurbsstructure, 0, "coefs"))[1], (int)mxGetDimensions(mxGetField(nurbsstructure, 0, "coefs"))[2], mxGetPr(mxGetCell(mxGetField(nurbsstructure, 0, "knots"), 0)), mxGetPr(mxGetCell(mxGetField(nurbsstructure, 0, "knots"), 1)), &paramtmp[0], 1, &bspPnts[0], leftU, rightU, NU, leftV, rightV, NV);
-                
-                mxGetPr(evaluated_points)[3*i]=(bspPnts[0])/(bspPnts[3]);
-                mxGetPr(evaluated_points)[3*i+1]=(bspPnts[1])/(bspPnts[3]);
-                mxGetPr(evaluated_points)[3*i+2]=(bspPnts[2])/(bspPnts[3]);
-                
-                mxGetPr(parametervalues)[2*i]=paramtmp[0];
-                mxGetPr(parametervalues)[2*i+1]=paramtmp[1];               
-                
-            }
-            
-        }
-        else if(nrhs==5){
-            
-            for (i = 0; i < mxGetN(initparamvalues); i++){
-                
-                paramtmp[0] = (double)mxGetPr(initparamvalues)[2*i];
-                paramtmp[1] = (double)mxGetPr(initparamvalues)[2*i+1];                
-                
-                for (j = 0; j < MAXITER; j++){
-                    
-                    if(paramtmp[0] <= umin){
-                        paramtmp[0] = umin;
-                    }
-                    else if(paramtmp[0] >= umax){
-                        paramtmp[0] = umax;
-                    }
-                    if(paramtmp[1] <= vmin){
-                        paramtmp[1] = vmin;
-                    }
-                    else if(paramtmp[1] >= vmax){
-                        paramtmp[1] = vmax;
-                    }
-                    
-                    nrbD1D2eval2(nurbsstructure, dnrbsstructure, d2nrbsstructure, &paramtmp[0], &pnttmp[0], &pderu[0], &pderv[0], &pderuu[0], &pderuv[0], &pdervv[0], &bspPnts[0], leftU, rightU, NU, leftV, rightV, NV);
-                    
-                    if(TrueFalse){
-                        res[0]=mxGetPr(point0)[3*i]-pnttmp[0];
-                        res[1]=mxGetPr(point0)[3*i+1]-pnttmp[1];
-                        res[2]=mxGetPr(point0)[3*i+2]-pnttmp[2];
-                    }
-                    else{
-                        res[0]=mxGetPr(point0)[0]-pnttmp[0];
-                        res[1]=mxGetPr(point0)[1]-pnttmp[1];
-                        res[2]=mxGetPr(point0)[2]-pnttmp[2];
-                    }
-                    H11=pderu[0]*pderu[0]+pderu[1]*pderu[1]+pderu[2]*pderu[2]-(pderuu[0]*res[0]+pderuu[1]*res[1]+pderuu[2]*res[2]);
-                    H12=pderu[0]*pderv[0]+pderu[1]*pderv[1]+pderu[2]*pderv[2]-(pderuv[0]*res[0]+pderuv[1]*res[1]+pderuv[2]*res[2]);
-                    H22=pderv[0]*pderv[0]+pderv[1]*pderv[1]+pderv[2]*pderv[2]-(pdervv[0]*res[0]+pdervv[1]*res[1]+pdervv[2]*res[2]);
-                    
-                    neggrad1=pderu[0]*res[0]+pderu[1]*res[1]+pderu[2]*res[2];
-                    neggrad2=pderv[0]*res[0]+pderv[1]*res[1]+pderv[2]*res[2];
-                    
-                    detH = H11*H22-H12*H12;
-                    if(fabs(detH)<1e-10){
-                        break;
-                    }
-                    s1 = (H22*neggrad1-H12*neggrad2)/detH;
-                    s2 = (H11*neggrad2-H12*neggrad1)/detH;
-                    
-                    paramtmp[0] += 0.7*s1;
-                    paramtmp[1] += 0.7*s2;
-                    
-                    if((s1*s1+s2*s2)<1e-20){
-                        break;
-                    }
-                }
-                
-                if(paramtmp[0] <= umin){
-                    paramtmp[0] = umin;
-                }
-                else if(paramtmp[0] >= umax){
-                    paramtmp[0] = umax;
-                }
-                if(paramtmp[1] <= vmin){
-                    paramtmp[1] = vmin;
-                }
-                else if(paramtmp[1] >= vmax){
-                    paramtmp[1] = vmax;
-                }
-                BspEval2(orderU-1, orderV-1, mxGetPr(mxGetField(nurbsstructure, 0, "coefs")), 4, (int)mxGetDimensions(mxGetField(nurbsstructure, 0, "coefs"))[1], (int)mxGetDimensions(mxGetField(nurbsstructure, 0, "coefs"))[2], mxGetPr(mxGetCell(mxGetField(nurbsstructure, 0, "knots"), 0)), mxGetPr(mxGetCell(mxGetField(nurbsstructure, 0, "knots"), 1)), &paramtmp[0], 1, &bspPnts[0], leftU, rightU, NU, leftV, rightV, NV);
-                
-                mxGetPr(evaluated_points)[3*i]=(bspPnts[0])/(bspPnts[3]);
-                mxGetPr(evaluated_points)[3*i+1]=(bspPnts[1])/(bspPnts[3]);
-                mxGetPr(evaluated_points)[3*i+2]=(bspPnts[2])/(bspPnts[3]);
-                
-                mxGetPr(parametervalues)[2*i]=paramtmp[0];
-                mxGetPr(parametervalues)[2*i+1]=paramtmp[1];                 
-                
-            }
-            
-        }
-        else{
-            mexPrintf("Error! Illegeal number of inputs.\n");
-        }
-        
-        free(leftU);
-        free(rightU);
-        free(NU);
-        free(leftV);
-        free(rightV);
-        free(NV);
-        
+    numDirs = (int)mxGetM(initparamvalues);
+    if(!nrbIsCompiled(nurbsstructure)){
+        nrbCompiledFromStruct(nurbsstructure, dnrbsstructure, d2nrbsstructure, numDirs, &nrb);
     }
-    
-    else if (mxGetM(initparamvalues)==1){
-        
-        int orderU = (int)mxGetScalar(mxGetField(nurbsstructure, 0, "order"));
-        
-        double *left  = (double*) malloc(orderU*sizeof(double)+1);
-        double *right = (double*) malloc(orderU*sizeof(double)+1);
-        double *N = (double*) malloc(orderU*sizeof(double)+1);
-        
-        umin = (double)mxGetPr(mxGetCell(mxGetField(nurbsstructure, 0, "knots"), 0))[orderU-1];
-        umax = (double)mxGetPr(mxGetCell(mxGetField(nurbsstructure, 0, "knots"), 0))[mxGetN(mxGetField(nurbsstructure, 0, "coefs"))];
-        
-        if(nrhs==6){
-            
-            for (i = 0; i < mxGetN(initparamvalues); i++){
-                
-                paramtmp[0] = (double)mxGetPr(initparamvalues)[i];
-                
-                t=0.0;
-                for (j = 0; j < MAXITER; j++){
-                    
-                    if(paramtmp[0] <= umin){
-                        paramtmp[0] = umin;
-                    }
-                    else if(paramtmp[0] >= umax){
-                        paramtmp[0] = umax;
-                    }
-                    
-                    nrbD1D2eval(nurbsstructure, dnrbsstructure, d2nrbsstructure, &paramtmp[0], &pnttmp[0], &pderu[0], &pderuu[0], &bspPnts[0], left, right, N);
-                    
-                    if(TrueFalse){
-                        res[0]=mxGetPr(point0)[3*i]+t*mxGetPr(linedirection)[3*i]-pnttmp[0];
-                        res[1]=mxGetPr(point0)[3*i+1]+t*mxGetPr(linedirection)[3*i+1]-pnttmp[1];
-                        res[2]=mxGetPr(point0)[3*i+2]+t*mxGetPr(linedirection)[3*i+2]-pnttmp[2];
-                        
-                        H12=-(pderu[0]*mxGetPr(linedirection)[3*i]+pderu[1]*mxGetPr(linedirection)[3*i+1]+pderu[2]*mxGetPr(linedirection)[3*i+2]);
-                        H22=  mxGetPr(linedirection)[3*i]*mxGetPr(linedirection)[3*i]+mxGetPr(linedirection)[3*i+1]*mxGetPr(linedirection)[3*i+1]+mxGetPr(linedirection)[3*i+2]*mxGetPr(linedirection)[3*i+2];
-                        
-                        neggrad2=res[0]*mxGetPr(linedirection)[3*i]+res[1]*mxGetPr(linedirection)[3*i+1]+res[2]*mxGetPr(linedirection)[3*i+2];
-                    }
-                    else{
-                        res[0]=mxGetPr(point0)[0]+t*mxGetPr(linedirection)[0]-pnttmp[0];
-                        res[1]=mxGetPr(point0)[1]+t*mxGetPr(linedirection)[1]-pnttmp[1];
-                        res[2]=mxGetPr(point0)[2]+t*mxGetPr(linedirection)[2]-pnttmp[2];
-                        
-                        H12=-(pderu[0]*mxGetPr(linedirection)[0]+pderu[1]*mxGetPr(linedirection)[1]+pderu[2]*mxGetPr(linedirection)[2]);
-                        H22=  mxGetPr(linedirection)[0]*mxGetPr(linedirection)[0]+mxGetPr(linedirection)[1]*mxGetPr(linedirection)[1]+mxGetPr(linedirection)[2]*mxGetPr(linedirection)[2];
-                        
-                        neggrad2=res[0]*mxGetPr(linedirection)[0]+res[1]*mxGetPr(linedirection)[1]+res[2]*mxGetPr(linedirection)[2];
-                    }
-                    H11=pderu[0]*pderu[0]+pderu[1]*pderu[1]+pderu[2]*pderu[2]-(pderuu[0]*res[0]+pderuu[1]*res[1]+pderuu[2]*res[2]);
-                    
-                    neggrad1=pderu[0]*res[0]+pderu[1]*res[1]+pderu[2]*res[2];
-                    
-                    detH = H11*H22-H12*H12;
-                    if(fabs(detH)<1e-10){
-                        break;
-                    }
-                    s1 = (H22*neggrad1+H12*neggrad2)/detH;
-                    s2 = -(H11*neggrad2+H12*neggrad1)/detH;
-                    
-                    paramtmp[0] += 0.7*s1;
-                    t+=0.7*s2;
-                    
-                    if((s1*s1+s2*s2)<1e-20){
-                        break;
-                    }
-                }
-                
-                if(paramtmp[0] <= umin){
-                    paramtmp[0] = umin;
-                }
-                else if(paramtmp[0] >= umax){
-                    paramtmp[0] = umax;
-                }
-                BspEval(orderU-1, mxGetPr(mxGetField(nurbsstructure, 0, "coefs")), 4, (int)mxGetN(mxGetField(nurbsstructure, 0, "coefs")), mxGetPr(mxGetField(nurbsstructure, 0, "knots")), &paramtmp[0], 1, &bspPnts[0], left, right, N);
-                
-                mxGetPr(evaluated_points)[3*i]=(bspPnts[0])/(bspPnts[3]);
-                mxGetPr(evaluated_points)[3*i+1]=(bspPnts[1])/(bspPnts[3]);
-                mxGetPr(evaluated_points)[3*i+2]=(bspPnts[2])/(bspPnts[3]);
-                
-                mxGetPr(parametervalues)[i]=paramtmp[0];
-                
-            }
-            
-        }
-        else if(nrhs==5){
-            
-            for (i = 0; i < mxGetN(initparamvalues); i++){
-                
-                paramtmp[0] = (double)mxGetPr(initparamvalues)[i];
-                
-                for (j = 0; j < MAXITER; j++){
-                    
-                    if(paramtmp[0] <= umin){
-                        paramtmp[0] = umin;
-                    }
-                    else if(paramtmp[0] >= umax){
-                        paramtmp[0] = umax;
-                    }
-                    
-                    nrbD1D2eval(nurbsstructure, dnrbsstructure, d2nrbsstructure, &paramtmp[0], &pnttmp[0], &pderu[0], &pderuu[0], &bspPnts[0], left, right, N);
-                    
-                    if(TrueFalse){
-                        res[0]=mxGetPr(point0)[3*i]-pnttmp[0];
-                        res[1]=mxGetPr(point0)[3*i+1]-pnttmp[1];
-                        res[2]=mxGetPr(point0)[3*i+2]-pnttmp[2];
-                    }
-                    else{
-                        res[0]=mxGetPr(point0)[0]-pnttmp[0];
-                        res[1]=mxGetPr(point0)[1]-pnttmp[1];
-                        res[2]=mxGetPr(point0)[2]-pnttmp[2];
-                    }
-                    H11=pderu[0]*pderu[0]+pderu[1]*pderu[1]+pderu[2]*pderu[2]-(pderuu[0]*res[0]+pderuu[1]*res[1]+pderuu[2]*res[2]);
-                    
-                    neggrad1=pderu[0]*res[0]+pderu[1]*res[1]+pderu[2]*res[2];
-                    
-                    if(fabs(H11)<1e-10){
-                        break;
-                    }
-                    s1 = neggrad1/H11;
-                    
-                    paramtmp[0] += 0.7*s1;
-                    
-                    if((s1*s1)<1e-20){
-                        break;
-                    }
-                }
-                
-                if(paramtmp[0] <= umin){
-                    paramtmp[0] = umin;
-                }
-                else if(paramtmp[0] >= umax){
-                    paramtmp[0] = umax;
-                }
-                BspEval(orderU-1, mxGetPr(mxGetField(nurbsstructure, 0, "coefs")), 4, (int)mxGetN(mxGetField(nurbsstructure, 0, "coefs")), mxGetPr(mxGetField(nurbsstructure, 0, "knots")), &paramtmp[0], 1, &bspPnts[0], left, right, N);
-                
-                mxGetPr(evaluated_points)[3*i]=(bspPnts[0])/(bspPnts[3]);
-                mxGetPr(evaluated_points)[3*i+1]=(bspPnts[1])/(bspPnts[3]);
-                mxGetPr(evaluated_points)[3*i+2]=(bspPnts[2])/(bspPnts[3]);
-                
-                mxGetPr(parametervalues)[i]=paramtmp[0];
-                
-            }
-            
-        }
-        else{
-            mexPrintf("Error! Illegeal number of inputs.\n");
-        }
-        
-        free(left);
-        free(right);
-        free(N);
-        
+    else if(numDirs!=nrb.numDirs){
+        mexErrMsgTxt("Wrong dimension of UV");
     }
     
-    else{
-        mexErrMsgTxt("Wrong dimension of UV");
+    numPnts = (int)mxGetN(initparamvalues);
+    evaluated_points = mxCreateDoubleMatrix(3, numPnts, mxREAL);
+    parametervalues = mxCreateDoubleMatrix(numDirs, numPnts, mxREAL);
+    convergedPtr = NULL;
+    iterationsPtr = NULL;
+    if(nlhs>2){
+        converged_flags = mxCreateLogicalMatrix(1, numPnts);
+        convergedPtr = mxGetLogicals(converged_flags);
+    }
+    if(nlhs>3){
+        iteration_counts = mxCreateDoubleMatrix(1, numPnts, mxREAL);
+        iterationsPtr = mxGetPr(iteration_counts);
     }
     
+    numThreads = nrbNumThreads(&opt, (numPnts+NRB_CLOSESTCHUNK-1)/NRB_CLOSESTCHUNK);
+    
+    nrbClosestPointBatch(&nrb, opt.method, opt.numSeeds, mxGetPr(initparamvalues), numPnts, mxGetPr(point0), (linedirection==NULL) ? NULL : mxGetPr(linedirection), TrueFalse ? 3 : 0, mxGetPr(evaluated_points), mxGetPr(parametervalues), convergedPtr, iterationsPtr, numThreads);
+    
 }
@@ -28,6 +28,8 @@ function [ParameterData,EntityType,numEntityType,unknownEntityType,numunknownEnt
 %
 % ParameterData also contains other useful information for usage in other
 % functions. For curves the length is given as a parameter in ParameterData.
+% For entity type 126 ParameterData also contains arclength, the arc length
+% table of the curve from nrbArcLengthIGES.
 % superior is another parameter for curves and surfaces. For curves superior=1
 % means that they are defined in the parameter space for a surface. superior=0
 % means that they are defined in the 3D-space. For surfaces superior=1 means
@@ -42,6 +44,9 @@ function [ParameterData,EntityType,numEntityType,unknownEntityType,numunknownEnt
 %
 % This version can not handle all possible IGES entities.
 %
+% The IGES-file is read with the mex function parseIGES and the arc length
+% tables are computed with nrbArcLengthIGES, compile them with makeIGESmex.
+%
 % Example:
 %
 % [ParameterData,EntityType,numEntityType,unknownEntityType]=iges2matlab('example.igs');
@@ -64,159 +69,29 @@ if not(or(showlines==0,showlines==1))
     showlines=0;
 end
 
-[fid,msg]=fopen(igsfile);
-
-if fid==-1
-    error(msg);
-end
-
-c = fread(fid,'uint8=>uint8')';
-
-fclose(fid);
-
-nwro=sum((c((81:82))==10))+sum((c((81:82))==13));
-
-edfi=nwro-sum(c(((end-1):end))==10)-sum(c(((end-1):end))==13);
-
-siz=length(c);
-
-ro=round((siz+edfi)/(80+nwro));
-
-if rem((siz+edfi),(80+nwro))~=0
-    error('Input file must be an IGES-file!');
-end
-
-roind=1:ro;
-
-SGDPT=c(roind*(80+nwro)-7-nwro);
-
-Sfind=SGDPT==83;
-Gfind=SGDPT==71;
-Dfind=SGDPT==68;
-Pfind=SGDPT==80;
-Tfind=SGDPT==84;
-
-sumSfind=sum(Sfind);
-sumGfind=sum(Gfind);
-sumDfind=sum(Dfind);
-sumPfind=sum(Pfind);
-sumTfind=sum(Tfind);
+[Pdata,Ddata,Hdata,Sdata]=parseIGES(igsfile);
 
 %------S Line information (The initial line to get things started)---------
-for i=roind(Sfind)
-    disp(char(c(((i-1)*(80+nwro)+1):(i*(80+nwro)-8-nwro))));
-end
-
-%---------------G Line information  (Header infomation)--------------------
-
-G=cell(1,25);
-Gstr=zeros(1,72*sumGfind);
-j=1;
-for i=roind(Gfind)
-    Gstr(((j-1)*72+1):(j*72))=c(((i-1)*(80+nwro)+1):(i*(80+nwro)-8-nwro));
-    j=j+1;
-end
-
-if and(Gstr(1)==49,Gstr(2)==72)
-    G{1}=Gstr(3);
-    st=4;
-else
-    G{1}=44;
-    st=1;
-end
-
-if and(Gstr(st+1)==49,Gstr(st+2)==72)
-    G{2}=Gstr(st+3);
-    st=st+4;
-else
-    G{2}=59;
-    st=st+1;
-end
-
-le=length(Gstr);
-
-for i=3:25
-    for j=(st+1):le
-        if or(Gstr(j)==G{1},Gstr(j)==G{2})
-            break
-        end
-    end
-    G{i}=Gstr((st+1):(j-1));
-    st=j;
-end
-
-for i=[3 4 5 6 12 15 18 21 22 25]   %string
-    stind=1;
-    for j=1:length(G{i})
-        if G{i}(j)~=32
-            stind=j;
-            break
-        end
-    end
-
-    for j=stind:length(G{i})
-        if G{i}(j)==72
-            stind=j+1;
-            break
-        end
-    end
-
-    endind=length(G{i});
-    for j=length(G{i}):-1:1
-        if G{i}(j)~=32
-            endind=j;
-            break
-        end
-    end
-    G{i}=G{i}(stind:endind);
-end
-
-for i=[7 8 9 10 11 13 14 16 17 19 20 23 24]   %num
-    G{i}=str2num(char(G{i}));
+for i=1:size(Sdata,1)
+    disp(Sdata(i,:));
 end
 
 %--D Line information (Data information) & P Line information (All data)---
 
-noent=round(sumDfind/2);
+noent=length(Pdata);
 
 ParameterData=cell(1,noent);
 
-roP=sumSfind+sumGfind+sumDfind;
-
 entty=zeros(1,520);
 entunk=zeros(1,520);
 
-entiall=0;
-
-for i=(sumSfind+sumGfind+1):2:(sumSfind+sumGfind+sumDfind-1)
-
-    entiall=entiall+1;
-
-    Dstr=c(((i-1)*(80+nwro)+1):(i*(80+nwro)-8-nwro));
+for entiall=1:noent
 
-    type=str2num(char(Dstr(1:8)));
+    type=Ddata(1,entiall);
 
     ParameterData{entiall}.type=type;
 
-    Pstart=str2num(char(Dstr(9:16)))+roP;
-
-    if i==roP-1
-        Pend=ro-sumTfind;
-    else
-        Pend=str2num(char(c(((i+1)*(80+nwro)+9):((i+1)*(80+nwro)+16))))+roP-1;
-    end
-
-    Pstr=zeros(1,64*(Pend-Pstart+1));
-    j=1;
-    for k=Pstart:Pend
-        Pstr(((j-1)*64+1):(j*64))=c(((k-1)*(80+nwro)+1):(k*(80+nwro)-16-nwro));
-        j=j+1;
-    end
-
-    Pstr(Pstr==G{1})=44;
-    Pstr(Pstr==G{2})=59;
-
-    Pvec=str2num(char(Pstr));
+    Pvec=Pdata{entiall};
 
     % SURFACES
 
@@ -559,16 +434,7 @@ for i=(sumSfind+sumGfind+1):2:(sumSfind+sumGfind+sumDfind-1)
 
         ParameterData{entiall}.nurbs.knots=Pvec(8:(8+A));
 
-        nup=500;
-        p = nrbevalIGES(ParameterData{entiall}.nurbs,linspace(ParameterData{entiall}.v(1),ParameterData{entiall}.v(2),nup));
-        len=sum(sqrt(sum((p(:,1:(nup-1))-p(:,2:nup)).^2,1)));
-        if norm(p(:,1)-p(:,nup))<1e-3
-            ParameterData{entiall}.length=3*len;
-        else
-            ParameterData{entiall}.length=min((len/norm(p(:,1)-p(:,nup))-1)*10+1,3)*len;
-        end
-        
-        clear nup p len N A
+        clear N A
 
     elseif type==100
 
@@ -668,16 +534,7 @@ for i=(sumSfind+sumGfind+1):2:(sumSfind+sumGfind+sumDfind-1)
 
         ParameterData{entiall}.nurbs.knots=[0 0 0 1 1 2 2 3 3 3];
 
-        nup=500;
-        p = nrbevalIGES(ParameterData{entiall}.nurbs,linspace(ParameterData{entiall}.v(1),ParameterData{entiall}.v(2),nup));
-        len=sum(sqrt(sum((p(:,1:(nup-1))-p(:,2:nup)).^2,1)));
-        if norm(p(:,1)-p(:,nup))<1e-3
-            ParameterData{entiall}.length=3*len;
-        else
-            ParameterData{entiall}.length=min((len/norm(p(:,1)-p(:,nup))-1)*10+1,3)*len;
-        end
-        
-        clear PP nup p len
+        clear PP
 
     elseif type==110
 
@@ -691,7 +548,10 @@ for i=(sumSfind+sumGfind+1):2:(sumSfind+sumGfind+sumDfind-1)
             ParameterData{entiall}.superior=1;
         end
 
-        ParameterData{entiall}.form=str2num(char(c((i*(80+nwro)+65):(i*(80+nwro)+72))));
+        ParameterData{entiall}.form=Ddata(19,entiall);
+        if isnan(ParameterData{entiall}.form)
+            ParameterData{entiall}.form=[];
+        end
         
         p_1=Pvec(2:4)';
         p_2=Pvec(5:7)';
@@ -792,21 +652,14 @@ for i=(sumSfind+sumGfind+1):2:(sumSfind+sumGfind+sumDfind-1)
 
         ParameterData{entiall}.name='COLOR';
 
-        inn=find(or(Pstr==44,Pstr==59));
+        ParameterData{entiall}.cc1=Pvec(2);
+        ParameterData{entiall}.cc2=Pvec(3);
+        ParameterData{entiall}.cc3=Pvec(4);
 
-        ParameterData{entiall}.cc1=str2num(char(Pstr((inn(1)+1):(inn(2)-1))));
-        ParameterData{entiall}.cc2=str2num(char(Pstr((inn(2)+1):(inn(3)-1))));
-        ParameterData{entiall}.cc3=str2num(char(Pstr((inn(3)+1):(inn(4)-1))));
-
-        if length(inn)>4
-            inn2=find(Pstr(1:(inn(5)-1))==72);
-            if isempty(inn2)
-                ParameterData{entiall}.cname='';
-            else
-                ParameterData{entiall}.cname=char(Pstr((inn2(1)+1):(inn(5)-1)));
-            end
-        else
+        if isempty(Hdata{entiall})
             ParameterData{entiall}.cname='';
+        else
+            ParameterData{entiall}.cname=Hdata{entiall}{1};
         end
 
     else
@@ -844,6 +697,40 @@ if not(isempty(unknownEntityType))
     disp('perbergstrom / AT / hotmail.com');
 end
 
+% Arc length tables of the NURBS curves, all curves in one call to nrbArcLengthIGES
+
+crvind=zeros(1,noent);
+numcrv=0;
+for i=1:noent
+    if ParameterData{i}.type==126
+        numcrv=numcrv+1;
+        crvind(numcrv)=i;
+    end
+end
+
+if numcrv>0
+    crvs=cell(1,numcrv);
+    crvrange=zeros(2,numcrv);
+    for j=1:numcrv
+        crvs{j}=ParameterData{crvind(j)}.nurbs;
+        crvrange(:,j)=ParameterData{crvind(j)}.v(:);
+    end
+    tabs=nrbArcLengthIGES(crvs,crvrange);
+    len=nrbArcLengthIGES(tabs);
+    pend=nrbArcLengthIGES(tabs,crvs,2);
+    for j=1:numcrv
+        ParameterData{crvind(j)}.arclength=tabs{j};
+        p=pend{j};
+        if norm(p(:,1)-p(:,2))<1e-3
+            ParameterData{crvind(j)}.length=3*len(j);
+        else
+            ParameterData{crvind(j)}.length=min((len(j)/norm(p(:,1)-p(:,2))-1)*10+1,3)*len(j);
+        end
+    end
+end
+
+clear crvind numcrv crvs crvrange tabs len pend p
+
 cp1min=Inf;
 cp1max=-Inf;
 cp2min=Inf;
@@ -953,6 +840,10 @@ if ty==126
     
     ParameterData{ii}.nurbs.knots=ParameterData{ii}.t;
     
+    if isfield(ParameterData{ii},'arclength')
+        ParameterData{ii}.arclength=nrbArcLengthIGES(ParameterData{ii}.nurbs,ParameterData{ii}.v);
+    end
+    
 elseif ty==110
     
     p1=ParameterData{ii}.p1;
@@ -0,0 +1,73 @@
+function [ParameterData,EntityType,numEntityType,unknownEntityType,numunknownEntityType]=loadIGES(igsfile,showlines,cachefile)
+% LOADIGES reads an IGES-file with iges2matlab and keeps the result in a
+% binary cache file, so that the IGES-file is only parsed again when it
+% has changed.
+%
+% Usage:
+%
+% [ParameterData,EntityType,numEntityType,unknownEntityType,numunknownEntityType]=loadIGES(igsfile,showlines,cachefile)
+%
+% Input:
+%
+% igsfile - IGES file
+% showlines - information flag to plotIGES (optional), see iges2matlab.
+% cachefile - name of the cache file (optional). Default is igsfile
+%             followed by '.igc'.
+%
+% Output:
+%
+% Same as iges2matlab, including the NURBS derivatives dnurbs and d2nurbs
+% of the surfaces and curves.
+%
+% The first call parses igsfile with iges2matlab and writes the outputs to
+% cachefile with writeCacheIGES. Later calls read cachefile with
+% readCacheIGES instead, which checks a hash of the contents of igsfile
+% stored in cachefile. If igsfile has changed, or cachefile is missing
+% or damaged, igsfile is parsed again and cachefile is rewritten. If
+% cachefile cannot be written a warning is given and the outputs from
+% iges2matlab are returned.
+%
+% Compile readCacheIGES and writeCacheIGES with makeIGESmex.
+%
+% Example:
+%
+% [ParameterData,EntityType,numEntityType,unknownEntityType]=loadIGES('example.igs');
+%
+% m-file can be downloaded for free at
+% http://www.mathworks.com/matlabcentral/fileexchange/13253-iges-toolbox
+%
+
+if nargin<2
+    showlines=0;
+end
+if isempty(showlines)
+    showlines=0;
+end
+if not(or(showlines==0,showlines==1))
+    showlines=0;
+end
+if nargin<3
+    cachefile=[];
+end
+if isempty(cachefile)
+    cachefile=[igsfile,'.igc'];
+end
+
+[ok,data]=readCacheIGES(cachefile,igsfile);
+
+if ok
+    if and(iscell(data),numel(data)==6)
+        if isequal(data{1},showlines)
+            [ParameterData,EntityType,numEntityType,unknownEntityType,numunknownEntityType]=deal(data{2:6});
+            return
+        end
+    end
+end
+
+[ParameterData,EntityType,numEntityType,unknownEntityType,numunknownEntityType]=iges2matlab(igsfile,showlines);
+
+try
+    writeCacheIGES(cachefile,igsfile,{showlines,ParameterData,EntityType,numEntityType,unknownEntityType,numunknownEntityType});
+catch
+    warning('loadIGES:cache','Cannot write cache file %s.',cachefile);
+end
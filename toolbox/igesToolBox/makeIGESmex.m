@@ -1,13 +1,68 @@
-function makeIGESmex()
+function makeIGESmex(simd)
 % Makefile
 % run
 % >> makeIGESmex
 % in MATLAB for compiling the source code in the iges2matlab toolbox.
+%
+% The mex files are compiled with OpenMP if the compiler supports it,
+% otherwise they are compiled without OpenMP (serial evaluation).
+%
+% >> makeIGESmex('avx2')
+% compiles nrbevalIGES with AVX2 instructions as well, which speeds up the
+% evaluation of surfaces at many points. The mex file then runs only on
+% processors with AVX2. The results are the same as without AVX2.
 
-try
-    mex -v nrbevalIGES.c
+if nargin<1
+    simd='';
+end
+
+mexOpenMP('nrbevalIGES.c',simd);
+
+mexOpenMP('closestNrbLinePointIGES.c','');
+
+mexOpenMP('nrbBvhIGES.c','');
+
+mexOpenMP('parseIGES.c','');
+
+mexOpenMP('readCacheIGES.c','');
+
+mexOpenMP('writeCacheIGES.c','');
+
+mexOpenMP('nrbTessellateIGES.c','');
+
+mexOpenMP('nrbArcLengthIGES.c','');
+
+mexOpenMP('nrbRayIGES.c','');
+
+
+function mexOpenMP(srcfile,simd)
+% Compiles srcfile with OpenMP, falls back to compiling without OpenMP
+
+if ispc
+    flagvar='COMPFLAGS';
+    ompflags=' /openmp';
+    ldflags={};
+    simdflags=' /arch:AVX2';
+elseif ismac
+    flagvar='CFLAGS';
+    ompflags=' -Xpreprocessor -fopenmp';
+    ldflags={'LDFLAGS=$LDFLAGS -lomp'};
+    simdflags=' -mavx2 -ffp-contract=off';
+else
+    flagvar='CFLAGS';
+    ompflags=' -fopenmp';
+    ldflags={'LDFLAGS=$LDFLAGS -fopenmp'};
+    simdflags=' -mavx2 -ffp-contract=off';
+end
+
+if ~strcmpi(simd,'avx2')
+    simdflags='';
 end
 
 try
-    mex -v closestNrbLinePointIGES.c
-end
\ No newline at end of file
+    mex('-v',[flagvar '=$' flagvar ompflags simdflags],ldflags{:},srcfile);
+catch
+    try
+        mex('-v',[flagvar '=$' flagvar simdflags],srcfile);
+    end
+end
@@ -0,0 +1,71 @@
+
+/* BasisFunsLanes computes the basis functions for NRB_LANES parameter values in the same knot span at once */
+
+/* The operations are the same as in BasisFuns, lane by lane, so the result is identical to NRB_LANES calls of BasisFuns.
+ * With AVX (compile with -mavx2 -ffp-contract=off, see makeIGESmex) the lanes are processed with 256 bit vectors,
+ * otherwise with a plain loop over the lanes that the compiler may vectorise with SSE2. */
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#define NRB_LANES 4
+
+void BasisFunsLanes(int i, double *u, int p, double *U, double *N, double *left, double *right) {
+    /* Modification of ALGORITHM A2.2, The NURBS Book, L.Piegl and W. Tiller */
+    /* Compute the nonvanishing basis functions for NRB_LANES values of u in the knot span i */
+    /* Input: i,u,p,U */
+    /* Output: N, N[j*NRB_LANES+l] is basis function i-p+j at u[l] */
+    /* Arrays: left ((p+1)*NRB_LANES), right ((p+1)*NRB_LANES) */
+
+    int j, r;
+
+#ifdef __AVX__
+
+    __m256d uu, saved, temp;
+
+    uu = _mm256_loadu_pd(u);
+    _mm256_storeu_pd(N, _mm256_set1_pd(1.0));
+
+    for (j = 1; j <= p; j++) {
+        _mm256_storeu_pd(&left[j*NRB_LANES], _mm256_sub_pd(uu, _mm256_set1_pd(U[i+1-j])));
+        _mm256_storeu_pd(&right[j*NRB_LANES], _mm256_sub_pd(_mm256_set1_pd(U[i+j]), uu));
+        saved = _mm256_setzero_pd();
+        for (r = 0; r < j; r++) {
+            temp = _mm256_div_pd(_mm256_loadu_pd(&N[r*NRB_LANES]), _mm256_add_pd(_mm256_loadu_pd(&right[(r+1)*NRB_LANES]), _mm256_loadu_pd(&left[(j-r)*NRB_LANES])));
+            _mm256_storeu_pd(&N[r*NRB_LANES], _mm256_add_pd(saved, _mm256_mul_pd(_mm256_loadu_pd(&right[(r+1)*NRB_LANES]), temp)));
+            saved = _mm256_mul_pd(_mm256_loadu_pd(&left[(j-r)*NRB_LANES]), temp);
+        }
+        _mm256_storeu_pd(&N[j*NRB_LANES], saved);
+    }
+
+#else
+
+    int l;
+    double saved[NRB_LANES], temp[NRB_LANES];
+
+    for (l = 0; l < NRB_LANES; l++) {
+        N[l] = 1.0;
+    }
+
+    for (j = 1; j <= p; j++) {
+        for (l = 0; l < NRB_LANES; l++) {
+            left[j*NRB_LANES+l]  = u[l] - U[i+1-j];
+            right[j*NRB_LANES+l] = U[i+j] - u[l];
+            saved[l] = 0.0;
+        }
+        for (r = 0; r < j; r++) {
+            for (l = 0; l < NRB_LANES; l++) {
+                temp[l] = N[r*NRB_LANES+l] / (right[(r+1)*NRB_LANES+l] + left[(j-r)*NRB_LANES+l]);
+                N[r*NRB_LANES+l] = saved[l] + right[(r+1)*NRB_LANES+l] * temp[l];
+                saved[l] = left[(j-r)*NRB_LANES+l] * temp[l];
+            }
+        }
+        for (l = 0; l < NRB_LANES; l++) {
+            N[j*NRB_LANES+l] = saved[l];
+        }
+    }
+
+#endif
+
+}
@@ -6,11 +6,11 @@ static void BspEval(int deg, double *cp, int mcp, int ncp, double *knot, double
     
     /* BspEval( deg - degree of B-spline, cp - pointer to control points, mcp - number of elements in a control point, ncp - number of control points, knot - pointer to knot sequence, us - pointer to parameter values, nus - number of parameter values, ep - pointer to evaluated points, left - pointer to array for function BasisFuns, right - pointer to array for function BasisFuns, N - pointer to array for function BasisFuns) */
     
-    int i, ii, jj, span, ind;
+    int i, ii, jj, span, ind, hint = 0;
     
     for (jj = 0; jj < nus; jj++){
         
-        if(us[jj]<=knot[deg] || deg==0){
+        if(us[jj]<=knot[deg]){
             for (ii = 0; ii < mcp; ii++){
                 ep[jj*mcp+ii] = cp[ii];
             }
@@ -24,7 +24,7 @@ static void BspEval(int deg, double *cp, int mcp, int ncp, double *knot, double
             for (ii = 0; ii < mcp; ii++){
                 ep[jj*mcp+ii]=0.0;
             }
-            span = FindSpan(ncp, deg, us[jj], knot);
+            span = FindSpanHint(ncp, deg, us[jj], knot, &hint);
             BasisFuns(span, us[jj], deg, knot, N, left, right);
             
             ind = span - deg;
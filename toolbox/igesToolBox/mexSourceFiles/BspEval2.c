@@ -6,12 +6,12 @@ static void BspEval2(int degU, int degV, double *cp, int mcp, int ncp, int kcp,
     
     /* BspEval2( degU - degree of B-spline in u, degV - degree of B-spline in v, cp - pointer to control points, mcp - number of elements in a control point, ncp - number of control points in u, kcp - number of control points in v, knotU - pointer to knot sequence in u, knotV - pointer to knot sequence in v, us - pointer to parameter values,  nus - number of parameter values, ep - pointer to evaluated points, leftU - pointer to array for function BasisFuns, rightU - pointer to array for function BasisFuns, NU - pointer to array for function BasisFuns, leftV - pointer to array for function BasisFuns, rightV - pointer to array for function BasisFuns, NV - pointer to array for function BasisFuns) */
     
-    int i, j, ii, jj, spanU, spanV, ind, ind2;
+    int i, j, ii, jj, spanU, spanV, ind, ind2, hintU = 0, hintV = 0;
     
     for (jj = 0; jj < nus; jj++){
         
-        if(us[2*jj]<=knotU[degU] || degU==0){
-            if(us[2*jj+1]<=knotV[degV] || degV==0){
+        if(us[2*jj]<=knotU[degU]){
+            if(us[2*jj+1]<=knotV[degV]){
                 for (ii = 0; ii < mcp; ii++){
                     ep[jj*mcp+ii] = cp[ii];
                 }
@@ -25,7 +25,7 @@ static void BspEval2(int degU, int degV, double *cp, int mcp, int ncp, int kcp,
                 for (ii = 0; ii < mcp; ii++){
                     ep[jj*mcp+ii]=0.0;
                 }
-                spanV = FindSpan(kcp, degV, us[2*jj+1], knotV);
+                spanV = FindSpanHint(kcp, degV, us[2*jj+1], knotV, &hintV);
                 BasisFuns(spanV, us[2*jj+1], degV, knotV, NV, leftV, rightV);
                 
                 ind = spanV - degV;
@@ -38,7 +38,7 @@ static void BspEval2(int degU, int degV, double *cp, int mcp, int ncp, int kcp,
             }
         }
         else if(us[2*jj]>=knotU[ncp]){
-            if(us[2*jj+1]<=knotV[degV] || degV==0){
+            if(us[2*jj+1]<=knotV[degV]){
                 for (ii = 0; ii < mcp; ii++){
                     ep[jj*mcp+ii] = cp[ii+mcp*ncp-mcp];
                 }
@@ -52,7 +52,7 @@ static void BspEval2(int degU, int degV, double *cp, int mcp, int ncp, int kcp,
                 for (ii = 0; ii < mcp; ii++){
                     ep[jj*mcp+ii]=0.0;
                 }
-                spanV = FindSpan(kcp, degV, us[2*jj+1], knotV);
+                spanV = FindSpanHint(kcp, degV, us[2*jj+1], knotV, &hintV);
                 BasisFuns(spanV, us[2*jj+1], degV, knotV, NV, leftV, rightV);
                 
                 ind = spanV - degV;
@@ -68,8 +68,8 @@ static void BspEval2(int degU, int degV, double *cp, int mcp, int ncp, int kcp,
             for (ii = 0; ii < mcp; ii++){
                 ep[jj*mcp+ii]=0.0;
             }
-            if(us[2*jj+1]<=knotV[degV] || degV==0){
-                spanU = FindSpan(ncp, degU, us[2*jj], knotU);
+            if(us[2*jj+1]<=knotV[degV]){
+                spanU = FindSpanHint(ncp, degU, us[2*jj], knotU, &hintU);
                 BasisFuns(spanU, us[2*jj], degU, knotU, NU, leftU, rightU);
                 
                 ind = spanU - degU;
@@ -81,7 +81,7 @@ static void BspEval2(int degU, int degV, double *cp, int mcp, int ncp, int kcp,
                 }
             }
             else if(us[2*jj+1]>=knotV[kcp]){
-                spanU = FindSpan(ncp, degU, us[2*jj], knotU);
+                spanU = FindSpanHint(ncp, degU, us[2*jj], knotU, &hintU);
                 BasisFuns(spanU, us[2*jj], degU, knotU, NU, leftU, rightU);
                 
                 ind = spanU - degU;
@@ -93,10 +93,10 @@ static void BspEval2(int degU, int degV, double *cp, int mcp, int ncp, int kcp,
                 }
             }
             else{
-                spanU = FindSpan(ncp, degU, us[2*jj], knotU);
+                spanU = FindSpanHint(ncp, degU, us[2*jj], knotU, &hintU);
                 BasisFuns(spanU, us[2*jj], degU, knotU, NU, leftU, rightU);
                 
-                spanV = FindSpan(kcp, degV, us[2*jj+1], knotV);
+                spanV = FindSpanHint(kcp, degV, us[2*jj+1], knotV, &hintV);
                 BasisFuns(spanV, us[2*jj+1], degV, knotV, NV, leftV, rightV);
                 
                 ind = spanU - degU;
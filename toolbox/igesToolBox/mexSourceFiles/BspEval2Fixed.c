@@ -0,0 +1,114 @@
+
+/* Degree specialised versions of BspEval2 for 4 elements per control point and degrees 1, 2 and 3 in u and v */
+
+/* BSPEVAL2FIXED(DU,DV) defines BspEval2Fixed<DU><DV>, where the degrees are constants. All loops over the basis
+ * functions and the control points have fixed bounds and the arrays are of fixed size, so the compiler unrolls them.
+ * Parameter values on the boundary of the parameter domain are evaluated with BspEval2. The operations are done in
+ * the same order as in BspEval2, so the result is identical. */
+
+/* BspEval2Fixed needs FindSpanHint and BspEval2 */
+
+/* Full unrolling of the loops is not done by all compilers at the optimisation level used by mex */
+#if defined(__clang__)
+#define BSPFIXED_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__) && (__GNUC__>=8)
+#define BSPFIXED_UNROLL _Pragma("GCC unroll 4")
+#else
+#define BSPFIXED_UNROLL
+#endif
+
+
+/* ALGORITHM A2.2, The NURBS Book, L.Piegl and W. Tiller, for degree P (uses j, r, saved and temp) */
+#define BSPFIXED_BASIS(P, i, u, U, N, left, right) \
+    N[0] = 1.0; \
+    BSPFIXED_UNROLL \
+    for (j = 1; j <= P; j++) { \
+        left[j]  = u - U[i+1-j]; \
+        right[j] = U[i+j] - u; \
+        saved = 0.0; \
+        BSPFIXED_UNROLL \
+        for (r = 0; r < j; r++) { \
+            temp = N[r] / (right[r+1] + left[j-r]); \
+            N[r] = saved + right[r+1] * temp; \
+            saved = left[j-r] * temp; \
+        } \
+        N[j] = saved; \
+    }
+
+#define BSPEVAL2FIXED(DU, DV) \
+static void BspEval2Fixed##DU##DV(double *cp, int ncp, int kcp, double *knotU, double *knotV, double *us, int nus, double *ep, double *leftU, double *rightU, double *NU, double *leftV, double *rightV, double *NV, int *hint){ \
+    \
+    int i, j, r, jj, spanU, spanV; \
+    double u, v, saved, temp, NVNU, *pnt, x, y, z, w; \
+    double NUf[DU+1], leftUf[DU+1], rightUf[DU+1], NVf[DV+1], leftVf[DV+1], rightVf[DV+1]; \
+    \
+    for (jj = 0; jj < nus; jj++){ \
+        \
+        u = us[2*jj]; \
+        v = us[2*jj+1]; \
+        if(u<=knotU[DU] || u>=knotU[ncp] || v<=knotV[DV] || v>=knotV[kcp]){ \
+            BspEval2(DU, DV, cp, 4, ncp, kcp, knotU, knotV, &us[2*jj], 1, &ep[4*jj], leftU, rightU, NU, leftV, rightV, NV); \
+            continue; \
+        } \
+        \
+        spanU = FindSpanHint(ncp, DU, u, knotU, &hint[0]); \
+        BSPFIXED_BASIS(DU, spanU, u, knotU, NUf, leftUf, rightUf) \
+        spanV = FindSpanHint(kcp, DV, v, knotV, &hint[1]); \
+        BSPFIXED_BASIS(DV, spanV, v, knotV, NVf, leftVf, rightVf) \
+        \
+        x = 0.0; \
+        y = 0.0; \
+        z = 0.0; \
+        w = 0.0; \
+        BSPFIXED_UNROLL \
+        for (i = 0; i <= DV; i++){ \
+            BSPFIXED_UNROLL \
+            for (j = 0; j <= DU; j++){ \
+                NVNU = NVf[i] * NUf[j]; \
+                pnt = &cp[(i+spanV-DV)*4*ncp+(j+spanU-DU)*4]; \
+                x += NVNU * pnt[0]; \
+                y += NVNU * pnt[1]; \
+                z += NVNU * pnt[2]; \
+                w += NVNU * pnt[3]; \
+            } \
+        } \
+        ep[4*jj] = x; \
+        ep[4*jj+1] = y; \
+        ep[4*jj+2] = z; \
+        ep[4*jj+3] = w; \
+        \
+    } \
+    \
+}
+
+BSPEVAL2FIXED(1, 1)
+BSPEVAL2FIXED(1, 2)
+BSPEVAL2FIXED(1, 3)
+BSPEVAL2FIXED(2, 1)
+BSPEVAL2FIXED(2, 2)
+BSPEVAL2FIXED(2, 3)
+BSPEVAL2FIXED(3, 1)
+BSPEVAL2FIXED(3, 2)
+BSPEVAL2FIXED(3, 3)
+
+typedef void (*BspEval2FixedFun)(double*, int, int, double*, double*, double*, int, double*, double*, double*, double*, double*, double*, double*, int*);
+
+static const BspEval2FixedFun BspEval2FixedTable[3][3] = {
+    {BspEval2Fixed11, BspEval2Fixed12, BspEval2Fixed13},
+    {BspEval2Fixed21, BspEval2Fixed22, BspEval2Fixed23},
+    {BspEval2Fixed31, BspEval2Fixed32, BspEval2Fixed33}
+};
+
+
+static int BspEval2Fixed(int degU, int degV, double *cp, int ncp, int kcp, double *knotU, double *knotV, double *us, int nus, double *ep, double *leftU, double *rightU, double *NU, double *leftV, double *rightV, double *NV, int *hint){
+    /* BspEval2Fixed evaluates a B-spline with 4 elements per control point at given parameter values (u,v), returns 0 (and does nothing) if there is no specialised version for the degrees */
+
+    /* BspEval2Fixed( degU - degree of B-spline in u, degV - degree of B-spline in v, cp - pointer to control points, ncp - number of control points in u, kcp - number of control points in v, knotU - pointer to knot sequence in u, knotV - pointer to knot sequence in v, us - pointer to parameter values,  nus - number of parameter values, ep - pointer to evaluated points (4 x nus), leftU, rightU, NU, leftV, rightV, NV - pointers to arrays for function BspEval2, hint - pointer to knot spans in u and v of a previous parameter value, updated) */
+
+    if (degU<1 || degU>3 || degV<1 || degV>3){
+        return 0;
+    }
+    BspEval2FixedTable[degU-1][degV-1](cp, ncp, kcp, knotU, knotV, us, nus, ep, leftU, rightU, NU, leftV, rightV, NV, hint);
+    return 1;
+
+}
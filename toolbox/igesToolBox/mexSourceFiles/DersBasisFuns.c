@@ -0,0 +1,79 @@
+
+void DersBasisFuns(int i, double u, int p, int n, double *U, double *ders, double *ndu, double *a, double *left, double *right) {
+    /* ALGORITHM A2.3, The NURBS Book, L.Piegl and W. Tiller */
+    /* Compute nonzero basis functions and their derivatives */
+    /* Input: i,u,p,n,U */
+    /* Output: ders, ders[k*(p+1)+j] is the k:th derivative of basis function i-p+j, derivatives of order > p are zero */
+    /* Arrays: ndu (p+1)*(p+1), a 2*(p+1), left (p+1), right (p+1) */
+    /* The lower triangle of ndu holds the reciprocals of the knot differences, so that every knot difference is divided only once */
+    
+    int j, k, r, s1, s2, rk, pk, j1, j2, du;
+    double saved, temp, d;
+    
+    ndu[0] = 1.0;
+    
+    for (j = 1; j <= p; j++) {
+        left[j]  = u - U[i+1-j];
+        right[j] = U[i+j] - u;
+        saved = 0.0;
+        for (r = 0; r < j; r++) {
+            /* Lower triangle */
+            ndu[j*(p+1)+r] = 1.0 / (right[r+1] + left[j-r]);
+            temp = ndu[r*(p+1)+j-1] * ndu[j*(p+1)+r];
+            /* Upper triangle */
+            ndu[r*(p+1)+j] = saved + right[r+1] * temp;
+            saved = left[j-r] * temp;
+        }
+        ndu[j*(p+1)+j] = saved;
+    }
+    
+    /* Load the basis functions */
+    for (j = 0; j <= p; j++) {
+        ders[j] = ndu[j*(p+1)+p];
+    }
+    
+    du = (n < p) ? n : p;
+    
+    /* Compute the derivatives */
+    for (r = 0; r <= p; r++) {
+        s1 = 0;  s2 = 1;
+        a[0] = 1.0;
+        for (k = 1; k <= du; k++) {
+            d = 0.0;
+            rk = r-k;  pk = p-k;
+            if (r >= k) {
+                a[s2*(p+1)] = a[s1*(p+1)] * ndu[(pk+1)*(p+1)+rk];
+                d = a[s2*(p+1)] * ndu[rk*(p+1)+pk];
+            }
+            j1 = (rk >= -1) ? 1 : -rk;
+            j2 = (r-1 <= pk) ? k-1 : p-r;
+            for (j = j1; j <= j2; j++) {
+                a[s2*(p+1)+j] = (a[s1*(p+1)+j] - a[s1*(p+1)+j-1]) * ndu[(pk+1)*(p+1)+rk+j];
+                d += a[s2*(p+1)+j] * ndu[(rk+j)*(p+1)+pk];
+            }
+            if (r <= pk) {
+                a[s2*(p+1)+k] = -a[s1*(p+1)+k-1] * ndu[(pk+1)*(p+1)+r];
+                d += a[s2*(p+1)+k] * ndu[r*(p+1)+pk];
+            }
+            ders[k*(p+1)+r] = d;
+            /* Switch rows */
+            j = s1;  s1 = s2;  s2 = j;
+        }
+    }
+    
+    /* Multiply through by the correct factors */
+    r = p;
+    for (k = 1; k <= du; k++) {
+        for (j = 0; j <= p; j++) {
+            ders[k*(p+1)+j] *= r;
+        }
+        r *= (p-k);
+    }
+    
+    for (k = du+1; k <= n; k++) {
+        for (j = 0; j <= p; j++) {
+            ders[k*(p+1)+j] = 0.0;
+        }
+    }
+    
+}
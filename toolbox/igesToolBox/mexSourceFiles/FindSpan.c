@@ -27,3 +27,40 @@ unsigned int FindSpan(int n, int p, double u, double *U) {
     return(mid);
     
 }
+
+static unsigned int FindSpanHint(int n, int p, double u, double *U, int *hint) {
+    /* Modification of ALGORITHM A2.1, The NURBS Book, L.Piegl and W. Tiller */
+    /* Determine the knot span index, trying the span of a previous value and its neighbours first */
+    /* Input: n,p,u,U,hint */
+    /* Return: the knot span index (same as FindSpan), which is also stored in *hint */
+    
+    /* A value in the same span as the previous one costs two comparisons, in the next or previous nonempty span
+     * three or four (repeated knots are passed one comparison each), otherwise FindSpan is used. */
+    
+    int span = *hint;
+    
+    if (span >= p && span < n && u >= U[span]){
+        if (u < U[span+1]){
+            return(span);
+        }
+        /* Next nonempty span */
+        for (span++; span < n-1 && U[span+1] == U[span]; span++){
+        }
+        if (span < n-1 && u < U[span+1]){
+            *hint = span;
+            return(span);
+        }
+    }
+    else if (span > p && span < n && u < U[span]){
+        /* Previous nonempty span */
+        for (span--; span > p && U[span+1] == U[span]; span--){
+        }
+        if (u >= U[span]){
+            *hint = span;
+            return(span);
+        }
+    }
+    *hint = FindSpan(n, p, u, U);
+    return(*hint);
+    
+}
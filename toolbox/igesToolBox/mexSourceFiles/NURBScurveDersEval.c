@@ -0,0 +1,64 @@
+static void NURBScurveDersEval(int deg, double *cp, int ncp, double *knot, int nd, double *us, int nus, double **out, int nout, double *work, int *hint){
+    /* Modification of ALGORITHM A3.2 and A4.2, The NURBS Book, L.Piegl and W. Tiller */
+    
+    /* Evaluates a NURBS curve and its derivatives up to order nd at given parameter values, with one span lookup per parameter value and without derivative control points */
+    
+    /* NURBScurveDersEval( deg - degree of NURBS, cp - pointer to control points, ncp - number of control points, knot - pointer to knot sequence, nd - highest derivative order (0, 1 or 2), us - pointer to parameter values,  nus - number of parameter values, out - pointers to evaluated points P, Pu, Puu (3 x nus), nout - number of pointers in out, work - pointer to work array of NRB_DERSWORK(deg+1) elements, hint - pointer to knot span of a previous parameter value, updated) */
+    
+    int i, k, ii, jj, m, span, ind;
+    double u, wgh, Aw[3][4], S[3][3], *ders, *ndu, *a, *left, *right, *pnt;
+    
+    m = deg+1;
+    ndu = work;
+    a = ndu+m*m;
+    left = a+2*m;
+    right = left+m;
+    ders = right+m;
+    
+    for (jj = 0; jj < nus; jj++){
+        
+        u = us[jj];
+        if(u<=knot[deg]){
+            u = knot[deg];
+        }
+        else if(u>=knot[ncp]){
+            u = knot[ncp];
+        }
+        
+        span = FindSpanHint(ncp, deg, u, knot, hint);
+        DersBasisFuns(span, u, deg, nd, knot, ders, ndu, a, left, right);
+        
+        ind = span - deg;
+        
+        for (k = 0; k <= nd; k++){
+            for (ii = 0; ii < 4; ii++){
+                Aw[k][ii] = 0.0;
+            }
+            for (i = 0; i <= deg; i++){
+                pnt = &cp[(i+ind)*4];
+                for (ii = 0; ii < 4; ii++){
+                    Aw[k][ii] += ders[k*(deg+1)+i] * pnt[ii];
+                }
+            }
+        }
+        
+        wgh = Aw[0][3];
+        for (ii = 0; ii < 3; ii++){
+            S[0][ii] = Aw[0][ii]/wgh;
+            if(nd>0){
+                S[1][ii] = (Aw[1][ii]-Aw[1][3]*S[0][ii])/wgh;
+            }
+            if(nd>1){
+                S[2][ii] = (Aw[2][ii]-2*Aw[1][3]*S[1][ii]-Aw[2][3]*S[0][ii])/wgh;
+            }
+        }
+        
+        for (k = 0; k < nout; k++){
+            for (ii = 0; ii < 3; ii++){
+                out[k][jj*3+ii] = S[k][ii];
+            }
+        }
+        
+    }
+    
+}
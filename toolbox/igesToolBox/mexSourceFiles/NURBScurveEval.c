@@ -6,12 +6,12 @@ static void NURBScurveEval(int deg, double *cp, int ncp, double *knot, double *u
     
     /* NURBScurveEval( deg - degree of NURBS, cp - pointer to control points, ncp - number of control points, knot - pointer to knot sequence, us - pointer to parameter values, nus - number of parameter values, ep - pointer to evaluated points, left - pointer to array for function BasisFuns, right - pointer to array for function BasisFuns, N - pointer to array for function BasisFuns) */
     
-    int i, jj, span, ind;
+    int i, jj, span, ind, hint = 0;
     double wgh;
     
     for (jj = 0; jj < nus; jj++){
         
-        if(us[jj]<=knot[deg] || deg==0){
+        if(us[jj]<=knot[deg]){
             ep[jj*3] = cp[0]/cp[3];
             ep[jj*3+1] = cp[1]/cp[3];
             ep[jj*3+2] = cp[2]/cp[3];
@@ -27,7 +27,7 @@ static void NURBScurveEval(int deg, double *cp, int ncp, double *knot, double *u
             ep[jj*3+2]=0.0;
             wgh=0.0;
             
-            span = FindSpan(ncp, deg, us[jj], knot);
+            span = FindSpanHint(ncp, deg, us[jj], knot, &hint);
             BasisFuns(span, us[jj], deg, knot, N, left, right);
             
             ind = span - deg;
@@ -0,0 +1,114 @@
+static void NURBSsurfaceDersEval(int degU, int degV, double *cp, int ncp, int kcp, double *knotU, double *knotV, int nd, double *us, int nus, double **out, int nout, double *work, int *hint){
+    /* Modification of ALGORITHM A3.6 and A4.4, The NURBS Book, L.Piegl and W. Tiller */
+    
+    /* Evaluates a NURBS surface and its derivatives up to order nd at given parameter values, with one span lookup per parameter value and without derivative control nets */
+    
+    /* NURBSsurfaceDersEval( degU - degree of NURBS in u, degV - degree of NURBS in v, cp - pointer to control points, ncp - number of control points in u, kcp - number of control points in v, knotU - pointer to knot sequence in u, knotV - pointer to knot sequence in v, nd - highest derivative order (0, 1 or 2), us - pointer to parameter values,  nus - number of parameter values, out - pointers to evaluated points P, Pu, Pv, Puu, Puv, Pvv (3 x nus), nout - number of pointers in out, work - pointer to work array of NRB_DERSWORK(max(degU,degV)+1) elements, hint - pointer to knot spans in u and v of a previous parameter value, updated) */
+    
+    int i, j, k, ii, jj, m, spanU, spanV, ind, ind2;
+    double u, v, wgh, Aw[6][4], temp[3][4], S[6][3], *dersU, *dersV, *ndu, *a, *left, *right, *pnt;
+    
+    m = ((degU>degV) ? degU : degV)+1;
+    ndu = work;
+    a = ndu+m*m;
+    left = a+2*m;
+    right = left+m;
+    dersU = right+m;
+    dersV = dersU+3*m;
+    
+    for (jj = 0; jj < nus; jj++){
+        
+        u = us[2*jj];
+        if(u<=knotU[degU]){
+            u = knotU[degU];
+        }
+        else if(u>=knotU[ncp]){
+            u = knotU[ncp];
+        }
+        v = us[2*jj+1];
+        if(v<=knotV[degV]){
+            v = knotV[degV];
+        }
+        else if(v>=knotV[kcp]){
+            v = knotV[kcp];
+        }
+        
+        spanU = FindSpanHint(ncp, degU, u, knotU, &hint[0]);
+        DersBasisFuns(spanU, u, degU, nd, knotU, dersU, ndu, a, left, right);
+        
+        spanV = FindSpanHint(kcp, degV, v, knotV, &hint[1]);
+        DersBasisFuns(spanV, v, degV, nd, knotV, dersV, ndu, a, left, right);
+        
+        ind = spanU - degU;
+        ind2 = spanV - degV;
+        
+        for (k = 0; k < 6; k++){
+            for (ii = 0; ii < 4; ii++){
+                Aw[k][ii] = 0.0;
+            }
+        }
+        
+        /* Aw[0] = A, Aw[1] = A_u, Aw[2] = A_v, Aw[3] = A_uu, Aw[4] = A_uv, Aw[5] = A_vv of the homogeneous B-spline */
+        for (j = 0; j <= degV; j++){
+            for (k = 0; k <= nd; k++){
+                for (ii = 0; ii < 4; ii++){
+                    temp[k][ii] = 0.0;
+                }
+            }
+            for (i = 0; i <= degU; i++){
+                pnt = &cp[(j+ind2)*4*ncp+(i+ind)*4];
+                for (ii = 0; ii < 4; ii++){
+                    temp[0][ii] += dersU[i] * pnt[ii];
+                }
+                if(nd>0){
+                    for (ii = 0; ii < 4; ii++){
+                        temp[1][ii] += dersU[(degU+1)+i] * pnt[ii];
+                    }
+                }
+                if(nd>1){
+                    for (ii = 0; ii < 4; ii++){
+                        temp[2][ii] += dersU[2*(degU+1)+i] * pnt[ii];
+                    }
+                }
+            }
+            for (ii = 0; ii < 4; ii++){
+                Aw[0][ii] += dersV[j] * temp[0][ii];
+            }
+            if(nd>0){
+                for (ii = 0; ii < 4; ii++){
+                    Aw[1][ii] += dersV[j] * temp[1][ii];
+                    Aw[2][ii] += dersV[(degV+1)+j] * temp[0][ii];
+                }
+            }
+            if(nd>1){
+                for (ii = 0; ii < 4; ii++){
+                    Aw[3][ii] += dersV[j] * temp[2][ii];
+                    Aw[4][ii] += dersV[(degV+1)+j] * temp[1][ii];
+                    Aw[5][ii] += dersV[2*(degV+1)+j] * temp[0][ii];
+                }
+            }
+        }
+        
+        wgh = Aw[0][3];
+        for (ii = 0; ii < 3; ii++){
+            S[0][ii] = Aw[0][ii]/wgh;
+            if(nd>0){
+                S[1][ii] = (Aw[1][ii]-Aw[1][3]*S[0][ii])/wgh;
+                S[2][ii] = (Aw[2][ii]-Aw[2][3]*S[0][ii])/wgh;
+            }
+            if(nd>1){
+                S[3][ii] = (Aw[3][ii]-2*Aw[1][3]*S[1][ii]-Aw[3][3]*S[0][ii])/wgh;
+                S[4][ii] = (Aw[4][ii]-Aw[1][3]*S[2][ii]-Aw[2][3]*S[1][ii]-Aw[4][3]*S[0][ii])/wgh;
+                S[5][ii] = (Aw[5][ii]-2*Aw[2][3]*S[2][ii]-Aw[5][3]*S[0][ii])/wgh;
+            }
+        }
+        
+        for (k = 0; k < nout; k++){
+            for (ii = 0; ii < 3; ii++){
+                out[k][jj*3+ii] = S[k][ii];
+            }
+        }
+        
+    }
+    
+}
@@ -6,13 +6,13 @@ static void NURBSsurfaceEval(int degU, int degV, double *cp, int ncp, int kcp, d
     
     /* NURBSsurfaceEval( degU - degree of NURBS in u, degV - degree of NURBS in v, cp - pointer to control points, ncp - number of control points in u, kcp - number of control points in v, knotU - pointer to knot sequence in u, knotV - pointer to knot sequence in v, us - pointer to parameter values,  nus - number of parameter values, ep - pointer to evaluated points, leftU - pointer to array for function BasisFuns, rightU - pointer to array for function BasisFuns, NU - pointer to array for function BasisFuns, leftV - pointer to array for function BasisFuns, rightV - pointer to array for function BasisFuns, NV - pointer to array for function BasisFuns) */
     
-    int i, j, jj, spanU, spanV, ind, ind2;
+    int i, j, jj, spanU, spanV, ind, ind2, hintU = 0, hintV = 0;
     double wgh;
     
     for (jj = 0; jj < nus; jj++){
         
-        if(us[2*jj]<=knotU[degU] || degU==0){
-            if(us[2*jj+1]<=knotV[degV] || degV==0){
+        if(us[2*jj]<=knotU[degU]){
+            if(us[2*jj+1]<=knotV[degV]){
                 ep[jj*3] = cp[0]/cp[3];
                 ep[jj*3+1] = cp[1]/cp[3];
                 ep[jj*3+2] = cp[2]/cp[3];
@@ -28,7 +28,7 @@ static void NURBSsurfaceEval(int degU, int degV, double *cp, int ncp, int kcp, d
                 ep[jj*3+2]=0.0;
                 wgh=0.0;
                 
-                spanV = FindSpan(kcp, degV, us[2*jj+1], knotV);
+                spanV = FindSpanHint(kcp, degV, us[2*jj+1], knotV, &hintV);
                 BasisFuns(spanV, us[2*jj+1], degV, knotV, NV, leftV, rightV);
                 
                 ind = spanV - degV;
@@ -45,7 +45,7 @@ static void NURBSsurfaceEval(int degU, int degV, double *cp, int ncp, int kcp, d
             }
         }
         else if(us[2*jj]>=knotU[ncp]){
-            if(us[2*jj+1]<=knotV[degV] || degV==0){
+            if(us[2*jj+1]<=knotV[degV]){
                 ep[jj*3] = cp[4*ncp-4]/cp[4*ncp-1];
                 ep[jj*3+1] = cp[4*ncp-3]/cp[4*ncp-1];
                 ep[jj*3+2] = cp[4*ncp-2]/cp[4*ncp-1];
@@ -61,7 +61,7 @@ static void NURBSsurfaceEval(int degU, int degV, double *cp, int ncp, int kcp, d
                 ep[jj*3+2]=0.0;
                 wgh=0.0;
                 
-                spanV = FindSpan(kcp, degV, us[2*jj+1], knotV);
+                spanV = FindSpanHint(kcp, degV, us[2*jj+1], knotV, &hintV);
                 BasisFuns(spanV, us[2*jj+1], degV, knotV, NV, leftV, rightV);
                 
                 ind = spanV - degV;
@@ -84,8 +84,8 @@ static void NURBSsurfaceEval(int degU, int degV, double *cp, int ncp, int kcp, d
             ep[jj*3+2]=0.0;
             wgh=0.0;
             
-            if(us[2*jj+1]<=knotV[degV] || degV==0){
-                spanU = FindSpan(ncp, degU, us[2*jj], knotU);
+            if(us[2*jj+1]<=knotV[degV]){
+                spanU = FindSpanHint(ncp, degU, us[2*jj], knotU, &hintU);
                 BasisFuns(spanU, us[2*jj], degU, knotU, NU, leftU, rightU);
                 
                 ind = spanU - degU;
@@ -101,7 +101,7 @@ static void NURBSsurfaceEval(int degU, int degV, double *cp, int ncp, int kcp, d
                 ep[jj*3+2]=ep[jj*3+2]/wgh;
             }
             else if(us[2*jj+1]>=knotV[kcp]){
-                spanU = FindSpan(ncp, degU, us[2*jj], knotU);
+                spanU = FindSpanHint(ncp, degU, us[2*jj], knotU, &hintU);
                 BasisFuns(spanU, us[2*jj], degU, knotU, NU, leftU, rightU);
                 
                 ind = spanU - degU;
@@ -117,10 +117,10 @@ static void NURBSsurfaceEval(int degU, int degV, double *cp, int ncp, int kcp, d
                 ep[jj*3+2]=ep[jj*3+2]/wgh;
             }
             else{
-                spanU = FindSpan(ncp, degU, us[2*jj], knotU);
+                spanU = FindSpanHint(ncp, degU, us[2*jj], knotU, &hintU);
                 BasisFuns(spanU, us[2*jj], degU, knotU, NU, leftU, rightU);
                 
-                spanV = FindSpan(kcp, degV, us[2*jj+1], knotV);
+                spanV = FindSpanHint(kcp, degV, us[2*jj+1], knotV, &hintV);
                 BasisFuns(spanV, us[2*jj+1], degV, knotV, NV, leftV, rightV);
                 
                 ind = spanU - degU;
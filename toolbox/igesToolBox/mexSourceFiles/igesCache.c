@@ -0,0 +1,150 @@
+
+/* igesCache stores a Matlab array (struct, cell, char, logical and real numeric arrays) in a binary cache file */
+
+/* The file is written by igesCacheWrite and read by igesCacheRead, which both need igesCache */
+
+/*
+ * Cache file layout, all words are 64-bit unsigned integers in the byte
+ * order of the machine that wrote the file:
+ *
+ * Header (IGES_CACHEHEADER words)
+ *   0 magic number, IGES_CACHEMAGIC
+ *   1 byte order mark, IGES_CACHEBOM
+ *   2 version, IGES_CACHEVERSION, increased when the data stored by loadIGES
+ *     changes (2: ParameterData has the field arclength)
+ *   3 size of the IGES-file in bytes
+ *   4 hash of the IGES-file (igesHash)
+ *   5 number of node words
+ *   6 offset of the node words in bytes
+ *   7 size of the data block in bytes
+ *   8 offset of the data block in bytes (multiple of 64)
+ *   9 size of the cache file in bytes
+ *  10 hash of the rest of the cache file (after the header)
+ *
+ * Node words, the arrays in depth-first order. Every array is stored as
+ *   kind, class id, number of dimensions, dimensions,
+ * followed by
+ *   numeric, char and logical arrays - offset of the elements in the data block
+ *   cell arrays - the elements
+ *   struct arrays - number of fields, offsets of the field names in the
+ *                   data block, the fields of the first element, the fields
+ *                   of the second element, ...
+ * An unset cell element or field (NULL) is stored as the kind only.
+ *
+ * Data block, the elements of the arrays and the (zero terminated) field
+ * names, each starting at a multiple of 8 bytes.
+ */
+
+#include <stdint.h>
+
+#define IGES_CACHEMAGIC    0x4843414353454749ULL   /* "IGESCACH" */
+#define IGES_CACHEBOM      0x0102030405060708ULL
+#define IGES_CACHEVERSION  2
+#define IGES_CACHEHEADER   16
+#define IGES_CACHEMAXDIMS  32
+
+#define IGES_CACHENUMERIC  0
+#define IGES_CACHECHAR     1
+#define IGES_CACHELOGICAL  2
+#define IGES_CACHECELL     3
+#define IGES_CACHESTRUCT   4
+#define IGES_CACHENULL     5
+
+typedef struct {
+    uint64_t *node;             /* node words, NULL when only counting */
+    size_t numNode;             /* number of node words */
+    unsigned char *data;        /* data block, NULL when only counting */
+    size_t dataSize;            /* size of the data block in bytes */
+} igesCacheBuffer;
+
+typedef struct {
+    const uint64_t *node;       /* node words */
+    size_t numNode;             /* number of node words */
+    size_t pos;                 /* next node word */
+    const unsigned char *data;  /* data block */
+    size_t dataSize;            /* size of the data block in bytes */
+} igesCacheReader;
+
+
+static uint64_t igesHashRotl(uint64_t x, int r){
+    return (x << r) | (x >> (64-r));
+}
+
+
+static uint64_t igesHashRound(uint64_t acc, uint64_t w){
+    acc += w*14029467366897019727ULL;
+    return igesHashRotl(acc, 31)*11400714785074694791ULL;
+}
+
+
+static uint64_t igesHashMerge(uint64_t h, uint64_t acc){
+    h ^= igesHashRound(0, acc);
+    return h*11400714785074694791ULL + 9650029242287828579ULL;
+}
+
+
+static uint64_t igesHash(const unsigned char *p, size_t size){
+    /* igesHash returns the 64-bit hash XXH64 (seed 0) of size bytes at p */
+
+    /* igesHash( p - bytes, size - number of bytes) */
+
+    const uint64_t P1 = 11400714785074694791ULL, P2 = 14029467366897019727ULL;
+    const uint64_t P3 = 1609587929392839161ULL, P4 = 9650029242287828579ULL;
+    const uint64_t P5 = 2870177450012600261ULL;
+    const unsigned char *end = p + size;
+    uint64_t h, v1, v2, v3, v4, w;
+    uint32_t w32;
+
+    if (size>=32){
+        v1 = P1 + P2;
+        v2 = P2;
+        v3 = 0;
+        v4 = 0 - P1;
+        while (p+32<=end){
+            memcpy(&w, p, 8);
+            v1 = igesHashRound(v1, w);
+            memcpy(&w, p+8, 8);
+            v2 = igesHashRound(v2, w);
+            memcpy(&w, p+16, 8);
+            v3 = igesHashRound(v3, w);
+            memcpy(&w, p+24, 8);
+            v4 = igesHashRound(v4, w);
+            p += 32;
+        }
+        h = igesHashRotl(v1, 1) + igesHashRotl(v2, 7) + igesHashRotl(v3, 12) + igesHashRotl(v4, 18);
+        h = igesHashMerge(h, v1);
+        h = igesHashMerge(h, v2);
+        h = igesHashMerge(h, v3);
+        h = igesHashMerge(h, v4);
+    }
+    else {
+        h = P5;
+    }
+    h += (uint64_t)size;
+
+    while (p+8<=end){
+        memcpy(&w, p, 8);
+        h ^= igesHashRound(0, w);
+        h = igesHashRotl(h, 27)*P1 + P4;
+        p += 8;
+    }
+    if (p+4<=end){
+        memcpy(&w32, p, 4);
+        h ^= (uint64_t)w32*P1;
+        h = igesHashRotl(h, 23)*P2 + P3;
+        p += 4;
+    }
+    while (p<end){
+        h ^= (uint64_t)(*p)*P5;
+        h = igesHashRotl(h, 11)*P1;
+        p++;
+    }
+
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+
+}
@@ -0,0 +1,179 @@
+/* igesCacheRead reads a Matlab array from a binary cache file in memory */
+
+/* igesCacheRead needs igesCache, the file layout is described there */
+
+
+static int igesCacheOpen(const unsigned char *file, size_t size, igesCacheReader *rd, uint64_t *srcSize, uint64_t *srcHash){
+    /* igesCacheOpen checks the header of a cache file in memory, returns 0 if it is not a valid cache file */
+
+    /* igesCacheOpen( file - cache file contents, size - number of bytes, rd - reader, srcSize, srcHash - size and hash of the IGES-file) */
+
+    uint64_t header[IGES_CACHEHEADER];
+
+    if (size<sizeof(header)){
+        return 0;
+    }
+    memcpy(header, file, sizeof(header));
+    if (header[0]!=IGES_CACHEMAGIC || header[1]!=IGES_CACHEBOM || header[2]!=IGES_CACHEVERSION){
+        return 0;
+    }
+    if (header[9]!=(uint64_t)size || header[6]!=IGES_CACHEHEADER*sizeof(uint64_t)){
+        return 0;
+    }
+    if (header[5]>(size-header[6])/sizeof(uint64_t) || header[6]+header[5]*sizeof(uint64_t)>header[8]){
+        return 0;
+    }
+    if ((header[8] & 63)!=0 || header[8]>size || header[7]!=size-header[8]){
+        return 0;
+    }
+    if (igesHash(file+sizeof(header), size-sizeof(header))!=header[10]){
+        return 0;
+    }
+
+    *srcSize = header[3];
+    *srcHash = header[4];
+    rd->node = (const uint64_t*)(file + header[6]);
+    rd->numNode = (size_t)header[5];
+    rd->pos = 0;
+    rd->data = file + header[8];
+    rd->dataSize = (size_t)header[7];
+    return 1;
+
+}
+
+
+static int igesCacheNext(igesCacheReader *rd, uint64_t *w){
+    /* igesCacheNext reads the next node word, returns 0 at the end of the node words */
+
+    if (rd->pos>=rd->numNode){
+        return 0;
+    }
+    *w = rd->node[rd->pos++];
+    return 1;
+
+}
+
+
+static int igesCacheGet(igesCacheReader *rd, mxArray **arr){
+    /* igesCacheGet reads the next array from the cache, returns 0 if the cache is corrupt */
+
+    /* igesCacheGet( rd - reader, arr - the array, NULL for an unset cell element or field) */
+
+    mwSize dims[IGES_CACHEMAXDIMS];
+    const char **names;
+    mxArray *child;
+    uint64_t kind, cls, ndims, w, numFields;
+    size_t k, numel, numBytes;
+    int f;
+
+    *arr = NULL;
+    if (!igesCacheNext(rd, &kind)){
+        return 0;
+    }
+    if (kind==IGES_CACHENULL){
+        return 1;
+    }
+    if (!igesCacheNext(rd, &cls) || !igesCacheNext(rd, &ndims) || ndims<2 || ndims>IGES_CACHEMAXDIMS){
+        return 0;
+    }
+    numel = 1;
+    for (k = 0; k < ndims; k++){
+        if (!igesCacheNext(rd, &w)){
+            return 0;
+        }
+        if (w>0 && numel>(rd->dataSize + rd->numNode)/w){
+            return 0;
+        }
+        dims[k] = (mwSize)w;
+        numel *= (size_t)w;
+    }
+
+    if (kind==IGES_CACHECELL){
+        if (cls!=mxCELL_CLASS || numel>rd->numNode-rd->pos){
+            return 0;
+        }
+        *arr = mxCreateCellArray((mwSize)ndims, dims);
+        for (k = 0; k < numel; k++){
+            if (!igesCacheGet(rd, &child)){
+                mxDestroyArray(*arr);
+                *arr = NULL;
+                return 0;
+            }
+            if (child!=NULL){
+                mxSetCell(*arr, k, child);
+            }
+        }
+        return 1;
+    }
+
+    if (kind==IGES_CACHESTRUCT){
+        if (cls!=mxSTRUCT_CLASS || !igesCacheNext(rd, &numFields) || numFields>rd->numNode-rd->pos){
+            return 0;
+        }
+        if (numFields>0 && numel>(rd->numNode-rd->pos)/numFields){
+            return 0;
+        }
+        names = (const char**) mxMalloc((numFields>0 ? numFields : 1)*sizeof(char*));
+        for (f = 0; f < (int)numFields; f++){
+            if (!igesCacheNext(rd, &w) || w>=rd->dataSize || memchr(rd->data+w, 0, rd->dataSize-(size_t)w)==NULL){
+                mxFree(names);
+                return 0;
+            }
+            names[f] = (const char*)(rd->data+w);
+        }
+        *arr = mxCreateStructArray((mwSize)ndims, dims, (int)numFields, names);
+        mxFree(names);
+        for (k = 0; k < numel; k++){
+            for (f = 0; f < (int)numFields; f++){
+                if (!igesCacheGet(rd, &child)){
+                    mxDestroyArray(*arr);
+                    *arr = NULL;
+                    return 0;
+                }
+                if (child!=NULL){
+                    mxSetFieldByNumber(*arr, k, f, child);
+                }
+            }
+        }
+        return 1;
+    }
+
+    if (kind==IGES_CACHECHAR){
+        if (cls!=mxCHAR_CLASS){
+            return 0;
+        }
+        *arr = mxCreateCharArray((mwSize)ndims, dims);
+    }
+    else if (kind==IGES_CACHELOGICAL){
+        if (cls!=mxLOGICAL_CLASS){
+            return 0;
+        }
+        *arr = mxCreateLogicalArray((mwSize)ndims, dims);
+    }
+    else if (kind==IGES_CACHENUMERIC){
+        switch (cls){
+            case mxDOUBLE_CLASS: case mxSINGLE_CLASS:
+            case mxINT8_CLASS: case mxUINT8_CLASS: case mxINT16_CLASS: case mxUINT16_CLASS:
+            case mxINT32_CLASS: case mxUINT32_CLASS: case mxINT64_CLASS: case mxUINT64_CLASS:
+                break;
+            default:
+                return 0;
+        }
+        *arr = mxCreateNumericArray((mwSize)ndims, dims, (mxClassID)cls, mxREAL);
+    }
+    else {
+        return 0;
+    }
+
+    numBytes = numel*mxGetElementSize(*arr);
+    if (!igesCacheNext(rd, &w) || w>rd->dataSize || numBytes>rd->dataSize-(size_t)w){
+        mxDestroyArray(*arr);
+        *arr = NULL;
+        return 0;
+    }
+    if (numBytes>0){
+        memcpy(mxGetData(*arr), rd->data+w, numBytes);
+    }
+    return 1;
+
+}
@@ -0,0 +1,175 @@
+/* igesCacheWrite writes a Matlab array to a binary cache file */
+
+/* igesCacheWrite needs igesCache, the file layout is described there */
+
+
+static void igesCacheWord(igesCacheBuffer *buf, uint64_t w){
+    /* igesCacheWord appends a node word */
+
+    if (buf->node!=NULL){
+        buf->node[buf->numNode] = w;
+    }
+    buf->numNode++;
+
+}
+
+
+static size_t igesCacheData(igesCacheBuffer *buf, const void *src, size_t numBytes){
+    /* igesCacheData appends numBytes bytes at src to the data block (padded to 8 bytes), returns their offset */
+
+    size_t offset = buf->dataSize, padded = (numBytes+7) & ~(size_t)7;
+
+    if (buf->data!=NULL){
+        if (numBytes>0){
+            memcpy(buf->data+offset, src, numBytes);
+        }
+        memset(buf->data+offset+numBytes, 0, padded-numBytes);
+    }
+    buf->dataSize += padded;
+    return offset;
+
+}
+
+
+static int igesCachePut(const mxArray *arr, igesCacheBuffer *buf){
+    /* igesCachePut appends arr to buf, returns 0 if arr contains unsupported arrays */
+
+    /* igesCachePut( arr - Matlab array, buf - cache buffer) */
+
+    const mwSize *dims;
+    const char *name;
+    size_t k, ndims, numel;
+    int f, numFields, kind;
+    mxClassID cls;
+
+    if (arr==NULL){
+        igesCacheWord(buf, IGES_CACHENULL);
+        return 1;
+    }
+    if (mxIsComplex(arr) || mxIsSparse(arr)){
+        return 0;
+    }
+
+    cls = mxGetClassID(arr);
+    switch (cls){
+        case mxDOUBLE_CLASS: case mxSINGLE_CLASS:
+        case mxINT8_CLASS: case mxUINT8_CLASS: case mxINT16_CLASS: case mxUINT16_CLASS:
+        case mxINT32_CLASS: case mxUINT32_CLASS: case mxINT64_CLASS: case mxUINT64_CLASS:
+            kind = IGES_CACHENUMERIC;
+            break;
+        case mxCHAR_CLASS:
+            kind = IGES_CACHECHAR;
+            break;
+        case mxLOGICAL_CLASS:
+            kind = IGES_CACHELOGICAL;
+            break;
+        case mxCELL_CLASS:
+            kind = IGES_CACHECELL;
+            break;
+        case mxSTRUCT_CLASS:
+            kind = IGES_CACHESTRUCT;
+            break;
+        default:
+            return 0;
+    }
+
+    ndims = mxGetNumberOfDimensions(arr);
+    dims = mxGetDimensions(arr);
+    numel = mxGetNumberOfElements(arr);
+    if (ndims>IGES_CACHEMAXDIMS){
+        return 0;
+    }
+
+    igesCacheWord(buf, (uint64_t)kind);
+    igesCacheWord(buf, (uint64_t)cls);
+    igesCacheWord(buf, (uint64_t)ndims);
+    for (k = 0; k < ndims; k++){
+        igesCacheWord(buf, (uint64_t)dims[k]);
+    }
+
+    if (kind==IGES_CACHECELL){
+        for (k = 0; k < numel; k++){
+            if (!igesCachePut(mxGetCell(arr, k), buf)){
+                return 0;
+            }
+        }
+    }
+    else if (kind==IGES_CACHESTRUCT){
+        numFields = mxGetNumberOfFields(arr);
+        igesCacheWord(buf, (uint64_t)numFields);
+        for (f = 0; f < numFields; f++){
+            name = mxGetFieldNameByNumber(arr, f);
+            igesCacheWord(buf, (uint64_t)igesCacheData(buf, name, strlen(name)+1));
+        }
+        for (k = 0; k < numel; k++){
+            for (f = 0; f < numFields; f++){
+                if (!igesCachePut(mxGetFieldByNumber(arr, k, f), buf)){
+                    return 0;
+                }
+            }
+        }
+    }
+    else {
+        igesCacheWord(buf, (uint64_t)igesCacheData(buf, mxGetData(arr), numel*mxGetElementSize(arr)));
+    }
+
+    return 1;
+
+}
+
+
+static int igesCacheWrite(const char *filename, const mxArray *arr, uint64_t srcSize, uint64_t srcHash){
+    /* igesCacheWrite writes arr to the cache file filename, returns 0 if arr is unsupported and -1 if the file cannot be written */
+
+    /* igesCacheWrite( filename - cache file, arr - Matlab array, srcSize, srcHash - size and hash of the IGES-file) */
+
+    igesCacheBuffer buf;
+    uint64_t *header;
+    unsigned char *file;
+    size_t dataOffset, fileSize, ok;
+    FILE *fid;
+
+    /* First pass counts, second pass fills the cache file in memory */
+
+    buf.node = NULL;
+    buf.data = NULL;
+    buf.numNode = 0;
+    buf.dataSize = 0;
+    if (!igesCachePut(arr, &buf)){
+        return 0;
+    }
+    dataOffset = ((IGES_CACHEHEADER + buf.numNode)*sizeof(uint64_t) + 63) & ~(size_t)63;
+    fileSize = dataOffset + buf.dataSize;
+
+    file = (unsigned char*) mxCalloc(fileSize, 1);
+    header = (uint64_t*)file;
+    buf.node = header + IGES_CACHEHEADER;
+    buf.data = file + dataOffset;
+    buf.numNode = 0;
+    buf.dataSize = 0;
+    igesCachePut(arr, &buf);
+
+    header[0] = IGES_CACHEMAGIC;
+    header[1] = IGES_CACHEBOM;
+    header[2] = IGES_CACHEVERSION;
+    header[3] = srcSize;
+    header[4] = srcHash;
+    header[5] = (uint64_t)buf.numNode;
+    header[6] = IGES_CACHEHEADER*sizeof(uint64_t);
+    header[7] = (uint64_t)buf.dataSize;
+    header[8] = (uint64_t)dataOffset;
+    header[9] = (uint64_t)fileSize;
+    header[10] = igesHash(file + IGES_CACHEHEADER*sizeof(uint64_t), fileSize - IGES_CACHEHEADER*sizeof(uint64_t));
+
+    fid = fopen(filename, "wb");
+    if (fid==NULL){
+        mxFree(file);
+        return -1;
+    }
+    ok = fwrite(file, 1, fileSize, fid)==fileSize;
+    ok = (fclose(fid)==0) && ok;
+
+    mxFree(file);
+    return ok ? 1 : -1;
+
+}
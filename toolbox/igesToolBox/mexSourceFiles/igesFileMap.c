@@ -0,0 +1,116 @@
+
+/* igesFileMap maps a file read-only into memory, so that it is read by the operating system as it is parsed */
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+typedef struct {
+    const unsigned char *data;  /* file contents */
+    size_t size;                /* number of bytes in data */
+#ifdef _WIN32
+    HANDLE file, mapping;
+#endif
+} igesFileMap;
+
+
+static int igesMapFile(const char *filename, igesFileMap *map){
+    /* igesMapFile maps the file filename into memory, returns 0 if the file cannot be opened */
+
+    /* igesMapFile( filename - name of file, map - pointer to mapped file) */
+
+#ifdef _WIN32
+
+    LARGE_INTEGER size;
+
+    map->data = NULL;
+    map->size = 0;
+    map->mapping = NULL;
+    map->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (map->file==INVALID_HANDLE_VALUE){
+        return 0;
+    }
+    if (!GetFileSizeEx(map->file, &size)){
+        CloseHandle(map->file);
+        return 0;
+    }
+    map->size = (size_t)size.QuadPart;
+    if (map->size==0){
+        return 1;
+    }
+    map->mapping = CreateFileMappingA(map->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (map->mapping==NULL){
+        CloseHandle(map->file);
+        return 0;
+    }
+    map->data = (const unsigned char*) MapViewOfFile(map->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (map->data==NULL){
+        CloseHandle(map->mapping);
+        CloseHandle(map->file);
+        return 0;
+    }
+    return 1;
+
+#else
+
+    int fd;
+    struct stat st;
+    void *data;
+
+    map->data = NULL;
+    map->size = 0;
+    fd = open(filename, O_RDONLY);
+    if (fd<0){
+        return 0;
+    }
+    if (fstat(fd, &st)!=0){
+        close(fd);
+        return 0;
+    }
+    map->size = (size_t)st.st_size;
+    if (map->size==0){
+        close(fd);
+        return 1;
+    }
+    data = mmap(NULL, map->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data==MAP_FAILED){
+        return 0;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(data, map->size, MADV_SEQUENTIAL);
+#endif
+    map->data = (const unsigned char*) data;
+    return 1;
+
+#endif
+
+}
+
+
+static void igesUnmapFile(igesFileMap *map){
+    /* igesUnmapFile unmaps a file mapped by igesMapFile */
+
+#ifdef _WIN32
+    if (map->data!=NULL){
+        UnmapViewOfFile((LPCVOID)map->data);
+        CloseHandle(map->mapping);
+    }
+    if (map->file!=INVALID_HANDLE_VALUE){
+        CloseHandle(map->file);
+    }
+#else
+    if (map->data!=NULL){
+        munmap((void*)map->data, map->size);
+    }
+#endif
+    map->data = NULL;
+    map->size = 0;
+
+}
@@ -0,0 +1,441 @@
+
+/* igesParse splits an IGES file into its sections and parses the directory entries and the parameter data of the entities */
+
+/* An IGES file is a sequence of records of 80 columns (followed by 0, 1 or 2 newline characters), column 73 gives
+ * the section, S (start), G (global), D (directory entry), P (parameter data) or T (terminate). Every entity has
+ * two D records and one or more P records. The parameters in columns 1-64 of the P records are separated by the
+ * parameter delimiter and ended by the record delimiter given in the G section (default ',' and ';').
+ *
+ * The records are located from the mapped file without copying it, and the entities are parsed independently of
+ * each other, in parallel if compiled with OpenMP. Numbers are converted directly from the characters, without
+ * strtod for the common case (see igesParseNumber). */
+
+#define IGES_RECLEN 80
+#define IGES_NUMDFIELDS 20
+
+typedef struct {
+    const unsigned char *data;  /* file contents */
+    size_t recLen;              /* IGES_RECLEN + number of newline characters */
+    int numRecs;                /* number of records */
+    int numS, numG, numD, numP, numT;
+    int firstG, firstD, firstP; /* index of first record of sections */
+    unsigned char paramDelim;   /* parameter delimiter */
+    unsigned char recordDelim;  /* record delimiter */
+    double nan;                 /* NaN, mxGetNaN must not be called in parallel regions */
+} igesFile;
+
+typedef struct {
+    double *val;                /* parameters, NaN for strings */
+    int numVal;                 /* number of parameters */
+    char *str;                  /* Hollerith strings, concatenated */
+    int *strLen;                /* length of every string */
+    int numStr;                 /* number of strings */
+} igesEntity;
+
+
+static int igesIsNewline(unsigned char c){
+    /* igesIsNewline returns 1 for carriage return and line feed */
+
+    return c==10 || c==13;
+
+}
+
+
+static int igesSections(const unsigned char *data, size_t size, igesFile *igs){
+    /* igesSections finds the record length and the sections of an IGES file, returns 0 if it is not an IGES file */
+
+    /* igesSections( data - pointer to file contents, size - number of bytes in data, igs - pointer to IGES file) */
+
+    int r, nwro, edfi;
+    unsigned char sec;
+
+    igs->data = NULL;
+    igs->recLen = IGES_RECLEN;
+    igs->numRecs = 0;
+    igs->numS = 0;
+    igs->numG = 0;
+    igs->numD = 0;
+    igs->numP = 0;
+    igs->numT = 0;
+    igs->firstG = 0;
+    igs->firstD = 0;
+    igs->firstP = 0;
+    igs->paramDelim = ',';
+    igs->recordDelim = ';';
+    igs->nan = mxGetNaN();
+
+    if (size<IGES_RECLEN+2){
+        return 0;
+    }
+
+    /* Newline characters after every record, the last record may have fewer */
+    nwro = igesIsNewline(data[IGES_RECLEN])+igesIsNewline(data[IGES_RECLEN+1]);
+    edfi = nwro-igesIsNewline(data[size-2])-igesIsNewline(data[size-1]);
+    igs->recLen = IGES_RECLEN+nwro;
+    if ((size+edfi)%igs->recLen!=0){
+        return 0;
+    }
+    igs->data = data;
+    igs->numRecs = (int)((size+edfi)/igs->recLen);
+
+    for (r = 0; r < igs->numRecs; r++){
+        sec = data[r*igs->recLen+72];
+        if (sec=='S'){
+            igs->numS++;
+        }
+        else if (sec=='G'){
+            igs->numG++;
+        }
+        else if (sec=='D'){
+            igs->numD++;
+        }
+        else if (sec=='P'){
+            igs->numP++;
+        }
+        else if (sec=='T'){
+            igs->numT++;
+        }
+    }
+    igs->firstG = igs->numS;
+    igs->firstD = igs->firstG+igs->numG;
+    igs->firstP = igs->firstD+igs->numD;
+
+    return 1;
+
+}
+
+
+static const unsigned char *igesRecord(const igesFile *igs, int r){
+    /* igesRecord returns a pointer to column 1 of record r */
+
+    return igs->data+(size_t)r*igs->recLen;
+
+}
+
+
+static void igesDelimiters(igesFile *igs){
+    /* igesDelimiters reads the parameter and record delimiters from the G section */
+
+    /* The first two parameters of the G section are the delimiters as Hollerith strings (1H,) or empty (default) */
+
+    int k, st, len = 72*igs->numG;
+    unsigned char G[8];
+
+    /* The delimiters are within the first 8 characters */
+    for (k = 0; k < 8; k++){
+        G[k] = (k<len) ? igesRecord(igs, igs->firstG+k/72)[k%72] : ' ';
+    }
+
+    if (G[0]=='1' && G[1]=='H'){
+        igs->paramDelim = G[2];
+        st = 3;
+    }
+    else{
+        igs->paramDelim = ',';
+        st = 0;
+    }
+    if (G[st+1]=='1' && G[st+2]=='H'){
+        igs->recordDelim = G[st+3];
+    }
+    else{
+        igs->recordDelim = ';';
+    }
+
+}
+
+
+/* Powers of ten that are exact in double */
+static const double igesPow10[23] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+
+static double igesParseNumber(const unsigned char *s, int len, double nan){
+    /* igesParseNumber converts an integer or real number (with exponent E or D) to double, returns nan if s is not a number */
+
+    /* igesParseNumber( s - pointer to characters, len - number of characters, nan - NaN) */
+
+    /* Numbers with at most 15 significant digits and a power of ten of at most 22 are converted with one
+     * multiplication or division of exact doubles, which is correctly rounded (Clinger's fast path), so
+     * the result is the same as from strtod. Other numbers are converted with strtod. */
+
+    int k, first, last, neg = 0, expNeg = 0, anyDigit = 0, numDigits = 0, fracDigits = 0, exp = 0, exp10;
+    double val;
+    char buf[64], *endptr;
+
+    for (first = 0; first < len && s[first]==' '; first++){
+    }
+    for (last = len-1; last >= first && s[last]==' '; last--){
+    }
+    if (first>last){
+        return nan;
+    }
+
+    k = first;
+    if (s[k]=='+' || s[k]=='-'){
+        neg = (s[k]=='-');
+        k++;
+    }
+    val = 0.0;
+    for (; k <= last && s[k]>='0' && s[k]<='9'; k++){
+        val = 10.0*val+(double)(s[k]-'0');
+        numDigits += (val>0.0);
+        anyDigit = 1;
+    }
+    if (k<=last && s[k]=='.'){
+        for (k++; k <= last && s[k]>='0' && s[k]<='9'; k++){
+            val = 10.0*val+(double)(s[k]-'0');
+            numDigits += (val>0.0);
+            fracDigits++;
+            anyDigit = 1;
+        }
+    }
+    if (anyDigit && k<last && (s[k]=='E' || s[k]=='e' || s[k]=='D' || s[k]=='d')){
+        k++;
+        if (s[k]=='+' || s[k]=='-'){
+            expNeg = (s[k]=='-');
+            k++;
+        }
+        if (k>last){
+            anyDigit = 0;
+        }
+        for (; k <= last && s[k]>='0' && s[k]<='9'; k++){
+            if (exp<10000){
+                exp = 10*exp+(s[k]-'0');
+            }
+        }
+    }
+    if (anyDigit && k>last && numDigits<=15){
+        exp10 = (expNeg ? -exp : exp)-fracDigits;
+        if (exp10>=-22 && exp10<=22){
+            val = (exp10<0) ? val/igesPow10[-exp10] : val*igesPow10[exp10];
+            return neg ? -val : val;
+        }
+    }
+
+    if (last-first+1>=(int)sizeof(buf)){
+        return nan;
+    }
+    for (k = first; k <= last; k++){
+        buf[k-first] = (s[k]=='D' || s[k]=='d') ? 'E' : (char)s[k];
+    }
+    buf[last-first+1] = '\0';
+    val = strtod(buf, &endptr);
+    if (*endptr!='\0'){
+        return nan;
+    }
+    return val;
+
+}
+
+
+static void igesDirectoryEntry(const igesFile *igs, int e, double *fields){
+    /* igesDirectoryEntry parses the 20 fields of the directory entry of entity e, NaN for empty or non-numeric fields */
+
+    /* igesDirectoryEntry( igs - pointer to IGES file, e - entity index (0-based), fields - pointer to fields (IGES_NUMDFIELDS)) */
+
+    int k, l;
+    const unsigned char *rec;
+
+    for (l = 0; l < 2; l++){
+        rec = igesRecord(igs, igs->firstD+2*e+l);
+        for (k = 0; k < 9; k++){
+            fields[10*l+k] = igesParseNumber(&rec[8*k], 8, igs->nan);
+        }
+        /* Sequence number after the section letter */
+        fields[10*l+9] = igesParseNumber(&rec[73], 7, igs->nan);
+    }
+
+}
+
+
+static int igesParameterRecords(const igesFile *igs, int e, int numEnt, int *first){
+    /* igesParameterRecords returns the number of P records of entity e and the index of the first one */
+
+    /* The parameter data of an entity ends where the parameter data of the next entity starts, as in the directory entry
+     * field 2 (pointer to the first P record), the last entity ends at the end of the P section */
+
+    /* igesParameterRecords( igs - pointer to IGES file, e - entity index (0-based), numEnt - number of entities, first - pointer to index of first P record) */
+
+    int last;
+    double ptr;
+
+    ptr = igesParseNumber(&igesRecord(igs, igs->firstD+2*e)[8], 8, igs->nan);
+    if (!(ptr>=1.0 && ptr<=(double)igs->numP)){
+        *first = igs->firstP;
+        return 0;
+    }
+    *first = igs->firstP+(int)ptr-1;
+
+    if (e==numEnt-1){
+        last = igs->firstP+igs->numP-1;
+    }
+    else{
+        ptr = igesParseNumber(&igesRecord(igs, igs->firstD+2*e+2)[8], 8, igs->nan);
+        last = (ptr>=1.0 && ptr<=(double)igs->numP) ? igs->firstP+(int)ptr-2 : igs->firstP+igs->numP-1;
+    }
+    return (last>=*first) ? last-*first+1 : 0;
+
+}
+
+
+static void igesParseParameters(const unsigned char *pstr, int len, unsigned char paramDelim, unsigned char recordDelim, double nan, double *val, int *numVal, char *str, int *strLen, int *numStr){
+    /* igesParseParameters splits parameter data into numbers and Hollerith strings */
+
+    /* igesParseParameters( pstr - pointer to parameter data (columns 1-64 of the P records), len - number of characters in pstr, paramDelim - parameter delimiter, recordDelim - record delimiter, nan - NaN, val - pointer to parameters, NaN for strings, 0 for empty parameters (len+1), numVal - pointer to number of parameters, str - pointer to concatenated strings (len), strLen - pointer to lengths of strings (len), numStr - pointer to number of strings) */
+
+    int pos = 0, start, n, k, strPos = 0, afterDelim = 0;
+
+    *numVal = 0;
+    *numStr = 0;
+    while (pos<len){
+        for (; pos < len && pstr[pos]==' '; pos++){
+        }
+        if (pos>=len || pstr[pos]==recordDelim){
+            if (afterDelim){
+                /* Empty last parameter, default value */
+                val[(*numVal)++] = 0.0;
+            }
+            break;
+        }
+        afterDelim = 1;
+        if (pstr[pos]==paramDelim){
+            /* Empty parameter, default value */
+            val[(*numVal)++] = 0.0;
+            pos++;
+            continue;
+        }
+
+        /* Hollerith string nHc...c, may contain the delimiters */
+        start = pos;
+        n = 0;
+        for (k = pos; k < len && pstr[k]>='0' && pstr[k]<='9' && n<len; k++){
+            n = 10*n+(pstr[k]-'0');
+        }
+        if (k>start && k<len && pstr[k]=='H'){
+            if (n>len-k-1){
+                n = len-k-1;
+            }
+            memcpy(&str[strPos], &pstr[k+1], n);
+            strPos += n;
+            strLen[(*numStr)++] = n;
+            val[(*numVal)++] = nan;
+            pos = k+1+n;
+        }
+        else{
+            for (; pos < len && pstr[pos]!=paramDelim && pstr[pos]!=recordDelim; pos++){
+            }
+            val[(*numVal)++] = igesParseNumber(&pstr[start], pos-start, nan);
+        }
+
+        for (; pos < len && pstr[pos]==' '; pos++){
+        }
+        afterDelim = 0;
+        if (pos<len && pstr[pos]==paramDelim){
+            afterDelim = 1;
+            pos++;
+        }
+        else if (pos<len && pstr[pos]!=recordDelim){
+            /* Missing delimiter, skip to the next one */
+            for (; pos < len && pstr[pos]!=paramDelim && pstr[pos]!=recordDelim; pos++){
+            }
+            if (pos<len && pstr[pos]==paramDelim){
+                afterDelim = 1;
+                pos++;
+            }
+        }
+    }
+
+}
+
+
+static int igesParseEntities(const igesFile *igs, int numEnt, igesEntity *ents, double *dirEntries, int numThreads){
+    /* igesParseEntities parses the directory entries and parameter data of all entities, returns 0 if out of memory */
+
+    /* If out of memory, some entities have NULL arrays, and the arrays of all entities must still be freed */
+
+    /* igesParseEntities( igs - pointer to IGES file, numEnt - number of entities, ents - pointer to entities (numEnt), the arrays in them are allocated with malloc, dirEntries - pointer to directory entry fields (IGES_NUMDFIELDS x numEnt), numThreads - number of threads) */
+
+    int failed = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads) if(numThreads>1)
+#endif
+    {
+        int e, r, first, numRecs, len, maxLen = 0, numVal, numStr;
+        unsigned char *pstr = NULL;
+        double *val = NULL;
+        char *str = NULL;
+        int *strLen = NULL;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+        for (e = 0; e < numEnt; e++){
+
+            ents[e].numVal = 0;
+            ents[e].val = NULL;
+            ents[e].numStr = 0;
+            ents[e].str = NULL;
+            ents[e].strLen = NULL;
+
+            igesDirectoryEntry(igs, e, &dirEntries[IGES_NUMDFIELDS*e]);
+
+            numRecs = igesParameterRecords(igs, e, numEnt, &first);
+            len = 64*numRecs;
+            if (len>maxLen){
+                maxLen = 2*len+64;
+                free(pstr);
+                free(val);
+                free(str);
+                free(strLen);
+                pstr = (unsigned char*) malloc(maxLen);
+                val = (double*) malloc((maxLen+1)*sizeof(double));
+                str = (char*) malloc(maxLen);
+                strLen = (int*) malloc(maxLen*sizeof(int));
+                if (pstr==NULL || val==NULL || str==NULL || strLen==NULL){
+                    maxLen = 0;
+                }
+            }
+            if (len>maxLen){
+                failed = 1;
+                continue;
+            }
+            for (r = 0; r < numRecs; r++){
+                memcpy(&pstr[64*r], igesRecord(igs, first+r), 64);
+            }
+
+            igesParseParameters(pstr, len, igs->paramDelim, igs->recordDelim, igs->nan, val, &numVal, str, strLen, &numStr);
+
+            ents[e].val = (double*) malloc((numVal>0 ? numVal : 1)*sizeof(double));
+            if (ents[e].val==NULL){
+                failed = 1;
+                continue;
+            }
+            ents[e].numVal = numVal;
+            memcpy(ents[e].val, val, numVal*sizeof(double));
+            if (numStr>0){
+                len = 0;
+                for (r = 0; r < numStr; r++){
+                    len += strLen[r];
+                }
+                ents[e].strLen = (int*) malloc(numStr*sizeof(int));
+                ents[e].str = (char*) malloc(len>0 ? len : 1);
+                if (ents[e].strLen==NULL || ents[e].str==NULL){
+                    failed = 1;
+                    continue;
+                }
+                ents[e].numStr = numStr;
+                memcpy(ents[e].strLen, strLen, numStr*sizeof(int));
+                memcpy(ents[e].str, str, len);
+            }
+
+        }
+
+        free(pstr);
+        free(val);
+        free(str);
+        free(strLen);
+    }
+
+    return !failed;
+
+}
@@ -0,0 +1,503 @@
+/* Arc length tables of NURBS curves, for evaluation at given arc lengths */
+
+/* An arc length table (output from nrbArcLengthIGES) is a double row vector:
+ *
+ *   [0]  magic number NRB_ARCLEN_MAGIC
+ *   [1]  version (1)
+ *   [2]  number of rows, numRows
+ *   [3]  length of the curve
+ *   [4, 5]  first and last parameter value t0, t1 of the table, inside the parameter interval of the curve
+ *   [6, 7]  unused (0)
+ *
+ * followed by numRows rows of NRB_ARCLENROW doubles
+ *
+ *   t, s, v at t, v at the t of the next row, dv/dt at t, dv/dt at the t of the next row
+ *
+ * where s is the arc length from the start of the curve to the parameter value t and the speed v is the
+ * length of the first derivative inside the interval to the next row. The rows split every nonempty knot
+ * span into intervals where the NRB_GAUSS point Gauss-Legendre rule gives the length with a relative error
+ * of at most NRB_ARCLENTOL, so the length between a row and any parameter value before the next row is also
+ * given by the Gauss-Legendre rule. The first row starts at (t0, 0) and the last at (t1, length), the speeds
+ * of the last row are 0.
+ *
+ * The parameter value at an arc length is first estimated by quintic Hermite interpolation of t(s) between
+ * two rows, with dt/ds=1/v and d2t/ds2=-(dv/dt)/v^3, and then corrected with Newton's method. */
+
+/* nrbArcLength needs nrbCompiled and nrbDersEval */
+
+#define NRB_ARCLEN_MAGIC 1095912268.0
+#define NRB_ARCLENHEADER 8
+#define NRB_ARCLENROW 6
+#define NRB_ARCLENTOL 1e-11
+#define NRB_ARCLENDEPTH 24
+#define NRB_ARCLENITER 30
+#define NRB_GAUSS 5
+
+/* Number of arc lengths of one curve evaluated together by a thread */
+#define NRB_ARCLENCHUNK 64
+
+static const double nrbGaussNode[NRB_GAUSS] = {-0.9061798459386640, -0.5384693101056831, 0.0, 0.5384693101056831, 0.9061798459386640};
+static const double nrbGaussWeight[NRB_GAUSS] = {0.2369268850561891, 0.4786286704993665, 0.5688888888888889, 0.4786286704993665, 0.2369268850561891};
+
+typedef struct {
+    int numRows;            /* number of rows in row */
+    double length;          /* length of the curve */
+    double t0, t1;          /* parameter interval of the curve */
+    double *row;            /* NRB_ARCLENROW x numRows */
+} nrbArcLengthTable;
+
+typedef struct {
+    double *row;            /* NRB_ARCLENROW x rowCap, rows of the table */
+    int numRows, rowCap;
+    int failed;             /* 1 if out of memory, then the rows are not complete */
+    const nrbCompiled *nrb; /* curve of the table */
+    nrbScratch *scr;        /* arrays from nrbScratchInit */
+} nrbArcLengthRows;
+
+
+static int nrbIsArcLength(const mxArray *arr){
+    /* nrbIsArcLength returns 1 if arr is an arc length table (output from nrbArcLengthIGES) */
+
+    if (arr==NULL || !mxIsDouble(arr) || mxGetNumberOfElements(arr)<NRB_ARCLENHEADER){
+        return 0;
+    }
+    return mxGetPr(arr)[0]==NRB_ARCLEN_MAGIC;
+
+}
+
+
+static void nrbArcLengthFromArray(const mxArray *arr, nrbArcLengthTable *tab){
+    /* nrbArcLengthFromArray sets up tab pointing into an arc length table (output from nrbArcLengthIGES) */
+
+    double *hdr = mxGetPr(arr);
+    mwSize len = mxGetNumberOfElements(arr);
+
+    if (hdr[1]!=1.0){
+        mexErrMsgTxt("Unknown version of arc length table, run nrbArcLengthIGES again.");
+    }
+    tab->numRows = (int)hdr[2];
+    tab->length = hdr[3];
+    tab->t0 = hdr[4];
+    tab->t1 = hdr[5];
+    if (tab->numRows<2 || len!=(mwSize)NRB_ARCLENHEADER+(mwSize)NRB_ARCLENROW*tab->numRows){
+        mexErrMsgTxt("Corrupt arc length table.");
+    }
+    tab->row = hdr+NRB_ARCLENHEADER;
+
+}
+
+
+static void nrbArcLengthSpeed(const nrbCompiled *nrb, double *ts, int num, double *speed, double *accel, nrbScratch *scr){
+    /* nrbArcLengthSpeed evaluates the length of the first derivative of a curve, and optionally its derivative */
+
+    /* nrbArcLengthSpeed( nrb - pointer to compiled NURBS curve, ts - pointer to parameter values, num - number of parameter values (at most NRB_GAUSS+1), speed - pointer to lengths of the derivatives (num), accel - pointer to derivatives of speed (num) or NULL, scr - pointer to arrays from nrbScratchInit) */
+
+    int k;
+    double P[3*(NRB_GAUSS+1)], Pu[3*(NRB_GAUSS+1)], Puu[3*(NRB_GAUSS+1)], *out[3];
+
+    out[0] = P;
+    out[1] = Pu;
+    out[2] = Puu;
+    nrbDersEval(nrb, (accel!=NULL) ? 2 : 1, ts, num, out, (accel!=NULL) ? 3 : 2, scr);
+    for (k = 0; k < num; k++){
+        speed[k] = sqrt(Pu[3*k]*Pu[3*k]+Pu[3*k+1]*Pu[3*k+1]+Pu[3*k+2]*Pu[3*k+2]);
+        if (accel!=NULL){
+            accel[k] = (speed[k]>0.0) ? (Pu[3*k]*Puu[3*k]+Pu[3*k+1]*Puu[3*k+1]+Pu[3*k+2]*Puu[3*k+2])/speed[k] : 0.0;
+        }
+    }
+
+}
+
+
+static double nrbArcLengthGauss(const nrbCompiled *nrb, double a, double b, nrbScratch *scr){
+    /* nrbArcLengthGauss returns the Gauss-Legendre approximation of the length of a curve between a and b */
+
+    int k;
+    double ts[NRB_GAUSS], speed[NRB_GAUSS], len = 0.0;
+
+    for (k = 0; k < NRB_GAUSS; k++){
+        ts[k] = 0.5*(a+b)+0.5*(b-a)*nrbGaussNode[k];
+    }
+    nrbArcLengthSpeed(nrb, ts, NRB_GAUSS, speed, NULL, scr);
+    for (k = 0; k < NRB_GAUSS; k++){
+        len += nrbGaussWeight[k]*speed[k];
+    }
+    return 0.5*(b-a)*len;
+
+}
+
+
+static void nrbArcLengthAddRow(nrbArcLengthRows *rows, double t, double s){
+    /* nrbArcLengthAddRow appends the row (t, s, 0, 0), or sets rows->failed if out of memory */
+
+    int k, rowCap;
+    double *row;
+
+    if (rows->failed){
+        return;
+    }
+    if (rows->numRows==rows->rowCap){
+        rowCap = 2*rows->rowCap+64;
+        row = (double*) realloc(rows->row, rowCap*NRB_ARCLENROW*sizeof(double));
+        if (row==NULL){
+            rows->failed = 1;
+            return;
+        }
+        rows->row = row;
+        rows->rowCap = rowCap;
+    }
+    rows->row[NRB_ARCLENROW*rows->numRows] = t;
+    rows->row[NRB_ARCLENROW*rows->numRows+1] = s;
+    for (k = 2; k < NRB_ARCLENROW; k++){
+        rows->row[NRB_ARCLENROW*rows->numRows+k] = 0.0;
+    }
+    rows->numRows++;
+
+}
+
+
+static double nrbArcLengthInterval(nrbArcLengthRows *rows, double a, double b, double whole, double s, int depth){
+    /* nrbArcLengthInterval sets the speeds of the last row at a and adds the rows after a of the interval [a, b] with the length whole, returns the arc length at b */
+
+    /* nrbArcLengthInterval( rows - pointer to rows, a, b - parameter interval, whole - Gauss-Legendre length of [a, b], s - arc length at a, depth - number of splits of the knot span) */
+
+    double m = 0.5*(a+b), left, right, ts[2], *row;
+
+    if (rows->failed){
+        return s;
+    }
+
+    left = nrbArcLengthGauss(rows->nrb, a, m, rows->scr);
+    right = nrbArcLengthGauss(rows->nrb, m, b, rows->scr);
+
+    if (fabs(left+right-whole)>NRB_ARCLENTOL*(left+right) && depth<NRB_ARCLENDEPTH && m>a && m<b){
+        s = nrbArcLengthInterval(rows, a, m, left, s, depth+1);
+        return nrbArcLengthInterval(rows, m, b, right, s, depth+1);
+    }
+
+    /* The speeds inside the knot span, a and b may be knots where the derivative jumps */
+    row = &rows->row[NRB_ARCLENROW*(rows->numRows-1)];
+    ts[0] = a+1e-12*(b-a);
+    ts[1] = b-1e-12*(b-a);
+    nrbArcLengthSpeed(rows->nrb, ts, 2, row+2, row+4, rows->scr);
+
+    s += left+right;
+    nrbArcLengthAddRow(rows, b, s);
+    return s;
+
+}
+
+
+static void nrbArcLengthBuild(const nrbCompiled *nrb, double t0, double t1, nrbArcLengthRows *rows){
+    /* nrbArcLengthBuild computes the rows of the arc length table of a curve between t0 and t1, rows->row is allocated with malloc, rows->failed is set if out of memory */
+
+    /* nrbArcLengthBuild( nrb - pointer to compiled NURBS curve, t0, t1 - parameter interval, clamped to the parameter interval of the curve, rows - pointer to rows (output)) */
+
+    int i;
+    const nrbNet *net = &nrb->net[0];
+    double s = 0.0, a, b;
+    nrbScratch scr;
+
+    rows->row = NULL;
+    rows->numRows = 0;
+    rows->rowCap = 0;
+    rows->failed = 0;
+    rows->nrb = nrb;
+    rows->scr = &scr;
+    if (!nrbScratchInit(&scr, net->orderU, 0)){
+        rows->failed = 1;
+        nrbScratchFree(&scr);
+        return;
+    }
+    t0 = (t0>net->knotU[net->orderU-1]) ? t0 : net->knotU[net->orderU-1];
+    t0 = (t0<net->knotU[net->ncp]) ? t0 : net->knotU[net->ncp];
+    t1 = (t1<net->knotU[net->ncp]) ? t1 : net->knotU[net->ncp];
+    t1 = (t1>t0) ? t1 : t0;
+
+    nrbArcLengthAddRow(rows, t0, 0.0);
+    for (i = net->orderU-1; i < net->ncp; i++){
+        a = (net->knotU[i]>t0) ? net->knotU[i] : t0;
+        b = (net->knotU[i+1]<t1) ? net->knotU[i+1] : t1;
+        if (b>a){
+            s = nrbArcLengthInterval(rows, a, b, nrbArcLengthGauss(nrb, a, b, &scr), s, 0);
+        }
+    }
+    if (rows->numRows<2){
+        /* Empty parameter interval */
+        nrbArcLengthAddRow(rows, t1, 0.0);
+    }
+    rows->scr = NULL;
+
+    nrbScratchFree(&scr);
+
+}
+
+
+static mxArray *nrbArcLengthToArray(const nrbArcLengthRows *rows){
+    /* nrbArcLengthToArray returns the arc length table of rows as a Matlab array */
+
+    mxArray *arr;
+    double *hdr;
+
+    arr = mxCreateDoubleMatrix(1, NRB_ARCLENHEADER+NRB_ARCLENROW*rows->numRows, mxREAL);
+    hdr = mxGetPr(arr);
+    hdr[0] = NRB_ARCLEN_MAGIC;
+    hdr[1] = 1.0;
+    hdr[2] = (double)rows->numRows;
+    hdr[3] = rows->row[NRB_ARCLENROW*(rows->numRows-1)+1];
+    hdr[4] = rows->row[0];
+    hdr[5] = rows->row[NRB_ARCLENROW*(rows->numRows-1)];
+    memcpy(hdr+NRB_ARCLENHEADER, rows->row, NRB_ARCLENROW*rows->numRows*sizeof(double));
+    return arr;
+
+}
+
+
+static double nrbArcLengthParam(const nrbCompiled *nrb, const nrbArcLengthTable *tab, double s, int *hint, double *P, double *Pu, nrbScratch *scr){
+    /* nrbArcLengthParam returns the parameter value at the arc length s and evaluates the curve there, s is clamped to [0, length] */
+
+    /* nrbArcLengthParam( nrb - pointer to compiled NURBS curve, tab - pointer to arc length table of the curve, s - arc length, hint - pointer to row of a previous arc length, updated, P - pointer to point (3), Pu - pointer to first derivative (3), scr - pointer to arrays from nrbScratchInit) */
+
+    int k, lo, hi, mid, iter;
+    double *row, t, ta, tb, t0, sa, ds, h, x, m0, m1, c0, c1, f, speed, curv, tol, ts[NRB_GAUSS+1], Ps[3*(NRB_GAUSS+1)], Pus[3*(NRB_GAUSS+1)], *out[2];
+
+    out[0] = Ps;
+    out[1] = Pus;
+
+    if (s<=0.0 || s>=tab->length){
+        t = (s<=0.0) ? tab->t0 : tab->t1;
+        out[0] = P;
+        out[1] = Pu;
+        nrbDersEval(nrb, 1, &t, 1, out, 2, scr);
+        return t;
+    }
+
+    /* Row with s in [row[lo].s, row[lo+1].s], the row of the previous arc length is tried first */
+    row = tab->row;
+    lo = *hint;
+    if (lo<0 || lo>=tab->numRows-1 || !(row[NRB_ARCLENROW*lo+1]<=s && s<=row[NRB_ARCLENROW*(lo+1)+1])){
+        lo = 0;
+        hi = tab->numRows-1;
+        while (hi-lo>1){
+            mid = (lo+hi)/2;
+            if (row[NRB_ARCLENROW*mid+1]<=s){
+                lo = mid;
+            }
+            else{
+                hi = mid;
+            }
+        }
+    }
+    *hint = lo;
+    row = &tab->row[NRB_ARCLENROW*lo];
+
+    t0 = row[0];
+    ta = row[0];
+    tb = row[NRB_ARCLENROW];
+    sa = row[1];
+    ds = row[NRB_ARCLENROW+1]-sa;
+
+    /* Quintic Hermite interpolation of t(s), in units where the interval is [0, 1] in both s and t */
+    h = tb-ta;
+    x = (ds>0.0) ? (s-sa)/ds : 0.0;
+    if (row[2]>0.0 && row[3]>0.0){
+        m0 = ds/(h*row[2]);
+        m1 = ds/(h*row[3]);
+        c0 = -ds*ds*row[4]/(h*row[2]*row[2]*row[2]);
+        c1 = -ds*ds*row[5]/(h*row[3]*row[3]*row[3]);
+        t = x*x*x*(10.0+x*(-15.0+6.0*x))+m0*x*(1.0+x*x*(-6.0+x*(8.0-3.0*x)))+m1*x*x*x*(-4.0+x*(7.0-3.0*x))+c0*x*x*(0.5+x*(-1.5+x*(1.5-0.5*x)))+c1*x*x*x*(0.5+x*(-1.0+0.5*x));
+        t = (t>0.0 && t<1.0) ? ta+t*h : ta+x*h;
+        /* |dv/dt|/v^2 at the rows, for the error after a Newton step */
+        curv = fabs(row[4])/(row[2]*row[2]);
+        curv = (fabs(row[5])/(row[3]*row[3])>curv) ? fabs(row[5])/(row[3]*row[3]) : curv;
+    }
+    else{
+        t = ta+x*h;
+        curv = HUGE_VAL;
+    }
+
+    /* Newton's method for s(t)=s in [ta, tb], with bisection when a step leaves the bracket. The
+     * step is not checked if twice the error after it, about curv*f^2/2, is below the tolerance. */
+    tol = NRB_ARCLENTOL*tab->length;
+    for (iter = 0; iter < NRB_ARCLENITER; iter++){
+        for (k = 0; k < NRB_GAUSS; k++){
+            ts[k] = 0.5*(t0+t)+0.5*(t-t0)*nrbGaussNode[k];
+        }
+        ts[NRB_GAUSS] = t;
+        nrbDersEval(nrb, 1, ts, NRB_GAUSS+1, out, 2, scr);
+        f = 0.0;
+        for (k = 0; k < NRB_GAUSS; k++){
+            f += nrbGaussWeight[k]*sqrt(Pus[3*k]*Pus[3*k]+Pus[3*k+1]*Pus[3*k+1]+Pus[3*k+2]*Pus[3*k+2]);
+        }
+        f = sa+0.5*(t-t0)*f-s;
+        if (fabs(f)<=tol){
+            break;
+        }
+        if (f>0.0){
+            tb = t;
+        }
+        else{
+            ta = t;
+        }
+        speed = sqrt(Pus[3*NRB_GAUSS]*Pus[3*NRB_GAUSS]+Pus[3*NRB_GAUSS+1]*Pus[3*NRB_GAUSS+1]+Pus[3*NRB_GAUSS+2]*Pus[3*NRB_GAUSS+2]);
+        t = (speed>0.0) ? t-f/speed : ta;
+        if (!(t>ta && t<tb)){
+            t = 0.5*(ta+tb);
+        }
+        else if (curv*f*f<=tol){
+            iter = NRB_ARCLENITER;
+            break;
+        }
+    }
+    if (iter==NRB_ARCLENITER){
+        ts[NRB_GAUSS] = t;
+        nrbDersEval(nrb, 1, ts+NRB_GAUSS, 1, out, 2, scr);
+        for (k = 0; k < 3; k++){
+            Ps[3*NRB_GAUSS+k] = Ps[k];
+            Pus[3*NRB_GAUSS+k] = Pus[k];
+        }
+    }
+
+    for (k = 0; k < 3; k++){
+        P[k] = Ps[3*NRB_GAUSS+k];
+        Pu[k] = Pus[3*NRB_GAUSS+k];
+    }
+    return t;
+
+}
+
+
+static void nrbArcLengthEval(const nrbCompiled *nrb, const nrbArcLengthTable *tab, double *s, int num, double *P, double *ts, double *T, int *hint, nrbScratch *scr){
+    /* nrbArcLengthEval evaluates a curve and its unit tangent at given arc lengths */
+
+    /* nrbArcLengthEval( nrb - pointer to compiled NURBS curve, tab - pointer to arc length table of the curve, s - pointer to arc lengths, num - number of arc lengths, P - pointer to points (3 x num), ts - pointer to parameter values (num), T - pointer to unit tangents (3 x num) or NULL, hint - pointer to row of a previous arc length, updated, scr - pointer to arrays from nrbScratchInit) */
+
+    int k;
+    double Pu[3], len;
+
+    for (k = 0; k < num; k++){
+        ts[k] = nrbArcLengthParam(nrb, tab, s[k], hint, P+3*k, Pu, scr);
+        if (T!=NULL){
+            len = sqrt(Pu[0]*Pu[0]+Pu[1]*Pu[1]+Pu[2]*Pu[2]);
+            len = (len>0.0) ? 1.0/len : 0.0;
+            T[3*k] = Pu[0]*len;
+            T[3*k+1] = Pu[1]*len;
+            T[3*k+2] = Pu[2]*len;
+        }
+    }
+
+}
+
+
+static void nrbArcLengthBuildBatch(const nrbCompiled *crvs, int numCrvs, const double *range, nrbArcLengthRows *rows, int numThreads){
+    /* nrbArcLengthBuildBatch computes the rows of the arc length tables of many curves, in parallel if compiled with OpenMP, rows[k].failed is set if out of memory */
+
+    /* nrbArcLengthBuildBatch( crvs - pointer to compiled NURBS curves (numCrvs), numCrvs - number of curves, range - pointer to parameter intervals (2 x numCrvs) or NULL for the whole curves, rows - pointer to rows (numCrvs) (output), numThreads - number of threads) */
+
+    int k;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(numThreads) if(numThreads>1) schedule(dynamic, 1)
+#endif
+    for (k = 0; k < numCrvs; k++){
+        nrbArcLengthBuild(&crvs[k], (range!=NULL) ? range[2*k] : -HUGE_VAL, (range!=NULL) ? range[2*k+1] : HUGE_VAL, &rows[k]);
+    }
+
+}
+
+
+static int nrbArcLengthEvalBatch(const nrbCompiled *nrb, const nrbArcLengthTable *tab, double *s, int numPnts, double *P, double *ts, double *T, int numThreads){
+    /* nrbArcLengthEvalBatch evaluates a curve at many arc lengths in chunks of NRB_ARCLENCHUNK, in parallel if compiled with OpenMP, returns 0 if out of memory */
+
+    /* nrbArcLengthEvalBatch( nrb - pointer to compiled NURBS curve, tab - pointer to arc length table of the curve, s - pointer to arc lengths, numPnts - number of arc lengths, P - pointer to points (3 x numPnts), ts - pointer to parameter values (numPnts), T - pointer to unit tangents (3 x numPnts) or NULL, numThreads - number of threads) */
+
+    int failed = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads) if(numThreads>1)
+#endif
+    {
+        int i, num, hint = 0, ok;
+        nrbScratch scr;
+
+        ok = nrbScratchInit(&scr, nrb->net[0].orderU, 0);
+        if (!ok){
+            failed = 1;
+        }
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+        for (i = 0; i < numPnts; i += NRB_ARCLENCHUNK){
+            if (!ok){
+                continue;
+            }
+            num = (numPnts-i<NRB_ARCLENCHUNK) ? numPnts-i : NRB_ARCLENCHUNK;
+            nrbArcLengthEval(nrb, tab, s+i, num, P+3*i, ts+i, (T!=NULL) ? T+3*i : NULL, &hint, &scr);
+        }
+
+        nrbScratchFree(&scr);
+    }
+
+    return !failed;
+
+}
+
+
+static int nrbArcLengthEvalCurves(const nrbCompiled *crvs, const nrbArcLengthTable *tabs, int numCrvs, int *numS, double **sPtr, double **outPtr, int numThreads){
+    /* nrbArcLengthEvalCurves evaluates many curves at given or uniformly spaced arc lengths, in parallel over the curves if compiled with OpenMP, returns 0 if out of memory */
+
+    /* nrbArcLengthEvalCurves( crvs - pointer to compiled NURBS curves (numCrvs), tabs - pointer to arc length tables of the curves (numCrvs), numCrvs - number of curves, numS - pointer to numbers of arc lengths (numCrvs), sPtr - pointer to pointers to arc lengths, NULL for numS[k] uniformly spaced arc lengths (numCrvs), outPtr - pointer to pointers to points, parameter values and unit tangents, the last two may be NULL (3 x numCrvs), numThreads - number of threads) */
+
+    int failed = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads) if(numThreads>1)
+#endif
+    {
+        int i, j, hint, sCap = 0;
+        double *sUniform = NULL, *tBuffer = NULL, *sj;
+        nrbScratch scr;
+
+        nrbScratchInit(&scr, 0, 0);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+        for (i = 0; i < numCrvs; i++){
+            if (numS[i]>sCap){
+                free(sUniform);
+                free(tBuffer);
+                sUniform = (double*) malloc(numS[i]*sizeof(double));
+                tBuffer = (double*) malloc(numS[i]*sizeof(double));
+                if (sUniform==NULL || tBuffer==NULL){
+                    sCap = 0;
+                    failed = 1;
+                    continue;
+                }
+                sCap = numS[i];
+            }
+            sj = sPtr[i];
+            if (sj==NULL){
+                for (j = 0; j < numS[i]; j++){
+                    sUniform[j] = (numS[i]>1) ? tabs[i].length*j/(numS[i]-1) : 0.0;
+                }
+                sj = sUniform;
+            }
+            nrbScratchFree(&scr);
+            if (!nrbScratchInit(&scr, crvs[i].net[0].orderU, 0)){
+                failed = 1;
+                continue;
+            }
+            hint = 0;
+            nrbArcLengthEval(&crvs[i], &tabs[i], sj, numS[i], outPtr[3*i], (outPtr[3*i+1]!=NULL) ? outPtr[3*i+1] : tBuffer, outPtr[3*i+2], &hint, &scr);
+        }
+
+        nrbScratchFree(&scr);
+        free(sUniform);
+        free(tBuffer);
+    }
+
+    return !failed;
+
+}
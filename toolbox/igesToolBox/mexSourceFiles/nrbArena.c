@@ -0,0 +1,97 @@
+/* Work arrays kept between calls of a mex function, one slot per thread */
+
+/* Work arrays that would otherwise be allocated and freed in every call are taken from slots that only grow, and are
+ * freed when the mex function is cleared (mexAtExit). A slot is made large enough with nrbArenaReserve outside of
+ * parallel regions, and is then used by one thread only, so no locking is needed. Slot 0 is used for arrays shared
+ * by all threads, slot 1+t by thread t. */
+
+/* nrbArena registers its own exit function, the mex function must not call mexAtExit */
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+typedef struct {
+    void *mem;              /* memory of the slot, NULL if empty */
+    size_t size;            /* size of mem in bytes */
+} nrbArenaSlot;
+
+static nrbArenaSlot *nrbArenaSlots = NULL;
+static int nrbArenaNumSlots = 0;
+
+
+static void nrbArenaFree(void){
+    /* nrbArenaFree frees all slots, called when the mex function is cleared */
+
+    int k;
+
+    for (k = 0; k < nrbArenaNumSlots; k++){
+        free(nrbArenaSlots[k].mem);
+    }
+    free(nrbArenaSlots);
+    nrbArenaSlots = NULL;
+    nrbArenaNumSlots = 0;
+
+}
+
+
+static void *nrbArenaReserve(int slot, size_t size){
+    /* nrbArenaReserve makes slot at least size bytes and returns its memory, must not be called in a parallel region */
+
+    /* nrbArenaReserve( slot - slot index, size - number of bytes) */
+
+    int k;
+    nrbArenaSlot *slots;
+
+    if (slot>=nrbArenaNumSlots){
+        slots = (nrbArenaSlot*) realloc(nrbArenaSlots, (slot+1)*sizeof(nrbArenaSlot));
+        if (slots==NULL){
+            mexErrMsgTxt("Out of memory.");
+        }
+        if (nrbArenaSlots==NULL){
+            mexAtExit(nrbArenaFree);
+        }
+        for (k = nrbArenaNumSlots; k <= slot; k++){
+            slots[k].mem = NULL;
+            slots[k].size = 0;
+        }
+        nrbArenaSlots = slots;
+        nrbArenaNumSlots = slot+1;
+    }
+
+    if (size>nrbArenaSlots[slot].size){
+        free(nrbArenaSlots[slot].mem);
+        nrbArenaSlots[slot].mem = malloc(size);
+        nrbArenaSlots[slot].size = (nrbArenaSlots[slot].mem!=NULL) ? size : 0;
+        if (nrbArenaSlots[slot].mem==NULL){
+            mexErrMsgTxt("Out of memory.");
+        }
+    }
+
+    return nrbArenaSlots[slot].mem;
+
+}
+
+
+static void nrbArenaReserveThreads(int numThreads, size_t size){
+    /* nrbArenaReserveThreads makes the slots of threads 0, ..., numThreads-1 at least size bytes */
+
+    int t;
+
+    for (t = 0; t < numThreads; t++){
+        nrbArenaReserve(1+t, size);
+    }
+
+}
+
+
+static void *nrbArenaThread(void){
+    /* nrbArenaThread returns the memory of the slot of the calling thread, reserved with nrbArenaReserveThreads */
+
+#ifdef _OPENMP
+    return nrbArenaSlots[1+omp_get_thread_num()].mem;
+#else
+    return nrbArenaSlots[1].mem;
+#endif
+
+}
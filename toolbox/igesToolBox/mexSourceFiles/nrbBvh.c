@@ -0,0 +1,349 @@
+
+/* Bounding volume hierarchy over the knot span sub-patches of NURBS surfaces */
+
+/* A BVH (output from nrbBvhIGES) is a double row vector:
+ *
+ *   [0]  magic number NRB_BVH_MAGIC
+ *   [1]  version (1)
+ *   [2]  number of surfaces, numSrfs
+ *   [3]  number of nodes, numNodes
+ *   [4]  number of sub-patches, numPatches
+ *   [5, 6, 7]  unused (0)
+ *
+ * followed by numNodes nodes of NRB_BVHNODE doubles
+ *
+ *   xmin, ymin, zmin, xmax, ymax, zmax, first, count
+ *
+ * where count>0 for a leaf with the sub-patches first, ..., first+count-1 and count=0 for an inner node with the
+ * children node+1 and node first (0-based indices), and numPatches sub-patches of NRB_BVHPATCH doubles
+ *
+ *   surface index (1-based), and NRB_BVHGRID x NRB_BVHGRID samples u, v, x, y, z
+ *
+ * A sub-patch is the part of a surface over one nonempty pair of knot spans. Its box is the box of the
+ * (degU+1) x (degV+1) control points of the spans, which contains the sub-patch if the weights are positive
+ * (convex hull property). The nodes are split at the median of the sub-patch centres along the longest axis. */
+
+/* nrbBvh needs nrbCompiled and nrbNetEval2 */
+
+#define NRB_BVH_MAGIC 1112954446.0
+#define NRB_BVHHEADER 8
+#define NRB_BVHNODE 8
+#define NRB_BVHGRID 3
+#define NRB_BVHPATCH (1+5*NRB_BVHGRID*NRB_BVHGRID)
+#define NRB_BVHLEAFSIZE 4
+#define NRB_BVHSTACK 64
+#define NRB_BVHCANDIDATES 4
+
+typedef struct {
+    int numSrfs;            /* number of surfaces */
+    int numNodes;           /* number of nodes in node */
+    int numPatches;         /* number of sub-patches in patch */
+    double *node;           /* NRB_BVHNODE x numNodes */
+    double *patch;          /* NRB_BVHPATCH x numPatches */
+} nrbBvh;
+
+typedef struct {
+    double box[6];          /* xmin, ymin, zmin, xmax, ymax, zmax */
+    double key;             /* coordinate of the centre of box used for sorting */
+    int index;              /* sub-patch index before sorting */
+} nrbBvhItem;
+
+
+static int nrbIsBvh(const mxArray *arr){
+    /* nrbIsBvh returns 1 if arr is a BVH (output from nrbBvhIGES) */
+
+    if (arr==NULL || !mxIsDouble(arr) || mxGetNumberOfElements(arr)<NRB_BVHHEADER){
+        return 0;
+    }
+    return mxGetPr(arr)[0]==NRB_BVH_MAGIC;
+
+}
+
+
+static void nrbBvhFromArray(const mxArray *arr, nrbBvh *bvh){
+    /* nrbBvhFromArray sets up bvh pointing into a BVH (output from nrbBvhIGES) */
+
+    double *hdr = mxGetPr(arr);
+    mwSize len = mxGetNumberOfElements(arr);
+
+    if (hdr[1]!=1.0){
+        mexErrMsgTxt("Unknown version of BVH, run nrbBvhIGES again.");
+    }
+    bvh->numSrfs = (int)hdr[2];
+    bvh->numNodes = (int)hdr[3];
+    bvh->numPatches = (int)hdr[4];
+    if (bvh->numSrfs<1 || bvh->numNodes<1 || bvh->numPatches<1 || len!=(mwSize)NRB_BVHHEADER+(mwSize)NRB_BVHNODE*bvh->numNodes+(mwSize)NRB_BVHPATCH*bvh->numPatches){
+        mexErrMsgTxt("Corrupt BVH.");
+    }
+    bvh->node = hdr+NRB_BVHHEADER;
+    bvh->patch = bvh->node+(mwSize)NRB_BVHNODE*bvh->numNodes;
+
+}
+
+
+static nrbCompiled *nrbSurfacesFromCell(const mxArray *srfcell, int *numSrfs){
+    /* nrbSurfacesFromCell sets up the compiled NURBS of the surfaces in a cell array, returns an array freed with mxFree */
+
+    /* nrbSurfacesFromCell( srfcell - cell array of NURBS surfaces or compiled NURBS surfaces, numSrfs - pointer to number of surfaces) */
+
+    int k;
+    mxArray *srf;
+    nrbCompiled *srfs;
+
+    if (!mxIsCell(srfcell)){
+        mexErrMsgTxt("srfs must be a cell array.");
+    }
+    *numSrfs = (int)mxGetNumberOfElements(srfcell);
+    if (*numSrfs<1){
+        mexErrMsgTxt("srfs must contain at least one surface.");
+    }
+    srfs = (nrbCompiled*) mxMalloc((*numSrfs)*sizeof(nrbCompiled));
+    for (k = 0; k < *numSrfs; k++){
+        srf = mxGetCell(srfcell, k);
+        if (nrbIsCompiled(srf)){
+            nrbCompiledFromArray(srf, &srfs[k]);
+        }
+        else if (srf!=NULL && mxIsStruct(srf) && mxGetField(srf, 0, "coefs")!=NULL && mxGetNumberOfElements(mxGetField(srf, 0, "order"))==2){
+            if (mxGetM(mxGetField(srf, 0, "coefs"))!=4){
+                mexErrMsgTxt("nurbs.coefs must have 4 rows.");
+            }
+            nrbCompiledFromStruct(srf, NULL, NULL, 2, &srfs[k]);
+        }
+        else{
+            mexErrMsgTxt("Every element of srfs must be a NURBS surface or a compiled NURBS surface.");
+        }
+        if (srfs[k].numDirs!=2){
+            mexErrMsgTxt("Every element of srfs must be a NURBS surface or a compiled NURBS surface.");
+        }
+    }
+    return srfs;
+
+}
+
+
+static int nrbBvhNumPatches(const nrbNet *net){
+    /* nrbBvhNumPatches returns the number of nonempty pairs of knot spans of a surface net */
+
+    int i, numU = 0, numV = 0;
+
+    for (i = net->orderU-1; i < net->ncp; i++){
+        if (net->knotU[i]<net->knotU[i+1]){
+            numU++;
+        }
+    }
+    for (i = net->orderV-1; i < net->kcp; i++){
+        if (net->knotV[i]<net->knotV[i+1]){
+            numV++;
+        }
+    }
+    return numU*numV;
+
+}
+
+
+static int nrbBvhPatches(const nrbNet *net, int srfIndex, nrbBvhItem *items, double *patch, nrbScratch *scr){
+    /* nrbBvhPatches computes the boxes and samples of the sub-patches of a surface net, returns the number of sub-patches */
+
+    /* nrbBvhPatches( net - pointer to surface net, srfIndex - surface index (1-based), items - pointer to boxes of sub-patches, patch - pointer to sub-patches (NRB_BVHPATCH x number of sub-patches), scr - pointer to arrays for function BasisFuns) */
+
+    int i, j, k, l, m, num = 0, degU = net->orderU-1, degV = net->orderV-1;
+    double *cp, *pp, x, uv[2*NRB_BVHGRID*NRB_BVHGRID], bspPnts[4*NRB_BVHGRID*NRB_BVHGRID];
+
+    for (j = degV; j < net->kcp; j++){
+        if (!(net->knotV[j]<net->knotV[j+1])){
+            continue;
+        }
+        for (i = degU; i < net->ncp; i++){
+            if (!(net->knotU[i]<net->knotU[i+1])){
+                continue;
+            }
+
+            /* Box of the control points of the spans */
+            for (m = 0; m < 3; m++){
+                items[num].box[m] = HUGE_VAL;
+                items[num].box[m+3] = -HUGE_VAL;
+            }
+            for (k = j-degV; k <= j; k++){
+                for (l = i-degU; l <= i; l++){
+                    cp = &net->coefs[4*(k*net->ncp+l)];
+                    for (m = 0; m < 3; m++){
+                        x = cp[m]/cp[3];
+                        if (x<items[num].box[m]){
+                            items[num].box[m] = x;
+                        }
+                        if (x>items[num].box[m+3]){
+                            items[num].box[m+3] = x;
+                        }
+                    }
+                }
+            }
+
+            /* Samples at the centres of a NRB_BVHGRID x NRB_BVHGRID grid over the spans */
+            for (k = 0; k < NRB_BVHGRID; k++){
+                for (l = 0; l < NRB_BVHGRID; l++){
+                    uv[2*(k*NRB_BVHGRID+l)] = net->knotU[i]+(l+0.5)/NRB_BVHGRID*(net->knotU[i+1]-net->knotU[i]);
+                    uv[2*(k*NRB_BVHGRID+l)+1] = net->knotV[j]+(k+0.5)/NRB_BVHGRID*(net->knotV[j+1]-net->knotV[j]);
+                }
+            }
+            nrbNetEval2(net, uv, NRB_BVHGRID*NRB_BVHGRID, bspPnts, scr);
+
+            pp = &patch[NRB_BVHPATCH*num];
+            pp[0] = (double)srfIndex;
+            for (k = 0; k < NRB_BVHGRID*NRB_BVHGRID; k++){
+                pp[1+5*k] = uv[2*k];
+                pp[2+5*k] = uv[2*k+1];
+                for (m = 0; m < 3; m++){
+                    x = bspPnts[4*k+m]/bspPnts[4*k+3];
+                    pp[3+5*k+m] = x;
+                    /* Samples are inside the box unless some weights are not positive */
+                    if (x<items[num].box[m]){
+                        items[num].box[m] = x;
+                    }
+                    if (x>items[num].box[m+3]){
+                        items[num].box[m+3] = x;
+                    }
+                }
+            }
+
+            num++;
+        }
+    }
+    return num;
+
+}
+
+
+static int nrbBvhCompareItems(const void *a, const void *b){
+    /* nrbBvhCompareItems compares the keys of two sub-patches, for qsort */
+
+    double ka = ((const nrbBvhItem*)a)->key, kb = ((const nrbBvhItem*)b)->key;
+
+    return (ka<kb) ? -1 : ((ka>kb) ? 1 : 0);
+
+}
+
+
+static int nrbBvhBuild(nrbBvhItem *items, int first, int count, double *node, int *numNodes){
+    /* nrbBvhBuild builds the subtree of the sub-patches first, ..., first+count-1, returns the index of its root node */
+
+    /* nrbBvhBuild( items - pointer to boxes of all sub-patches (reordered), first - index of first sub-patch, count - number of sub-patches, node - pointer to nodes (NRB_BVHNODE x 2*number of sub-patches), numNodes - pointer to number of used nodes, updated) */
+
+    int k, m, axis, mid, index = (*numNodes)++;
+    double *nd = &node[NRB_BVHNODE*index], cmin[3], cmax[3], c;
+
+    for (m = 0; m < 3; m++){
+        nd[m] = HUGE_VAL;
+        nd[m+3] = -HUGE_VAL;
+        cmin[m] = HUGE_VAL;
+        cmax[m] = -HUGE_VAL;
+    }
+    for (k = first; k < first+count; k++){
+        for (m = 0; m < 3; m++){
+            if (items[k].box[m]<nd[m]){
+                nd[m] = items[k].box[m];
+            }
+            if (items[k].box[m+3]>nd[m+3]){
+                nd[m+3] = items[k].box[m+3];
+            }
+            c = 0.5*(items[k].box[m]+items[k].box[m+3]);
+            if (c<cmin[m]){
+                cmin[m] = c;
+            }
+            if (c>cmax[m]){
+                cmax[m] = c;
+            }
+        }
+    }
+
+    if (count<=NRB_BVHLEAFSIZE){
+        nd[6] = (double)first;
+        nd[7] = (double)count;
+        return index;
+    }
+
+    /* Median split along the longest axis of the centres */
+    axis = 0;
+    for (m = 1; m < 3; m++){
+        if (cmax[m]-cmin[m]>cmax[axis]-cmin[axis]){
+            axis = m;
+        }
+    }
+    for (k = first; k < first+count; k++){
+        items[k].key = 0.5*(items[k].box[axis]+items[k].box[axis+3]);
+    }
+    qsort(&items[first], count, sizeof(nrbBvhItem), nrbBvhCompareItems);
+
+    mid = count/2;
+    nrbBvhBuild(items, first, mid, node, numNodes);
+    nd[6] = (double)nrbBvhBuild(items, first+mid, count-mid, node, numNodes);
+    nd[7] = 0.0;
+    return index;
+
+}
+
+
+static mxArray *nrbBvhCreate(const nrbCompiled *srfs, int numSrfs){
+    /* nrbBvhCreate builds the BVH of numSrfs surfaces */
+
+    /* nrbBvhCreate( srfs - pointer to compiled NURBS surfaces, numSrfs - number of surfaces) */
+
+    int k, numPatches = 0, numNodes = 0, maxOrderU = 0, maxOrderV = 0;
+    double *node, *patch, *out;
+    nrbBvhItem *items;
+    nrbScratch scr;
+    mxArray *arr;
+
+    for (k = 0; k < numSrfs; k++){
+        numPatches += nrbBvhNumPatches(&srfs[k].net[0]);
+        if (srfs[k].net[0].orderU>maxOrderU){
+            maxOrderU = srfs[k].net[0].orderU;
+        }
+        if (srfs[k].net[0].orderV>maxOrderV){
+            maxOrderV = srfs[k].net[0].orderV;
+        }
+    }
+    if (numPatches<1){
+        mexErrMsgTxt("The surfaces have no nonempty knot spans.");
+    }
+
+    items = (nrbBvhItem*) malloc(numPatches*sizeof(nrbBvhItem));
+    patch = (double*) malloc((size_t)NRB_BVHPATCH*numPatches*sizeof(double));
+    node = (double*) malloc((size_t)NRB_BVHNODE*2*numPatches*sizeof(double));
+    if (!nrbScratchInit(&scr, maxOrderU, maxOrderV) || items==NULL || patch==NULL || node==NULL){
+        nrbScratchFree(&scr);
+        free(node);
+        free(patch);
+        free(items);
+        mexErrMsgTxt("Out of memory.");
+    }
+
+    numPatches = 0;
+    for (k = 0; k < numSrfs; k++){
+        numPatches += nrbBvhPatches(&srfs[k].net[0], k+1, &items[numPatches], &patch[NRB_BVHPATCH*numPatches], &scr);
+    }
+    for (k = 0; k < numPatches; k++){
+        items[k].index = k;
+    }
+    nrbScratchFree(&scr);
+
+    nrbBvhBuild(items, 0, numPatches, node, &numNodes);
+
+    arr = mxCreateDoubleMatrix(1, NRB_BVHHEADER+NRB_BVHNODE*numNodes+NRB_BVHPATCH*numPatches, mxREAL);
+    out = mxGetPr(arr);
+    out[0] = NRB_BVH_MAGIC;
+    out[1] = 1.0;
+    out[2] = (double)numSrfs;
+    out[3] = (double)numNodes;
+    out[4] = (double)numPatches;
+    memcpy(&out[NRB_BVHHEADER], node, (size_t)NRB_BVHNODE*numNodes*sizeof(double));
+    out += NRB_BVHHEADER+NRB_BVHNODE*numNodes;
+    for (k = 0; k < numPatches; k++){
+        memcpy(&out[NRB_BVHPATCH*k], &patch[NRB_BVHPATCH*items[k].index], NRB_BVHPATCH*sizeof(double));
+    }
+
+    free(node);
+    free(patch);
+    free(items);
+    return arr;
+
+}
@@ -0,0 +1,208 @@
+/* nrbBvhNearest finds the samples of a BVH closest to a line/point and nrbBvhClosestBatch the surfaces closest to many
+ * points/lines, in parallel if compiled with OpenMP */
+
+/* They need nrbBvh and nrbClosestPoint */
+
+static double nrbBvhBoxDist2(const double *box, double *r0, double *v){
+    /* nrbBvhBoxDist2 returns a lower bound of the squared distance between the points in box and the line/point */
+
+    /* The bound is exact for a point. For a line the box is replaced by its circumscribed sphere. */
+
+    int m;
+    double d, c[3], rad2 = 0.0, dist2 = 0.0;
+
+    if (v==NULL){
+        for (m = 0; m < 3; m++){
+            if (r0[m]<box[m]){
+                d = box[m]-r0[m];
+                dist2 += d*d;
+            }
+            else if (r0[m]>box[m+3]){
+                d = r0[m]-box[m+3];
+                dist2 += d*d;
+            }
+        }
+        return dist2;
+    }
+
+    for (m = 0; m < 3; m++){
+        c[m] = 0.5*(box[m]+box[m+3]);
+        d = 0.5*(box[m+3]-box[m]);
+        rad2 += d*d;
+    }
+    d = sqrt(nrbLinePointDist2(c, r0, v))-sqrt(rad2);
+    return (d>0.0) ? d*d : 0.0;
+
+}
+
+
+static void nrbBvhCandidate(int numCand, double *candDist2, int *candSrf, double *candParam, double dist2, int srfIndex, double *paramValue){
+    /* nrbBvhCandidate inserts a sample into the list of candidates, sorted by distance with at most one sample per surface */
+
+    int k, l;
+
+    for (k = 0; k < numCand && candSrf[k]!=srfIndex; k++){
+    }
+    if (k==numCand){
+        /* Surface not in the list, replace the last candidate */
+        k = numCand-1;
+    }
+    if (dist2>=candDist2[k]){
+        return;
+    }
+    for (l = k; l > 0 && candDist2[l-1]>dist2; l--){
+        candDist2[l] = candDist2[l-1];
+        candSrf[l] = candSrf[l-1];
+        candParam[2*l] = candParam[2*l-2];
+        candParam[2*l+1] = candParam[2*l-1];
+    }
+    candDist2[l] = dist2;
+    candSrf[l] = srfIndex;
+    candParam[2*l] = paramValue[0];
+    candParam[2*l+1] = paramValue[1];
+
+}
+
+
+static void nrbBvhNearest(const nrbBvh *bvh, double *r0, double *v, int numCand, double *candDist2, int *candSrf, double *candParam){
+    /* nrbBvhNearest finds the samples closest to the line/point on the numCand closest surfaces */
+
+    /* nrbBvhNearest( bvh - pointer to BVH, r0 - pointer to point (3), v - pointer to line direction (3) or NULL for point, numCand - number of candidates, candDist2 - pointer to squared distances of the samples (numCand), candSrf - pointer to surface indices (1-based) of the samples, 0 if there are fewer than numCand surfaces (numCand), candParam - pointer to parameter values (u,v) of the samples (2 x numCand)) */
+
+    /* Branch and bound: a node is skipped if its box is farther away than the last candidate found so far,
+     * and of the two children the closer one is visited first. */
+
+    int k, s, n, top = 0, stack[NRB_BVHSTACK], child[2];
+    double childDist2[2], *nd, *pp;
+
+    for (k = 0; k < numCand; k++){
+        candDist2[k] = HUGE_VAL;
+        candSrf[k] = 0;
+    }
+    stack[top++] = 0;
+    while (top>0){
+        n = stack[--top];
+        nd = &bvh->node[NRB_BVHNODE*n];
+        if (nrbBvhBoxDist2(nd, r0, v)>=candDist2[numCand-1]){
+            continue;
+        }
+        if (nd[7]>0.0){
+            for (k = (int)nd[6]; k < (int)nd[6]+(int)nd[7]; k++){
+                pp = &bvh->patch[NRB_BVHPATCH*k];
+                for (s = 0; s < NRB_BVHGRID*NRB_BVHGRID; s++){
+                    nrbBvhCandidate(numCand, candDist2, candSrf, candParam, nrbLinePointDist2(&pp[3+5*s], r0, v), (int)pp[0], &pp[1+5*s]);
+                }
+            }
+            continue;
+        }
+        child[0] = n+1;
+        child[1] = (int)nd[6];
+        childDist2[0] = nrbBvhBoxDist2(&bvh->node[NRB_BVHNODE*child[0]], r0, v);
+        childDist2[1] = nrbBvhBoxDist2(&bvh->node[NRB_BVHNODE*child[1]], r0, v);
+        k = (childDist2[1]<childDist2[0]) ? 1 : 0;
+        if (childDist2[1-k]<candDist2[numCand-1] && top<NRB_BVHSTACK){
+            stack[top++] = child[1-k];
+        }
+        if (childDist2[k]<candDist2[numCand-1] && top<NRB_BVHSTACK){
+            stack[top++] = child[k];
+        }
+    }
+
+}
+
+
+static void nrbBvhClosestBatch(const nrbBvh *bvh, const nrbCompiled *srfs, int method, int numSeeds, int numPnts, double *r0, double *v, int stride, double *evalPnts, double *paramValues, double *srfIndices, double *dists, int numThreads){
+    /* nrbBvhClosestBatch finds the surface closest to numPnts lines/points and, if srfs is given, the closest point on it */
+
+    /* nrbBvhClosestBatch( bvh - pointer to BVH, srfs - pointer to the compiled NURBS surfaces of bvh or NULL for start values only, method - NRB_TRUST or NRB_NEWTON, numSeeds - number of start values per line/point and surface for nrbClosestPointSeeds, numPnts - number of lines/points, r0 - pointer to points (3 x numPnts), v - pointer to line directions (3 x numPnts) or NULL for points, stride - 3 if r0 (and v) has one column per line/point, 0 if the same line/point is used for all, evalPnts - pointer to closest points (3 x numPnts), not used if srfs is NULL, paramValues - pointer to parameter values (2 x numPnts), srfIndices - pointer to surface indices (1-based) (numPnts), dists - pointer to distances (numPnts), numThreads - number of threads) */
+
+    /* Without srfs the closest sample is returned. With srfs Newton's method is started from the closest sample on
+     * each of the NRB_BVHCANDIDATES closest surfaces, and the closest result (or sample, if Newton's method went
+     * away from it) is returned. */
+
+    int k, numCand = (srfs==NULL) ? 1 : NRB_BVHCANDIDATES, maxOrderU = 0, maxOrderV = 0, failed = 0;
+    double nan = mxGetNaN();
+
+    if (srfs!=NULL){
+        for (k = 0; k < bvh->numSrfs; k++){
+            if (srfs[k].net[0].orderU>maxOrderU){
+                maxOrderU = srfs[k].net[0].orderU;
+            }
+            if (srfs[k].net[0].orderV>maxOrderV){
+                maxOrderV = srfs[k].net[0].orderV;
+            }
+        }
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads) if(numThreads>1)
+#endif
+    {
+        int i, c, iter, ok, candSrf[NRB_BVHCANDIDATES];
+        double dist2, candDist2[NRB_BVHCANDIDATES], candParam[2*NRB_BVHCANDIDATES], evalPnt[3], paramValue[2], bspPnt[4], *r0i, *vi;
+        nrbScratch scr;
+
+        ok = nrbScratchInit(&scr, maxOrderU, maxOrderV);
+        if (!ok){
+            failed = 1;
+        }
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, NRB_CLOSESTCHUNK)
+#endif
+        for (i = 0; i < numPnts; i++){
+            if (!ok){
+                continue;
+            }
+            r0i = r0+stride*i;
+            vi = (v==NULL) ? NULL : v+stride*i;
+            nrbBvhNearest(bvh, r0i, vi, numCand, candDist2, candSrf, candParam);
+            srfIndices[i] = (double)candSrf[0];
+            paramValues[2*i] = candParam[0];
+            paramValues[2*i+1] = candParam[1];
+            dists[i] = sqrt(candDist2[0]);
+            if (candSrf[0]<1){
+                /* No sample with a finite distance */
+                paramValues[2*i] = nan;
+                paramValues[2*i+1] = nan;
+                dists[i] = nan;
+                if (srfs!=NULL){
+                    evalPnts[3*i] = nan;
+                    evalPnts[3*i+1] = nan;
+                    evalPnts[3*i+2] = nan;
+                }
+                continue;
+            }
+            if (srfs==NULL){
+                continue;
+            }
+
+            /* The closest sample, replaced by closer results of Newton's method */
+            nrbNetEval2(&srfs[candSrf[0]-1].net[0], candParam, 1, bspPnt, &scr);
+            evalPnts[3*i] = bspPnt[0]/bspPnt[3];
+            evalPnts[3*i+1] = bspPnt[1]/bspPnt[3];
+            evalPnts[3*i+2] = bspPnt[2]/bspPnt[3];
+            for (c = 0; c < numCand && candSrf[c]>0; c++){
+                nrbClosestPointSeeds(&srfs[candSrf[c]-1], method, numSeeds, &candParam[2*c], r0i, vi, evalPnt, paramValue, &iter, &scr);
+                dist2 = nrbLinePointDist2(evalPnt, r0i, vi);
+                if (dist2<=candDist2[0]){
+                    candDist2[0] = dist2;
+                    srfIndices[i] = (double)candSrf[c];
+                    paramValues[2*i] = paramValue[0];
+                    paramValues[2*i+1] = paramValue[1];
+                    evalPnts[3*i] = evalPnt[0];
+                    evalPnts[3*i+1] = evalPnt[1];
+                    evalPnts[3*i+2] = evalPnt[2];
+                }
+            }
+            dists[i] = sqrt((candDist2[0]>0.0) ? candDist2[0] : 0.0);
+        }
+
+        nrbScratchFree(&scr);
+    }
+
+    if (failed){
+        mexErrMsgTxt("Out of memory.");
+    }
+
+}
@@ -0,0 +1,12 @@
+
+static void nrbClampParam(double *paramValue, double pmin, double pmax){
+    /* nrbClampParam clamps a parameter value to [pmin,pmax] */
+
+    if(*paramValue <= pmin){
+        *paramValue = pmin;
+    }
+    else if(*paramValue >= pmax){
+        *paramValue = pmax;
+    }
+
+}
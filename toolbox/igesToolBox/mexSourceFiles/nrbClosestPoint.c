@@ -0,0 +1,574 @@
+
+/* nrbClosestPointTrust, nrbClosestPoint2 and nrbClosestPoint find the closest point of a NURBS and a line/point for
+ * one start value, and nrbClosestPointSeeds keeps the closest of several start values (nrbClosestPointBatch solves many
+ * points/lines) */
+
+/* They need nrbClampParam, nrbNetEval, nrbNetEval2, nrbD1D2eval2, nrbD1D2eval, nrbOptions and MAXITER (maximum number of Newton iterations) */
+
+/* Points/lines take different numbers of Newton steps, so they are handed out to the threads in small chunks */
+#define NRB_CLOSESTCHUNK 16
+
+/* nrbClosestPointTrust: tolerance of steps in parameter values scaled to [0,1], and initial trust region radius */
+#define NRB_CLOSESTTOL 1e-10
+#define NRB_CLOSESTRADIUS 0.5
+
+static int nrbClosestPoint2(const nrbCompiled *nrb, double *paramStart, double *r0, double *v, double *evalPnt, double *paramValue, int *numIter, nrbScratch *scr){
+    /* Closest point of a NURBS surface and a line/point using Newton's method, returns 1 if the Newton steps converged */
+
+    /* nrbClosestPoint2( nrb - pointer to compiled NURBS with first and second derivative nets, paramStart - pointer to start parameter values (u,v), r0 - pointer to point (3), v - pointer to line direction (3) or NULL for point, evalPnt - pointer closest point on surface, paramValue - pointer parameter values (u,v) of closest point, numIter - pointer to number of Newton steps, scr - pointer to arrays for function BasisFuns) */
+
+    int j, converged = 0;
+    double t, detH, H11, H12, H13, H22, H23, H33, neggrad1, neggrad2, neggrad3, s1, s2, s3, res[3];
+    double umin, umax, vmin, vmax, bspPnts[4], pnttmp[3], pderu[3], pderv[3], pderuu[3], pderuv[3], pdervv[3];
+    const nrbNet *net = &nrb->net[0];
+
+    umin = net->knotU[net->orderU-1];
+    umax = net->knotU[net->ncp];
+    vmin = net->knotV[net->orderV-1];
+    vmax = net->knotV[net->kcp];
+
+    paramValue[0] = paramStart[0];
+    paramValue[1] = paramStart[1];
+
+    if(v!=NULL){
+
+        t=0.0;
+        for (j = 0; j < MAXITER; j++){
+
+            nrbClampParam(&paramValue[0], umin, umax);
+            nrbClampParam(&paramValue[1], vmin, vmax);
+
+            nrbD1D2eval2(nrb, paramValue, &pnttmp[0], &pderu[0], &pderv[0], &pderuu[0], &pderuv[0], &pdervv[0], &bspPnts[0], scr);
+
+            res[0]=r0[0]+t*v[0]-pnttmp[0];
+            res[1]=r0[1]+t*v[1]-pnttmp[1];
+            res[2]=r0[2]+t*v[2]-pnttmp[2];
+
+            H13=-(pderu[0]*v[0]+pderu[1]*v[1]+pderu[2]*v[2]);
+            H23=-(pderv[0]*v[0]+pderv[1]*v[1]+pderv[2]*v[2]);
+            H33=  v[0]*v[0]+v[1]*v[1]+v[2]*v[2];
+
+            neggrad3=res[0]*v[0]+res[1]*v[1]+res[2]*v[2];
+
+            H11=pderu[0]*pderu[0]+pderu[1]*pderu[1]+pderu[2]*pderu[2]-(pderuu[0]*res[0]+pderuu[1]*res[1]+pderuu[2]*res[2]);
+            H12=pderu[0]*pderv[0]+pderu[1]*pderv[1]+pderu[2]*pderv[2]-(pderuv[0]*res[0]+pderuv[1]*res[1]+pderuv[2]*res[2]);
+            H22=pderv[0]*pderv[0]+pderv[1]*pderv[1]+pderv[2]*pderv[2]-(pdervv[0]*res[0]+pdervv[1]*res[1]+pdervv[2]*res[2]);
+
+            neggrad1=pderu[0]*res[0]+pderu[1]*res[1]+pderu[2]*res[2];
+            neggrad2=pderv[0]*res[0]+pderv[1]*res[1]+pderv[2]*res[2];
+
+            detH = 2*H13*H12*H23-H13*H13*H22-H12*H12*H33+H11*H22*H33-H11*H23*H23;
+            if(fabs(detH)<1e-10){
+                break;
+            }
+            s1 = ((H22*H33-H23*H23)*neggrad1+(H13*H23-H12*H33)*neggrad2-(H12*H23-H13*H22)*neggrad3)/detH;
+            s2 = ((H13*H23-H12*H33)*neggrad1+(H11*H33-H13*H13)*neggrad2-(H13*H12-H11*H23)*neggrad3)/detH;
+            s3 = ((H12*H23-H13*H22)*neggrad1+(H13*H12-H11*H23)*neggrad2-(H11*H22-H12*H12)*neggrad3)/detH;
+
+            paramValue[0] += 0.7*s1;
+            paramValue[1] += 0.7*s2;
+            t+=0.7*s3;
+
+            if((s1*s1+s2*s2+s3*s3)<1e-20){
+                converged = 1;
+                j++;
+                break;
+            }
+        }
+
+    }
+    else{
+
+        for (j = 0; j < MAXITER; j++){
+
+            nrbClampParam(&paramValue[0], umin, umax);
+            nrbClampParam(&paramValue[1], vmin, vmax);
+
+            nrbD1D2eval2(nrb, paramValue, &pnttmp[0], &pderu[0], &pderv[0], &pderuu[0], &pderuv[0], &pdervv[0], &bspPnts[0], scr);
+
+            res[0]=r0[0]-pnttmp[0];
+            res[1]=r0[1]-pnttmp[1];
+            res[2]=r0[2]-pnttmp[2];
+
+            H11=pderu[0]*pderu[0]+pderu[1]*pderu[1]+pderu[2]*pderu[2]-(pderuu[0]*res[0]+pderuu[1]*res[1]+pderuu[2]*res[2]);
+            H12=pderu[0]*pderv[0]+pderu[1]*pderv[1]+pderu[2]*pderv[2]-(pderuv[0]*res[0]+pderuv[1]*res[1]+pderuv[2]*res[2]);
+            H22=pderv[0]*pderv[0]+pderv[1]*pderv[1]+pderv[2]*pderv[2]-(pdervv[0]*res[0]+pdervv[1]*res[1]+pdervv[2]*res[2]);
+
+            neggrad1=pderu[0]*res[0]+pderu[1]*res[1]+pderu[2]*res[2];
+            neggrad2=pderv[0]*res[0]+pderv[1]*res[1]+pderv[2]*res[2];
+
+            detH = H11*H22-H12*H12;
+            if(fabs(detH)<1e-10){
+                break;
+            }
+            s1 = (H22*neggrad1-H12*neggrad2)/detH;
+            s2 = (H11*neggrad2-H12*neggrad1)/detH;
+
+            paramValue[0] += 0.7*s1;
+            paramValue[1] += 0.7*s2;
+
+            if((s1*s1+s2*s2)<1e-20){
+                converged = 1;
+                j++;
+                break;
+            }
+        }
+
+    }
+
+    nrbClampParam(&paramValue[0], umin, umax);
+    nrbClampParam(&paramValue[1], vmin, vmax);
+
+    nrbNetEval2(net, paramValue, 1, &bspPnts[0], scr);
+
+    evalPnt[0]=(bspPnts[0])/(bspPnts[3]);
+    evalPnt[1]=(bspPnts[1])/(bspPnts[3]);
+    evalPnt[2]=(bspPnts[2])/(bspPnts[3]);
+
+    *numIter = j;
+    return converged;
+
+}
+
+
+static int nrbClosestPoint(const nrbCompiled *nrb, double *paramStart, double *r0, double *v, double *evalPnt, double *paramValue, int *numIter, nrbScratch *scr){
+    /* Closest point of a NURBS curve and a line/point using Newton's method, returns 1 if the Newton steps converged */
+
+    /* nrbClosestPoint( nrb - pointer to compiled NURBS with first and second derivative nets, paramStart - pointer to start parameter value u, r0 - pointer to point (3), v - pointer to line direction (3) or NULL for point, evalPnt - pointer closest point on curve, paramValue - pointer parameter value u of closest point, numIter - pointer to number of Newton steps, scr - pointer to arrays for function BasisFuns) */
+
+    int j, converged = 0;
+    double t, detH, H11, H12, H22, neggrad1, neggrad2, s1, s2, res[3];
+    double umin, umax, bspPnts[4], pnttmp[3], pderu[3], pderuu[3];
+    const nrbNet *net = &nrb->net[0];
+
+    umin = net->knotU[net->orderU-1];
+    umax = net->knotU[net->ncp];
+
+    paramValue[0] = paramStart[0];
+
+    if(v!=NULL){
+
+        t=0.0;
+        for (j = 0; j < MAXITER; j++){
+
+            nrbClampParam(&paramValue[0], umin, umax);
+
+            nrbD1D2eval(nrb, paramValue, &pnttmp[0], &pderu[0], &pderuu[0], &bspPnts[0], scr);
+
+            res[0]=r0[0]+t*v[0]-pnttmp[0];
+            res[1]=r0[1]+t*v[1]-pnttmp[1];
+            res[2]=r0[2]+t*v[2]-pnttmp[2];
+
+            H12=-(pderu[0]*v[0]+pderu[1]*v[1]+pderu[2]*v[2]);
+            H22=  v[0]*v[0]+v[1]*v[1]+v[2]*v[2];
+
+            neggrad2=res[0]*v[0]+res[1]*v[1]+res[2]*v[2];
+
+            H11=pderu[0]*pderu[0]+pderu[1]*pderu[1]+pderu[2]*pderu[2]-(pderuu[0]*res[0]+pderuu[1]*res[1]+pderuu[2]*res[2]);
+
+            neggrad1=pderu[0]*res[0]+pderu[1]*res[1]+pderu[2]*res[2];
+
+            detH = H11*H22-H12*H12;
+            if(fabs(detH)<1e-10){
+                break;
+            }
+            s1 = (H22*neggrad1+H12*neggrad2)/detH;
+            s2 = -(H11*neggrad2+H12*neggrad1)/detH;
+
+            paramValue[0] += 0.7*s1;
+            t+=0.7*s2;
+
+            if((s1*s1+s2*s2)<1e-20){
+                converged = 1;
+                j++;
+                break;
+            }
+        }
+
+    }
+    else{
+
+        for (j = 0; j < MAXITER; j++){
+
+            nrbClampParam(&paramValue[0], umin, umax);
+
+            nrbD1D2eval(nrb, paramValue, &pnttmp[0], &pderu[0], &pderuu[0], &bspPnts[0], scr);
+
+            res[0]=r0[0]-pnttmp[0];
+            res[1]=r0[1]-pnttmp[1];
+            res[2]=r0[2]-pnttmp[2];
+
+            H11=pderu[0]*pderu[0]+pderu[1]*pderu[1]+pderu[2]*pderu[2]-(pderuu[0]*res[0]+pderuu[1]*res[1]+pderuu[2]*res[2]);
+
+            neggrad1=pderu[0]*res[0]+pderu[1]*res[1]+pderu[2]*res[2];
+
+            if(fabs(H11)<1e-10){
+                break;
+            }
+            s1 = neggrad1/H11;
+
+            paramValue[0] += 0.7*s1;
+
+            if((s1*s1)<1e-20){
+                converged = 1;
+                j++;
+                break;
+            }
+        }
+
+    }
+
+    nrbClampParam(&paramValue[0], umin, umax);
+
+    nrbNetEval(net, paramValue, 1, &bspPnts[0], scr);
+
+    evalPnt[0]=(bspPnts[0])/(bspPnts[3]);
+    evalPnt[1]=(bspPnts[1])/(bspPnts[3]);
+    evalPnt[2]=(bspPnts[2])/(bspPnts[3]);
+
+    *numIter = j;
+    return converged;
+
+}
+
+
+static double nrbClosestModel(const nrbCompiled *nrb, double *paramValue, double *r0, double *v, double *grad, double *hess, nrbScratch *scr){
+    /* nrbClosestModel returns half the squared distance between a NURBS point and a line/point, and its gradient and Hessian */
+
+    /* nrbClosestModel( nrb - pointer to compiled NURBS, paramValue - pointer to parameter value(s), r0 - pointer to point (3), v - pointer to line direction (3) or NULL for point, grad - pointer to gradient (numDirs), hess - pointer to Hessian H11, H12, H22 and Gauss-Newton matrix J11, J12, J22 (surface) or H11 and J11 in hess[0] and hess[3] (curve), scr - pointer to arrays for function BasisFuns) */
+
+    /* For a line the line parameter is eliminated, the residual and the derivatives are projected on the plane
+     * orthogonal to v. */
+
+    int i, a, numDirs = nrb->numDirs;
+    double c, vv = 0.0, res[3], pnt[3], der[2][3], der2[3][3], bspPnts[4];
+
+    if (numDirs==2){
+        nrbD1D2eval2(nrb, paramValue, pnt, der[0], der[1], der2[0], der2[1], der2[2], bspPnts, scr);
+    }
+    else{
+        nrbD1D2eval(nrb, paramValue, pnt, der[0], der2[0], bspPnts, scr);
+    }
+    for (i = 0; i < 3; i++){
+        res[i] = pnt[i]-r0[i];
+    }
+    if (v!=NULL){
+        vv = v[0]*v[0]+v[1]*v[1]+v[2]*v[2];
+    }
+    if (vv>0.0){
+        c = (res[0]*v[0]+res[1]*v[1]+res[2]*v[2])/vv;
+        for (i = 0; i < 3; i++){
+            res[i] -= c*v[i];
+        }
+        for (a = 0; a < numDirs; a++){
+            c = (der[a][0]*v[0]+der[a][1]*v[1]+der[a][2]*v[2])/vv;
+            for (i = 0; i < 3; i++){
+                der[a][i] -= c*v[i];
+            }
+        }
+    }
+
+    for (a = 0; a < numDirs; a++){
+        grad[a] = der[a][0]*res[0]+der[a][1]*res[1]+der[a][2]*res[2];
+    }
+    hess[3] = der[0][0]*der[0][0]+der[0][1]*der[0][1]+der[0][2]*der[0][2];
+    hess[0] = hess[3]+der2[0][0]*res[0]+der2[0][1]*res[1]+der2[0][2]*res[2];
+    if (numDirs==2){
+        hess[4] = der[0][0]*der[1][0]+der[0][1]*der[1][1]+der[0][2]*der[1][2];
+        hess[5] = der[1][0]*der[1][0]+der[1][1]*der[1][1]+der[1][2]*der[1][2];
+        hess[1] = hess[4]+der2[1][0]*res[0]+der2[1][1]*res[1]+der2[1][2]*res[2];
+        hess[2] = hess[5]+der2[2][0]*res[0]+der2[2][1]*res[1]+der2[2][2]*res[2];
+    }
+    return 0.5*(res[0]*res[0]+res[1]*res[1]+res[2]*res[2]);
+
+}
+
+
+static int nrbClosestPointTrust(const nrbCompiled *nrb, double *paramStart, double *r0, double *v, double *evalPnt, double *paramValue, int *numIter, nrbScratch *scr){
+    /* Closest point of a NURBS and a line/point using a projected Newton method with a trust region, returns 1 if it converged */
+
+    /* nrbClosestPointTrust( nrb - pointer to compiled NURBS with first and second derivative nets, paramStart - pointer to start parameter value(s), r0 - pointer to point (3), v - pointer to line direction (3) or NULL for point, evalPnt - pointer closest point on NURBS, paramValue - pointer parameter value(s) of closest point, numIter - pointer to number of evaluations, scr - pointer to arrays for function BasisFuns) */
+
+    /* In parameter values scaled to [0,1], parameters at a bound with the gradient pointing out of the domain are
+     * kept fixed. The Newton step of the others is used if the Hessian (or else the Gauss-Newton matrix) is positive
+     * definite and the step is inside the trust region, otherwise the dogleg step to the border of the trust region
+     * (or the steepest descent step).
+     * The step is projected on the bounds and kept if it decreases the distance, and the radius is adapted to the
+     * ratio of actual and predicted decrease. A curve is solved as a surface with a fixed second parameter. */
+
+    int i, k, iter, isFree[2], isNewton, numDirs = nrb->numDirs, converged = 0;
+    double lo[2], hi[2], scale[2], x[2], xt[2], d[2], g[2], H[6], gt[2], Ht[6], gs[2], Hs[3], sN[2], sC[2], s[2], w[2];
+    double bspPnts[4], f, ft, det, gnorm, gtnorm, gi, sNnorm, sCnorm, gHg, pred, rho, dnorm, a, b, c, beta, radius = NRB_CLOSESTRADIUS;
+    const nrbNet *net = &nrb->net[0];
+
+    lo[0] = net->knotU[net->orderU-1];
+    hi[0] = net->knotU[net->ncp];
+    x[0] = paramStart[0];
+    g[1] = 0.0;
+    gt[1] = 0.0;
+    for (k = 0; k < 6; k += 3){
+        H[k+1] = 0.0;
+        H[k+2] = 1.0;
+        Ht[k+1] = 0.0;
+        Ht[k+2] = 1.0;
+    }
+    if (numDirs==2){
+        lo[1] = net->knotV[net->orderV-1];
+        hi[1] = net->knotV[net->kcp];
+        x[1] = paramStart[1];
+    }
+    else{
+        lo[1] = 0.0;
+        hi[1] = 0.0;
+        x[1] = 0.0;
+    }
+    for (i = 0; i < 2; i++){
+        scale[i] = (hi[i]>lo[i]) ? hi[i]-lo[i] : 1.0;
+        nrbClampParam(&x[i], lo[i], hi[i]);
+    }
+
+    f = nrbClosestModel(nrb, x, r0, v, g, H, scr);
+    for (iter = 1; iter < MAXITER; ){
+
+        /* Scaled gradient of the free parameters */
+        for (i = 0; i < 2; i++){
+            gs[i] = g[i]*scale[i];
+            isFree[i] = !(i>=numDirs || (x[i]<=lo[i] && gs[i]>0.0) || (x[i]>=hi[i] && gs[i]<0.0));
+            if (!isFree[i]){
+                gs[i] = 0.0;
+            }
+        }
+        gnorm = sqrt(gs[0]*gs[0]+gs[1]*gs[1]);
+        if (gnorm==0.0){
+            converged = 1;
+            break;
+        }
+
+        /* Scaled Hessian, or Gauss-Newton matrix if the Hessian is not positive definite, fixed parameters get a unit
+         * diagonal */
+        for (k = 0; k < 6; k += 3){
+            Hs[0] = H[k]*scale[0]*scale[0];
+            Hs[1] = H[k+1]*scale[0]*scale[1];
+            Hs[2] = H[k+2]*scale[1]*scale[1];
+            for (i = 0; i < 2; i++){
+                if (!isFree[i]){
+                    Hs[1] = 0.0;
+                    Hs[2*i] = 1.0;
+                }
+            }
+            det = Hs[0]*Hs[2]-Hs[1]*Hs[1];
+            if (Hs[0]>0.0 && det>0.0){
+                break;
+            }
+        }
+        sNnorm = HUGE_VAL;
+        if (Hs[0]>0.0 && det>0.0){
+            sN[0] = -(Hs[2]*gs[0]-Hs[1]*gs[1])/det;
+            sN[1] = -(Hs[0]*gs[1]-Hs[1]*gs[0])/det;
+            sNnorm = sqrt(sN[0]*sN[0]+sN[1]*sN[1]);
+            if (sNnorm<=NRB_CLOSESTTOL){
+                for (i = 0; i < numDirs; i++){
+                    x[i] += sN[i]*scale[i];
+                    nrbClampParam(&x[i], lo[i], hi[i]);
+                }
+                converged = 1;
+                break;
+            }
+        }
+
+        isNewton = (k==0 && sNnorm<=radius);
+        if (sNnorm<=radius){
+            s[0] = sN[0];
+            s[1] = sN[1];
+        }
+        else{
+            gHg = gs[0]*(Hs[0]*gs[0]+Hs[1]*gs[1])+gs[1]*(Hs[1]*gs[0]+Hs[2]*gs[1]);
+            beta = (gHg>0.0) ? gnorm*gnorm/gHg : HUGE_VAL;
+            sC[0] = -beta*gs[0];
+            sC[1] = -beta*gs[1];
+            sCnorm = beta*gnorm;
+            if (sCnorm>=radius){
+                s[0] = -radius/gnorm*gs[0];
+                s[1] = -radius/gnorm*gs[1];
+            }
+            else if (sNnorm<HUGE_VAL){
+                /* Dogleg, from the steepest descent step towards the Newton step up to the radius */
+                w[0] = sN[0]-sC[0];
+                w[1] = sN[1]-sC[1];
+                a = w[0]*w[0]+w[1]*w[1];
+                b = 2.0*(sC[0]*w[0]+sC[1]*w[1]);
+                c = sCnorm*sCnorm-radius*radius;
+                beta = (-b+sqrt(b*b-4.0*a*c))/(2.0*a);
+                s[0] = sC[0]+beta*w[0];
+                s[1] = sC[1]+beta*w[1];
+            }
+            else{
+                s[0] = sC[0];
+                s[1] = sC[1];
+            }
+        }
+
+        /* Step projected on the bounds */
+        for (i = 0; i < 2; i++){
+            xt[i] = x[i]+s[i]*scale[i];
+            nrbClampParam(&xt[i], lo[i], hi[i]);
+            d[i] = (xt[i]-x[i])/scale[i];
+        }
+        dnorm = sqrt(d[0]*d[0]+d[1]*d[1]);
+        if (dnorm==0.0){
+            converged = 1;
+            break;
+        }
+        pred = -(gs[0]*d[0]+gs[1]*d[1]+0.5*(Hs[0]*d[0]*d[0]+2.0*Hs[1]*d[0]*d[1]+Hs[2]*d[1]*d[1]));
+
+        ft = nrbClosestModel(nrb, xt, r0, v, gt, Ht, scr);
+        iter++;
+
+        rho = (pred>0.0) ? (f-ft)/pred : ((ft<f) ? 1.0 : -1.0);
+        if (rho<0.25){
+            radius = 0.25*dnorm;
+        }
+        else if (rho>0.75 && dnorm>=0.99*radius){
+            radius = (2.0*radius<1.0) ? 2.0*radius : 1.0;
+        }
+
+        /* Close to the minimum the decrease of the distance is lost in rounding, there a Newton step is also kept
+         * if it decreases the gradient */
+        gtnorm = 0.0;
+        if (isNewton && ft>=f){
+            for (i = 0; i < numDirs; i++){
+                gi = gt[i]*scale[i];
+                if (!((xt[i]<=lo[i] && gi>0.0) || (xt[i]>=hi[i] && gi<0.0))){
+                    gtnorm += gi*gi;
+                }
+            }
+            gtnorm = sqrt(gtnorm);
+        }
+        if (ft<f || (isNewton && gtnorm<gnorm)){
+            x[0] = xt[0];
+            x[1] = xt[1];
+            f = ft;
+            g[0] = gt[0];
+            g[1] = gt[1];
+            for (k = 0; k < 6; k++){
+                H[k] = Ht[k];
+            }
+            if (dnorm<=NRB_CLOSESTTOL){
+                converged = 1;
+                break;
+            }
+        }
+        if (radius<=NRB_CLOSESTTOL){
+            /* No decrease of the distance at this precision */
+            converged = 1;
+            break;
+        }
+    }
+
+    paramValue[0] = x[0];
+    if (numDirs==2){
+        paramValue[1] = x[1];
+        nrbNetEval2(net, paramValue, 1, bspPnts, scr);
+    }
+    else{
+        nrbNetEval(net, paramValue, 1, bspPnts, scr);
+    }
+    evalPnt[0] = bspPnts[0]/bspPnts[3];
+    evalPnt[1] = bspPnts[1]/bspPnts[3];
+    evalPnt[2] = bspPnts[2]/bspPnts[3];
+
+    *numIter = iter;
+    return converged;
+
+}
+
+
+static int nrbClosestPointMethod(const nrbCompiled *nrb, int method, double *paramStart, double *r0, double *v, double *evalPnt, double *paramValue, int *numIter, nrbScratch *scr){
+    /* nrbClosestPointMethod finds the closest point for one start value with the method of option 'method' */
+
+    if (method==NRB_TRUST){
+        return nrbClosestPointTrust(nrb, paramStart, r0, v, evalPnt, paramValue, numIter, scr);
+    }
+    if (nrb->numDirs==2){
+        return nrbClosestPoint2(nrb, paramStart, r0, v, evalPnt, paramValue, numIter, scr);
+    }
+    return nrbClosestPoint(nrb, paramStart, r0, v, evalPnt, paramValue, numIter, scr);
+
+}
+
+
+static void nrbSeedParam(const nrbCompiled *nrb, int k, int numSeeds, double *paramValue){
+    /* nrbSeedParam gives start value k (1, ..., numSeeds-1) spread over the parameter domain, start value 0 is given by the user */
+
+    /* The u-values are equally spaced and the v-values follow the golden ratio (a rank-1 lattice), so that any number of start values covers the domain evenly */
+
+    const nrbNet *net = &nrb->net[0];
+    double s = (k-0.5)/(numSeeds-1), g = (k-0.5)*0.6180339887498949;
+
+    paramValue[0] = net->knotU[net->orderU-1]+s*(net->knotU[net->ncp]-net->knotU[net->orderU-1]);
+    if (nrb->numDirs==2){
+        g -= floor(g);
+        paramValue[1] = net->knotV[net->orderV-1]+g*(net->knotV[net->kcp]-net->knotV[net->orderV-1]);
+    }
+
+}
+
+
+static double nrbLinePointDist2(double *evalPnt, double *r0, double *v){
+    /* nrbLinePointDist2 returns the squared distance between evalPnt and the line/point */
+
+    int i;
+    double res[3], rv = 0.0, vv = 0.0, dist2 = 0.0;
+
+    for (i = 0; i < 3; i++){
+        res[i] = evalPnt[i]-r0[i];
+        dist2 += res[i]*res[i];
+    }
+    if (v!=NULL){
+        for (i = 0; i < 3; i++){
+            rv += res[i]*v[i];
+            vv += v[i]*v[i];
+        }
+        if (vv>0.0){
+            dist2 -= rv*rv/vv;
+        }
+    }
+    return dist2;
+
+}
+
+
+static int nrbClosestPointSeeds(const nrbCompiled *nrb, int method, int numSeeds, double *paramStart, double *r0, double *v, double *evalPnt, double *paramValue, int *numIter, nrbScratch *scr){
+    /* nrbClosestPointSeeds runs the closest point method from paramStart and numSeeds-1 start values from nrbSeedParam, and keeps the result closest to the line/point, returns 1 if it converged */
+
+    /* nrbClosestPointSeeds( nrb - pointer to compiled NURBS, method - NRB_TRUST or NRB_NEWTON, numSeeds - number of start values, paramStart - pointer to start parameter value(s), r0 - pointer to point (3), v - pointer to line direction (3) or NULL for point, evalPnt - pointer closest point, paramValue - pointer parameter value(s) of closest point, numIter - pointer to number of Newton steps (evaluations for NRB_TRUST) of the kept result, scr - pointer to arrays for function BasisFuns) */
+
+    int k, converged, seedConverged, seedIter;
+    double dist2, seedDist2, seedStart[2], seedPnt[3], seedParam[2];
+
+    converged = nrbClosestPointMethod(nrb, method, paramStart, r0, v, evalPnt, paramValue, numIter, scr);
+    if (numSeeds<2){
+        return converged;
+    }
+
+    dist2 = nrbLinePointDist2(evalPnt, r0, v);
+    for (k = 1; k < numSeeds; k++){
+        nrbSeedParam(nrb, k, numSeeds, seedStart);
+        seedConverged = nrbClosestPointMethod(nrb, method, seedStart, r0, v, seedPnt, seedParam, &seedIter, scr);
+        seedDist2 = nrbLinePointDist2(seedPnt, r0, v);
+        if (seedDist2<dist2){
+            dist2 = seedDist2;
+            converged = seedConverged;
+            *numIter = seedIter;
+            evalPnt[0] = seedPnt[0];
+            evalPnt[1] = seedPnt[1];
+            evalPnt[2] = seedPnt[2];
+            paramValue[0] = seedParam[0];
+            if (nrb->numDirs==2){
+                paramValue[1] = seedParam[1];
+            }
+        }
+    }
+    return converged;
+
+}
@@ -0,0 +1,47 @@
+/* nrbClosestPointBatch finds the closest points of a NURBS and many points/lines, in parallel if compiled with OpenMP */
+
+/* nrbClosestPointBatch needs nrbClosestPoint */
+
+static void nrbClosestPointBatch(const nrbCompiled *nrb, int method, int numSeeds, double *paramStart, int numPnts, double *r0, double *v, int stride, double *evalPnts, double *paramValues, mxLogical *converged, double *numIter, int numThreads){
+    /* nrbClosestPointBatch finds the closest points of a NURBS and numPnts lines/points */
+
+    /* nrbClosestPointBatch( nrb - pointer to compiled NURBS, method - NRB_TRUST or NRB_NEWTON, numSeeds - number of start values per line/point, paramStart - pointer to start parameter values (numDirs x numPnts), numPnts - number of lines/points, r0 - pointer to points (3 x 1 or 3 x numPnts), v - pointer to line directions (same size as r0) or NULL for points, stride - 3 if r0 (and v) has one column per line/point, 0 if the same line/point is used for all, evalPnts - pointer to closest points (3 x numPnts), paramValues - pointer to parameter values of closest points (numDirs x numPnts), converged - pointer to convergence flags (numPnts) or NULL, numIter - pointer to numbers of evaluations (numPnts) or NULL, numThreads - number of threads) */
+
+    int numDirs = nrb->numDirs, failed = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads) if(numThreads>1)
+#endif
+    {
+        int i, conv, iter, ok;
+        nrbScratch scr;
+
+        ok = nrbScratchInit(&scr, nrb->net[0].orderU, nrb->net[0].orderV);
+        if (!ok){
+            failed = 1;
+        }
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, NRB_CLOSESTCHUNK)
+#endif
+        for (i = 0; i < numPnts; i++){
+            if (!ok){
+                continue;
+            }
+            conv = nrbClosestPointSeeds(nrb, method, numSeeds, paramStart+numDirs*i, r0+stride*i, (v==NULL) ? NULL : v+stride*i, evalPnts+3*i, paramValues+numDirs*i, &iter, &scr);
+            if (converged!=NULL){
+                converged[i] = (mxLogical)conv;
+            }
+            if (numIter!=NULL){
+                numIter[i] = (double)iter;
+            }
+        }
+
+        nrbScratchFree(&scr);
+    }
+
+    if (failed){
+        mexErrMsgTxt("Out of memory.");
+    }
+
+}
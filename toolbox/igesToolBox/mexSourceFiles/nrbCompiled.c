@@ -0,0 +1,237 @@
+
+/* Compiled NURBS, a parsed view of a NURBS and its derivatives */
+
+/* A compiled NURBS (output from nrbCompileIGES) is a double row vector:
+ *
+ *   [0]  magic number NRB_COMPILED_MAGIC
+ *   [1]  version (1)
+ *   [2]  number of parameters, 1 - curve, 2 - surface
+ *   [3]  number of nets, numNets
+ *   [4+7*k, ..., 10+7*k]  net k: orderU, orderV, ncp, kcp, offset knotU, offset knotV, offset coefs
+ *
+ * followed by the knot vectors and control points of every net, each block
+ * padded to a multiple of 4 doubles. Offsets are 0-based element offsets
+ * into the vector, offset knotV is -1 for curves. The nets are stored in
+ * the order nurbs, du, dv, duu, duv, dvv (surface) or nurbs, du, duu (curve),
+ * i.e. as returned by nrbDerivativesIGES. */
+
+#define NRB_COMPILED_MAGIC 1128419918.0
+#define NRB_MAXNETS 6
+#define NRB_MAXORDER 16
+
+/* Number of parameter values evaluated together in the batch evaluators */
+#define NRB_BLOCK 256
+
+/* Number of elements in the work array of NURBScurveDersEval and NURBSsurfaceDersEval for order m */
+#define NRB_DERSWORK(m) ((m)*(m)+10*(m))
+
+typedef struct {
+    int orderU, orderV;     /* orders, orderV is 0 for curves */
+    int ncp, kcp;           /* number of control points in u and v */
+    double *knotU, *knotV;  /* knot sequences */
+    double *coefs;          /* 4 x ncp x kcp homogeneous control points */
+} nrbNet;
+
+typedef struct {
+    int numDirs;            /* 1 - curve, 2 - surface */
+    int numNets;            /* number of nets in net */
+    nrbNet net[NRB_MAXNETS];
+} nrbCompiled;
+
+typedef struct {
+    double *leftU, *rightU, *NU, *leftV, *rightV, *NV;
+    double *ders;           /* work array for NURBScurveDersEval and NURBSsurfaceDersEval */
+    int hint[2];            /* knot spans in u and v of the last evaluated parameter value, for FindSpanHint */
+    double buffer[6*NRB_MAXORDER+NRB_DERSWORK(NRB_MAXORDER)];
+    double *heap;
+} nrbScratch;
+
+
+static int nrbIsCompiled(const mxArray *arr){
+    /* nrbIsCompiled returns 1 if arr is a compiled NURBS (output from nrbCompileIGES) */
+
+    if (arr==NULL || !mxIsDouble(arr) || mxGetNumberOfElements(arr)<4){
+        return 0;
+    }
+    return mxGetPr(arr)[0]==NRB_COMPILED_MAGIC;
+
+}
+
+
+static int nrbNetInArray(const double *net, int numDirs, int first, mwSize len){
+    /* nrbNetInArray returns 1 if the header of a net of a compiled NURBS is consistent and its knots and control points are within the array */
+
+    /* nrbNetInArray( net - pointer to the 7 header fields of the net, numDirs - number of parameters, first - 1 for the NURBS itself, 0 for a derivative net, len - number of elements of the compiled NURBS) */
+
+    double orderU = net[0], orderV = net[1], ncp = net[2], kcp = net[3];
+
+    if (!(ncp>=1.0 && kcp>=1.0 && net[4]>=0.0 && net[6]>=0.0 && net[6]+4.0*ncp*kcp<=(double)len)){
+        return 0;
+    }
+    if (numDirs==2 && !(net[5]>=0.0)){
+        return 0;
+    }
+    if (numDirs==1 && kcp!=1.0){
+        return 0;
+    }
+
+    /* Derivative nets of order < 1 are zero and their knots are never read */
+    if (orderU<1.0 || (numDirs==2 && orderV<1.0)){
+        return !first;
+    }
+    if (orderU>ncp || net[4]+ncp+orderU>(double)len){
+        return 0;
+    }
+    if (numDirs==2 && (orderV>kcp || net[5]+kcp+orderV>(double)len)){
+        return 0;
+    }
+    return 1;
+
+}
+
+
+static void nrbCompiledFromArray(const mxArray *arr, nrbCompiled *nrb){
+    /* nrbCompiledFromArray sets up the nets of nrb pointing into a compiled NURBS */
+
+    /* nrbCompiledFromArray( arr - compiled NURBS (output from nrbCompileIGES), nrb - pointer to compiled NURBS view) */
+
+    int k;
+    double *hdr = mxGetPr(arr), *net;
+    mwSize len = mxGetNumberOfElements(arr);
+
+    if (hdr[1]!=1.0){
+        mexErrMsgTxt("Unknown version of compiled NURBS, run nrbCompileIGES again.");
+    }
+    nrb->numDirs = (int)hdr[2];
+    nrb->numNets = (int)hdr[3];
+    if ((nrb->numDirs!=1 && nrb->numDirs!=2) || nrb->numNets<1 || nrb->numNets>NRB_MAXNETS || len<(mwSize)(4+7*nrb->numNets)){
+        mexErrMsgTxt("Corrupt compiled NURBS.");
+    }
+
+    for (k = 0; k < nrb->numNets; k++){
+        net = &hdr[4+7*k];
+        nrb->net[k].orderU = (int)net[0];
+        nrb->net[k].orderV = (int)net[1];
+        nrb->net[k].ncp = (int)net[2];
+        nrb->net[k].kcp = (int)net[3];
+        if (!nrbNetInArray(net, nrb->numDirs, k==0, len)){
+            mexErrMsgTxt("Corrupt compiled NURBS.");
+        }
+        nrb->net[k].knotU = hdr+(mwSize)net[4];
+        nrb->net[k].knotV = (net[5]<0) ? NULL : hdr+(mwSize)net[5];
+        nrb->net[k].coefs = hdr+(mwSize)net[6];
+    }
+
+}
+
+
+static void nrbNetFromStruct(const mxArray *nurbs, int numDirs, nrbNet *net){
+    /* nrbNetFromStruct sets up net pointing into a NURBS structure */
+
+    mxArray *knots = mxGetField(nurbs, 0, "knots");
+    mxArray *coefs = mxGetField(nurbs, 0, "coefs");
+    double *order = mxGetPr(mxGetField(nurbs, 0, "order"));
+
+    if (numDirs==2){
+        net->orderU = (int)order[0];
+        net->orderV = (int)order[1];
+        net->ncp = (int)mxGetDimensions(coefs)[1];
+        net->kcp = (mxGetNumberOfDimensions(coefs)>2) ? (int)mxGetDimensions(coefs)[2] : 1;
+        net->knotU = mxGetPr(mxGetCell(knots, 0));
+        net->knotV = mxGetPr(mxGetCell(knots, 1));
+    }
+    else{
+        net->orderU = (int)order[0];
+        net->orderV = 0;
+        net->ncp = (int)mxGetN(coefs);
+        net->kcp = 1;
+        net->knotU = mxIsCell(knots) ? mxGetPr(mxGetCell(knots, 0)) : mxGetPr(knots);
+        net->knotV = NULL;
+    }
+    net->coefs = mxGetPr(coefs);
+
+}
+
+
+static void nrbCompiledFromStruct(const mxArray *nurbs, const mxArray *dnurbs, const mxArray *d2nurbs, int numDirs, nrbCompiled *nrb){
+    /* nrbCompiledFromStruct sets up the nets of nrb pointing into NURBS structures */
+
+    /* nrbCompiledFromStruct( nurbs - NURBS structure, dnurbs - NURBS derivatives or NULL, d2nurbs - NURBS second derivatives or NULL, numDirs - number of parameters, nrb - pointer to compiled NURBS view) */
+
+    int k;
+
+    nrb->numDirs = numDirs;
+    nrb->numNets = 1;
+    nrbNetFromStruct(nurbs, numDirs, &nrb->net[0]);
+
+    if (dnurbs!=NULL){
+        if (numDirs==2){
+            for (k = 0; k < 2; k++){
+                nrbNetFromStruct(mxGetCell(dnurbs, k), 2, &nrb->net[1+k]);
+            }
+            nrb->numNets = 3;
+            if (d2nurbs!=NULL){
+                for (k = 0; k < 3; k++){
+                    nrbNetFromStruct(mxGetCell(d2nurbs, k), 2, &nrb->net[3+k]);
+                }
+                nrb->numNets = 6;
+            }
+        }
+        else{
+            nrbNetFromStruct(dnurbs, 1, &nrb->net[1]);
+            nrb->numNets = 2;
+            if (d2nurbs!=NULL){
+                nrbNetFromStruct(d2nurbs, 1, &nrb->net[2]);
+                nrb->numNets = 3;
+            }
+        }
+    }
+
+}
+
+
+static int nrbScratchInit(nrbScratch *scr, int orderU, int orderV){
+    /* nrbScratchInit sets up arrays for functions BasisFuns and DersBasisFuns, on the heap only for very high orders */
+
+    /* nrbScratchInit returns 0 if out of memory, then the arrays are too short for the orders and must not be used.
+     * It is called in parallel regions, so the caller raises the error after the region. */
+
+    int len = (orderU>orderV ? orderU : orderV)+1, ok = 1;
+    double *base;
+
+    scr->heap = NULL;
+    if (len>NRB_MAXORDER){
+        scr->heap = (double*) malloc((6*len+NRB_DERSWORK(len))*sizeof(double));
+        ok = (scr->heap!=NULL);
+    }
+    if (scr->heap!=NULL){
+        base = scr->heap;
+    }
+    else{
+        base = scr->buffer;
+        len = NRB_MAXORDER;
+    }
+    scr->leftU = base;
+    scr->rightU = base+len;
+    scr->NU = base+2*len;
+    scr->leftV = base+3*len;
+    scr->rightV = base+4*len;
+    scr->NV = base+5*len;
+    scr->ders = base+6*len;
+    scr->hint[0] = 0;
+    scr->hint[1] = 0;
+
+    return ok;
+
+}
+
+
+static void nrbScratchFree(nrbScratch *scr){
+    /* nrbScratchFree frees arrays allocated by nrbScratchInit */
+
+    if (scr->heap!=NULL){
+        free(scr->heap);
+        scr->heap = NULL;
+    }
+
+}
@@ -0,0 +1,19 @@
+/* nrbDersEval evaluates a compiled NURBS and its derivatives from basis function derivatives */
+
+/* nrbDersEval needs nrbCompiled, NURBScurveDersEval and NURBSsurfaceDersEval */
+
+static void nrbDersEval(const nrbCompiled *nrb, int nd, double *us, int nus, double **out, int nout, nrbScratch *scr){
+    /* nrbDersEval evaluates a NURBS and its derivatives from basis function derivatives, the derivative nets are not used */
+
+    /* nrbDersEval( nrb - pointer to compiled NURBS, nd - highest derivative order (0, 1 or 2), us - pointer to parameter values, nus - number of parameter values, out - pointers to evaluated points P, Pu, Pv, Puu, Puv, Pvv (surface) or P, Pu, Puu (curve) (3 x nus), nout - number of pointers in out, scr - pointer to arrays from nrbScratchInit) */
+
+    const nrbNet *net = &nrb->net[0];
+
+    if (nrb->numDirs==2){
+        NURBSsurfaceDersEval(net->orderU-1, net->orderV-1, net->coefs, net->ncp, net->kcp, net->knotU, net->knotV, nd, us, nus, out, nout, scr->ders, scr->hint);
+    }
+    else{
+        NURBScurveDersEval(net->orderU-1, net->coefs, net->ncp, net->knotU, nd, us, nus, out, nout, scr->ders, scr->hint);
+    }
+
+}
@@ -0,0 +1,185 @@
+
+/* nrbEvalBatch evaluates a compiled NURBS and its derivatives at many parameter values, in parallel if compiled with OpenMP */
+
+/* The parameter values are split into blocks of NRB_BLOCK values. Every thread has its own arrays for BasisFuns
+ * and its own work array (from nrbArena, kept between calls), and writes its blocks directly into the outputs. Each
+ * value is evaluated with the same arithmetic as in the serial case, so the result does not depend on the number of
+ * threads. */
+
+/* With derivative nets the homogeneous points of all nets of a block are evaluated first, and then P and its
+ * derivatives are computed point by point from the quotient rule and written once to the outputs, which are
+ * therefore not read back and need not be initialised. */
+
+/* nrbEvalBatch needs NURBScurveEval, NURBSsurfaceEval, nrbCompiled, nrbNetEval, nrbNetEval2, nrbDersEval, nrbOptions, nrbArena and nrbSortedEval */
+
+/* Number of elements in the work array of nrbEvalBlock */
+#define NRB_EVALWORK (4*NRB_MAXNETS*NRB_BLOCK)
+
+
+static int nrbUseDers(const nrbCompiled *nrb, int nout){
+    /* nrbUseDers returns 1 if the derivatives must be evaluated from basis function derivatives, i.e. the derivative nets are missing */
+
+    int numFullNets = (nrb->numDirs==2) ? 6 : 3;
+
+    return (nout>1 && nrb->numNets<2) || (nout>1+nrb->numDirs && nrb->numNets<numFullNets);
+
+}
+
+
+static void nrbEvalBlock(const nrbCompiled *nrb, int nout, double *UV, int nus, double *out[6], double *work, nrbScratch *scr){
+    /* nrbEvalBlock evaluates at most NRB_BLOCK parameter values */
+
+    /* nrbEvalBlock( nrb - pointer to compiled NURBS, nout - number of outputs (P, Pu, Pv, Puu, Puv, Pvv for surfaces, P, Pu, Puu for curves), UV - pointer to parameter values, nus - number of parameter values, out - pointers to outputs (3 x nus), work - pointer to work array (NRB_EVALWORK elements), scr - pointer to arrays for functions BasisFuns and DersBasisFuns) */
+
+    int i, j, k;
+    double rw, w[6], S[6][3], *Aw[6], *pnt;
+
+    if (nrbUseDers(nrb, nout)){
+        nrbDersEval(nrb, (nout>1+nrb->numDirs) ? 2 : 1, UV, nus, out, nout, scr);
+        return;
+    }
+
+    if (nout==1){
+        if (nrb->numDirs==1){
+            NURBScurveEval(nrb->net[0].orderU-1, nrb->net[0].coefs, nrb->net[0].ncp, nrb->net[0].knotU, UV, nus, out[0], scr->leftU, scr->rightU, scr->NU);
+            return;
+        }
+        if (nrb->net[0].orderU<2 || nrb->net[0].orderU>4 || nrb->net[0].orderV<2 || nrb->net[0].orderV>4){
+            /* Degrees without a specialised version of BspEval2 */
+            NURBSsurfaceEval(nrb->net[0].orderU-1, nrb->net[0].orderV-1, nrb->net[0].coefs, nrb->net[0].ncp, nrb->net[0].kcp, nrb->net[0].knotU, nrb->net[0].knotV, UV, nus, out[0], scr->leftU, scr->rightU, scr->NU, scr->leftV, scr->rightV, scr->NV);
+            return;
+        }
+    }
+
+    /* Homogeneous points of the nets, Aw[k] (4 x nus). Nets of order < 1 give zero, the rational derivatives still depend on the lower ones. */
+    for (k = 0; k < nout; k++){
+        Aw[k] = work+4*NRB_BLOCK*k;
+        if (nrb->numDirs==2){
+            nrbNetEval2(&nrb->net[k], UV, nus, Aw[k], scr);
+        }
+        else{
+            nrbNetEval(&nrb->net[k], UV, nus, Aw[k], scr);
+        }
+    }
+
+    for (j = 0; j < nus; j++){
+
+        for (k = 0; k < nout; k++){
+            w[k] = Aw[k][4*j+3];
+        }
+        rw = 1.0/w[0];
+
+        pnt = &Aw[0][4*j];
+        for (i = 0; i < 3; i++){
+            S[0][i] = pnt[i]*rw;
+        }
+
+        if (nrb->numDirs==2){
+            if (nout>1){
+                pnt = &Aw[1][4*j];
+                for (i = 0; i < 3; i++){
+                    S[1][i] = (pnt[i]-w[1]*S[0][i])*rw;
+                }
+            }
+            if (nout>2){
+                pnt = &Aw[2][4*j];
+                for (i = 0; i < 3; i++){
+                    S[2][i] = (pnt[i]-w[2]*S[0][i])*rw;
+                }
+            }
+            if (nout>3){
+                pnt = &Aw[3][4*j];
+                for (i = 0; i < 3; i++){
+                    S[3][i] = (pnt[i]-2*w[1]*S[1][i]-w[3]*S[0][i])*rw;
+                }
+            }
+            if (nout>4){
+                pnt = &Aw[4][4*j];
+                for (i = 0; i < 3; i++){
+                    S[4][i] = (pnt[i]-w[1]*S[2][i]-w[2]*S[1][i]-w[4]*S[0][i])*rw;
+                }
+            }
+            if (nout>5){
+                pnt = &Aw[5][4*j];
+                for (i = 0; i < 3; i++){
+                    S[5][i] = (pnt[i]-2*w[2]*S[2][i]-w[5]*S[0][i])*rw;
+                }
+            }
+        }
+        else{
+            if (nout>1){
+                pnt = &Aw[1][4*j];
+                for (i = 0; i < 3; i++){
+                    S[1][i] = (pnt[i]-w[1]*S[0][i])*rw;
+                }
+            }
+            if (nout>2){
+                pnt = &Aw[2][4*j];
+                for (i = 0; i < 3; i++){
+                    S[2][i] = (pnt[i]-2*w[1]*S[1][i]-w[2]*S[0][i])*rw;
+                }
+            }
+        }
+
+        for (k = 0; k < nout; k++){
+            for (i = 0; i < 3; i++){
+                out[k][3*j+i] = S[k][i];
+            }
+        }
+
+    }
+
+}
+
+
+static void nrbEvalBatch(const nrbCompiled *nrb, int nout, double *UV, int nus, double *out[6], int numThreads){
+    /* nrbEvalBatch evaluates a compiled NURBS and its derivatives at given parameter values */
+
+    /* nrbEvalBatch( nrb - pointer to compiled NURBS, nout - number of outputs, UV - pointer to parameter values, nus - number of parameter values, out - pointers to outputs (3 x nus), numThreads - number of threads) */
+
+    int numBlocks = (nus+NRB_BLOCK-1)/NRB_BLOCK, failed = 0;
+
+    if (nout==1 && nrb->numDirs==2 && nrbSortedEval(&nrb->net[0], UV, nus, out[0], numThreads)){
+        return;
+    }
+
+    nrbArenaReserveThreads(numThreads, NRB_EVALWORK*sizeof(double));
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads) if(numThreads>1)
+#endif
+    {
+        int b, k, first, num;
+        double *outb[6], *work;
+        int ok;
+        nrbScratch scr;
+
+        work = (double*) nrbArenaThread();
+        ok = nrbScratchInit(&scr, nrb->net[0].orderU, nrb->net[0].orderV);
+        if (!ok){
+            failed = 1;
+        }
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+        for (b = 0; b < numBlocks; b++){
+            if (!ok){
+                continue;
+            }
+            first = b*NRB_BLOCK;
+            num = (nus-first<NRB_BLOCK) ? nus-first : NRB_BLOCK;
+            for (k = 0; k < nout; k++){
+                outb[k] = out[k]+3*first;
+            }
+            nrbEvalBlock(nrb, nout, UV+nrb->numDirs*first, num, outb, work, &scr);
+        }
+
+        nrbScratchFree(&scr);
+    }
+
+    if (failed){
+        mexErrMsgTxt("Out of memory.");
+    }
+
+}
@@ -0,0 +1,309 @@
+/* nrbEvalSingle evaluates a compiled NURBS in single precision, or in double precision with outputs in single precision */
+
+/* 'single': the control points are rounded to single precision once per call, and the basis functions and the sums over
+ * the control points are computed in single precision. A homogeneous control point (x,y,z,w) is then 4 floats, i.e. one
+ * 128 bit SSE vector. The time goes mostly to the knot spans, the divisions in the basis functions and the loads of the
+ * control points, not to the sums, so this is only slightly faster than double precision; the gain of 'single' is the
+ * memory of the outputs. The knot differences u-U[i]
+ * are computed in double precision before they are rounded, so that large parameter values do not lose accuracy. Only
+ * P is evaluated in single precision, when derivatives are requested the evaluation is the same as for 'mixed'.
+ * 'mixed': the NURBS is evaluated in double precision with nrbEvalBlock, into a work array of every thread, and the
+ * results are rounded to single precision. */
+
+/* nrbEvalSingle needs FindSpanHint, BspEval2Fixed (for BSPFIXED_UNROLL), nrbCompiled, nrbArena and nrbEvalBatch */
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+
+static void BasisFunsSingle(int i, double u, int p, double *U, float *N, float *left, float *right) {
+    /* Modification of ALGORITHM A2.2, The NURBS Book, L.Piegl and W. Tiller */
+    /* Compute the nonvanishing basis functions in single precision */
+    /* Input: i,u,p,U */
+    /* Output: N */
+    /* Arrays: left (p+1), right (p+1) */
+
+    int j, r;
+    float saved, temp;
+
+    N[0] = 1.0f;
+    for (j = 1; j <= p; j++) {
+        left[j]  = (float)(u - U[i+1-j]);
+        right[j] = (float)(U[i+j] - u);
+        saved = 0.0f;
+        for (r = 0; r < j; r++) {
+            temp = N[r] / (right[r+1] + left[j-r]);
+            N[r] = saved + right[r+1] * temp;
+            saved = left[j-r] * temp;
+        }
+        N[j] = saved;
+    }
+
+}
+
+
+static void nrbAccumSingle(float *acc, float N, const float *pnt){
+    /* nrbAccumSingle adds N times the homogeneous point pnt to acc (4 floats) */
+
+#ifdef __SSE__
+    _mm_storeu_ps(acc, _mm_add_ps(_mm_loadu_ps(acc), _mm_mul_ps(_mm_set1_ps(N), _mm_loadu_ps(pnt))));
+#else
+    acc[0] += N * pnt[0];
+    acc[1] += N * pnt[1];
+    acc[2] += N * pnt[2];
+    acc[3] += N * pnt[3];
+#endif
+
+}
+
+
+static void NURBScurveEvalSingle(int deg, float *cp, int ncp, double *knot, double *us, int nus, float *ep, float *N, float *left, float *right, int *hint){
+    /* Modification of  ALGORITHM A4.1, The NURBS Book, L.Piegl and W. Tiller */
+
+    /* Evaluates a NURBS curve at given parameter values in single precision */
+
+    /* NURBScurveEvalSingle( deg - degree of NURBS, cp - pointer to control points in single precision, ncp - number of control points, knot - pointer to knot sequence, us - pointer to parameter values, nus - number of parameter values, ep - pointer to evaluated points (3 x nus), N, left, right - pointers to arrays for function BasisFunsSingle, hint - pointer to knot span of a previous parameter value, updated) */
+
+    int j, jj, span;
+    double u;
+    float acc[4];
+
+    for (jj = 0; jj < nus; jj++){
+
+        u = us[jj];
+        if(u<=knot[deg]){
+            u = knot[deg];
+        }
+        else if(u>=knot[ncp]){
+            u = knot[ncp];
+        }
+
+        span = FindSpanHint(ncp, deg, u, knot, hint);
+        BasisFunsSingle(span, u, deg, knot, N, left, right);
+
+        acc[0] = acc[1] = acc[2] = acc[3] = 0.0f;
+        for (j = 0; j <= deg; j++){
+            nrbAccumSingle(acc, N[j], &cp[(span-deg+j)*4]);
+        }
+
+        ep[jj*3] = acc[0]/acc[3];
+        ep[jj*3+1] = acc[1]/acc[3];
+        ep[jj*3+2] = acc[2]/acc[3];
+
+    }
+
+}
+
+
+static void NURBSsurfaceEvalSingle(int degU, int degV, float *cp, int ncp, int kcp, double *knotU, double *knotV, double *us, int nus, float *ep, float *NU, float *NV, float *left, float *right, int *hint){
+    /* Modification of  ALGORITHM A4.3, The NURBS Book, L.Piegl and W. Tiller */
+
+    /* Evaluates a NURBS surface at given parameter values in single precision */
+
+    /* NURBSsurfaceEvalSingle( degU - degree of NURBS in u, degV - degree of NURBS in v, cp - pointer to control points in single precision, ncp - number of control points in u, kcp - number of control points in v, knotU - pointer to knot sequence in u, knotV - pointer to knot sequence in v, us - pointer to parameter values, nus - number of parameter values, ep - pointer to evaluated points (3 x nus), NU, NV, left, right - pointers to arrays for function BasisFunsSingle, hint - pointer to knot spans in u and v of a previous parameter value, updated) */
+
+    int i, j, jj, spanU, spanV;
+    double u, v;
+    float acc[4], row[4];
+
+    for (jj = 0; jj < nus; jj++){
+
+        u = us[2*jj];
+        if(u<=knotU[degU]){
+            u = knotU[degU];
+        }
+        else if(u>=knotU[ncp]){
+            u = knotU[ncp];
+        }
+        v = us[2*jj+1];
+        if(v<=knotV[degV]){
+            v = knotV[degV];
+        }
+        else if(v>=knotV[kcp]){
+            v = knotV[kcp];
+        }
+
+        spanU = FindSpanHint(ncp, degU, u, knotU, &hint[0]);
+        BasisFunsSingle(spanU, u, degU, knotU, NU, left, right);
+        spanV = FindSpanHint(kcp, degV, v, knotV, &hint[1]);
+        BasisFunsSingle(spanV, v, degV, knotV, NV, left, right);
+
+        acc[0] = acc[1] = acc[2] = acc[3] = 0.0f;
+        for (i = 0; i <= degV; i++){
+            row[0] = row[1] = row[2] = row[3] = 0.0f;
+            for (j = 0; j <= degU; j++){
+                nrbAccumSingle(row, NU[j], &cp[(i+spanV-degV)*4*ncp+(j+spanU-degU)*4]);
+            }
+            nrbAccumSingle(acc, NV[i], row);
+        }
+
+        ep[jj*3] = acc[0]/acc[3];
+        ep[jj*3+1] = acc[1]/acc[3];
+        ep[jj*3+2] = acc[2]/acc[3];
+
+    }
+
+}
+
+
+/* NRBSINGLEFIXED(DU,DV) defines NURBSsurfaceEvalSingle<DU><DV>, NURBSsurfaceEvalSingle for constant degrees DU and DV, see BspEval2Fixed */
+#define NRBSINGLEFIXED(DU, DV) \
+static void NURBSsurfaceEvalSingle##DU##DV(float *cp, int ncp, int kcp, double *knotU, double *knotV, double *us, int nus, float *ep, int *hint){ \
+    \
+    int i, j, jj, spanU, spanV; \
+    double u, v; \
+    float acc[4], row[4], NU[DU+1], NV[DV+1], left[4], right[4]; \
+    \
+    for (jj = 0; jj < nus; jj++){ \
+        \
+        u = us[2*jj]; \
+        if(u<=knotU[DU]){ \
+            u = knotU[DU]; \
+        } \
+        else if(u>=knotU[ncp]){ \
+            u = knotU[ncp]; \
+        } \
+        v = us[2*jj+1]; \
+        if(v<=knotV[DV]){ \
+            v = knotV[DV]; \
+        } \
+        else if(v>=knotV[kcp]){ \
+            v = knotV[kcp]; \
+        } \
+        \
+        spanU = FindSpanHint(ncp, DU, u, knotU, &hint[0]); \
+        BasisFunsSingle(spanU, u, DU, knotU, NU, left, right); \
+        spanV = FindSpanHint(kcp, DV, v, knotV, &hint[1]); \
+        BasisFunsSingle(spanV, v, DV, knotV, NV, left, right); \
+        \
+        acc[0] = acc[1] = acc[2] = acc[3] = 0.0f; \
+        BSPFIXED_UNROLL \
+        for (i = 0; i <= DV; i++){ \
+            row[0] = row[1] = row[2] = row[3] = 0.0f; \
+            BSPFIXED_UNROLL \
+            for (j = 0; j <= DU; j++){ \
+                nrbAccumSingle(row, NU[j], &cp[(i+spanV-DV)*4*ncp+(j+spanU-DU)*4]); \
+            } \
+            nrbAccumSingle(acc, NV[i], row); \
+        } \
+        \
+        ep[jj*3] = acc[0]/acc[3]; \
+        ep[jj*3+1] = acc[1]/acc[3]; \
+        ep[jj*3+2] = acc[2]/acc[3]; \
+        \
+    } \
+    \
+}
+
+NRBSINGLEFIXED(1, 1)
+NRBSINGLEFIXED(1, 2)
+NRBSINGLEFIXED(1, 3)
+NRBSINGLEFIXED(2, 1)
+NRBSINGLEFIXED(2, 2)
+NRBSINGLEFIXED(2, 3)
+NRBSINGLEFIXED(3, 1)
+NRBSINGLEFIXED(3, 2)
+NRBSINGLEFIXED(3, 3)
+
+typedef void (*NURBSsurfaceEvalSingleFixedFun)(float*, int, int, double*, double*, double*, int, float*, int*);
+
+static const NURBSsurfaceEvalSingleFixedFun NURBSsurfaceEvalSingleTable[3][3] = {
+    {NURBSsurfaceEvalSingle11, NURBSsurfaceEvalSingle12, NURBSsurfaceEvalSingle13},
+    {NURBSsurfaceEvalSingle21, NURBSsurfaceEvalSingle22, NURBSsurfaceEvalSingle23},
+    {NURBSsurfaceEvalSingle31, NURBSsurfaceEvalSingle32, NURBSsurfaceEvalSingle33}
+};
+
+
+static void nrbEvalBatchSingle(const nrbCompiled *nrb, int nout, double *UV, int nus, float *out[6], int precision, int numThreads){
+    /* nrbEvalBatchSingle evaluates a compiled NURBS and its derivatives at given parameter values, with outputs in single precision */
+
+    /* nrbEvalBatchSingle( nrb - pointer to compiled NURBS, nout - number of outputs, UV - pointer to parameter values, nus - number of parameter values, out - pointers to outputs (3 x nus), precision - NRB_SINGLE or NRB_MIXED, numThreads - number of threads) */
+
+    const nrbNet *net = &nrb->net[0];
+    int k, numBlocks = (nus+NRB_BLOCK-1)/NRB_BLOCK, numCoefs, failed = 0;
+    float *cpf;
+
+    /* Degree 0 is evaluated as in NURBSsurfaceEval and NURBScurveEval, in double precision */
+    if (precision==NRB_SINGLE && nout==1 && net->orderU>1 && net->orderU<=NRB_MAXORDER && (nrb->numDirs==1 || (net->orderV>1 && net->orderV<=NRB_MAXORDER))){
+
+        numCoefs = 4*net->ncp*net->kcp;
+        cpf = (float*) nrbArenaReserve(0, numCoefs*sizeof(float)+1);
+        for (k = 0; k < numCoefs; k++){
+            cpf[k] = (float)net->coefs[k];
+        }
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads) if(numThreads>1)
+#endif
+        {
+            int b, first, num, hint[2] = {0, 0};
+            float NU[NRB_MAXORDER], NV[NRB_MAXORDER], left[NRB_MAXORDER], right[NRB_MAXORDER];
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+            for (b = 0; b < numBlocks; b++){
+                first = b*NRB_BLOCK;
+                num = (nus-first<NRB_BLOCK) ? nus-first : NRB_BLOCK;
+                if (nrb->numDirs==2 && net->orderU<=4 && net->orderV<=4){
+                    NURBSsurfaceEvalSingleTable[net->orderU-2][net->orderV-2](cpf, net->ncp, net->kcp, net->knotU, net->knotV, UV+2*first, num, out[0]+3*first, hint);
+                }
+                else if (nrb->numDirs==2){
+                    NURBSsurfaceEvalSingle(net->orderU-1, net->orderV-1, cpf, net->ncp, net->kcp, net->knotU, net->knotV, UV+2*first, num, out[0]+3*first, NU, NV, left, right, hint);
+                }
+                else{
+                    NURBScurveEvalSingle(net->orderU-1, cpf, net->ncp, net->knotU, UV+first, num, out[0]+3*first, NU, left, right, hint);
+                }
+            }
+        }
+
+        return;
+
+    }
+
+    /* Evaluated in double precision, one block in the work array of the thread */
+    nrbArenaReserveThreads(numThreads, (NRB_EVALWORK+3*NRB_MAXNETS*NRB_BLOCK)*sizeof(double));
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads) if(numThreads>1)
+#endif
+    {
+        int b, i, kk, first, num, ok;
+        double *outb[6], *work;
+        nrbScratch scr;
+
+        work = (double*) nrbArenaThread();
+        for (kk = 0; kk < nout; kk++){
+            outb[kk] = work+NRB_EVALWORK+3*NRB_BLOCK*kk;
+        }
+        ok = nrbScratchInit(&scr, net->orderU, net->orderV);
+        if (!ok){
+            failed = 1;
+        }
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+        for (b = 0; b < numBlocks; b++){
+            if (!ok){
+                continue;
+            }
+            first = b*NRB_BLOCK;
+            num = (nus-first<NRB_BLOCK) ? nus-first : NRB_BLOCK;
+            nrbEvalBlock(nrb, nout, UV+nrb->numDirs*first, num, outb, work, &scr);
+            for (kk = 0; kk < nout; kk++){
+                for (i = 0; i < 3*num; i++){
+                    out[kk][3*first+i] = (float)outb[kk][i];
+                }
+            }
+        }
+
+        nrbScratchFree(&scr);
+    }
+
+    if (failed){
+        mexErrMsgTxt("Out of memory.");
+    }
+
+}
@@ -0,0 +1,155 @@
+
+/* nrbGridEval evaluates a compiled NURBS surface and its derivatives on a tensor grid of parameter values */
+
+/* The basis functions (and derivatives) are computed once per u-value and once per v-value. For every v-value the
+ * control net is contracted in v to one row of homogeneous points (and v-derivatives), which is then contracted in u
+ * for all u-values. The grid is evaluated in the same order as [V,U]=meshgrid(v,u); UV=[U(:)';V(:)'], i.e. u runs
+ * fastest, and the v-values are split between threads. */
+
+/* nrbGridEval needs DersBasisFuns, FindSpanHint, nrbCompiled, nrbOptions and nrbArena */
+
+
+static void nrbGridBasis(int deg, int ncp, double *knot, int nd, double *us, int nus, int *span, double *ders, nrbScratch *scr){
+    /* nrbGridBasis computes the knot span and basis function derivatives for every parameter value */
+
+    /* nrbGridBasis( deg - degree, ncp - number of control points, knot - pointer to knot sequence, nd - highest derivative order, us - pointer to parameter values, nus - number of parameter values, span - pointer to knot span indices (nus), ders - pointer to basis function derivatives ((nd+1)*(deg+1) x nus), scr - pointer to arrays from nrbScratchInit) */
+
+    int jj, m = deg+1, hint = 0;
+    double u, *ndu = scr->ders, *a = ndu+m*m, *left = a+2*m, *right = left+m;
+
+    for (jj = 0; jj < nus; jj++){
+        u = us[jj];
+        if(u<=knot[deg]){
+            u = knot[deg];
+        }
+        else if(u>=knot[ncp]){
+            u = knot[ncp];
+        }
+        span[jj] = FindSpanHint(ncp, deg, u, knot, &hint);
+        DersBasisFuns(span[jj], u, deg, nd, knot, &ders[jj*(nd+1)*m], ndu, a, left, right);
+    }
+
+}
+
+
+static void nrbGridEval(const nrbCompiled *nrb, int nout, double *us, int nu, double *vs, int nv, double **out, float **outf, int numThreads){
+    /* nrbGridEval evaluates a compiled NURBS surface and its derivatives on a tensor grid */
+
+    /* nrbGridEval( nrb - pointer to compiled NURBS surface, nout - number of outputs (P, Pu, Pv, Puu, Puv, Pvv), us - pointer to u-values, nu - number of u-values, vs - pointer to v-values, nv - number of v-values, out - pointers to outputs (3 x nu*nv), outf - pointers to outputs in single precision (3 x nu*nv), used instead of out if not NULL, numThreads - number of threads) */
+
+    const nrbNet *net = &nrb->net[0];
+    int degU = net->orderU-1, degV = net->orderV-1, ncp = net->ncp;
+    int nd = (nout>3) ? 2 : ((nout>1) ? 1 : 0);
+    int *spanU, *spanV;
+    double *dersU, *dersV;
+    nrbScratch scr;
+
+    /* dersU, dersV and spanU, spanV in slot 0 of the arena, the rows of the threads in their own slots */
+    dersU = (double*) nrbArenaReserve(0, ((nd+1)*(degU+1)*nu+(nd+1)*(degV+1)*nv)*sizeof(double)+(nu+nv)*sizeof(int)+1);
+    dersV = dersU+(nd+1)*(degU+1)*nu;
+    spanU = (int*) (dersV+(nd+1)*(degV+1)*nv);
+    spanV = spanU+nu;
+    nrbArenaReserveThreads(numThreads, (nd+1)*4*ncp*sizeof(double));
+
+    if (!nrbScratchInit(&scr, net->orderU, net->orderV)){
+        mexErrMsgTxt("Out of memory.");
+    }
+    nrbGridBasis(degU, ncp, net->knotU, nd, us, nu, spanU, dersU, &scr);
+    nrbGridBasis(degV, net->kcp, net->knotV, nd, vs, nv, spanV, dersV, &scr);
+    nrbScratchFree(&scr);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads) if(numThreads>1)
+#endif
+    {
+        int i, j, k, r, s, ii, ind, ind2, kk;
+        double wgh, Aw[6][4], S[6][3], *dU, *dV, *row, *pnt, *rowPnt;
+
+        /* row[kv*4*ncp+4*col+ii], homogeneous control points of column col contracted with the kv:th v-derivative */
+        row = (double*) nrbArenaThread();
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+        for (j = 0; j < nv; j++){
+
+            dV = &dersV[j*(nd+1)*(degV+1)];
+            ind2 = spanV[j]-degV;
+
+            for (k = 0; k < (nd+1)*4*ncp; k++){
+                row[k] = 0.0;
+            }
+            for (s = 0; s <= degV; s++){
+                pnt = &net->coefs[(ind2+s)*4*ncp];
+                for (k = 0; k <= nd; k++){
+                    for (ii = 0; ii < 4*ncp; ii++){
+                        row[k*4*ncp+ii] += dV[k*(degV+1)+s] * pnt[ii];
+                    }
+                }
+            }
+
+            for (i = 0; i < nu; i++){
+
+                dU = &dersU[i*(nd+1)*(degU+1)];
+                ind = spanU[i]-degU;
+
+                for (k = 0; k < 6; k++){
+                    for (ii = 0; ii < 4; ii++){
+                        Aw[k][ii] = 0.0;
+                    }
+                }
+
+                /* Aw[0] = A, Aw[1] = A_u, Aw[2] = A_v, Aw[3] = A_uu, Aw[4] = A_uv, Aw[5] = A_vv of the homogeneous B-spline */
+                for (r = 0; r <= degU; r++){
+                    rowPnt = &row[4*(ind+r)];
+                    for (ii = 0; ii < 4; ii++){
+                        Aw[0][ii] += dU[r] * rowPnt[ii];
+                    }
+                    if(nd>0){
+                        for (ii = 0; ii < 4; ii++){
+                            Aw[1][ii] += dU[(degU+1)+r] * rowPnt[ii];
+                            Aw[2][ii] += dU[r] * rowPnt[4*ncp+ii];
+                        }
+                    }
+                    if(nd>1){
+                        for (ii = 0; ii < 4; ii++){
+                            Aw[3][ii] += dU[2*(degU+1)+r] * rowPnt[ii];
+                            Aw[4][ii] += dU[(degU+1)+r] * rowPnt[4*ncp+ii];
+                            Aw[5][ii] += dU[r] * rowPnt[8*ncp+ii];
+                        }
+                    }
+                }
+
+                wgh = Aw[0][3];
+                for (ii = 0; ii < 3; ii++){
+                    S[0][ii] = Aw[0][ii]/wgh;
+                    if(nd>0){
+                        S[1][ii] = (Aw[1][ii]-Aw[1][3]*S[0][ii])/wgh;
+                        S[2][ii] = (Aw[2][ii]-Aw[2][3]*S[0][ii])/wgh;
+                    }
+                    if(nd>1){
+                        S[3][ii] = (Aw[3][ii]-2*Aw[1][3]*S[1][ii]-Aw[3][3]*S[0][ii])/wgh;
+                        S[4][ii] = (Aw[4][ii]-Aw[1][3]*S[2][ii]-Aw[2][3]*S[1][ii]-Aw[4][3]*S[0][ii])/wgh;
+                        S[5][ii] = (Aw[5][ii]-2*Aw[2][3]*S[2][ii]-Aw[5][3]*S[0][ii])/wgh;
+                    }
+                }
+
+                kk = 3*(i+nu*j);
+                for (k = 0; k < nout; k++){
+                    for (ii = 0; ii < 3; ii++){
+                        if (outf!=NULL){
+                            outf[k][kk+ii] = (float)S[k][ii];
+                        }
+                        else{
+                            out[k][kk+ii] = S[k][ii];
+                        }
+                    }
+                }
+
+            }
+
+        }
+
+    }
+
+}
@@ -0,0 +1,20 @@
+/* nrbNetEval evaluates the B-spline curve of a net of a compiled NURBS */
+
+/* nrbNetEval needs nrbCompiled and BspEval */
+
+static void nrbNetEval(const nrbNet *net, double *us, int nus, double *ep, nrbScratch *scr){
+    /* nrbNetEval evaluates the B-spline curve of a net at given parameter values, ep is zero for nets of order < 1 */
+
+    /* nrbNetEval( net - pointer to net, us - pointer to parameter values, nus - number of parameter values, ep - pointer to evaluated points (4 x nus), scr - pointer to arrays for function BasisFuns) */
+
+    int jj;
+
+    if (net->orderU<1){
+        for (jj = 0; jj < 4*nus; jj++){
+            ep[jj] = 0.0;
+        }
+        return;
+    }
+    BspEval(net->orderU-1, net->coefs, 4, net->ncp, net->knotU, us, nus, ep, scr->leftU, scr->rightU, scr->NU);
+
+}
@@ -0,0 +1,23 @@
+/* nrbNetEval2 evaluates the B-spline surface of a net of a compiled NURBS */
+
+/* nrbNetEval2 needs nrbCompiled, BspEval2 and BspEval2Fixed */
+
+static void nrbNetEval2(const nrbNet *net, double *us, int nus, double *ep, nrbScratch *scr){
+    /* nrbNetEval2 evaluates the B-spline surface of a net at given parameter values (u,v), ep is zero for nets of order < 1 */
+
+    /* nrbNetEval2( net - pointer to net, us - pointer to parameter values, nus - number of parameter values, ep - pointer to evaluated points (4 x nus), scr - pointer to arrays for function BasisFuns) */
+
+    int jj;
+
+    if (net->orderU<1 || net->orderV<1){
+        for (jj = 0; jj < 4*nus; jj++){
+            ep[jj] = 0.0;
+        }
+        return;
+    }
+    if (BspEval2Fixed(net->orderU-1, net->orderV-1, net->coefs, net->ncp, net->kcp, net->knotU, net->knotV, us, nus, ep, scr->leftU, scr->rightU, scr->NU, scr->leftV, scr->rightV, scr->NV, scr->hint)){
+        return;
+    }
+    BspEval2(net->orderU-1, net->orderV-1, net->coefs, 4, net->ncp, net->kcp, net->knotU, net->knotV, us, nus, ep, scr->leftU, scr->rightU, scr->NU, scr->leftV, scr->rightV, scr->NV);
+
+}
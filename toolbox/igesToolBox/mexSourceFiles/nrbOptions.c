@@ -0,0 +1,150 @@
+
+/* Options given as trailing string/value pairs to the mex functions, e.g. nrbevalIGES(srf,UV,'threads',4) */
+
+/* 'threads' is used by nrbevalIGES, closestNrbLinePointIGES, nrbBvhIGES, parseIGES, nrbArcLengthIGES and nrbRayIGES, 'seeds' and
+ * 'method' by closestNrbLinePointIGES and nrbBvhIGES, 'precision' by nrbevalIGES, 'hits' by nrbRayIGES */
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* Values of option 'precision' */
+#define NRB_DOUBLE 0        /* evaluated and returned in double precision */
+#define NRB_SINGLE 1        /* evaluated and returned in single precision */
+#define NRB_MIXED 2         /* evaluated in double precision, returned in single precision */
+
+/* Values of option 'method' */
+#define NRB_TRUST 0         /* projected Newton method with trust region */
+#define NRB_NEWTON 1        /* damped Newton method */
+
+typedef struct {
+    int numThreads;         /* number of threads, 1 - serial */
+    int numSeeds;           /* number of start values per closest point */
+    int precision;          /* NRB_DOUBLE, NRB_SINGLE or NRB_MIXED */
+    int maxHits;            /* maximum number of hits per ray, 0 - all */
+    int method;             /* NRB_TRUST or NRB_NEWTON, closest point method */
+} nrbOptions;
+
+
+static int nrbMaxThreads(void){
+    /* nrbMaxThreads returns the number of threads used by default */
+
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+
+}
+
+
+static int nrbParseOptions(int nrhs, const mxArray *prhs[], int first, nrbOptions *opt){
+    /* nrbParseOptions reads string/value pairs from prhs[first], ..., returns the number of inputs before the first option */
+
+    /* nrbParseOptions( nrhs - number of inputs, prhs - inputs, first - index of first input that may be an option, opt - pointer to options) */
+
+    int k, nargs;
+    char name[32], value[32];
+
+    opt->numThreads = nrbMaxThreads();
+    opt->numSeeds = 1;
+    opt->precision = NRB_DOUBLE;
+    opt->maxHits = 0;
+    opt->method = NRB_NEWTON;
+
+    nargs = nrhs;
+    for (k = first; k < nrhs; k++){
+        if (mxIsChar(prhs[k])){
+            nargs = k;
+            break;
+        }
+    }
+
+    for (k = nargs; k < nrhs; k += 2){
+        if (!mxIsChar(prhs[k]) || mxGetString(prhs[k], name, sizeof(name))!=0){
+            mexErrMsgTxt("Options must be given as string/value pairs.");
+        }
+        if (k+1>=nrhs){
+            mexErrMsgTxt("Options must be given as string/value pairs.");
+        }
+        if (strcmp(name, "precision")==0){
+            if (!mxIsChar(prhs[k+1]) || mxGetString(prhs[k+1], value, sizeof(value))!=0){
+                mexErrMsgTxt("Precision must be 'double', 'single' or 'mixed'.");
+            }
+            if (strcmp(value, "double")==0){
+                opt->precision = NRB_DOUBLE;
+            }
+            else if (strcmp(value, "single")==0){
+                opt->precision = NRB_SINGLE;
+            }
+            else if (strcmp(value, "mixed")==0){
+                opt->precision = NRB_MIXED;
+            }
+            else{
+                mexErrMsgTxt("Precision must be 'double', 'single' or 'mixed'.");
+            }
+            continue;
+        }
+        if (strcmp(name, "method")==0){
+            if (!mxIsChar(prhs[k+1]) || mxGetString(prhs[k+1], value, sizeof(value))!=0){
+                mexErrMsgTxt("Method must be 'trust' or 'newton'.");
+            }
+            if (strcmp(value, "trust")==0){
+                opt->method = NRB_TRUST;
+            }
+            else if (strcmp(value, "newton")==0){
+                opt->method = NRB_NEWTON;
+            }
+            else{
+                mexErrMsgTxt("Method must be 'trust' or 'newton'.");
+            }
+            continue;
+        }
+        if (!mxIsNumeric(prhs[k+1]) || mxGetNumberOfElements(prhs[k+1])!=1){
+            mexErrMsgTxt("Options must be given as string/value pairs.");
+        }
+        if (strcmp(name, "threads")==0){
+            opt->numThreads = (int)mxGetScalar(prhs[k+1]);
+            if (opt->numThreads<1){
+                opt->numThreads = nrbMaxThreads();
+            }
+        }
+        else if (strcmp(name, "seeds")==0){
+            opt->numSeeds = (int)mxGetScalar(prhs[k+1]);
+            if (opt->numSeeds<1){
+                mexErrMsgTxt("Number of seeds must be at least 1.");
+            }
+        }
+        else if (strcmp(name, "hits")==0){
+            opt->maxHits = (int)mxGetScalar(prhs[k+1]);
+            if (opt->maxHits<0){
+                mexErrMsgTxt("Number of hits must be at least 0.");
+            }
+        }
+        else{
+            mexErrMsgTxt("Unknown option.");
+        }
+    }
+
+    return nargs;
+
+}
+
+
+static int nrbNumThreads(const nrbOptions *opt, int numBlocks){
+    /* nrbNumThreads returns the number of threads to use for numBlocks independent blocks */
+
+    int numThreads = opt->numThreads;
+
+#ifndef _OPENMP
+    numThreads = 1;
+#endif
+    if (numThreads>numBlocks){
+        numThreads = numBlocks;
+    }
+    if (numThreads<1){
+        numThreads = 1;
+    }
+    return numThreads;
+
+}
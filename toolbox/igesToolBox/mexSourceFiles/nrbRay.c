@@ -0,0 +1,649 @@
+/* Intersections of rays and NURBS surfaces, using the sub-patches of a BVH (nrbBvh) */
+
+/* Every sub-patch of the BVH is converted to a rational Bezier patch. The ray r0+t*v lies in the two planes
+ * n1.x=d1 and n2.x=d2 with normals orthogonal to v, so the surface meets the ray where the polynomial patch with
+ * the 2D control points (n1.Pw-d1*w, n2.Pw-d2*w) is zero (for positive weights). By the convex hull property the
+ * patch misses the ray if the box of these control points does not contain the origin, otherwise it is split in
+ * halves (de Casteljau) until it is flat, and Newton's method on the surface is started from its centre. If Newton's
+ * method does not converge inside the patch, it is split further. The boxes
+ * of the BVH are visited front to back, and if only the first hits of a ray are wanted, boxes behind them are
+ * skipped. Trimming curves are not taken into account. */
+
+/* nrbRay needs nrbBvh, nrbArena and nrbD1D2eval2 */
+
+/* Rays take different amounts of work, so they are handed out to the threads in small chunks */
+#define NRB_RAYCHUNK 16
+
+/* Maximum number of halvings of a sub-patch */
+#define NRB_RAYDEPTH 24
+
+/* A patch is flat if its control points are closer than NRB_RAYFLAT times its size to the plane of its corners */
+#define NRB_RAYFLAT 1e-3
+
+/* Maximum number of Newton steps, and Newton's method has converged when a step is less than NRB_RAYTOL times the knot spans */
+#define NRB_RAYITER 20
+#define NRB_RAYTOL 1e-13
+
+/* Tolerance of the boxes, and of hits on the same surface that are counted once, relative to the size of the BVH */
+#define NRB_RAYEPS 1e-9
+
+/* Number of doubles of a patch on the subdivision stack: umin, umax, vmin, vmax, depth and 2 x nu x nv control points */
+#define NRB_RAYENTRY(nu, nv) (5+2*(nu)*(nv))
+
+typedef struct {
+    double t;               /* ray parameter */
+    double uv[2];           /* parameter values */
+    double P[3];            /* point on surface */
+    int srf;                /* surface index (1-based) */
+    int ray;                /* ray index (0-based) */
+} nrbRayHit;
+
+typedef struct {
+    nrbRayHit *hit;
+    int num, cap;
+    int failed;             /* 1 if out of memory, then hits are missing */
+} nrbRayHits;
+
+typedef struct {
+    int srf;                /* surface index (1-based), 0 if the sub-patch has no area */
+    int degU, degV;         /* degrees */
+    double box[4];          /* knot spans umin, umax, vmin, vmax */
+    double *cp;             /* 4 x (degU+1) x (degV+1) homogeneous Bezier control points */
+} nrbRayPatch;
+
+
+static void nrbRayHitsAdd(nrbRayHits *hits, const nrbRayHit *hit){
+    /* nrbRayHitsAdd appends a hit, or sets hits->failed if out of memory */
+
+    int cap;
+    nrbRayHit *hit2;
+
+    if (hits->num==hits->cap){
+        cap = (hits->cap>0) ? 2*hits->cap : 16;
+        hit2 = (nrbRayHit*) realloc(hits->hit, cap*sizeof(nrbRayHit));
+        if (hit2==NULL){
+            hits->failed = 1;
+            return;
+        }
+        hits->hit = hit2;
+        hits->cap = cap;
+    }
+    hits->hit[hits->num++] = *hit;
+
+}
+
+
+static void nrbRayInsert(nrbRayHits *hits, const nrbRayHit *hit, int maxHits, double dup2){
+    /* nrbRayInsert inserts a hit into the hits of a ray sorted by t, unless the surface already has a hit at the same point */
+
+    /* nrbRayInsert( hits - pointer to hits of the ray, hit - pointer to new hit, maxHits - maximum number of hits kept (0 - all), dup2 - squared distance of hits counted once) */
+
+    int k;
+    double d, dist2;
+
+    for (k = 0; k < hits->num; k++){
+        if (hits->hit[k].srf==hit->srf){
+            d = hits->hit[k].P[0]-hit->P[0];
+            dist2 = d*d;
+            d = hits->hit[k].P[1]-hit->P[1];
+            dist2 += d*d;
+            d = hits->hit[k].P[2]-hit->P[2];
+            dist2 += d*d;
+            if (dist2<=dup2){
+                return;
+            }
+        }
+    }
+    if (maxHits>0 && hits->num==maxHits){
+        if (hit->t>=hits->hit[maxHits-1].t){
+            return;
+        }
+        hits->num--;
+    }
+    nrbRayHitsAdd(hits, hit);
+    if (hits->failed){
+        return;
+    }
+    for (k = hits->num-1; k > 0 && hits->hit[k-1].t>hit->t; k--){
+        hits->hit[k] = hits->hit[k-1];
+    }
+    hits->hit[k] = *hit;
+
+}
+
+
+static void nrbRayBlossom(int deg, const double *knot, int span, const double *cp, int stride, double *bez, int bstride, double *work){
+    /* nrbRayBlossom converts the control points of one knot span of a B-spline to Bezier control points */
+
+    /* nrbRayBlossom( deg - degree, knot - pointer to knot sequence, span - knot span index, cp - pointer to the homogeneous control point span-deg, stride - number of doubles between control points, bez - pointer to Bezier control points, bstride - number of doubles between Bezier control points, work - pointer to work array (4*(deg+1))) */
+
+    /* The Bezier control point j is the blossom with deg-j arguments knot[span] and j arguments knot[span+1],
+     * computed by the de Boor algorithm with the argument of each level. */
+
+    int j, r, m, c, idx;
+    double x, alpha;
+
+    for (j = 0; j <= deg; j++){
+        for (m = 0; m <= deg; m++){
+            for (c = 0; c < 4; c++){
+                work[4*m+c] = cp[stride*m+c];
+            }
+        }
+        for (r = 1; r <= deg; r++){
+            x = (r<=deg-j) ? knot[span] : knot[span+1];
+            for (m = deg; m >= r; m--){
+                idx = span-deg+m;
+                alpha = (x-knot[idx])/(knot[idx+deg+1-r]-knot[idx]);
+                for (c = 0; c < 4; c++){
+                    work[4*m+c] = (1.0-alpha)*work[4*m-4+c]+alpha*work[4*m+c];
+                }
+            }
+        }
+        for (c = 0; c < 4; c++){
+            bez[bstride*j+c] = work[4*deg+c];
+        }
+    }
+
+}
+
+
+static nrbRayPatch *nrbRayPatches(const nrbBvh *bvh, const nrbCompiled *srfs, int *maxOrder, double **cpArray){
+    /* nrbRayPatches converts the sub-patches of a BVH to rational Bezier patches */
+
+    /* nrbRayPatches( bvh - pointer to BVH, srfs - pointer to the compiled NURBS surfaces of bvh, maxOrder - pointer to the highest orders in u and v (2), cpArray - pointer to the array of all Bezier control points, freed with mxFree like the returned array) */
+
+    int k, i, j, l, spanU, spanV, degU, degV, size = 0;
+    double *pp, *cp, *row, work[4*NRB_MAXORDER];
+    const nrbNet *net;
+    nrbRayPatch *patches;
+
+    maxOrder[0] = 1;
+    maxOrder[1] = 1;
+    for (k = 0; k < bvh->numSrfs; k++){
+        net = &srfs[k].net[0];
+        if (net->orderU>maxOrder[0]){
+            maxOrder[0] = net->orderU;
+        }
+        if (net->orderV>maxOrder[1]){
+            maxOrder[1] = net->orderV;
+        }
+    }
+
+    patches = (nrbRayPatch*) mxMalloc(bvh->numPatches*sizeof(nrbRayPatch));
+    for (k = 0; k < bvh->numPatches; k++){
+        net = &srfs[(int)bvh->patch[NRB_BVHPATCH*k]-1].net[0];
+        if (net->orderU>1 && net->orderV>1){
+            size += 4*net->orderU*net->orderV;
+        }
+    }
+    cp = (double*) mxMalloc((size>0 ? size : 1)*sizeof(double));
+    *cpArray = cp;
+    row = (double*) mxMalloc(4*maxOrder[0]*maxOrder[1]*sizeof(double));
+
+    for (k = 0; k < bvh->numPatches; k++){
+        pp = &bvh->patch[NRB_BVHPATCH*k];
+        net = &srfs[(int)pp[0]-1].net[0];
+        degU = net->orderU-1;
+        degV = net->orderV-1;
+        patches[k].srf = 0;
+        patches[k].degU = degU;
+        patches[k].degV = degV;
+        patches[k].cp = NULL;
+        if (degU<1 || degV<1){
+            continue;
+        }
+
+        /* The knot spans of the sub-patch contain its middle sample */
+        l = (NRB_BVHGRID*NRB_BVHGRID)/2;
+        spanU = (int)FindSpan(net->ncp, degU, pp[1+5*l], net->knotU);
+        spanV = (int)FindSpan(net->kcp, degV, pp[2+5*l], net->knotV);
+        patches[k].srf = (int)pp[0];
+        patches[k].box[0] = net->knotU[spanU];
+        patches[k].box[1] = net->knotU[spanU+1];
+        patches[k].box[2] = net->knotV[spanV];
+        patches[k].box[3] = net->knotV[spanV+1];
+        patches[k].cp = cp;
+
+        /* Rows in u, then columns in v */
+        for (j = 0; j <= degV; j++){
+            nrbRayBlossom(degU, net->knotU, spanU, &net->coefs[4*(net->ncp*(spanV-degV+j)+spanU-degU)], 4, &row[4*(degU+1)*j], 4, work);
+        }
+        for (i = 0; i <= degU; i++){
+            nrbRayBlossom(degV, net->knotV, spanV, &row[4*i], 4*(degU+1), &cp[4*i], 4*(degU+1), work);
+        }
+        cp += 4*(degU+1)*(degV+1);
+    }
+
+    mxFree(row);
+    return patches;
+
+}
+
+
+static int nrbRayPlanes(double *v, double *r0, double *plane){
+    /* nrbRayPlanes sets up two planes n1.x=d1, n2.x=d2 with unit normals orthogonal to each other and to v through r0, returns 0 if v is zero */
+
+    /* nrbRayPlanes( v - pointer to ray direction (3), r0 - pointer to ray origin (3), plane - pointer to n1, d1, n2, d2 (8)) */
+
+    int m, k = 0;
+    double len, e[3] = {0.0, 0.0, 0.0}, *n1 = plane, *n2 = plane+4;
+
+    len = sqrt(v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
+    if (!(len>0.0)){
+        return 0;
+    }
+
+    /* n1 is orthogonal to v and to the axis closest to orthogonal to v */
+    for (m = 1; m < 3; m++){
+        if (fabs(v[m])<fabs(v[k])){
+            k = m;
+        }
+    }
+    e[k] = 1.0;
+    n1[0] = v[1]*e[2]-v[2]*e[1];
+    n1[1] = v[2]*e[0]-v[0]*e[2];
+    n1[2] = v[0]*e[1]-v[1]*e[0];
+    len = sqrt(n1[0]*n1[0]+n1[1]*n1[1]+n1[2]*n1[2]);
+    n1[0] /= len;
+    n1[1] /= len;
+    n1[2] /= len;
+    n2[0] = v[1]*n1[2]-v[2]*n1[1];
+    n2[1] = v[2]*n1[0]-v[0]*n1[2];
+    n2[2] = v[0]*n1[1]-v[1]*n1[0];
+    len = sqrt(n2[0]*n2[0]+n2[1]*n2[1]+n2[2]*n2[2]);
+    n2[0] /= len;
+    n2[1] /= len;
+    n2[2] /= len;
+    plane[3] = n1[0]*r0[0]+n1[1]*r0[1]+n1[2]*r0[2];
+    plane[7] = n2[0]*r0[0]+n2[1]*r0[1]+n2[2]*r0[2];
+    return 1;
+
+}
+
+
+static double nrbRayBoxEnter(const double *box, double *r0, double *v, double eps, double tmax){
+    /* nrbRayBoxEnter returns the ray parameter t>=0 where the ray enters box, HUGE_VAL if it misses box for t<=tmax */
+
+    /* nrbRayBoxEnter( box - pointer to xmin, ymin, zmin, xmax, ymax, zmax, r0 - pointer to ray origin (3), v - pointer to ray direction (3), eps - distance added to all sides of box, tmax - largest ray parameter) */
+
+    int m;
+    double a, b, x, t0 = 0.0, t1 = tmax;
+
+    for (m = 0; m < 3; m++){
+        if (v[m]==0.0){
+            if (r0[m]<box[m]-eps || r0[m]>box[m+3]+eps){
+                return HUGE_VAL;
+            }
+            continue;
+        }
+        a = (box[m]-eps-r0[m])/v[m];
+        b = (box[m+3]+eps-r0[m])/v[m];
+        if (a>b){
+            x = a;
+            a = b;
+            b = x;
+        }
+        if (a>t0){
+            t0 = a;
+        }
+        if (b<t1){
+            t1 = b;
+        }
+    }
+    return (t0<=t1) ? t0 : HUGE_VAL;
+
+}
+
+
+static void nrbRaySplit(const double *f, int n, int stride, double *left, double *right){
+    /* nrbRaySplit splits a 2D Bezier curve at the parameter 1/2 (de Casteljau) */
+
+    /* nrbRaySplit( f - pointer to n control points, n - number of control points, stride - number of doubles between control points, left, right - pointers to control points of the halves (same stride)) */
+
+    int i, r;
+    double tmp[2*NRB_MAXORDER];
+
+    for (i = 0; i < n; i++){
+        tmp[2*i] = f[stride*i];
+        tmp[2*i+1] = f[stride*i+1];
+    }
+    left[0] = tmp[0];
+    left[1] = tmp[1];
+    right[stride*(n-1)] = tmp[2*n-2];
+    right[stride*(n-1)+1] = tmp[2*n-1];
+    for (r = 1; r < n; r++){
+        for (i = 0; i < n-r; i++){
+            tmp[2*i] = 0.5*(tmp[2*i]+tmp[2*i+2]);
+            tmp[2*i+1] = 0.5*(tmp[2*i+1]+tmp[2*i+3]);
+        }
+        left[stride*r] = tmp[0];
+        left[stride*r+1] = tmp[1];
+        right[stride*(n-1-r)] = tmp[2*(n-1-r)];
+        right[stride*(n-1-r)+1] = tmp[2*(n-1-r)+1];
+    }
+
+}
+
+
+static int nrbRayNewton(const nrbCompiled *srf, const double *plane, const double *box, const double *spanBox, double *paramValue, double *evalPnt, nrbScratch *scr){
+    /* nrbRayNewton finds the point of a surface on the ray with Newton's method, returns 1 if it converged inside box */
+
+    /* nrbRayNewton( srf - pointer to compiled NURBS surface, plane - pointer to the planes of the ray from nrbRayPlanes (8), box - pointer to parameter box umin, umax, vmin, vmax, the start value is its centre, spanBox - pointer to the knot spans of the sub-patch (4), paramValue - pointer to parameter values (u,v), evalPnt - pointer to point on surface, scr - pointer to arrays for function BasisFuns) */
+
+    int iter, converged = 0;
+    double F1, F2, J11, J12, J21, J22, det, du, dv, tolU, tolV;
+    double evalDeru[3], evalDerv[3], evalDeruu[3], evalDeruv[3], evalDervv[3], bspPnts[4];
+    const nrbNet *net = &srf->net[0];
+
+    paramValue[0] = 0.5*(box[0]+box[1]);
+    paramValue[1] = 0.5*(box[2]+box[3]);
+    tolU = NRB_RAYTOL*(spanBox[1]-spanBox[0]);
+    tolV = NRB_RAYTOL*(spanBox[3]-spanBox[2]);
+
+    for (iter = 0; iter < NRB_RAYITER; iter++){
+        nrbD1D2eval2(srf, paramValue, evalPnt, evalDeru, evalDerv, evalDeruu, evalDeruv, evalDervv, bspPnts, scr);
+        F1 = plane[0]*evalPnt[0]+plane[1]*evalPnt[1]+plane[2]*evalPnt[2]-plane[3];
+        F2 = plane[4]*evalPnt[0]+plane[5]*evalPnt[1]+plane[6]*evalPnt[2]-plane[7];
+        J11 = plane[0]*evalDeru[0]+plane[1]*evalDeru[1]+plane[2]*evalDeru[2];
+        J12 = plane[0]*evalDerv[0]+plane[1]*evalDerv[1]+plane[2]*evalDerv[2];
+        J21 = plane[4]*evalDeru[0]+plane[5]*evalDeru[1]+plane[6]*evalDeru[2];
+        J22 = plane[4]*evalDerv[0]+plane[5]*evalDerv[1]+plane[6]*evalDerv[2];
+        det = J11*J22-J12*J21;
+        if (det==0.0){
+            return 0;
+        }
+        du = (J22*F1-J12*F2)/det;
+        dv = (J11*F2-J21*F1)/det;
+        paramValue[0] -= du;
+        paramValue[1] -= dv;
+        nrbClampParam(&paramValue[0], net->knotU[net->orderU-1], net->knotU[net->ncp]);
+        nrbClampParam(&paramValue[1], net->knotV[net->orderV-1], net->knotV[net->kcp]);
+        if (fabs(du)<=tolU && fabs(dv)<=tolV){
+            converged = 1;
+            break;
+        }
+    }
+    if (!converged){
+        return 0;
+    }
+
+    nrbNetEval2(net, paramValue, 1, bspPnts, scr);
+    evalPnt[0] = bspPnts[0]/bspPnts[3];
+    evalPnt[1] = bspPnts[1]/bspPnts[3];
+    evalPnt[2] = bspPnts[2]/bspPnts[3];
+
+    /* A point outside box is found from the patch containing it */
+    tolU = NRB_RAYEPS*(spanBox[1]-spanBox[0]);
+    tolV = NRB_RAYEPS*(spanBox[3]-spanBox[2]);
+    return paramValue[0]>=box[0]-tolU && paramValue[0]<=box[1]+tolU && paramValue[1]>=box[2]-tolV && paramValue[1]<=box[3]+tolV;
+
+}
+
+
+static void nrbRayPatchHits(const nrbCompiled *srf, const nrbRayPatch *patch, const double *plane, double *r0, double *v, int ray, int maxHits, double dup2, nrbRayHits *hits, double *stack, nrbScratch *scr){
+    /* nrbRayPatchHits inserts the hits of a ray and a Bezier patch into the hits of the ray */
+
+    /* nrbRayPatchHits( srf - pointer to compiled NURBS surface of the patch, patch - pointer to Bezier patch, plane - pointer to the planes of the ray from nrbRayPlanes (8), r0 - pointer to ray origin (3), v - pointer to ray direction (3), ray - ray index (0-based), maxHits - maximum number of hits kept (0 - all), dup2 - squared distance of hits counted once, hits - pointer to hits of the ray, stack - pointer to work array ((NRB_RAYDEPTH+2)*NRB_RAYENTRY(degU+1,degV+1)), scr - pointer to arrays for function BasisFuns) */
+
+    int i, j, k, c, top, nu = patch->degU+1, nv = patch->degV+1, entry = NRB_RAYENTRY(nu, nv);
+    double fmin[2], fmax[2], size, dev, lenU, lenV, s, b, x, *e, *f, *par, *cp;
+    nrbRayHit hit;
+
+    /* The patch projected on the planes */
+    e = stack;
+    e[0] = patch->box[0];
+    e[1] = patch->box[1];
+    e[2] = patch->box[2];
+    e[3] = patch->box[3];
+    e[4] = 0.0;
+    f = e+5;
+    for (k = 0; k < nu*nv; k++){
+        cp = &patch->cp[4*k];
+        f[2*k] = plane[0]*cp[0]+plane[1]*cp[1]+plane[2]*cp[2]-plane[3]*cp[3];
+        f[2*k+1] = plane[4]*cp[0]+plane[5]*cp[1]+plane[6]*cp[2]-plane[7]*cp[3];
+    }
+    top = 1;
+    par = stack+(NRB_RAYDEPTH+1)*entry;
+
+    while (top>0){
+        top--;
+        e = stack+top*entry;
+        f = e+5;
+
+        /* The ray misses the patch if the box of the control points does not contain the origin */
+        for (c = 0; c < 2; c++){
+            fmin[c] = f[c];
+            fmax[c] = f[c];
+            for (k = 1; k < nu*nv; k++){
+                if (f[2*k+c]<fmin[c]){
+                    fmin[c] = f[2*k+c];
+                }
+                else if (f[2*k+c]>fmax[c]){
+                    fmax[c] = f[2*k+c];
+                }
+            }
+        }
+        if (fmin[0]>0.0 || fmax[0]<0.0 || fmin[1]>0.0 || fmax[1]<0.0){
+            continue;
+        }
+        size = (fmax[0]-fmin[0]>fmax[1]-fmin[1]) ? fmax[0]-fmin[0] : fmax[1]-fmin[1];
+
+        /* Distance to the plane of the corners, from the twist of the corners and the distance to their bilinear
+         * patch, and lengths of the control polygon in u and v */
+        dev = 0.0;
+        lenU = 0.0;
+        lenV = 0.0;
+        for (c = 0; c < 2; c++){
+            b = 0.25*fabs(f[c]-f[2*(nu-1)+c]-f[2*(nu*(nv-1))+c]+f[2*(nu*nv-1)+c]);
+            if (b>dev){
+                dev = b;
+            }
+        }
+        for (j = 0; j < nv; j++){
+            for (i = 0; i < nu; i++){
+                k = j*nu+i;
+                s = (double)i/(nu-1);
+                x = (double)j/(nv-1);
+                for (c = 0; c < 2; c++){
+                    b = (1.0-x)*((1.0-s)*f[c]+s*f[2*(nu-1)+c])+x*((1.0-s)*f[2*(nu*(nv-1))+c]+s*f[2*(nu*nv-1)+c]);
+                    if (fabs(f[2*k+c]-b)>dev){
+                        dev = fabs(f[2*k+c]-b);
+                    }
+                    if (i>0){
+                        lenU += fabs(f[2*k+c]-f[2*k-2+c]);
+                    }
+                    if (j>0){
+                        lenV += fabs(f[2*k+c]-f[2*(k-nu)+c]);
+                    }
+                }
+            }
+        }
+
+        /* Newton's method on flat patches, which are split further if it does not converge inside them */
+        if (dev<=NRB_RAYFLAT*size || e[4]>=NRB_RAYDEPTH){
+            if (nrbRayNewton(srf, plane, e, patch->box, hit.uv, hit.P, scr)){
+                hit.t = (v[0]*(hit.P[0]-r0[0])+v[1]*(hit.P[1]-r0[1])+v[2]*(hit.P[2]-r0[2]))/(v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
+                if (hit.t>=0.0){
+                    hit.srf = patch->srf;
+                    hit.ray = ray;
+                    nrbRayInsert(hits, &hit, maxHits, dup2);
+                }
+                continue;
+            }
+            if (e[4]>=NRB_RAYDEPTH){
+                continue;
+            }
+        }
+
+        /* Halves in the direction where the control points vary most */
+        memcpy(par, e, entry*sizeof(double));
+        for (k = 0; k < 2; k++){
+            memcpy(e+k*entry, par, 4*sizeof(double));
+            e[k*entry+4] = par[4]+1.0;
+        }
+        if (lenU>=lenV){
+            e[1] = 0.5*(par[0]+par[1]);
+            e[entry] = e[1];
+            for (j = 0; j < nv; j++){
+                nrbRaySplit(&par[5+2*nu*j], nu, 2, &e[5+2*nu*j], &e[entry+5+2*nu*j]);
+            }
+        }
+        else{
+            e[3] = 0.5*(par[2]+par[3]);
+            e[entry+2] = e[3];
+            for (i = 0; i < nu; i++){
+                nrbRaySplit(&par[5+2*i], nv, 2*nu, &e[5+2*i], &e[entry+5+2*i]);
+            }
+        }
+        top += 2;
+    }
+
+}
+
+
+static void nrbRayCast(const nrbBvh *bvh, const nrbCompiled *srfs, const nrbRayPatch *patches, double *r0, double *v, int ray, int maxHits, double eps, nrbRayHits *hits, double *stack, nrbScratch *scr){
+    /* nrbRayCast finds the hits of one ray, sorted by t */
+
+    /* nrbRayCast( bvh - pointer to BVH, srfs - pointer to the compiled NURBS surfaces of bvh, patches - pointer to Bezier patches from nrbRayPatches, r0 - pointer to ray origin (3), v - pointer to ray direction (3), ray - ray index (0-based), maxHits - maximum number of hits (0 - all), eps - tolerance of boxes and duplicate hits, hits - pointer to hits of the ray, stack - pointer to work array of nrbRayPatchHits, scr - pointer to arrays for function BasisFuns) */
+
+    /* A node is skipped if the ray misses its box, or enters it after the last of maxHits hits found so far,
+     * and of the two children the one the ray enters first is visited first. */
+
+    int k, n, top = 0, nodes[NRB_BVHSTACK], child[2];
+    double plane[8], tmax, childEnter[2], *nd;
+
+    hits->num = 0;
+    if (!nrbRayPlanes(v, r0, plane)){
+        return;
+    }
+
+    nodes[top++] = 0;
+    while (top>0){
+        n = nodes[--top];
+        nd = &bvh->node[NRB_BVHNODE*n];
+        tmax = (maxHits>0 && hits->num==maxHits) ? hits->hit[maxHits-1].t : HUGE_VAL;
+        if (nrbRayBoxEnter(nd, r0, v, eps, tmax)==HUGE_VAL){
+            continue;
+        }
+        if (nd[7]>0.0){
+            for (k = (int)nd[6]; k < (int)nd[6]+(int)nd[7]; k++){
+                if (patches[k].srf>0){
+                    nrbRayPatchHits(&srfs[patches[k].srf-1], &patches[k], plane, r0, v, ray, maxHits, eps*eps, hits, stack, scr);
+                }
+            }
+            continue;
+        }
+        child[0] = n+1;
+        child[1] = (int)nd[6];
+        childEnter[0] = nrbRayBoxEnter(&bvh->node[NRB_BVHNODE*child[0]], r0, v, eps, tmax);
+        childEnter[1] = nrbRayBoxEnter(&bvh->node[NRB_BVHNODE*child[1]], r0, v, eps, tmax);
+        k = (childEnter[1]<childEnter[0]) ? 1 : 0;
+        if (childEnter[1-k]<HUGE_VAL && top<NRB_BVHSTACK){
+            nodes[top++] = child[1-k];
+        }
+        if (childEnter[k]<HUGE_VAL && top<NRB_BVHSTACK){
+            nodes[top++] = child[k];
+        }
+    }
+
+}
+
+
+static nrbRayHit *nrbRayBatch(const nrbBvh *bvh, const nrbCompiled *srfs, int numRays, double *r0, int strideR0, double *v, int strideV, int maxHits, int *numHits, int numThreads){
+    /* nrbRayBatch finds the hits of numRays rays, returns them sorted by ray and t in an array freed with free */
+
+    /* nrbRayBatch( bvh - pointer to BVH, srfs - pointer to the compiled NURBS surfaces of bvh, numRays - number of rays, r0 - pointer to ray origins (3 x numRays), strideR0 - 3, or 0 if all rays have the same origin, v - pointer to ray directions (3 x numRays), strideV - 3, or 0 if all rays have the same direction, maxHits - maximum number of hits per ray (0 - all), numHits - pointer to number of hits, numThreads - number of threads) */
+
+    /* Each chunk of NRB_RAYCHUNK rays collects its hits in its own array, and the arrays are joined at the end. */
+
+    int k, m, maxOrder[2], numChunks = (numRays+NRB_RAYCHUNK-1)/NRB_RAYCHUNK, failed = 0;
+    double d, eps = 0.0, *cpArray;
+    nrbRayPatch *patches;
+    nrbRayHits *chunks;
+    nrbRayHit *out;
+
+    patches = nrbRayPatches(bvh, srfs, maxOrder, &cpArray);
+    for (m = 0; m < 3; m++){
+        d = bvh->node[m+3]-bvh->node[m];
+        eps += d*d;
+    }
+    eps = NRB_RAYEPS*sqrt(eps);
+
+    chunks = (nrbRayHits*) mxCalloc((numChunks>0 ? numChunks : 1), sizeof(nrbRayHits));
+    nrbArenaReserveThreads(numThreads, (NRB_RAYDEPTH+2)*NRB_RAYENTRY(maxOrder[0], maxOrder[1])*sizeof(double));
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads) if(numThreads>1)
+#endif
+    {
+        int c, i, j, ok;
+        double *stack = (double*) nrbArenaThread();
+        nrbRayHits hits;
+        nrbScratch scr;
+
+        hits.hit = NULL;
+        hits.num = 0;
+        hits.cap = 0;
+        hits.failed = 0;
+        ok = nrbScratchInit(&scr, maxOrder[0], maxOrder[1]);
+        if (!ok){
+            failed = 1;
+        }
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+        for (c = 0; c < numChunks; c++){
+            if (!ok){
+                continue;
+            }
+            for (i = c*NRB_RAYCHUNK; i < numRays && i < (c+1)*NRB_RAYCHUNK; i++){
+                nrbRayCast(bvh, srfs, patches, r0+strideR0*i, v+strideV*i, i, maxHits, eps, &hits, stack, &scr);
+                for (j = 0; j < hits.num; j++){
+                    nrbRayHitsAdd(&chunks[c], &hits.hit[j]);
+                }
+                if (hits.failed || chunks[c].failed){
+                    failed = 1;
+                    ok = 0;
+                    break;
+                }
+            }
+        }
+
+        nrbScratchFree(&scr);
+        free(hits.hit);
+    }
+
+    if (failed){
+        for (k = 0; k < numChunks; k++){
+            free(chunks[k].hit);
+        }
+        mexErrMsgTxt("Out of memory.");
+    }
+
+    *numHits = 0;
+    for (k = 0; k < numChunks; k++){
+        *numHits += chunks[k].num;
+    }
+    out = (nrbRayHit*) malloc((*numHits>0 ? *numHits : 1)*sizeof(nrbRayHit));
+    if (out==NULL){
+        for (k = 0; k < numChunks; k++){
+            free(chunks[k].hit);
+        }
+        mexErrMsgTxt("Out of memory.");
+    }
+    *numHits = 0;
+    for (k = 0; k < numChunks; k++){
+        if (chunks[k].num>0){
+            memcpy(&out[*numHits], chunks[k].hit, chunks[k].num*sizeof(nrbRayHit));
+            *numHits += chunks[k].num;
+        }
+        free(chunks[k].hit);
+    }
+
+    mxFree(chunks);
+    mxFree(cpArray);
+    mxFree(patches);
+    return out;
+
+}
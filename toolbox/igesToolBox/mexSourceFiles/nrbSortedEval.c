@@ -0,0 +1,168 @@
+
+/* nrbSortedEval evaluates a NURBS surface at many parameter values, NRB_LANES values in the same knot span at a time */
+
+/* The parameter values are split into blocks of NRB_SORTBLOCK values (that fit in cache), and each block is sorted by
+ * knot span (counting sort on spanV*ncp+spanU), so that consecutive values share their knot spans. NRB_LANES values with the same spans are evaluated together with BasisFunsLanes and
+ * NURBSsurfaceEvalLanes, the remaining values (on the boundary of the parameter domain) with NURBSsurfaceEval.
+ * The arithmetic is the same as in NURBSsurfaceEval, so the result is identical. The sorted evaluation is only used
+ * when compiled with AVX (makeIGESmex('avx2')), without it the sorting costs more than it saves. */
+
+/* nrbSortedEval needs FindSpanHint, BasisFunsLanes, NURBSsurfaceEval, nrbCompiled and nrbArena */
+
+#define NRB_SORTBLOCK 4096
+
+
+static void NURBSsurfaceEvalLanes(int degU, int degV, double *cp, int ncp, int spanU, int spanV, double *NU, double *NV, double *ep){
+    /* Modification of  ALGORITHM A4.3, The NURBS Book, L.Piegl and W. Tiller */
+
+    /* Evaluates a NURBS surface at NRB_LANES parameter values in the knot spans (spanU,spanV) */
+
+    /* NURBSsurfaceEvalLanes( degU - degree of NURBS in u, degV - degree of NURBS in v, cp - pointer to control points, ncp - number of control points in u, spanU - knot span in u, spanV - knot span in v, NU - pointer to basis functions in u (from BasisFunsLanes), NV - pointer to basis functions in v (from BasisFunsLanes), ep - pointer to evaluated points (3 x NRB_LANES)) */
+
+    int i, j, l, ind, ind2;
+    double *pnt, NVNU[NRB_LANES], acc[4][NRB_LANES];
+
+    ind = spanU - degU;
+    ind2 = spanV - degV;
+
+    for (l = 0; l < NRB_LANES; l++){
+        acc[0][l] = 0.0;
+        acc[1][l] = 0.0;
+        acc[2][l] = 0.0;
+        acc[3][l] = 0.0;
+    }
+
+    for (i = 0; i <= degV; i++){
+        for (j = 0; j <= degU; j++){
+            pnt = &cp[(i+ind2)*4*ncp+(j+ind)*4];
+            for (l = 0; l < NRB_LANES; l++){
+                NVNU[l] = NV[i*NRB_LANES+l] * NU[j*NRB_LANES+l];
+                acc[0][l] += NVNU[l] * pnt[0];
+                acc[1][l] += NVNU[l] * pnt[1];
+                acc[2][l] += NVNU[l] * pnt[2];
+                acc[3][l] += NVNU[l] * pnt[3];
+            }
+        }
+    }
+
+    for (l = 0; l < NRB_LANES; l++){
+        ep[l*3] = acc[0][l]/acc[3][l];
+        ep[l*3+1] = acc[1][l]/acc[3][l];
+        ep[l*3+2] = acc[2][l]/acc[3][l];
+    }
+
+}
+
+
+static int nrbSortedEval(const nrbNet *net, double *us, int nus, double *ep, int numThreads){
+    /* nrbSortedEval evaluates a NURBS surface at given parameter values, returns 0 (and does nothing) if sorting does not pay off */
+
+    /* nrbSortedEval( net - pointer to net of NURBS surface, us - pointer to parameter values, nus - number of parameter values, ep - pointer to evaluated points (3 x nus), numThreads - number of threads) */
+
+    int degU = net->orderU-1, degV = net->orderV-1, ncp = net->ncp, kcp = net->kcp;
+    int numKeys = ncp*kcp, numBlocks = (nus+NRB_SORTBLOCK-1)/NRB_SORTBLOCK, failed = 0;
+
+    /* Sorting pays off only with vector instructions, at least quadratic basis functions and on average NRB_LANES values per pair of knot spans in a block */
+#ifndef __AVX__
+    return 0;
+#endif
+    if (degU<2 || degV<2 || net->orderU>NRB_MAXORDER || net->orderV>NRB_MAXORDER || NRB_LANES*numKeys>NRB_SORTBLOCK || nus<NRB_SORTBLOCK){
+        return 0;
+    }
+
+    nrbArenaReserveThreads(numThreads, (2*NRB_SORTBLOCK+numKeys+2)*sizeof(int));
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads) if(numThreads>1)
+#endif
+    {
+        int b, jj, l, k, n, first, last, num, kk, hintU = 0, hintV = 0, ok;
+        int *key, *order, *count;
+        double *usb, *epb;
+        double uLane[NRB_LANES], vLane[NRB_LANES], epLane[3*NRB_LANES];
+        double NU[NRB_MAXORDER*NRB_LANES], NV[NRB_MAXORDER*NRB_LANES];
+        double left[NRB_MAXORDER*NRB_LANES], right[NRB_MAXORDER*NRB_LANES];
+        nrbScratch scr;
+
+        ok = nrbScratchInit(&scr, net->orderU, net->orderV);
+        if (!ok){
+            failed = 1;
+        }
+        key = (int*) nrbArenaThread();
+        order = key+NRB_SORTBLOCK;
+        count = order+NRB_SORTBLOCK;
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+        for (b = 0; b < numBlocks; b++){
+
+            if (!ok){
+                continue;
+            }
+            usb = &us[2*b*NRB_SORTBLOCK];
+            epb = &ep[3*b*NRB_SORTBLOCK];
+            num = (nus-b*NRB_SORTBLOCK<NRB_SORTBLOCK) ? nus-b*NRB_SORTBLOCK : NRB_SORTBLOCK;
+
+            for (jj = 0; jj < num; jj++){
+                if (usb[2*jj]>net->knotU[degU] && usb[2*jj]<net->knotU[ncp] && usb[2*jj+1]>net->knotV[degV] && usb[2*jj+1]<net->knotV[kcp]){
+                    key[jj] = FindSpanHint(kcp, degV, usb[2*jj+1], net->knotV, &hintV)*ncp + FindSpanHint(ncp, degU, usb[2*jj], net->knotU, &hintU);
+                }
+                else{
+                    key[jj] = numKeys;
+                }
+            }
+
+            /* Counting sort, values on the boundary (key numKeys) last */
+            for (jj = 0; jj < numKeys+2; jj++){
+                count[jj] = 0;
+            }
+            for (jj = 0; jj < num; jj++){
+                count[key[jj]+1]++;
+            }
+            for (jj = 0; jj <= numKeys; jj++){
+                count[jj+1] += count[jj];
+            }
+            for (jj = 0; jj < num; jj++){
+                order[count[key[jj]]++] = jj;
+            }
+
+            last = num;
+            for (first = 0; first < last; first += n){
+                kk = key[order[first]];
+                if (kk==numKeys){
+                    /* Boundary of the parameter domain */
+                    NURBSsurfaceEval(degU, degV, net->coefs, ncp, kcp, net->knotU, net->knotV, &usb[2*order[first]], 1, &epb[3*order[first]], scr.leftU, scr.rightU, scr.NU, scr.leftV, scr.rightV, scr.NV);
+                    n = 1;
+                    continue;
+                }
+                /* Up to NRB_LANES values in the same knot spans, unused lanes repeat the last value */
+                for (n = 1; n < NRB_LANES && first+n < last && key[order[first+n]]==kk; n++){
+                }
+                for (l = 0; l < NRB_LANES; l++){
+                    k = order[first+((l<n) ? l : n-1)];
+                    uLane[l] = usb[2*k];
+                    vLane[l] = usb[2*k+1];
+                }
+                BasisFunsLanes(kk%ncp, uLane, degU, net->knotU, NU, left, right);
+                BasisFunsLanes(kk/ncp, vLane, degV, net->knotV, NV, left, right);
+                NURBSsurfaceEvalLanes(degU, degV, net->coefs, ncp, kk%ncp, kk/ncp, NU, NV, epLane);
+                for (l = 0; l < n; l++){
+                    k = order[first+l];
+                    epb[3*k] = epLane[3*l];
+                    epb[3*k+1] = epLane[3*l+1];
+                    epb[3*k+2] = epLane[3*l+2];
+                }
+            }
+
+        }
+
+        nrbScratchFree(&scr);
+    }
+
+    if (failed){
+        mexErrMsgTxt("Out of memory.");
+    }
+    return 1;
+
+}
@@ -0,0 +1,838 @@
+
+/* Adaptive tessellation of a NURBS surface with a bound on the chord error, optionally trimmed by loops in the parameter domain */
+
+/* The parameter domain is split recursively into rectangular cells. A cell is tested on a NRB_TESSGRID x NRB_TESSGRID
+ * grid of parameter values: the distance between the surface and its triangles at the same parameter values (the
+ * chord error) must be at most tol, for the triangles with the better of the two diagonals and for the triangles
+ * fanned from the centre. Otherwise the cell is split in the middle, or at the knot closest to the middle, in u, in v
+ * or in both, depending on the direction of the error. Cells with many knots are always split, so that no knot span
+ * is left untested.
+ *
+ * The leaves are triangulated with their diagonal, or fanned from their centre if a smaller neighbour puts vertices
+ * on their edges (so that the triangulation has no cracks).
+ *
+ * Trimming loops are closed polygons in the parameter domain, the inside is given by the even-odd rule. Cells
+ * outside are dropped without further tests. Cells crossed by a loop are split until the loop passes through them
+ * once and its turning in the cell, times the size of the cell, is within the tolerance. Triangles crossed by a
+ * loop are cut where their edges cross it, the cut vertices are shared by the neighbouring triangles. */
+
+/* nrbTessellate needs nrbCompiled and nrbNetEval2 */
+
+#define NRB_TESSGRID 5
+#define NRB_TESSMAXDEPTH 20
+#define NRB_TESSMAXKNOTS 3
+#define NRB_TESSANISO 4.0
+#define NRB_TESSMAXLEAVES 4000000
+
+typedef struct {
+    double u0, u1, v0, v1;  /* cell */
+    int diagonal;           /* 0 - diagonal (u0,v0)-(u1,v1), 1 - diagonal (u1,v0)-(u0,v1) */
+    int trimmed;            /* 1 if crossed by a trimming loop */
+} nrbTessLeaf;
+
+typedef struct {
+    int numSeg;             /* number of segments */
+    double *seg;            /* u0, v0, u1, v1 of every segment */
+    double *turn;           /* turning angle of the loop at the start of every segment */
+    int numRows;            /* number of rows in v */
+    double vmin, rowHeight; /* rows */
+    int *rowFirst;          /* segments of row r are rowSeg[rowFirst[r]], ..., rowSeg[rowFirst[r+1]-1] */
+    int *rowSeg;
+} nrbTrim;
+
+typedef struct {
+    const nrbNet *net;      /* surface */
+    nrbScratch scr;
+    double tol;             /* chord error tolerance */
+    const nrbTrim *trim;    /* trimming loops or NULL */
+    int *segStack;          /* segments crossing the cells on the recursion path */
+    int segStackLen, segStackCap;
+    nrbTessLeaf *leaf;      /* leaves */
+    int numLeaves, leafCap;
+    int truncated;          /* 1 if NRB_TESSMAXLEAVES was reached */
+} nrbTess;
+
+typedef struct {
+    double u, v;
+    int index;
+} nrbTessVertex;
+
+
+static void nrbTrimInit(nrbTrim *trim, double **loops, int *loopLen, int numLoops){
+    /* nrbTrimInit sets up the segments of trimming loops and sorts them into rows in v */
+
+    /* nrbTrimInit( trim - pointer to trimming loops, loops - pointers to polygons (2 x loopLen[k]), loopLen - number of vertices of the polygons, numLoops - number of polygons) */
+
+    int k, i, n, r, r0, r1, num, first;
+    double *p, *q, vmin = HUGE_VAL, vmax = -HUGE_VAL, lo, hi, cross, dot;
+
+    num = 0;
+    for (k = 0; k < numLoops; k++){
+        if (loopLen[k]>=3){
+            num += loopLen[k];
+        }
+    }
+    trim->seg = (double*) malloc((num>0 ? num : 1)*4*sizeof(double));
+    trim->turn = (double*) malloc((num>0 ? num : 1)*sizeof(double));
+    trim->numSeg = 0;
+    for (k = 0; k < numLoops; k++){
+        n = loopLen[k];
+        if (n<3){
+            continue;
+        }
+        /* A closing vertex equal to the first vertex is not needed */
+        if (loops[k][0]==loops[k][2*(n-1)] && loops[k][1]==loops[k][2*(n-1)+1]){
+            n--;
+        }
+        first = trim->numSeg;
+        for (i = 0; i < n; i++){
+            p = &loops[k][2*i];
+            q = &loops[k][2*((i+1)%n)];
+            if (p[0]==q[0] && p[1]==q[1]){
+                continue;
+            }
+            trim->seg[4*trim->numSeg] = p[0];
+            trim->seg[4*trim->numSeg+1] = p[1];
+            trim->seg[4*trim->numSeg+2] = q[0];
+            trim->seg[4*trim->numSeg+3] = q[1];
+            trim->numSeg++;
+            vmin = (p[1]<vmin) ? p[1] : vmin;
+            vmax = (p[1]>vmax) ? p[1] : vmax;
+        }
+        for (i = first; i < trim->numSeg; i++){
+            p = &trim->seg[4*((i>first) ? i-1 : trim->numSeg-1)];
+            q = &trim->seg[4*i];
+            cross = (p[2]-p[0])*(q[3]-q[1])-(p[3]-p[1])*(q[2]-q[0]);
+            dot = (p[2]-p[0])*(q[2]-q[0])+(p[3]-p[1])*(q[3]-q[1]);
+            trim->turn[i] = atan2(fabs(cross), dot);
+        }
+    }
+
+    trim->numRows = (trim->numSeg+3)/4;
+    if (trim->numRows<1){
+        trim->numRows = 1;
+    }
+    trim->vmin = vmin;
+    trim->rowHeight = (vmax>vmin) ? (vmax-vmin)/trim->numRows : 1.0;
+    trim->rowFirst = (int*) calloc(trim->numRows+1, sizeof(int));
+
+    /* Count, then fill, the segments of every row */
+    for (k = 0; k < 2; k++){
+        for (i = 0; i < trim->numSeg; i++){
+            p = &trim->seg[4*i];
+            lo = (p[1]<p[3]) ? p[1] : p[3];
+            hi = (p[1]<p[3]) ? p[3] : p[1];
+            r0 = (int)floor((lo-trim->vmin)/trim->rowHeight);
+            r1 = (int)floor((hi-trim->vmin)/trim->rowHeight);
+            r0 = (r0<0) ? 0 : ((r0>=trim->numRows) ? trim->numRows-1 : r0);
+            r1 = (r1<0) ? 0 : ((r1>=trim->numRows) ? trim->numRows-1 : r1);
+            for (r = r0; r <= r1; r++){
+                if (k==0){
+                    trim->rowFirst[r+1]++;
+                }
+                else{
+                    trim->rowSeg[trim->rowFirst[r]++] = i;
+                }
+            }
+        }
+        if (k==0){
+            for (r = 0; r < trim->numRows; r++){
+                trim->rowFirst[r+1] += trim->rowFirst[r];
+            }
+            trim->rowSeg = (int*) malloc((trim->rowFirst[trim->numRows]>0 ? trim->rowFirst[trim->numRows] : 1)*sizeof(int));
+        }
+        else{
+            /* rowFirst[r] now points to the end of row r */
+            for (r = trim->numRows; r > 0; r--){
+                trim->rowFirst[r] = trim->rowFirst[r-1];
+            }
+            trim->rowFirst[0] = 0;
+        }
+    }
+
+}
+
+
+static void nrbTrimFree(nrbTrim *trim){
+    /* nrbTrimFree frees the arrays allocated by nrbTrimInit */
+
+    free(trim->seg);
+    free(trim->turn);
+    free(trim->rowFirst);
+    free(trim->rowSeg);
+
+}
+
+
+static int nrbTrimRow(const nrbTrim *trim, double v){
+    /* nrbTrimRow returns the row of v */
+
+    int r = (int)floor((v-trim->vmin)/trim->rowHeight);
+
+    return (r<0) ? 0 : ((r>=trim->numRows) ? trim->numRows-1 : r);
+
+}
+
+
+static int nrbTrimInside(const nrbTrim *trim, double u, double v){
+    /* nrbTrimInside returns 1 if (u,v) is inside the trimming loops (even-odd rule) */
+
+    int k, r = nrbTrimRow(trim, v), inside = 0;
+    double *s;
+
+    for (k = trim->rowFirst[r]; k < trim->rowFirst[r+1]; k++){
+        s = &trim->seg[4*trim->rowSeg[k]];
+        if ((s[1]>v)!=(s[3]>v)){
+            if (u<s[0]+(v-s[1])/(s[3]-s[1])*(s[2]-s[0])){
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+
+}
+
+
+static double nrbTrimCrossing(const nrbTrim *trim, double *a, double *b){
+    /* nrbTrimCrossing returns the parameter t in [0,1] of the first crossing of the segment a+t*(b-a) with a trimming loop, 0.5 if none is found */
+
+    int k, r, r0, r1;
+    double *s, du = b[0]-a[0], dv = b[1]-a[1], eu, ev, den, t, w, tmin = HUGE_VAL;
+
+    r0 = nrbTrimRow(trim, (a[1]<b[1]) ? a[1] : b[1]);
+    r1 = nrbTrimRow(trim, (a[1]<b[1]) ? b[1] : a[1]);
+    for (r = r0; r <= r1; r++){
+        for (k = trim->rowFirst[r]; k < trim->rowFirst[r+1]; k++){
+            s = &trim->seg[4*trim->rowSeg[k]];
+            eu = s[2]-s[0];
+            ev = s[3]-s[1];
+            den = du*ev-dv*eu;
+            if (den==0.0){
+                continue;
+            }
+            t = ((s[0]-a[0])*ev-(s[1]-a[1])*eu)/den;
+            w = ((s[0]-a[0])*dv-(s[1]-a[1])*du)/den;
+            if (t>=0.0 && t<=1.0 && w>=0.0 && w<=1.0 && t<tmin){
+                tmin = t;
+            }
+        }
+    }
+    return (tmin<=1.0) ? tmin : 0.5;
+
+}
+
+
+static int nrbTrimSegmentInCell(const double *s, double u0, double u1, double v0, double v1){
+    /* nrbTrimSegmentInCell returns 1 if the segment s touches the cell */
+
+    double c0, c1, c2, c3, du = s[2]-s[0], dv = s[3]-s[1];
+
+    if ((s[0]<u0 && s[2]<u0) || (s[0]>u1 && s[2]>u1) || (s[1]<v0 && s[3]<v0) || (s[1]>v1 && s[3]>v1)){
+        return 0;
+    }
+    c0 = du*(v0-s[1])-dv*(u0-s[0]);
+    c1 = du*(v0-s[1])-dv*(u1-s[0]);
+    c2 = du*(v1-s[1])-dv*(u0-s[0]);
+    c3 = du*(v1-s[1])-dv*(u1-s[0]);
+    return !((c0>0 && c1>0 && c2>0 && c3>0) || (c0<0 && c1<0 && c2<0 && c3<0));
+
+}
+
+
+static void nrbTessEval(const nrbNet *net, double *uv, int num, double *P, nrbScratch *scr){
+    /* nrbTessEval evaluates the surface at num (at most NRB_TESSGRID^2) parameter values, P is 3 x num */
+
+    int j, i;
+    double bspPnts[4*NRB_TESSGRID*NRB_TESSGRID];
+
+    nrbNetEval2(net, uv, num, bspPnts, scr);
+    for (j = 0; j < num; j++){
+        for (i = 0; i < 3; i++){
+            P[3*j+i] = bspPnts[4*j+i]/bspPnts[4*j+3];
+        }
+    }
+
+}
+
+
+static double nrbTessTriDist(double *P, double *A, double *B, double *C, double a, double b){
+    /* nrbTessTriDist returns the distance between P and A+a*(B-A)+b*(C-A) */
+
+    int i;
+    double d, dist2 = 0.0;
+
+    for (i = 0; i < 3; i++){
+        d = P[i]-(A[i]+a*(B[i]-A[i])+b*(C[i]-A[i]));
+        dist2 += d*d;
+    }
+    return sqrt(dist2);
+
+}
+
+
+static int nrbTessKnotSplit(const double *knots, int lo, int hi, double t0, double t1, double *split){
+    /* nrbTessKnotSplit returns the number of knots inside (t0,t1), and in split the knot closest to the middle if it is in the middle half, else the middle */
+
+    int k, num = 0;
+    double mid = 0.5*(t0+t1), best = mid, t;
+
+    for (k = lo; k <= hi; k++){
+        t = knots[k];
+        if (t>t0 && t<t1 && (k==lo || t!=knots[k-1])){
+            num++;
+            if (fabs(t-mid)<0.25*(t1-t0) && (best==mid || fabs(t-mid)<fabs(best-mid))){
+                best = t;
+            }
+        }
+    }
+    *split = best;
+    return num;
+
+}
+
+
+static void nrbTessCell(nrbTess *ts, double u0, double u1, double v0, double v1, int depthU, int depthV, int firstSeg, int numSegs){
+    /* nrbTessCell tests a cell and splits it or adds it to the leaves */
+
+    /* nrbTessCell( ts - pointer to tessellation, u0, u1, v0, v1 - cell, depthU, depthV - number of splits in u and v, firstSeg, numSegs - segments crossing the parent cell in segStack) */
+
+    int i, j, k, num, numVert, splitU, splitV, knotsU, knotsV, diagonal, first;
+    double uv[2*NRB_TESSGRID*NRB_TESSGRID], P[3*NRB_TESSGRID*NRB_TESSGRID], *s;
+    double a, b, d, err1, err2, errFan, errU, errV, uSplit, vSplit, turn;
+    const int G = NRB_TESSGRID-1;
+    double *P00, *P10, *P01, *P11, *Pc;
+
+    /* Segments crossing this cell */
+    first = ts->segStackLen;
+    num = 0;
+    numVert = 0;
+    turn = 0.0;
+    if (ts->trim!=NULL){
+        if (ts->segStackLen+numSegs>ts->segStackCap){
+            ts->segStackCap = 2*(ts->segStackLen+numSegs);
+            ts->segStack = (int*) realloc(ts->segStack, ts->segStackCap*sizeof(int));
+        }
+        for (k = firstSeg; k < firstSeg+numSegs; k++){
+            s = &ts->trim->seg[4*ts->segStack[k]];
+            if (nrbTrimSegmentInCell(s, u0, u1, v0, v1)){
+                ts->segStack[first+num] = ts->segStack[k];
+                num++;
+                if (s[0]>=u0 && s[0]<=u1 && s[1]>=v0 && s[1]<=v1){
+                    numVert++;
+                    turn += ts->trim->turn[ts->segStack[k]];
+                }
+            }
+        }
+        if (num==0 && !nrbTrimInside(ts->trim, 0.5*(u0+u1), 0.5*(v0+v1))){
+            return;
+        }
+        ts->segStackLen += num;
+    }
+
+    /* Chord error on the test grid */
+    for (j = 0; j <= G; j++){
+        for (i = 0; i <= G; i++){
+            uv[2*(j*(G+1)+i)] = (i==G) ? u1 : u0+(u1-u0)*i/G;
+            uv[2*(j*(G+1)+i)+1] = (j==G) ? v1 : v0+(v1-v0)*j/G;
+        }
+    }
+    nrbTessEval(ts->net, uv, (G+1)*(G+1), P, &ts->scr);
+    P00 = &P[0];
+    P10 = &P[3*G];
+    P01 = &P[3*G*(G+1)];
+    P11 = &P[3*(G*(G+1)+G)];
+    Pc = &P[3*((G/2)*(G+1)+G/2)];
+
+    err1 = 0.0;
+    err2 = 0.0;
+    errFan = 0.0;
+    errU = 0.0;
+    errV = 0.0;
+    for (j = 0; j <= G; j++){
+        for (i = 0; i <= G; i++){
+            a = (double)i/G;
+            b = (double)j/G;
+            s = &P[3*(j*(G+1)+i)];
+
+            /* Diagonal (u0,v0)-(u1,v1) */
+            if (a>=b){
+                d = nrbTessTriDist(s, P00, P10, P11, a-b, b);
+            }
+            else{
+                d = nrbTessTriDist(s, P00, P01, P11, b-a, a);
+            }
+            err1 = (d>err1) ? d : err1;
+
+            /* Diagonal (u1,v0)-(u0,v1) */
+            if (a+b<=1.0){
+                d = nrbTessTriDist(s, P00, P10, P01, a, b);
+            }
+            else{
+                d = nrbTessTriDist(s, P11, P01, P10, 1.0-a, 1.0-b);
+            }
+            err2 = (d>err2) ? d : err2;
+
+            /* Fan from the centre */
+            if (b<=a && a+b<=1.0){
+                d = nrbTessTriDist(s, P00, P10, Pc, a-b, 2.0*b);
+            }
+            else if (b<=a){
+                d = nrbTessTriDist(s, P10, P11, Pc, b-(1.0-a), 2.0*(1.0-a));
+            }
+            else if (a+b>=1.0){
+                d = nrbTessTriDist(s, P11, P01, Pc, (1.0-a)-(1.0-b), 2.0*(1.0-b));
+            }
+            else{
+                d = nrbTessTriDist(s, P01, P00, Pc, (1.0-b)-a, 2.0*a);
+            }
+            errFan = (d>errFan) ? d : errFan;
+        }
+    }
+
+    /* Deviation from the chords in u and v, for the direction of the split */
+    for (k = 0; k <= G; k += G/2){
+        d = nrbTessTriDist(&P[3*(k*(G+1)+G/2)], &P[3*k*(G+1)], &P[3*(k*(G+1)+G)], &P[3*k*(G+1)], 0.5, 0.0);
+        errU = (d>errU) ? d : errU;
+        d = nrbTessTriDist(&P[3*((G/2)*(G+1)+k)], &P[3*k], &P[3*(G*(G+1)+k)], &P[3*k], 0.5, 0.0);
+        errV = (d>errV) ? d : errV;
+    }
+
+    diagonal = (err2<err1) ? 1 : 0;
+    d = (err1<err2) ? err1 : err2;
+    d = (errFan>d) ? errFan : d;
+
+    knotsU = nrbTessKnotSplit(ts->net->knotU, ts->net->orderU, ts->net->ncp-1, u0, u1, &uSplit);
+    knotsV = nrbTessKnotSplit(ts->net->knotV, ts->net->orderV, ts->net->kcp-1, v0, v1, &vSplit);
+
+    splitU = 0;
+    splitV = 0;
+    if (depthU==0 && depthV==0){
+        splitU = 1;
+        splitV = 1;
+    }
+    else if (d>ts->tol){
+        splitU = !(errV>NRB_TESSANISO*errU);
+        splitV = !(errU>NRB_TESSANISO*errV);
+    }
+    if (knotsU>NRB_TESSMAXKNOTS){
+        splitU = 1;
+    }
+    if (knotsV>NRB_TESSMAXKNOTS){
+        splitV = 1;
+    }
+    if (num>0){
+        /* The loop must pass once, and be almost straight at the size of the cell */
+        a = nrbTessTriDist(P11, P00, P00, P00, 0.0, 0.0);
+        b = nrbTessTriDist(P10, P01, P01, P01, 0.0, 0.0);
+        if (num-numVert>1 || 0.25*turn*((a>b) ? a : b)>ts->tol){
+            splitU = (u1-u0)>=0.5*(v1-v0) || splitU;
+            splitV = (v1-v0)>=0.5*(u1-u0) || splitV;
+        }
+    }
+    if (depthU>=NRB_TESSMAXDEPTH || !(u0<uSplit && uSplit<u1)){
+        splitU = 0;
+    }
+    if (depthV>=NRB_TESSMAXDEPTH || !(v0<vSplit && vSplit<v1)){
+        splitV = 0;
+    }
+    if ((splitU || splitV) && ts->numLeaves>=NRB_TESSMAXLEAVES){
+        splitU = 0;
+        splitV = 0;
+        ts->truncated = 1;
+    }
+
+    if (splitU && splitV){
+        nrbTessCell(ts, u0, uSplit, v0, vSplit, depthU+1, depthV+1, first, num);
+        nrbTessCell(ts, uSplit, u1, v0, vSplit, depthU+1, depthV+1, first, num);
+        nrbTessCell(ts, u0, uSplit, vSplit, v1, depthU+1, depthV+1, first, num);
+        nrbTessCell(ts, uSplit, u1, vSplit, v1, depthU+1, depthV+1, first, num);
+    }
+    else if (splitU){
+        nrbTessCell(ts, u0, uSplit, v0, v1, depthU+1, depthV, first, num);
+        nrbTessCell(ts, uSplit, u1, v0, v1, depthU+1, depthV, first, num);
+    }
+    else if (splitV){
+        nrbTessCell(ts, u0, u1, v0, vSplit, depthU, depthV+1, first, num);
+        nrbTessCell(ts, u0, u1, vSplit, v1, depthU, depthV+1, first, num);
+    }
+    else{
+        if (ts->numLeaves==ts->leafCap){
+            ts->leafCap = 2*ts->leafCap+64;
+            ts->leaf = (nrbTessLeaf*) realloc(ts->leaf, ts->leafCap*sizeof(nrbTessLeaf));
+        }
+        ts->leaf[ts->numLeaves].u0 = u0;
+        ts->leaf[ts->numLeaves].u1 = u1;
+        ts->leaf[ts->numLeaves].v0 = v0;
+        ts->leaf[ts->numLeaves].v1 = v1;
+        ts->leaf[ts->numLeaves].diagonal = diagonal;
+        ts->leaf[ts->numLeaves].trimmed = (num>0);
+        ts->numLeaves++;
+    }
+
+    ts->segStackLen = first;
+
+}
+
+
+static int nrbTessCompareVU(const void *a, const void *b){
+    /* nrbTessCompareVU orders vertices by v, then u */
+
+    const nrbTessVertex *p = (const nrbTessVertex*)a, *q = (const nrbTessVertex*)b;
+
+    if (p->v!=q->v){
+        return (p->v<q->v) ? -1 : 1;
+    }
+    if (p->u!=q->u){
+        return (p->u<q->u) ? -1 : 1;
+    }
+    return 0;
+
+}
+
+
+static int nrbTessCompareUV(const void *a, const void *b){
+    /* nrbTessCompareUV orders vertices by u, then v */
+
+    const nrbTessVertex *p = (const nrbTessVertex*)a, *q = (const nrbTessVertex*)b;
+
+    if (p->u!=q->u){
+        return (p->u<q->u) ? -1 : 1;
+    }
+    if (p->v!=q->v){
+        return (p->v<q->v) ? -1 : 1;
+    }
+    return 0;
+
+}
+
+
+static int nrbTessFind(const nrbTessVertex *vert, int numVert, double u, double v, int byU){
+    /* nrbTessFind returns the first vertex not before (u,v) in vert sorted by (v,u), or by (u,v) if byU */
+
+    int lo = 0, hi = numVert, mid;
+    nrbTessVertex key;
+
+    key.u = u;
+    key.v = v;
+    while (lo<hi){
+        mid = lo+(hi-lo)/2;
+        if ((byU ? nrbTessCompareUV(&vert[mid], &key) : nrbTessCompareVU(&vert[mid], &key))<0){
+            lo = mid+1;
+        }
+        else{
+            hi = mid;
+        }
+    }
+    return lo;
+
+}
+
+
+typedef struct {
+    double *uv;             /* vertices (2 x numVert) */
+    int numVert, vertCap;
+    int *tri;               /* triangles (3 x numTri), 0-based */
+    int numTri, triCap;
+} nrbTessMesh;
+
+
+static int nrbTessAddVertex(nrbTessMesh *mesh, double u, double v){
+    /* nrbTessAddVertex adds a vertex, returns its index */
+
+    if (mesh->numVert==mesh->vertCap){
+        mesh->vertCap = 2*mesh->vertCap+64;
+        mesh->uv = (double*) realloc(mesh->uv, 2*mesh->vertCap*sizeof(double));
+    }
+    mesh->uv[2*mesh->numVert] = u;
+    mesh->uv[2*mesh->numVert+1] = v;
+    return mesh->numVert++;
+
+}
+
+
+static void nrbTessAddTriangle(nrbTessMesh *mesh, int a, int b, int c){
+    /* nrbTessAddTriangle adds a triangle unless it has no area */
+
+    double *p = &mesh->uv[2*a], *q = &mesh->uv[2*b], *r = &mesh->uv[2*c];
+
+    if ((q[0]-p[0])*(r[1]-p[1])-(q[1]-p[1])*(r[0]-p[0])<=0.0){
+        return;
+    }
+    if (mesh->numTri==mesh->triCap){
+        mesh->triCap = 2*mesh->triCap+64;
+        mesh->tri = (int*) realloc(mesh->tri, 3*mesh->triCap*sizeof(int));
+    }
+    mesh->tri[3*mesh->numTri] = a;
+    mesh->tri[3*mesh->numTri+1] = b;
+    mesh->tri[3*mesh->numTri+2] = c;
+    mesh->numTri++;
+
+}
+
+
+static void nrbTessTriangulate(nrbTess *ts, nrbTessMesh *mesh, int *trimmedFirst){
+    /* nrbTessTriangulate triangulates the leaves without cracks, the triangles of trimmed leaves are put last from trimmedFirst */
+
+    int i, k, m, n, numCorner, numUnique, pass, *poly, centre;
+    nrbTessVertex *byVU, *byU;
+    nrbTessLeaf *lf;
+
+    /* Unique corners of the leaves */
+    numCorner = 4*ts->numLeaves;
+    byVU = (nrbTessVertex*) malloc((numCorner>0 ? numCorner : 1)*sizeof(nrbTessVertex));
+    for (k = 0; k < ts->numLeaves; k++){
+        lf = &ts->leaf[k];
+        byVU[4*k].u = lf->u0;
+        byVU[4*k].v = lf->v0;
+        byVU[4*k+1].u = lf->u1;
+        byVU[4*k+1].v = lf->v0;
+        byVU[4*k+2].u = lf->u1;
+        byVU[4*k+2].v = lf->v1;
+        byVU[4*k+3].u = lf->u0;
+        byVU[4*k+3].v = lf->v1;
+    }
+    qsort(byVU, numCorner, sizeof(nrbTessVertex), nrbTessCompareVU);
+    numUnique = 0;
+    for (k = 0; k < numCorner; k++){
+        if (numUnique==0 || nrbTessCompareVU(&byVU[numUnique-1], &byVU[k])!=0){
+            byVU[numUnique] = byVU[k];
+            byVU[numUnique].index = nrbTessAddVertex(mesh, byVU[k].u, byVU[k].v);
+            numUnique++;
+        }
+    }
+    byU = (nrbTessVertex*) malloc((numUnique>0 ? numUnique : 1)*sizeof(nrbTessVertex));
+    memcpy(byU, byVU, numUnique*sizeof(nrbTessVertex));
+    qsort(byU, numUnique, sizeof(nrbTessVertex), nrbTessCompareUV);
+    poly = (int*) malloc((numUnique+4)*sizeof(int));
+
+    /* Untrimmed leaves first, then trimmed leaves */
+    for (pass = 0; pass < 2; pass++){
+        if (pass==1){
+            *trimmedFirst = mesh->numTri;
+        }
+        for (k = 0; k < ts->numLeaves; k++){
+            lf = &ts->leaf[k];
+            if (lf->trimmed!=pass){
+                continue;
+            }
+
+            /* Boundary of the leaf counter-clockwise, with the vertices of smaller neighbours */
+            n = 0;
+            for (m = 0; m < 4; m++){
+                if (m==0){
+                    i = nrbTessFind(byVU, numUnique, lf->u0, lf->v0, 0);
+                    poly[n++] = byVU[i].index;
+                    for (i++; i < numUnique && byVU[i].v==lf->v0 && byVU[i].u<lf->u1; i++){
+                        poly[n++] = byVU[i].index;
+                    }
+                }
+                else if (m==1){
+                    i = nrbTessFind(byU, numUnique, lf->u1, lf->v0, 1);
+                    poly[n++] = byU[i].index;
+                    for (i++; i < numUnique && byU[i].u==lf->u1 && byU[i].v<lf->v1; i++){
+                        poly[n++] = byU[i].index;
+                    }
+                }
+                else if (m==2){
+                    i = nrbTessFind(byVU, numUnique, lf->u1, lf->v1, 0);
+                    poly[n++] = byVU[i].index;
+                    for (i--; i >= 0 && byVU[i].v==lf->v1 && byVU[i].u>lf->u0; i--){
+                        poly[n++] = byVU[i].index;
+                    }
+                }
+                else{
+                    i = nrbTessFind(byU, numUnique, lf->u0, lf->v1, 1);
+                    poly[n++] = byU[i].index;
+                    for (i--; i >= 0 && byU[i].u==lf->u0 && byU[i].v>lf->v0; i--){
+                        poly[n++] = byU[i].index;
+                    }
+                }
+            }
+
+            if (n==4){
+                if (lf->diagonal==0){
+                    nrbTessAddTriangle(mesh, poly[0], poly[1], poly[2]);
+                    nrbTessAddTriangle(mesh, poly[0], poly[2], poly[3]);
+                }
+                else{
+                    nrbTessAddTriangle(mesh, poly[0], poly[1], poly[3]);
+                    nrbTessAddTriangle(mesh, poly[1], poly[2], poly[3]);
+                }
+            }
+            else{
+                centre = nrbTessAddVertex(mesh, 0.5*(lf->u0+lf->u1), 0.5*(lf->v0+lf->v1));
+                for (m = 0; m < n; m++){
+                    nrbTessAddTriangle(mesh, centre, poly[m], poly[(m+1)%n]);
+                }
+            }
+        }
+    }
+
+    free(poly);
+    free(byU);
+    free(byVU);
+
+}
+
+
+static int nrbTessCutVertex(nrbTessMesh *mesh, const nrbTrim *trim, int *table, int tableSize, int in, int out){
+    /* nrbTessCutVertex returns the vertex where the edge from vertex in to vertex out crosses a trimming loop, shared by the triangles of the edge */
+
+    /* nrbTessCutVertex( mesh - pointer to mesh, trim - pointer to trimming loops, table - hash table of cut edges (3 x tableSize), tableSize - power of 2, in, out - vertices of the edge inside and outside) */
+
+    int lo = (in<out) ? in : out, hi = (in<out) ? out : in;
+    unsigned int h = ((unsigned int)lo*2654435761u) ^ ((unsigned int)hi*40503u);
+    double a[2], b[2], t;
+
+    h &= (unsigned int)(tableSize-1);
+    while (table[3*h]>=0){
+        if (table[3*h]==lo && table[3*h+1]==hi){
+            return table[3*h+2];
+        }
+        h = (h+1) & (unsigned int)(tableSize-1);
+    }
+    a[0] = mesh->uv[2*in];
+    a[1] = mesh->uv[2*in+1];
+    b[0] = mesh->uv[2*out];
+    b[1] = mesh->uv[2*out+1];
+    t = nrbTrimCrossing(trim, a, b);
+    table[3*h] = lo;
+    table[3*h+1] = hi;
+    table[3*h+2] = nrbTessAddVertex(mesh, a[0]+t*(b[0]-a[0]), a[1]+t*(b[1]-a[1]));
+    return table[3*h+2];
+
+}
+
+
+static void nrbTessCut(nrbTessMesh *mesh, const nrbTrim *trim, int trimmedFirst){
+    /* nrbTessCut cuts the triangles from trimmedFirst by the trimming loops */
+
+    int k, m, numTri, tableSize, *table, *inside, *tri, v[3], x, y;
+
+    numTri = mesh->numTri-trimmedFirst;
+    tri = (int*) malloc((numTri>0 ? 3*numTri : 1)*sizeof(int));
+    memcpy(tri, &mesh->tri[3*trimmedFirst], 3*numTri*sizeof(int));
+    mesh->numTri = trimmedFirst;
+
+    for (tableSize = 64; tableSize < 4*numTri; tableSize *= 2){
+    }
+    table = (int*) malloc(3*tableSize*sizeof(int));
+    for (k = 0; k < tableSize; k++){
+        table[3*k] = -1;
+    }
+    inside = (int*) malloc((mesh->numVert>0 ? mesh->numVert : 1)*sizeof(int));
+    for (k = 0; k < mesh->numVert; k++){
+        inside[k] = -1;
+    }
+
+    for (k = 0; k < numTri; k++){
+        x = 0;
+        for (m = 0; m < 3; m++){
+            v[m] = tri[3*k+m];
+            if (inside[v[m]]<0){
+                inside[v[m]] = nrbTrimInside(trim, mesh->uv[2*v[m]], mesh->uv[2*v[m]+1]);
+            }
+            x += inside[v[m]];
+        }
+        if (x==3){
+            nrbTessAddTriangle(mesh, v[0], v[1], v[2]);
+        }
+        else if (x==1){
+            /* Rotate the inside vertex first */
+            for (m = 0; !inside[v[m]]; m++){
+            }
+            x = nrbTessCutVertex(mesh, trim, table, tableSize, v[m], v[(m+1)%3]);
+            y = nrbTessCutVertex(mesh, trim, table, tableSize, v[m], v[(m+2)%3]);
+            nrbTessAddTriangle(mesh, v[m], x, y);
+        }
+        else if (x==2){
+            /* Rotate the outside vertex last */
+            for (m = 0; inside[v[(m+2)%3]]; m++){
+            }
+            x = nrbTessCutVertex(mesh, trim, table, tableSize, v[(m+1)%3], v[(m+2)%3]);
+            y = nrbTessCutVertex(mesh, trim, table, tableSize, v[m], v[(m+2)%3]);
+            nrbTessAddTriangle(mesh, v[m], v[(m+1)%3], x);
+            nrbTessAddTriangle(mesh, v[m], x, y);
+        }
+    }
+
+    free(inside);
+    free(table);
+    free(tri);
+
+}
+
+
+static void nrbTessellate(const nrbNet *net, double tol, const nrbTrim *trim, nrbTessMesh *mesh, int *truncated){
+    /* nrbTessellate tessellates a surface net, the mesh has only vertices used by triangles */
+
+    /* nrbTessellate( net - pointer to surface net, tol - chord error tolerance, trim - pointer to trimming loops or NULL, mesh - pointer to mesh (empty), truncated - set to 1 if the number of cells was limited) */
+
+    int k, numUsed, trimmedFirst, *newIndex;
+    nrbTess ts;
+
+    ts.net = net;
+    ts.tol = tol;
+    ts.trim = (trim!=NULL && trim->numSeg>0) ? trim : NULL;
+    ts.segStackLen = 0;
+    ts.segStackCap = 0;
+    ts.segStack = NULL;
+    ts.leaf = NULL;
+    ts.numLeaves = 0;
+    ts.leafCap = 0;
+    ts.truncated = 0;
+    if (!nrbScratchInit(&ts.scr, net->orderU, net->orderV)){
+        mexErrMsgTxt("Out of memory.");
+    }
+
+    if (ts.trim!=NULL){
+        ts.segStackCap = 2*ts.trim->numSeg;
+        ts.segStack = (int*) malloc(ts.segStackCap*sizeof(int));
+        for (k = 0; k < ts.trim->numSeg; k++){
+            ts.segStack[k] = k;
+        }
+        ts.segStackLen = ts.trim->numSeg;
+    }
+
+    nrbTessCell(&ts, net->knotU[net->orderU-1], net->knotU[net->ncp], net->knotV[net->orderV-1], net->knotV[net->kcp], 0, 0, 0, ts.segStackLen);
+
+    mesh->uv = NULL;
+    mesh->numVert = 0;
+    mesh->vertCap = 0;
+    mesh->tri = NULL;
+    mesh->numTri = 0;
+    mesh->triCap = 0;
+    nrbTessTriangulate(&ts, mesh, &trimmedFirst);
+    if (ts.trim!=NULL){
+        nrbTessCut(mesh, ts.trim, trimmedFirst);
+    }
+
+    /* Remove vertices not used by any triangle */
+    newIndex = (int*) malloc((mesh->numVert>0 ? mesh->numVert : 1)*sizeof(int));
+    for (k = 0; k < mesh->numVert; k++){
+        newIndex[k] = -1;
+    }
+    for (k = 0; k < 3*mesh->numTri; k++){
+        newIndex[mesh->tri[k]] = 0;
+    }
+    numUsed = 0;
+    for (k = 0; k < mesh->numVert; k++){
+        if (newIndex[k]==0){
+            newIndex[k] = numUsed;
+            mesh->uv[2*numUsed] = mesh->uv[2*k];
+            mesh->uv[2*numUsed+1] = mesh->uv[2*k+1];
+            numUsed++;
+        }
+    }
+    for (k = 0; k < 3*mesh->numTri; k++){
+        mesh->tri[k] = newIndex[mesh->tri[k]];
+    }
+    mesh->numVert = numUsed;
+    free(newIndex);
+
+    *truncated = ts.truncated;
+    free(ts.segStack);
+    free(ts.leaf);
+    nrbScratchFree(&ts.scr);
+
+}
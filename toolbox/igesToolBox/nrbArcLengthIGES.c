@@ -0,0 +1,347 @@
+/**************************************************************************
+ *
+ * function tab=nrbArcLengthIGES(crv)
+ *
+ * Arc length tables of NURBS curves, for evaluation of the curves at
+ * given arc lengths, e.g. at points with the same distance along the
+ * curve.
+ *
+ * The length of every knot span is computed with Gauss-Legendre
+ * quadrature, and the spans are split until the length of each part is
+ * accurate to about 1e-11 relative. A parameter value at a given arc
+ * length is found from the table with a binary search and a few Newton
+ * steps.
+ *
+ * Usage in Matlab:
+ *
+ *  Build the arc length table(s)
+ * tab=nrbArcLengthIGES(crv)
+ * tabs=nrbArcLengthIGES(crvs)
+ * tab=nrbArcLengthIGES(crv,range)
+ * tabs=nrbArcLengthIGES(crvs,ranges)
+ *
+ *  Lengths of the curves
+ * L=nrbArcLengthIGES(tab)
+ * L=nrbArcLengthIGES(tabs)
+ *
+ *  Points at given arc lengths of one curve
+ * [P,t,T]=nrbArcLengthIGES(tab,crv,s)
+ *
+ *  Points at given arc lengths of many curves
+ * [P,t,T]=nrbArcLengthIGES(tabs,crvs,n)
+ * [P,t,T]=nrbArcLengthIGES(tabs,crvs,s)
+ *
+ * Options (after the other inputs):
+ *
+ * [P,t,T]=nrbArcLengthIGES(...,'threads',n)
+ *
+ * n - number of threads, 1 gives serial evaluation, 0 (default) uses
+ *     all available threads. The results do not depend on n. Multiple
+ *     threads are only used if the mex file is compiled with OpenMP
+ *     (see makeIGESmex).
+ *
+ * Input:
+ * crv - NURBS curve, either compiled (output from nrbCompileIGES) or a
+ *       NURBS structure.
+ * crvs - cell array of NURBS curves.
+ * range - Parameter interval [t0 t1] of the table, default the
+ *         whole curve. The arc lengths are measured from t0.
+ * ranges - Parameter intervals of the tables of crvs (2xnumel(crvs)).
+ * tab - Arc length table of crv (output from nrbArcLengthIGES(crv)).
+ * tabs - cell array of arc length tables of crvs (output from
+ *        nrbArcLengthIGES(crvs)).
+ * s - Arc lengths from the start of the curve (1xN), or for many
+ *     curves a cell array with the arc lengths of every curve. Arc
+ *     lengths outside [0,L] give the end points.
+ * n - Number of points on every curve, scalar or one number for every
+ *     curve. The points are at the arc lengths L*(0:n-1)/(n-1).
+ *
+ * Output:
+ * tab - Row vector with the arc length table.
+ * tabs - Cell array of arc length tables, same size as crvs.
+ * L - Lengths of the curves (1xnumel(tabs)).
+ * P - Points on the curve (3xN), for many curves a cell array.
+ * t - Parameter values of P (1xN), for many curves a cell array.
+ * T - Unit tangents at P (3xN), for many curves a cell array. T is zero
+ *     where the derivative of the curve is zero.
+ *
+ * c-file can be downloaded for free at
+ *
+ * http://www.mathworks.com/matlabcentral/fileexchange/13253-iges-toolbox
+ *
+ * compile in Matlab by using the command  "mex nrbArcLengthIGES.c"
+ *
+ * See "help mex" for more information
+ *
+ **************************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mex.h"
+
+/* Input Arguments */
+
+#define	tabstructure	prhs[0]
+#define	crvstructure	prhs[1]
+#define	arclengths	prhs[2]
+#define	paramranges	prhs[1]
+
+/* Sub functions (in folder "mexSourceFiles") */
+
+#include "mexSourceFiles/FindSpan.c"
+#include "mexSourceFiles/BasisFuns.c"
+#include "mexSourceFiles/DersBasisFuns.c"
+#include "mexSourceFiles/NURBScurveDersEval.c"
+#include "mexSourceFiles/NURBSsurfaceDersEval.c"
+#include "mexSourceFiles/nrbCompiled.c"
+#include "mexSourceFiles/nrbDersEval.c"
+#include "mexSourceFiles/nrbOptions.c"
+#include "mexSourceFiles/nrbArcLength.c"
+
+/* Sets up the compiled NURBS of the curve crv */
+
+static void nrbCurveFromArray(const mxArray *crv, nrbCompiled *nrb){
+
+    if(nrbIsCompiled(crv)){
+        nrbCompiledFromArray(crv, nrb);
+    }
+    else if(crv!=NULL && mxIsStruct(crv) && mxGetField(crv, 0, "coefs")!=NULL && mxGetField(crv, 0, "knots")!=NULL && mxGetField(crv, 0, "order")!=NULL && mxGetNumberOfElements(mxGetField(crv, 0, "order"))==1){
+        if (mxGetM(mxGetField(crv, 0, "coefs"))!=4){
+            mexErrMsgTxt("nurbs.coefs must have 4 rows.");
+        }
+        nrbCompiledFromStruct(crv, NULL, NULL, 1, nrb);
+    }
+    else{
+        mexErrMsgTxt("Curves must be NURBS curves or compiled NURBS curves.");
+    }
+    if(nrb->numDirs!=1){
+        mexErrMsgTxt("Curves must be NURBS curves or compiled NURBS curves.");
+    }
+
+}
+
+/* Sets up the arc length table tabarr of the curve nrb */
+
+static void nrbTableFromArray(const mxArray *tabarr, const nrbCompiled *nrb, nrbArcLengthTable *tab){
+
+    if(!nrbIsArcLength(tabarr)){
+        mexErrMsgTxt("Tables must be arc length tables (output from nrbArcLengthIGES).");
+    }
+    nrbArcLengthFromArray(tabarr, tab);
+    if(!(tab->t0>=nrb->net[0].knotU[nrb->net[0].orderU-1] && tab->t1<=nrb->net[0].knotU[nrb->net[0].ncp] && tab->t0<=tab->t1)){
+        mexErrMsgTxt("The arc length tables must be the tables of the curves.");
+    }
+
+}
+
+/* Main function */
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]){
+
+    int k, numCrvs, nargs, numPnts, *numS;
+    double *s, *P, *t, *T, *range, **sPtr, **outPtr, *L;
+    mxArray *out[3], *arr;
+    nrbCompiled *crvs;
+    nrbArcLengthTable *tabs;
+    nrbArcLengthRows *rows;
+    nrbOptions opt;
+
+    if(nrhs<1 || nlhs>3){
+        mexErrMsgTxt("Wrong number of inputs or outputs.");
+    }
+    nargs = nrbParseOptions(nrhs, prhs, 1, &opt);
+    if(nargs<1 || nargs>3){
+        mexErrMsgTxt("Wrong number of inputs.");
+    }
+
+    if(nargs<3){
+
+        if(nlhs>1){
+            mexErrMsgTxt("Number of outputs must be 1 when the tables are built or the lengths are returned.");
+        }
+
+        /* L=nrbArcLengthIGES(tab) and L=nrbArcLengthIGES(tabs) */
+        if(nargs==1 && (nrbIsArcLength(tabstructure) || (mxIsCell(tabstructure) && mxGetNumberOfElements(tabstructure)>0 && nrbIsArcLength(mxGetCell(tabstructure, 0))))){
+            numCrvs = mxIsCell(tabstructure) ? (int)mxGetNumberOfElements(tabstructure) : 1;
+            plhs[0] = mxCreateDoubleMatrix(1, numCrvs, mxREAL);
+            L = mxGetPr(plhs[0]);
+            tabs = (nrbArcLengthTable*) mxMalloc(sizeof(nrbArcLengthTable));
+            for (k = 0; k < numCrvs; k++){
+                arr = mxIsCell(tabstructure) ? mxGetCell(tabstructure, k) : (mxArray*)tabstructure;
+                if(!nrbIsArcLength(arr)){
+                    mexErrMsgTxt("Tables must be arc length tables (output from nrbArcLengthIGES).");
+                }
+                nrbArcLengthFromArray(arr, tabs);
+                L[k] = tabs->length;
+            }
+            mxFree(tabs);
+            return;
+        }
+
+        numCrvs = mxIsCell(prhs[0]) ? (int)mxGetNumberOfElements(prhs[0]) : 1;
+        range = NULL;
+        if(nargs==2){
+            if(!mxIsDouble(paramranges) || (mxIsCell(prhs[0]) ? (mxGetM(paramranges)!=2 || (int)mxGetN(paramranges)!=numCrvs) : mxGetNumberOfElements(paramranges)!=2)){
+                mexErrMsgTxt("The parameter intervals must be a 2xN matrix, one column for every curve.");
+            }
+            range = mxGetPr(paramranges);
+        }
+
+        /* tab=nrbArcLengthIGES(crv) */
+        if(!mxIsCell(prhs[0])){
+            crvs = (nrbCompiled*) mxMalloc(sizeof(nrbCompiled));
+            rows = (nrbArcLengthRows*) mxMalloc(sizeof(nrbArcLengthRows));
+            nrbCurveFromArray(prhs[0], crvs);
+            nrbArcLengthBuild(crvs, (range!=NULL) ? range[0] : -HUGE_VAL, (range!=NULL) ? range[1] : HUGE_VAL, rows);
+            if(rows->failed){
+                free(rows->row);
+                mexErrMsgTxt("Out of memory.");
+            }
+            plhs[0] = nrbArcLengthToArray(rows);
+            free(rows->row);
+            mxFree(rows);
+            mxFree(crvs);
+            return;
+        }
+
+        /* tabs=nrbArcLengthIGES(crvs), the tables are computed in parallel and copied to Matlab arrays afterwards */
+        crvs = (nrbCompiled*) mxMalloc((numCrvs>0 ? numCrvs : 1)*sizeof(nrbCompiled));
+        rows = (nrbArcLengthRows*) mxMalloc((numCrvs>0 ? numCrvs : 1)*sizeof(nrbArcLengthRows));
+        for (k = 0; k < numCrvs; k++){
+            nrbCurveFromArray(mxGetCell(prhs[0], k), &crvs[k]);
+        }
+
+        nrbArcLengthBuildBatch(crvs, numCrvs, range, rows, nrbNumThreads(&opt, numCrvs));
+        for (k = 0; k < numCrvs; k++){
+            if(rows[k].failed){
+                for (k = 0; k < numCrvs; k++){
+                    free(rows[k].row);
+                }
+                mexErrMsgTxt("Out of memory.");
+            }
+        }
+
+        plhs[0] = mxCreateCellArray(mxGetNumberOfDimensions(prhs[0]), mxGetDimensions(prhs[0]));
+        for (k = 0; k < numCrvs; k++){
+            mxSetCell(plhs[0], k, nrbArcLengthToArray(&rows[k]));
+            free(rows[k].row);
+        }
+        mxFree(rows);
+        mxFree(crvs);
+        return;
+
+    }
+
+    /* [P,t,T]=nrbArcLengthIGES(tab,crv,s) */
+    if(!mxIsCell(tabstructure)){
+
+        crvs = (nrbCompiled*) mxMalloc(sizeof(nrbCompiled));
+        tabs = (nrbArcLengthTable*) mxMalloc(sizeof(nrbArcLengthTable));
+        nrbCurveFromArray(crvstructure, crvs);
+        nrbTableFromArray(tabstructure, crvs, tabs);
+        if(!mxIsDouble(arclengths) || mxIsComplex(arclengths)){
+            mexErrMsgTxt("s must be a real double array.");
+        }
+
+        numPnts = (int)mxGetNumberOfElements(arclengths);
+        s = mxGetPr(arclengths);
+        out[0] = mxCreateDoubleMatrix(3, numPnts, mxREAL);
+        out[1] = mxCreateDoubleMatrix(1, numPnts, mxREAL);
+        out[2] = (nlhs>2) ? mxCreateDoubleMatrix(3, numPnts, mxREAL) : NULL;
+        P = mxGetPr(out[0]);
+        t = mxGetPr(out[1]);
+        T = (out[2]!=NULL) ? mxGetPr(out[2]) : NULL;
+
+        if(!nrbArcLengthEvalBatch(crvs, tabs, s, numPnts, P, t, T, nrbNumThreads(&opt, (numPnts+NRB_ARCLENCHUNK-1)/NRB_ARCLENCHUNK))){
+            mexErrMsgTxt("Out of memory.");
+        }
+        for (k = 0; k < 3; k++){
+            if(k<nlhs || k==0){
+                plhs[k] = out[k];
+            }
+            else if(out[k]!=NULL){
+                mxDestroyArray(out[k]);
+            }
+        }
+        mxFree(tabs);
+        mxFree(crvs);
+        return;
+
+    }
+
+    /* [P,t,T]=nrbArcLengthIGES(tabs,crvs,n) and [P,t,T]=nrbArcLengthIGES(tabs,crvs,s) */
+    if(!mxIsCell(crvstructure) || mxGetNumberOfElements(crvstructure)!=mxGetNumberOfElements(tabstructure)){
+        mexErrMsgTxt("tabs and crvs must be cell arrays of the same size.");
+    }
+    numCrvs = (int)mxGetNumberOfElements(crvstructure);
+    crvs = (nrbCompiled*) mxMalloc((numCrvs>0 ? numCrvs : 1)*sizeof(nrbCompiled));
+    tabs = (nrbArcLengthTable*) mxMalloc((numCrvs>0 ? numCrvs : 1)*sizeof(nrbArcLengthTable));
+    numS = (int*) mxMalloc((numCrvs>0 ? numCrvs : 1)*sizeof(int));
+    sPtr = (double**) mxMalloc((numCrvs>0 ? numCrvs : 1)*sizeof(double*));
+    outPtr = (double**) mxMalloc(3*(numCrvs>0 ? numCrvs : 1)*sizeof(double*));
+    for (k = 0; k < numCrvs; k++){
+        nrbCurveFromArray(mxGetCell(crvstructure, k), &crvs[k]);
+        nrbTableFromArray(mxGetCell(tabstructure, k), &crvs[k], &tabs[k]);
+    }
+
+    if(mxIsCell(arclengths)){
+        if((int)mxGetNumberOfElements(arclengths)!=numCrvs){
+            mexErrMsgTxt("s must have one element for every curve.");
+        }
+        for (k = 0; k < numCrvs; k++){
+            arr = mxGetCell(arclengths, k);
+            if(arr!=NULL && (!mxIsDouble(arr) || mxIsComplex(arr))){
+                mexErrMsgTxt("The elements of s must be real double arrays.");
+            }
+            numS[k] = (arr==NULL) ? 0 : (int)mxGetNumberOfElements(arr);
+            sPtr[k] = (arr==NULL) ? NULL : mxGetPr(arr);
+        }
+    }
+    else{
+        if(!mxIsDouble(arclengths) || (mxGetNumberOfElements(arclengths)!=1 && (int)mxGetNumberOfElements(arclengths)!=numCrvs)){
+            mexErrMsgTxt("n must be a scalar or have one element for every curve.");
+        }
+        for (k = 0; k < numCrvs; k++){
+            numS[k] = (int)mxGetPr(arclengths)[(mxGetNumberOfElements(arclengths)==1) ? 0 : k];
+            if(numS[k]<0 || (double)numS[k]!=mxGetPr(arclengths)[(mxGetNumberOfElements(arclengths)==1) ? 0 : k]){
+                mexErrMsgTxt("n must be nonnegative integers.");
+            }
+            sPtr[k] = NULL;
+        }
+    }
+
+    for (k = 0; k < 3; k++){
+        out[k] = (k<nlhs || k==0) ? mxCreateCellArray(mxGetNumberOfDimensions(crvstructure), mxGetDimensions(crvstructure)) : NULL;
+    }
+    for (k = 0; k < numCrvs; k++){
+        arr = mxCreateDoubleMatrix(3, numS[k], mxREAL);
+        mxSetCell(out[0], k, arr);
+        outPtr[3*k] = mxGetPr(arr);
+        outPtr[3*k+1] = NULL;
+        outPtr[3*k+2] = NULL;
+        if(out[1]!=NULL){
+            arr = mxCreateDoubleMatrix(1, numS[k], mxREAL);
+            mxSetCell(out[1], k, arr);
+            outPtr[3*k+1] = mxGetPr(arr);
+        }
+        if(out[2]!=NULL){
+            arr = mxCreateDoubleMatrix(3, numS[k], mxREAL);
+            mxSetCell(out[2], k, arr);
+            outPtr[3*k+2] = mxGetPr(arr);
+        }
+    }
+
+    if(!nrbArcLengthEvalCurves(crvs, tabs, numCrvs, numS, sPtr, outPtr, nrbNumThreads(&opt, numCrvs))){
+        mexErrMsgTxt("Out of memory.");
+    }
+    for (k = 0; k < nlhs || k==0; k++){
+        plhs[k] = out[k];
+    }
+    mxFree(outPtr);
+    mxFree(sPtr);
+    mxFree(numS);
+    mxFree(tabs);
+    mxFree(crvs);
+
+}
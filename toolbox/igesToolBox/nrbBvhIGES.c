@@ -0,0 +1,227 @@
+/**************************************************************************
+ *
+ * function bvh=nrbBvhIGES(srfs)
+ *
+ * Bounding volume hierarchy (BVH) over many NURBS surfaces, for closest
+ * points of the surfaces and many lines/points.
+ *
+ * Line (3D):  r=r0+t*v
+ * Point (3D): r0
+ *
+ * The surfaces are split into sub-patches, one for every pair of nonempty
+ * knot spans, and the sub-patches are sorted into a tree of axis aligned
+ * boxes around their control points. The surface closest to a line/point
+ * is found by visiting only the boxes near it, so the time per line/point
+ * grows with the logarithm of the number of sub-patches instead of with
+ * the number of surfaces.
+ *
+ * Usage in Matlab:
+ *
+ *  Build the BVH
+ * bvh=nrbBvhIGES(srfs)
+ *
+ *  Closest point of all surfaces and line/point
+ * [P,UV,srfind,dist]=nrbBvhIGES(bvh,srfs,r0,v)
+ * [P,UV,srfind,dist]=nrbBvhIGES(bvh,srfs,r0)
+ *
+ *  Closest surface and start parameter values only (no Newton steps)
+ * [srfind,UV0,dist0]=nrbBvhIGES(bvh,r0,v)
+ * [srfind,UV0,dist0]=nrbBvhIGES(bvh,r0)
+ * e.g. for [P,UV]=closestNrbLinePointIGES(srfs{srfind(i)},UV0(:,i),r0(:,i))
+ *
+ * Options (after the other inputs):
+ *
+ * [P,UV,srfind]=nrbBvhIGES(...,'threads',n)
+ *
+ * n - number of threads, 1 gives serial evaluation, 0 (default) uses
+ *     all available threads. The results do not depend on n. Multiple
+ *     threads are only used if the mex file is compiled with OpenMP
+ *     (see makeIGESmex).
+ *
+ * [P,UV,srfind]=nrbBvhIGES(bvh,srfs,...,'seeds',k)
+ *
+ * k - number of start values for Newton's method on each surface
+ *     (default 1), as in closestNrbLinePointIGES. The first start value
+ *     is the closest sampled point.
+ *
+ * [P,UV,srfind]=nrbBvhIGES(bvh,srfs,...,'method',m)
+ *
+ * m - 'newton' (default) or 'trust', the closest point method as in
+ *     closestNrbLinePointIGES.
+ *
+ * Input:
+ * srfs - cell array of NURBS surfaces, either compiled (output from
+ *        nrbCompileIGES) or NURBS structures. The same srfs must be
+ *        given when the BVH is used.
+ * bvh - BVH (output from nrbBvhIGES(srfs)).
+ * r0,(v) - See Line/Point (3D) above. r0 (and v) must have the dimension (3xN)
+ *
+ * Output:
+ * bvh - Row vector with the boxes of the tree and points sampled on
+ *       every sub-patch.
+ * P - Closest points on the surfaces (3xN).
+ * UV - Parameter values at P (2xN).
+ * srfind - Index in srfs of the surface of P (1xN).
+ * dist - Distance between P and the line/point (1xN).
+ * UV0 - Parameter values of the sampled point closest to the line/point.
+ * dist0 - Distance between that sampled point and the line/point.
+ *
+ * The closest point method (as in closestNrbLinePointIGES) is started from the
+ * sampled point (9 points on every sub-patch) closest to the line/point
+ * on each of the 4 surfaces with the closest sampled points, and the
+ * closest result is kept. Like closestNrbLinePointIGES it may end in a
+ * local minimum of the distance, mostly for lines crossing strongly
+ * curved surfaces, use 'seeds' for more start values. Trimming curves
+ * are not taken into account.
+ *
+ * c-file can be downloaded for free at
+ *
+ * http://www.mathworks.com/matlabcentral/fileexchange/13253-iges-toolbox
+ *
+ * compile in Matlab by using the command  "mex nrbBvhIGES.c"
+ *
+ * See "help mex" for more information
+ *
+ **************************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mex.h"
+
+/* Input Arguments */
+
+#define	bvhstructure	prhs[0]
+
+/* Output Arguments */
+
+#define	bvh_out	plhs[0]
+
+/* Misc */
+
+#define MAXITER 50
+
+/* Sub functions (in folder "mexSourceFiles") */
+
+#include "mexSourceFiles/FindSpan.c"
+#include "mexSourceFiles/BasisFuns.c"
+#include "mexSourceFiles/DersBasisFuns.c"
+#include "mexSourceFiles/BspEval.c"
+#include "mexSourceFiles/BspEval2.c"
+#include "mexSourceFiles/BspEval2Fixed.c"
+#include "mexSourceFiles/NURBScurveDersEval.c"
+#include "mexSourceFiles/NURBSsurfaceDersEval.c"
+#include "mexSourceFiles/nrbCompiled.c"
+#include "mexSourceFiles/nrbNetEval.c"
+#include "mexSourceFiles/nrbNetEval2.c"
+#include "mexSourceFiles/nrbDersEval.c"
+#include "mexSourceFiles/nrbOptions.c"
+#include "mexSourceFiles/nrbD1D2eval.c"
+#include "mexSourceFiles/nrbD1D2eval2.c"
+#include "mexSourceFiles/nrbClampParam.c"
+#include "mexSourceFiles/nrbClosestPoint.c"
+#include "mexSourceFiles/nrbBvh.c"
+#include "mexSourceFiles/nrbBvhClosestBatch.c"
+
+/* Main function */
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]){
+    
+    int k, numSrfs, nargs, numPnts, numThreads, first, numOut;
+    const mxArray *point0, *linedirection;
+    mxArray *out[4];
+    double *P, *UV, *srfind, *dist;
+    nrbCompiled *srfs;
+    nrbBvh bvh;
+    nrbOptions opt;
+    
+    if(nrhs==1){
+        if(nlhs>1){
+            mexErrMsgTxt("Number of outputs must be 1 when the BVH is built.");
+        }
+        srfs = nrbSurfacesFromCell(prhs[0], &numSrfs);
+        bvh_out = nrbBvhCreate(srfs, numSrfs);
+        mxFree(srfs);
+        return;
+    }
+    
+    if(nrhs<2 || !nrbIsBvh(bvhstructure)){
+        mexErrMsgTxt("First input must be a BVH (output from nrbBvhIGES) or a cell array of surfaces.");
+    }
+    nrbBvhFromArray(bvhstructure, &bvh);
+    
+    srfs = NULL;
+    first = mxIsCell(prhs[1]) ? 2 : 1;
+    nargs = nrbParseOptions(nrhs, prhs, first+1, &opt);
+    if(nargs<first+1 || nargs>first+2){
+        mexErrMsgTxt("Wrong number of inputs.");
+    }
+    if(first==2){
+        srfs = nrbSurfacesFromCell(prhs[1], &numSrfs);
+        if(numSrfs!=bvh.numSrfs){
+            mexErrMsgTxt("srfs must be the surfaces of the BVH.");
+        }
+        if(nlhs>4){
+            mexErrMsgTxt("Number of outputs must be at most 4.");
+        }
+    }
+    else if(nlhs>3){
+        mexErrMsgTxt("Number of outputs must be at most 3.");
+    }
+    
+    point0 = prhs[first];
+    linedirection = (nargs==first+2) ? prhs[first+1] : NULL;
+    if(mxGetM(point0)!=3){
+        mexErrMsgTxt("r0 must have 3 rows.");
+    }
+    if(linedirection!=NULL){
+        if(mxGetM(linedirection)!=3){
+            mexErrMsgTxt("v must have 3 rows.");
+        }
+        if(mxGetN(linedirection)!=mxGetN(point0)){
+            mexErrMsgTxt("r0 and v must be of same size.");
+        }
+    }
+    
+    numPnts = (int)mxGetN(point0);
+    if(srfs!=NULL){
+        /* [P,UV,srfind,dist] */
+        numOut = 4;
+        out[0] = mxCreateDoubleMatrix(3, numPnts, mxREAL);
+        out[1] = mxCreateDoubleMatrix(2, numPnts, mxREAL);
+        out[2] = mxCreateDoubleMatrix(1, numPnts, mxREAL);
+        out[3] = mxCreateDoubleMatrix(1, numPnts, mxREAL);
+        P = mxGetPr(out[0]);
+        UV = mxGetPr(out[1]);
+        srfind = mxGetPr(out[2]);
+        dist = mxGetPr(out[3]);
+    }
+    else{
+        /* [srfind,UV0,dist0] */
+        numOut = 3;
+        out[0] = mxCreateDoubleMatrix(1, numPnts, mxREAL);
+        out[1] = mxCreateDoubleMatrix(2, numPnts, mxREAL);
+        out[2] = mxCreateDoubleMatrix(1, numPnts, mxREAL);
+        P = NULL;
+        srfind = mxGetPr(out[0]);
+        UV = mxGetPr(out[1]);
+        dist = mxGetPr(out[2]);
+    }
+    
+    numThreads = nrbNumThreads(&opt, (numPnts+NRB_CLOSESTCHUNK-1)/NRB_CLOSESTCHUNK);
+    
+    nrbBvhClosestBatch(&bvh, srfs, opt.method, opt.numSeeds, numPnts, mxGetPr(point0), (linedirection==NULL) ? NULL : mxGetPr(linedirection), 3, P, UV, srfind, dist, numThreads);
+    
+    for (k = 0; k < numOut; k++){
+        if(k<nlhs || k==0){
+            plhs[k] = out[k];
+        }
+        else{
+            mxDestroyArray(out[k]);
+        }
+    }
+    if(srfs!=NULL){
+        mxFree(srfs);
+    }
+    
+}
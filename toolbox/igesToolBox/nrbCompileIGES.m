@@ -0,0 +1,129 @@
+function srf = nrbCompileIGES(nurbs,dnurbs,d2nurbs)
+% Returns a compiled NURBS for fast repeated evaluation.
+% Use nrbevalIGES and closestNrbLinePointIGES for evaluation.
+%
+% Usage:
+% srf = nrbCompileIGES(nurbs)
+% srf = nrbCompileIGES(nurbs,dnurbs)
+% srf = nrbCompileIGES(nurbs,dnurbs,d2nurbs)
+% srf = nrbCompileIGES(nurbs,[])
+%
+% Input:
+% nurbs - NURBS object
+% dnurbs,d2nurbs - NURBS derivatives (output from nrbDerivativesIGES).
+%                  If omitted they are computed with nrbDerivativesIGES.
+%                  If dnurbs is empty, no derivatives are stored and
+%                  nrbevalIGES and closestNrbLinePointIGES evaluate the
+%                  derivatives from the basis function derivatives, which
+%                  needs less memory and is faster for second derivatives.
+%
+% Output:
+% srf - Row vector with the knots, control points and derivative
+%       control points packed in one contiguous array. srf can be
+%       given instead of the NURBS structure (and its derivatives) to
+%       nrbevalIGES and closestNrbLinePointIGES, which then do not need
+%       to read the NURBS structures again on every call.
+%
+% Example:
+% srf=nrbCompileIGES(ParameterData{i}.nurbs);
+% [P,Pu,Pv]=nrbevalIGES(srf,UV);
+% [P,UV]=closestNrbLinePointIGES(srf,UV0,r0,v);
+%
+% The memory layout is described in mexSourceFiles/nrbCompiled.c.
+%
+
+if nargin==1
+    [dnurbs,d2nurbs]=nrbDerivativesIGES(nurbs);
+elseif nargin==2
+    d2nurbs=[];
+end
+
+numdirs=length(nurbs.order);
+
+if numdirs==2
+    nets={nurbs};
+    if not(isempty(dnurbs))
+        nets=[nets,dnurbs(1:2)];
+        if not(isempty(d2nurbs))
+            nets=[nets,d2nurbs(1:3)];
+        end
+    end
+elseif numdirs==1
+    nets={nurbs};
+    if not(isempty(dnurbs))
+        nets=[nets,{dnurbs}];
+        if not(isempty(d2nurbs))
+            nets=[nets,{d2nurbs}];
+        end
+    end
+else
+    error('nurbs.order must have 1 or 2 elements.');
+end
+
+numnets=length(nets);
+
+% Header: magic number, version, number of parameters, number of nets and
+% for each net [orderU orderV ncp kcp offsetKnotU offsetKnotV offsetCoefs]
+
+lenhdr=4+7*numnets;
+hdr=zeros(1,lenhdr);
+hdr(1:4)=[1128419918 1 numdirs numnets];
+
+blocks=cell(1,3*numnets);
+pos=4*ceil(lenhdr/4);
+
+for k=1:numnets
+
+    net=nets{k};
+
+    if numdirs==2
+        knotsU=net.knots{1};
+        knotsV=net.knots{2};
+        ordU=net.order(1);
+        ordV=net.order(2);
+        ncp=size(net.coefs,2);
+        kcp=size(net.coefs,3);
+    else
+        if iscell(net.knots)
+            knotsU=net.knots{1};
+        else
+            knotsU=net.knots;
+        end
+        knotsV=[];
+        ordU=net.order(1);
+        ordV=0;
+        ncp=size(net.coefs,2);
+        kcp=1;
+    end
+
+    if size(net.coefs,1)~=4
+        error('nurbs.coefs must have 4 rows.');
+    end
+
+    blocks{3*k-2}=alignblock(knotsU);
+    blocks{3*k-1}=alignblock(knotsV);
+    blocks{3*k}=alignblock(net.coefs);
+
+    offU=pos;
+    pos=pos+length(blocks{3*k-2});
+    if isempty(knotsV)
+        offV=-1;
+    else
+        offV=pos;
+    end
+    pos=pos+length(blocks{3*k-1});
+    offC=pos;
+    pos=pos+length(blocks{3*k});
+
+    hdr(4+7*(k-1)+(1:7))=[ordU ordV ncp kcp offU offV offC];
+
+end
+
+srf=[hdr zeros(1,4*ceil(lenhdr/4)-lenhdr) blocks{:}];
+
+
+function blk=alignblock(A)
+% Block padded to a multiple of 4 elements (32 bytes)
+
+blk=reshape(A,1,[]);
+blk=[blk zeros(1,4*ceil(length(blk)/4)-length(blk))];
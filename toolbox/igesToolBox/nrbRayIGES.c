@@ -0,0 +1,198 @@
+/**************************************************************************
+ *
+ * function [t,UV,srfind,rayind,P]=nrbRayIGES(bvh,srfs,r0,v)
+ *
+ * Intersections of rays and NURBS surfaces, all hits of many rays and
+ * many surfaces sorted along each ray.
+ *
+ * Ray (3D): r=r0+t*v, t>=0
+ *
+ * The surfaces are split into knot span sub-patches as in nrbBvhIGES,
+ * and every sub-patch hit by a ray is subdivided until it is flat or
+ * missed by the ray. The hit is then found by Newton's method on the
+ * surface, so it is as accurate as the surface evaluation.
+ *
+ * Usage in Matlab:
+ *
+ *  With a BVH (output from nrbBvhIGES(srfs)), for many calls with the same surfaces
+ * [t,UV,srfind,rayind,P]=nrbRayIGES(bvh,srfs,r0,v)
+ *
+ *  The BVH is built in every call
+ * [t,UV,srfind,rayind,P]=nrbRayIGES(srfs,r0,v)
+ *
+ * Options (after the other inputs):
+ *
+ * [t,UV,srfind,rayind]=nrbRayIGES(...,'threads',n)
+ *
+ * n - number of threads, 1 gives serial evaluation, 0 (default) uses
+ *     all available threads. The results do not depend on n. Multiple
+ *     threads are only used if the mex file is compiled with OpenMP
+ *     (see makeIGESmex).
+ *
+ * [t,UV,srfind,rayind]=nrbRayIGES(...,'hits',k)
+ *
+ * k - maximum number of hits per ray, the k hits with the smallest t.
+ *     0 (default) returns all hits. With k=1 only the first hit of
+ *     every ray is found (e.g. for depth maps), and surfaces behind it
+ *     are skipped.
+ *
+ * Input:
+ * bvh - BVH (output from nrbBvhIGES(srfs)).
+ * srfs - cell array of NURBS surfaces, either compiled (output from
+ *        nrbCompileIGES) or NURBS structures.
+ * r0,v - See Ray (3D) above. r0 and v must have the dimension (3xN),
+ *        or one of them (3x1) for rays with the same origin or the
+ *        same direction.
+ *
+ * Output:
+ * t - Ray parameters of the hits (1xH), P=r0+t*v.
+ * UV - Parameter values of the hits (2xH).
+ * srfind - Index in srfs of the surface of the hits (1xH).
+ * rayind - Index of the ray of the hits (1xH). The hits are sorted by
+ *          rayind, and the hits of a ray by t.
+ * P - Points of the hits on the surfaces (3xH).
+ *
+ * A ray touching a surface (without crossing it) may be missed, and a
+ * hit on a boundary shared by two surfaces is returned for both.
+ * Trimming curves are not taken into account.
+ *
+ * c-file can be downloaded for free at
+ *
+ * http://www.mathworks.com/matlabcentral/fileexchange/13253-iges-toolbox
+ *
+ * compile in Matlab by using the command  "mex nrbRayIGES.c"
+ *
+ * See "help mex" for more information
+ *
+ **************************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mex.h"
+
+/* Output Arguments */
+
+#define	t_out	plhs[0]
+
+/* Sub functions (in folder "mexSourceFiles") */
+
+#include "mexSourceFiles/FindSpan.c"
+#include "mexSourceFiles/BasisFuns.c"
+#include "mexSourceFiles/DersBasisFuns.c"
+#include "mexSourceFiles/BspEval2.c"
+#include "mexSourceFiles/BspEval2Fixed.c"
+#include "mexSourceFiles/NURBScurveDersEval.c"
+#include "mexSourceFiles/NURBSsurfaceDersEval.c"
+#include "mexSourceFiles/nrbCompiled.c"
+#include "mexSourceFiles/nrbNetEval2.c"
+#include "mexSourceFiles/nrbDersEval.c"
+#include "mexSourceFiles/nrbOptions.c"
+#include "mexSourceFiles/nrbArena.c"
+#include "mexSourceFiles/nrbD1D2eval2.c"
+#include "mexSourceFiles/nrbClampParam.c"
+#include "mexSourceFiles/nrbBvh.c"
+#include "mexSourceFiles/nrbRay.c"
+
+/* Main function */
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]){
+    
+    int k, numSrfs, nargs, first, numRays, numHits, numThreads, strideR0, strideV;
+    const mxArray *point0, *raydirection;
+    mxArray *bvharr = NULL, *out[5];
+    double *tt, *UV, *srfind, *rayind, *P;
+    nrbCompiled *srfs;
+    nrbRayHit *hits;
+    nrbBvh bvh;
+    nrbOptions opt;
+    
+    if(nrhs<1){
+        mexErrMsgTxt("Wrong number of inputs.");
+    }
+    if(nlhs>5){
+        mexErrMsgTxt("Number of outputs must be at most 5.");
+    }
+    first = nrbIsBvh(prhs[0]) ? 1 : 0;
+    nargs = nrbParseOptions(nrhs, prhs, first+1, &opt);
+    if(nargs!=first+3){
+        mexErrMsgTxt("Wrong number of inputs.");
+    }
+    
+    srfs = nrbSurfacesFromCell(prhs[first], &numSrfs);
+    if(first==1){
+        nrbBvhFromArray(prhs[0], &bvh);
+        if(numSrfs!=bvh.numSrfs){
+            mexErrMsgTxt("srfs must be the surfaces of the BVH.");
+        }
+    }
+    else{
+        bvharr = nrbBvhCreate(srfs, numSrfs);
+        nrbBvhFromArray(bvharr, &bvh);
+    }
+    
+    point0 = prhs[first+1];
+    raydirection = prhs[first+2];
+    if(mxGetM(point0)!=3 || !mxIsDouble(point0)){
+        mexErrMsgTxt("r0 must have 3 rows.");
+    }
+    if(mxGetM(raydirection)!=3 || !mxIsDouble(raydirection)){
+        mexErrMsgTxt("v must have 3 rows.");
+    }
+    numRays = (int)mxGetN(point0);
+    strideR0 = 3;
+    strideV = 3;
+    if(mxGetN(raydirection)!=mxGetN(point0)){
+        if(mxGetN(point0)==1){
+            numRays = (int)mxGetN(raydirection);
+            strideR0 = 0;
+        }
+        else if(mxGetN(raydirection)==1){
+            strideV = 0;
+        }
+        else{
+            mexErrMsgTxt("r0 and v must be of same size, or one of them 3x1.");
+        }
+    }
+    
+    numThreads = nrbNumThreads(&opt, (numRays+NRB_RAYCHUNK-1)/NRB_RAYCHUNK);
+    
+    hits = nrbRayBatch(&bvh, srfs, numRays, mxGetPr(point0), strideR0, mxGetPr(raydirection), strideV, opt.maxHits, &numHits, numThreads);
+    
+    out[0] = mxCreateDoubleMatrix(1, numHits, mxREAL);
+    out[1] = mxCreateDoubleMatrix(2, numHits, mxREAL);
+    out[2] = mxCreateDoubleMatrix(1, numHits, mxREAL);
+    out[3] = mxCreateDoubleMatrix(1, numHits, mxREAL);
+    out[4] = mxCreateDoubleMatrix(3, numHits, mxREAL);
+    tt = mxGetPr(out[0]);
+    UV = mxGetPr(out[1]);
+    srfind = mxGetPr(out[2]);
+    rayind = mxGetPr(out[3]);
+    P = mxGetPr(out[4]);
+    for (k = 0; k < numHits; k++){
+        tt[k] = hits[k].t;
+        UV[2*k] = hits[k].uv[0];
+        UV[2*k+1] = hits[k].uv[1];
+        srfind[k] = (double)hits[k].srf;
+        rayind[k] = (double)(hits[k].ray+1);
+        P[3*k] = hits[k].P[0];
+        P[3*k+1] = hits[k].P[1];
+        P[3*k+2] = hits[k].P[2];
+    }
+    free(hits);
+    
+    t_out = out[0];
+    for (k = 1; k < 5; k++){
+        if(k<nlhs){
+            plhs[k] = out[k];
+        }
+        else{
+            mxDestroyArray(out[k]);
+        }
+    }
+    if(bvharr!=NULL){
+        mxDestroyArray(bvharr);
+    }
+    mxFree(srfs);
+    
+}
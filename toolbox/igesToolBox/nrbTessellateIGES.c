@@ -0,0 +1,191 @@
+/**************************************************************************
+ *
+ * function [P,TRI,UV]=nrbTessellateIGES(nurbs,tol,loops)
+ *
+ * Adaptive triangulation of a NURBS surface, with at most the distance
+ * tol between the triangles and the surface, optionally trimmed by
+ * closed loops in the parameter domain.
+ *
+ * The parameter domain is split into rectangles, more where the surface
+ * is curved and less where it is flat. Each rectangle is tested at 5x5
+ * parameter values and split until its triangles are within tol of the
+ * surface. Flat surfaces therefore get few triangles, and curved
+ * surfaces get enough triangles to be within tol.
+ *
+ * Usage in Matlab:
+ *
+ * [P,TRI,UV]=nrbTessellateIGES(nurbs,tol)
+ * [P,TRI,UV]=nrbTessellateIGES(nurbs,tol,loops)
+ *
+ * Input:
+ * nurbs - NURBS structure or compiled NURBS (output from nrbCompileIGES)
+ *         of a surface.
+ * tol - Largest allowed distance between a triangle and the surface
+ *       (chord error), measured at the same parameter values.
+ * loops - Cell array with closed polygons in the parameter domain
+ *         (2xK matrices, the last point may repeat the first), e.g. the
+ *         outer boundary and the holes of a trimmed surface (entity
+ *         144). A point is inside if it is inside an odd number of
+ *         polygons. Triangles crossed by a polygon are cut at it.
+ *         Polygons with less than 3 points are ignored.
+ *
+ * Output:
+ * P - Points on the surface (3xN).
+ * TRI - Triangles (Mx3), indices into P and UV. The triangles are
+ *       counter-clockwise in the parameter domain.
+ * UV - Parameter values of P (2xN).
+ *
+ * The chord error is tested at a grid of points in each rectangle, so
+ * features smaller than a quarter of a rectangle may be missed. Along
+ * trimming loops the error also depends on how well the polygons follow
+ * the trimming curves. A warning is given if the number of rectangles
+ * reaches its limit before tol is met.
+ *
+ * c-file can be downloaded for free at
+ *
+ * http://www.mathworks.com/matlabcentral/fileexchange/13253-iges-toolbox
+ *
+ * compile in Matlab by using the command  "mex nrbTessellateIGES.c"
+ *
+ * See "help mex" for more information
+ *
+ **************************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mex.h"
+
+/* Input Arguments */
+
+#define	nurbsstructure	prhs[0]
+#define	tolerance	prhs[1]
+#define	trimloops	prhs[2]
+
+/* Output Arguments */
+
+#define	evaluated_points	plhs[0]
+#define	triangles	plhs[1]
+#define	parametervalues	plhs[2]
+
+/* Sub functions (in folder "mexSourceFiles") */
+
+#include "mexSourceFiles/FindSpan.c"
+#include "mexSourceFiles/BasisFuns.c"
+#include "mexSourceFiles/DersBasisFuns.c"
+#include "mexSourceFiles/BspEval2.c"
+#include "mexSourceFiles/BspEval2Fixed.c"
+#include "mexSourceFiles/nrbCompiled.c"
+#include "mexSourceFiles/nrbNetEval2.c"
+#include "mexSourceFiles/nrbTessellate.c"
+
+/* Main function */
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+    
+    int i, k, numLoops, truncated, *loopLen;
+    double tol, **loops, *UV, *P, *T;
+    mxArray *loop;
+    nrbCompiled nrb;
+    nrbTrim trim;
+    nrbTessMesh mesh;
+    nrbScratch scr;
+    
+    if (nrhs<2 || nrhs>3 || nlhs>3){
+        mexErrMsgTxt("Wrong number of inputs or outputs.");
+    }
+    
+    if (nrbIsCompiled(nurbsstructure)){
+        nrbCompiledFromArray(nurbsstructure, &nrb);
+    }
+    else if (mxIsStruct(nurbsstructure)){
+        if (mxGetM(mxGetField(nurbsstructure, 0, "coefs"))!=4){
+            mexErrMsgTxt("nurbs.coefs must have 4 rows.");
+        }
+        if (mxGetNumberOfElements(mxGetField(nurbsstructure, 0, "order"))!=2){
+            mexErrMsgTxt("nurbs must be a surface.");
+        }
+        nrbCompiledFromStruct(nurbsstructure, NULL, NULL, 2, &nrb);
+    }
+    else{
+        mexErrMsgTxt("nurbs must be a NURBS structure or a compiled NURBS.");
+    }
+    if (nrb.numDirs!=2){
+        mexErrMsgTxt("nurbs must be a surface.");
+    }
+    
+    if (!mxIsDouble(tolerance) || mxGetNumberOfElements(tolerance)!=1 || !(mxGetScalar(tolerance)>0.0)){
+        mexErrMsgTxt("tol must be a positive scalar.");
+    }
+    tol = mxGetScalar(tolerance);
+    
+    /* Trimming loops */
+    
+    numLoops = 0;
+    if (nrhs>2 && !mxIsEmpty(trimloops)){
+        if (!mxIsCell(trimloops)){
+            mexErrMsgTxt("loops must be a cell array.");
+        }
+        numLoops = (int)mxGetNumberOfElements(trimloops);
+    }
+    loops = (double**) mxMalloc((numLoops>0 ? numLoops : 1)*sizeof(double*));
+    loopLen = (int*) mxMalloc((numLoops>0 ? numLoops : 1)*sizeof(int));
+    for (k = 0; k < numLoops; k++){
+        loop = mxGetCell(trimloops, k);
+        if (loop==NULL || mxIsEmpty(loop)){
+            loops[k] = NULL;
+            loopLen[k] = 0;
+            continue;
+        }
+        if (!mxIsDouble(loop) || mxGetM(loop)!=2){
+            mexErrMsgTxt("The polygons in loops must be 2xK matrices.");
+        }
+        loops[k] = mxGetPr(loop);
+        loopLen[k] = (int)mxGetN(loop);
+        for (i = 0; i < 2*loopLen[k]; i++){
+            if (!mxIsFinite(loops[k][i])){
+                mexErrMsgTxt("The polygons in loops must have finite coordinates.");
+            }
+        }
+    }
+    nrbTrimInit(&trim, loops, loopLen, numLoops);
+    mxFree(loops);
+    mxFree(loopLen);
+    
+    nrbTessellate(&nrb.net[0], tol, (numLoops>0) ? &trim : NULL, &mesh, &truncated);
+    nrbTrimFree(&trim);
+    if (truncated){
+        mexWarnMsgTxt("Maximum number of triangles reached, tol is not met everywhere.");
+    }
+    
+    /* Outputs */
+    
+    evaluated_points = mxCreateDoubleMatrix(3, mesh.numVert, mxREAL);
+    P = mxGetPr(evaluated_points);
+    if (!nrbScratchInit(&scr, nrb.net[0].orderU, nrb.net[0].orderV)){
+        mexErrMsgTxt("Out of memory.");
+    }
+    UV = mesh.uv;
+    for (k = 0; k < mesh.numVert; k += NRB_TESSGRID*NRB_TESSGRID){
+        nrbTessEval(&nrb.net[0], &UV[2*k], (mesh.numVert-k<NRB_TESSGRID*NRB_TESSGRID) ? mesh.numVert-k : NRB_TESSGRID*NRB_TESSGRID, &P[3*k], &scr);
+    }
+    nrbScratchFree(&scr);
+    
+    if (nlhs>1){
+        triangles = mxCreateDoubleMatrix(mesh.numTri, 3, mxREAL);
+        T = mxGetPr(triangles);
+        for (k = 0; k < mesh.numTri; k++){
+            T[k] = mesh.tri[3*k]+1;
+            T[k+mesh.numTri] = mesh.tri[3*k+1]+1;
+            T[k+2*mesh.numTri] = mesh.tri[3*k+2]+1;
+        }
+    }
+    if (nlhs>2){
+        parametervalues = mxCreateDoubleMatrix(2, mesh.numVert, mxREAL);
+        memcpy(mxGetPr(parametervalues), mesh.uv, 2*mesh.numVert*sizeof(double));
+    }
+    
+    free(mesh.uv);
+    free(mesh.tri);
+    
+}
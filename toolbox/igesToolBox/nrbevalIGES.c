@@ -20,6 +20,49 @@
  *
  * UV - 2xN matrix, N number of (u,v)-parameters
  *
+ * Usage 3 in Matlab (compiled NURBS curve or surface):
+ *
+ * [P,Pu,Pv,Puu,Puv,Pvv]=nrbevalIGES(srf,UV)
+ *
+ * srf - compiled NURBS (output from nrbCompileIGES).
+ *
+ * If dnurbs,d2nurbs are not given (or not compiled into srf) the
+ * derivatives are evaluated from the derivatives of the basis functions,
+ * i.e. P, Pu, Pv, Puu, Puv and Pvv are computed with one knot span search
+ * per parameter value:
+ *
+ * [P,Pu,Pv,Puu,Puv,Pvv]=nrbevalIGES(nurbs,UV)
+ * [P,Pu,Pv,Puu,Puv,Pvv]=nrbevalIGES(nrbCompileIGES(nurbs,[]),UV)
+ *
+ * Usage 4 in Matlab (NURBS surface on a grid):
+ *
+ * [P,Pu,Pv,Puu,Puv,Pvv]=nrbevalIGES(nurbs,{u,v})
+ * [P,Pu,Pv,Puu,Puv,Pvv]=nrbevalIGES(srf,{u,v})
+ *
+ * u,v - vectors of u- and v-parameters. P (3 x length(u)*length(v)) is the
+ *       same as nrbevalIGES(nurbs,[U(:)';V(:)']) with [V,U]=meshgrid(v,u),
+ *       i.e. u runs fastest. The basis functions are computed once per
+ *       u- and v-value. The derivatives are evaluated from the basis
+ *       function derivatives, dnurbs,d2nurbs are not needed.
+ *
+ * Options (after the other inputs):
+ *
+ * P=nrbevalIGES(...,'threads',n)
+ * P=nrbevalIGES(...,'precision',prec)
+ *
+ * n - number of threads, 1 gives serial evaluation, 0 (default) uses
+ *     all available threads. The results do not depend on n. Multiple
+ *     threads are only used if the mex file is compiled with OpenMP
+ *     (see makeIGESmex).
+ * prec - 'double' (default), 'single' or 'mixed'. With 'single' and
+ *        'mixed' the outputs are of class single, i.e. half the memory.
+ *        They are storage formats, not speed modes: the evaluation is
+ *        only slightly faster (if at all) than with 'double'.
+ *        'mixed' evaluates in double precision and rounds the results.
+ *        'single' evaluates P in single precision, about 7 significant
+ *        digits, and derivatives as 'mixed'. On grids {u,v} 'single'
+ *        is the same as 'mixed'.
+ *
  * Input:
  * nurbs - NURBS structure
  * UV - Parameter values
@@ -44,6 +87,8 @@
  **************************************************************************/
 
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 #include "mex.h"
 
 /* Input Arguments */
@@ -70,229 +115,120 @@
 
 #include "mexSourceFiles/FindSpan.c"
 #include "mexSourceFiles/BasisFuns.c"
+#include "mexSourceFiles/BasisFunsLanes.c"
+#include "mexSourceFiles/DersBasisFuns.c"
 #include "mexSourceFiles/BspEval.c"
 #include "mexSourceFiles/BspEval2.c"
+#include "mexSourceFiles/BspEval2Fixed.c"
 #include "mexSourceFiles/NURBScurveEval.c"
 #include "mexSourceFiles/NURBSsurfaceEval.c"
+#include "mexSourceFiles/NURBScurveDersEval.c"
+#include "mexSourceFiles/NURBSsurfaceDersEval.c"
+#include "mexSourceFiles/nrbCompiled.c"
+#include "mexSourceFiles/nrbNetEval.c"
+#include "mexSourceFiles/nrbNetEval2.c"
+#include "mexSourceFiles/nrbDersEval.c"
+#include "mexSourceFiles/nrbOptions.c"
+#include "mexSourceFiles/nrbArena.c"
+#include "mexSourceFiles/nrbSortedEval.c"
+#include "mexSourceFiles/nrbEvalBatch.c"
+#include "mexSourceFiles/nrbEvalSingle.c"
+#include "mexSourceFiles/nrbGridEval.c"
 
 /* Main function */
 
 void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
     
-    int i, j;
-    double *bspPnts, *weightsPnts, *weights, *weights2;
+    int k, nus, nu, nv, nargs, numDirs, numFullNets;
+    double *UV, *out[6];
+    float *outf[6];
+    mxClassID outClass;
+    nrbCompiled nrb;
+    nrbOptions opt;
     
-    if (mxGetM(mxGetField(nurbsstructure, 0, "coefs"))!=4){
-        mexPrintf("Number of rows in nurbs.coefs is %d,\n", mxGetM(mxGetField(nurbsstructure, 0, "coefs")));
-        mexErrMsgTxt("nurbs.coefs must have 4 rows.");
-    }
     if (nlhs==0 || nrhs<2){
         mexErrMsgTxt("Wrong number of inputs or outputs.");
     }
     
-    if (mxGetM(parametervalues)==2){
-        
-        int orderU = (int)mxGetPr(mxGetField(nurbsstructure, 0, "order"))[0];
-        int orderV = (int)mxGetPr(mxGetField(nurbsstructure, 0, "order"))[1];
-        
-        double *leftU  = (double*) malloc(orderU*sizeof(double)+1);
-        double *rightU = (double*) malloc(orderU*sizeof(double)+1);
-        double *NU = (double*) malloc(orderU*sizeof(double)+1);
-        double *leftV  = (double*) malloc(orderV*sizeof(double)+1);
-        double *rightV = (double*) malloc(orderV*sizeof(double)+1);
-        double *NV = (double*) malloc(orderV*sizeof(double)+1);
-        
-        if(nlhs==1 && nrhs==2){
-            
-            evaluated_points = mxCreateDoubleMatrix(3, mxGetN(parametervalues), mxREAL);
-            NURBSsurfaceEval(orderU-1, orderV-1, mxGetPr(mxGetField(nurbsstructure, 0, "coefs")), (int)mxGetDimensions(mxGetField(nurbsstructure, 0, "coefs"))[1], (int)mxGetDimensions(mxGetField(nurbsstructure, 0, "coefs"))[2], mxGetPr(mxGetCell(mxGetField(nurbsstructure, 0, "knots"), 0)), mxGetPr(mxGetCell(mxGetField(nurbsstructure, 0, "knots"), 1)), mxGetPr(parametervalues), (int)mxGetN(parametervalues), mxGetPr(evaluated_points), leftU, rightU, NU, leftV, rightV, NV);
-            
+    nargs = nrbParseOptions(nrhs, prhs, 2, &opt);
+    
+    if (mxIsCell(parametervalues)){
+        numDirs = (int)mxGetNumberOfElements(parametervalues);
+        if (numDirs!=1 && numDirs!=2){
+            mexErrMsgTxt("Wrong dimension of UV");
         }
-        else{
-            
-            bspPnts  = (double*) malloc(4*(mxGetN(parametervalues))*sizeof(double)+1);
-            
-            BspEval2(orderU-1, orderV-1, mxGetPr(mxGetField(nurbsstructure, 0, "coefs")), 4, (int)mxGetDimensions(mxGetField(nurbsstructure, 0, "coefs"))[1], (int)mxGetDimensions(mxGetField(nurbsstructure, 0, "coefs"))[2], mxGetPr(mxGetCell(mxGetField(nurbsstructure, 0, "knots"), 0)), mxGetPr(mxGetCell(mxGetField(nurbsstructure, 0, "knots"), 1)), mxGetPr(parametervalues), (int)mxGetN(parametervalues), bspPnts, leftU, rightU, NU, leftV, rightV, NV);
-            evaluated_points = mxCreateDoubleMatrix(3, mxGetN(parametervalues), mxREAL);
-            for (j = 0; j < mxGetN(parametervalues); j++){
-                for (i = 0; i < 3; i++){
-                    mxGetPr(evaluated_points)[3*j+i]=(bspPnts[4*j+i])/(bspPnts[4*j+3]);
-                }
-            }
-            
-            if(nlhs>1 && nrhs>2){
-                
-                weightsPnts = (double*) malloc(mxGetN(parametervalues)*sizeof(double)+1);
-                for (j = 0; j < mxGetN(parametervalues); j++){
-                    weightsPnts[j]=bspPnts[4*j+3];
-                }
-                
-                BspEval2(((int)mxGetPr(mxGetField(mxGetCell(dnurbsstructure, 0), 0, "order"))[0])-1, ((int)mxGetPr(mxGetField(mxGetCell(dnurbsstructure, 0), 0, "order"))[1])-1, mxGetPr(mxGetField(mxGetCell(dnurbsstructure, 0), 0, "coefs")), 4, (int)mxGetDimensions(mxGetField(mxGetCell(dnurbsstructure, 0), 0, "coefs"))[1], (int)mxGetDimensions(mxGetField(mxGetCell(dnurbsstructure, 0), 0, "coefs"))[2], mxGetPr(mxGetCell(mxGetField(mxGetCell(dnurbsstructure, 0), 0, "knots"), 0)), mxGetPr(mxGetCell(mxGetField(mxGetCell(dnurbsstructure, 0), 0, "knots"), 1)), mxGetPr(parametervalues), (int)mxGetN(parametervalues), bspPnts, leftU, rightU, NU, leftV, rightV, NV);
-                weights = (double*) malloc((mxGetN(parametervalues))*sizeof(double)+1);
-                for (j = 0; j < mxGetN(parametervalues); j++){
-                    weights[j]=bspPnts[4*j+3];
-                }
-                d2uevaluated_points = mxCreateDoubleMatrix(3, mxGetN(parametervalues), mxREAL);
-                for (j = 0; j < mxGetN(parametervalues); j++){
-                    for (i = 0; i < 3; i++){
-                        mxGetPr(d2uevaluated_points)[3*j+i]=(bspPnts[4*j+i]-(weights[j])*(mxGetPr(evaluated_points)[3*j+i]))/(weightsPnts[j]);
-                    }
-                }
-                
-                if(nlhs>2 && nrhs>2){
-                    
-                    BspEval2(((int)mxGetPr(mxGetField(mxGetCell(dnurbsstructure, 1), 0, "order"))[0])-1, ((int)mxGetPr(mxGetField(mxGetCell(dnurbsstructure, 1), 0, "order"))[1])-1, mxGetPr(mxGetField(mxGetCell(dnurbsstructure, 1), 0, "coefs")), 4, (int)mxGetDimensions(mxGetField(mxGetCell(dnurbsstructure, 1), 0, "coefs"))[1], (int)mxGetDimensions(mxGetField(mxGetCell(dnurbsstructure, 1), 0, "coefs"))[2], mxGetPr(mxGetCell(mxGetField(mxGetCell(dnurbsstructure, 1), 0, "knots"), 0)), mxGetPr(mxGetCell(mxGetField(mxGetCell(dnurbsstructure, 1), 0, "knots"), 1)), mxGetPr(parametervalues), (int)mxGetN(parametervalues), bspPnts, leftU, rightU, NU, leftV, rightV, NV);
-                    weights2 = (double*) malloc((mxGetN(parametervalues))*sizeof(double)+1);
-                    for (j = 0; j < mxGetN(parametervalues); j++){
-                        weights2[j]=(bspPnts[4*j+3]);
-                    }
-                    d2vevaluated_points = mxCreateDoubleMatrix(3, mxGetN(parametervalues), mxREAL);
-                    for (j = 0; j < mxGetN(parametervalues); j++){
-                        for (i = 0; i < 3; i++){
-                            mxGetPr(d2vevaluated_points)[3*j+i]=(bspPnts[4*j+i]-(weights2[j])*(mxGetPr(evaluated_points)[3*j+i]))/(weightsPnts[j]);
-                        }
-                    }
-                    
-                    if(nlhs>3 && nrhs==4){
-                        
-                        d2uuevaluated_points = mxCreateDoubleMatrix(3, mxGetN(parametervalues), mxREAL);
-                        if((mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 0), 0, "order"))[0])>0 && (mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 0), 0, "order"))[1])>0){
-                            BspEval2(((int)mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 0), 0, "order"))[0])-1, ((int)mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 0), 0, "order"))[1])-1, mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 0), 0, "coefs")), 4, (int)mxGetDimensions(mxGetField(mxGetCell(d2nurbsstructure, 0), 0, "coefs"))[1], (int)mxGetDimensions(mxGetField(mxGetCell(d2nurbsstructure, 0), 0, "coefs"))[2], mxGetPr(mxGetCell(mxGetField(mxGetCell(d2nurbsstructure, 0), 0, "knots"), 0)), mxGetPr(mxGetCell(mxGetField(mxGetCell(d2nurbsstructure, 0), 0, "knots"), 1)), mxGetPr(parametervalues), (int)mxGetN(parametervalues), bspPnts, leftU, rightU, NU, leftV, rightV, NV);
-                            for (j = 0; j < mxGetN(parametervalues); j++){
-                                for (i = 0; i < 3; i++){
-                                    mxGetPr(d2uuevaluated_points)[3*j+i]=(bspPnts[4*j+i]-2*(weights[j])*(mxGetPr(d2uevaluated_points)[3*j+i])-(bspPnts[4*j+3])*(mxGetPr(evaluated_points)[3*j+i]))/(weightsPnts[j]);
-                                }
-                            }
-                        }
-                        
-                        if(nlhs>4 && nrhs==4){
-                            
-                            d2uvevaluated_points = mxCreateDoubleMatrix(3, mxGetN(parametervalues), mxREAL);
-                            if((mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 1), 0, "order"))[0])>0 && (mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 1), 0, "order"))[1])>0){
-                                BspEval2(((int)mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 1), 0, "order"))[0])-1, ((int)mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 1), 0, "order"))[1])-1, mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 1), 0, "coefs")), 4, (int)mxGetDimensions(mxGetField(mxGetCell(d2nurbsstructure, 1), 0, "coefs"))[1], (int)mxGetDimensions(mxGetField(mxGetCell(d2nurbsstructure, 1), 0, "coefs"))[2], mxGetPr(mxGetCell(mxGetField(mxGetCell(d2nurbsstructure, 1), 0, "knots"), 0)), mxGetPr(mxGetCell(mxGetField(mxGetCell(d2nurbsstructure, 1), 0, "knots"), 1)), mxGetPr(parametervalues), (int)mxGetN(parametervalues), bspPnts, leftU, rightU, NU, leftV, rightV, NV);
-                                for (j = 0; j < mxGetN(parametervalues); j++){
-                                    for (i = 0; i < 3; i++){
-                                        mxGetPr(d2uvevaluated_points)[3*j+i]=(bspPnts[4*j+i]-(weights[j])*(mxGetPr(d2uevaluated_points)[3*j+i])-(weights2[j])*(mxGetPr(d2vevaluated_points)[3*j+i])-(bspPnts[4*j+3])*(mxGetPr(evaluated_points)[3*j+i]))/(weightsPnts[j]);
-                                    }
-                                }
-                            }
-                            
-                            if(nlhs>5 && nrhs==4){
-                                
-                                d2vvevaluated_points = mxCreateDoubleMatrix(3, mxGetN(parametervalues), mxREAL);
-                                if((mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 2), 0, "order"))[0])>0 && (mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 2), 0, "order"))[1])>0){
-                                    BspEval2(((int)mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 2), 0, "order"))[0])-1, ((int)mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 2), 0, "order"))[1])-1, mxGetPr(mxGetField(mxGetCell(d2nurbsstructure, 2), 0, "coefs")), 4, (int)mxGetDimensions(mxGetField(mxGetCell(d2nurbsstructure, 2), 0, "coefs"))[1], (int)mxGetDimensions(mxGetField(mxGetCell(d2nurbsstructure, 2), 0, "coefs"))[2], mxGetPr(mxGetCell(mxGetField(mxGetCell(d2nurbsstructure, 2), 0, "knots"), 0)), mxGetPr(mxGetCell(mxGetField(mxGetCell(d2nurbsstructure, 2), 0, "knots"), 1)), mxGetPr(parametervalues), (int)mxGetN(parametervalues), bspPnts, leftU, rightU, NU, leftV, rightV, NV);
-                                    for (j = 0; j < mxGetN(parametervalues); j++){
-                                        for (i = 0; i < 3; i++){
-                                            mxGetPr(d2vvevaluated_points)[3*j+i]=(bspPnts[4*j+i]-2*(weights2[j])*(mxGetPr(d2vevaluated_points)[3*j+i])-(bspPnts[4*j+3])*(mxGetPr(evaluated_points)[3*j+i]))/(weightsPnts[j]);
-                                        }
-                                    }
-                                }
-                                
-                            }
-                            
-                        }
-                        
-                    }
-                    
-                    free(weights2);
-                    
-                }
-                
-                free(weights);
-                free(weightsPnts);
-                
+        for (k = 0; k < numDirs; k++){
+            if (!mxIsDouble(mxGetCell(parametervalues, k))){
+                mexErrMsgTxt("UV{1} and UV{2} must be vectors of type double.");
             }
-            
-            free(bspPnts);
-            
         }
-        
-        free(leftU);
-        free(rightU);
-        free(NU);
-        free(leftV);
-        free(rightV);
-        free(NV);
-        
     }
+    else{
+        numDirs = (int)mxGetM(parametervalues);
+    }
+    
+    if (nrbIsCompiled(nurbsstructure)){
+        nrbCompiledFromArray(nurbsstructure, &nrb);
+        if (numDirs!=nrb.numDirs){
+            mexErrMsgTxt("Wrong dimension of UV");
+        }
+    }
+    else{
+        if (mxGetM(mxGetField(nurbsstructure, 0, "coefs"))!=4){
+            mexPrintf("Number of rows in nurbs.coefs is %d,\n", mxGetM(mxGetField(nurbsstructure, 0, "coefs")));
+            mexErrMsgTxt("nurbs.coefs must have 4 rows.");
+        }
+        if (numDirs!=1 && numDirs!=2){
+            mexErrMsgTxt("Wrong dimension of UV");
+        }
+        nrbCompiledFromStruct(nurbsstructure, (nargs>2) ? dnurbsstructure : NULL, (nargs>3) ? d2nurbsstructure : NULL, numDirs, &nrb);
+    }
+    
+    numFullNets = (numDirs==2) ? 6 : 3;
+    if (nlhs>numFullNets){
+        mexErrMsgTxt("Wrong number of inputs or outputs.");
+    }
+    
+    outClass = (opt.precision==NRB_DOUBLE) ? mxDOUBLE_CLASS : mxSINGLE_CLASS;
     
-    else if (mxGetM(parametervalues)==1){
+    if (mxIsCell(parametervalues) && numDirs==2){
+        
+        nu = (int)mxGetNumberOfElements(mxGetCell(parametervalues, 0));
+        nv = (int)mxGetNumberOfElements(mxGetCell(parametervalues, 1));
+        
+        for (k = 0; k < nlhs; k++){
+            plhs[k] = mxCreateUninitNumericMatrix(3, nu*nv, outClass, mxREAL);
+            out[k] = (double*) mxGetData(plhs[k]);
+            outf[k] = (float*) mxGetData(plhs[k]);
+        }
         
-        int orderU = (int)mxGetScalar(mxGetField(nurbsstructure, 0, "order"));
+        nrbGridEval(&nrb, nlhs, mxGetPr(mxGetCell(parametervalues, 0)), nu, mxGetPr(mxGetCell(parametervalues, 1)), nv, out, (opt.precision==NRB_DOUBLE) ? NULL : outf, nrbNumThreads(&opt, nv));
         
-        double *left  = (double*) malloc(orderU*sizeof(double)+1);
-        double *right = (double*) malloc(orderU*sizeof(double)+1);
-        double *N = (double*) malloc(orderU*sizeof(double)+1);
+    }
+    else{
         
-        if(nlhs==1 && nrhs==2){
-            
-            evaluated_points = mxCreateDoubleMatrix(3, mxGetN(parametervalues), mxREAL);
-            NURBScurveEval(orderU-1, mxGetPr(mxGetField(nurbsstructure, 0, "coefs")), (int)mxGetN(mxGetField(nurbsstructure, 0, "coefs")), mxGetPr(mxGetField(nurbsstructure, 0, "knots")), mxGetPr(parametervalues), (int)mxGetN(parametervalues), mxGetPr(evaluated_points), left, right, N);
-            
+        if (mxIsCell(parametervalues)){
+            nus = (int)mxGetNumberOfElements(mxGetCell(parametervalues, 0));
+            UV = mxGetPr(mxGetCell(parametervalues, 0));
         }
         else{
-            
-            bspPnts  = (double*) malloc(4*(mxGetN(parametervalues))*sizeof(double)+1);
-            
-            BspEval(orderU-1, mxGetPr(mxGetField(nurbsstructure, 0, "coefs")), 4, (int)mxGetN(mxGetField(nurbsstructure, 0, "coefs")), mxGetPr(mxGetField(nurbsstructure, 0, "knots")), mxGetPr(parametervalues), (int)mxGetN(parametervalues), bspPnts, left, right, N);
-            evaluated_points = mxCreateDoubleMatrix(3, mxGetN(parametervalues), mxREAL);
-            for (j = 0; j < mxGetN(parametervalues); j++){
-                for (i = 0; i < 3; i++){
-                    mxGetPr(evaluated_points)[3*j+i]=(bspPnts[4*j+i])/(bspPnts[4*j+3]);
-                }
-            }
-            
-            if(nlhs>1 && nrhs>2){
-                
-                weightsPnts = (double*) malloc(mxGetN(parametervalues)*sizeof(double)+1);
-                for (j = 0; j < mxGetN(parametervalues); j++){
-                    weightsPnts[j]=bspPnts[4*j+3];
-                }
-                
-                BspEval(((int)mxGetScalar(mxGetField(dnurbsstructure, 0, "order")))-1, mxGetPr(mxGetField(dnurbsstructure, 0, "coefs")), 4, (int)mxGetN(mxGetField(dnurbsstructure, 0, "coefs")), mxGetPr(mxGetField(dnurbsstructure, 0, "knots")), mxGetPr(parametervalues), (int)mxGetN(parametervalues), bspPnts, left, right, N);
-                weights = (double*) malloc((mxGetN(parametervalues))*sizeof(double)+1);
-                for (j = 0; j < mxGetN(parametervalues); j++){
-                    weights[j]=bspPnts[4*j+3];
-                }
-                d1evaluated_points = mxCreateDoubleMatrix(3, mxGetN(parametervalues), mxREAL);
-                for (j = 0; j < mxGetN(parametervalues); j++){
-                    for (i = 0; i < 3; i++){
-                        mxGetPr(d1evaluated_points)[3*j+i]=(bspPnts[4*j+i]-(weights[j])*(mxGetPr(evaluated_points)[3*j+i]))/(weightsPnts[j]);
-                    }
-                }
-                
-                if(nlhs>2 && nrhs==4){
-                    
-                    d12evaluated_points = mxCreateDoubleMatrix(3, mxGetN(parametervalues), mxREAL);
-                    if(mxGetScalar(mxGetField(d2nurbsstructure, 0, "order"))>0){
-                        BspEval(((int)mxGetScalar(mxGetField(d2nurbsstructure, 0, "order")))-1, mxGetPr(mxGetField(d2nurbsstructure, 0, "coefs")), 4, (int)mxGetN(mxGetField(d2nurbsstructure, 0, "coefs")), mxGetPr(mxGetField(d2nurbsstructure, 0, "knots")), mxGetPr(parametervalues), (int)mxGetN(parametervalues), bspPnts, left, right, N);
-                        for (j = 0; j < mxGetN(parametervalues); j++){
-                            for (i = 0; i < 3; i++){
-                                mxGetPr(d12evaluated_points)[3*j+i]=(bspPnts[4*j+i]-2*(weights[j])*(mxGetPr(d1evaluated_points)[3*j+i])-(bspPnts[4*j+3])*(mxGetPr(evaluated_points)[3*j+i]))/(weightsPnts[j]);
-                            }
-                        }
-                    }
-                    
-                }
-                
-                free(weights);
-                free(weightsPnts);
-                
-            }
-            
-            free(bspPnts);
-            
+            nus = (int)mxGetN(parametervalues);
+            UV = mxGetPr(parametervalues);
         }
         
-        free(left);
-        free(right);
-        free(N);
+        for (k = 0; k < nlhs; k++){
+            plhs[k] = mxCreateUninitNumericMatrix(3, nus, outClass, mxREAL);
+            out[k] = (double*) mxGetData(plhs[k]);
+            outf[k] = (float*) mxGetData(plhs[k]);
+        }
+        
+        if (opt.precision==NRB_DOUBLE){
+            nrbEvalBatch(&nrb, nlhs, UV, nus, out, nrbNumThreads(&opt, (nus+NRB_BLOCK-1)/NRB_BLOCK));
+        }
+        else{
+            nrbEvalBatchSingle(&nrb, nlhs, UV, nus, outf, opt.precision, nrbNumThreads(&opt, (nus+NRB_BLOCK-1)/NRB_BLOCK));
+        }
         
-    }
-    
-    else{
-        mexErrMsgTxt("Wrong dimension of UV");
     }
     
 }
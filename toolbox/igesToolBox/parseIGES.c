@@ -0,0 +1,169 @@
+/**************************************************************************
+ *
+ * function [Pdata,Ddata,Hdata,Sdata]=parseIGES(igsfile)
+ *
+ * Reads the entities of an IGES-file, used by iges2matlab.
+ *
+ * The file is mapped into memory and read in one pass, and the entities
+ * are parsed in parallel if the mex file is compiled with OpenMP (see
+ * makeIGESmex).
+ *
+ * Usage in Matlab:
+ *
+ * [Pdata,Ddata,Hdata,Sdata]=parseIGES(igsfile)
+ *
+ * Options (after the other inputs):
+ *
+ * [Pdata,Ddata,Hdata,Sdata]=parseIGES(igsfile,'threads',n)
+ *
+ * n - number of threads, 1 gives serial parsing, 0 (default) uses
+ *     all available threads. The results do not depend on n.
+ *
+ * Input:
+ * igsfile - IGES file
+ *
+ * Output:
+ * Pdata - 1xN cell array, Pdata{i} is a row vector with the parameter
+ *         data of entity i, Pdata{i}(1) is the entity type. Empty
+ *         parameters are 0 and Hollerith strings are NaN.
+ * Ddata - 20xN matrix with the 20 fields of the directory entries, NaN
+ *         for empty or non-numeric fields.
+ * Hdata - 1xN cell array, Hdata{i} is a cell array with the Hollerith
+ *         strings in the parameter data of entity i (empty if none).
+ * Sdata - Start section, one row per record (columns 1-72).
+ *
+ * N is the number of entities (half the number of D records).
+ *
+ * c-file can be downloaded for free at
+ *
+ * http://www.mathworks.com/matlabcentral/fileexchange/13253-iges-toolbox
+ *
+ * compile in Matlab by using the command  "mex parseIGES.c"
+ *
+ * See "help mex" for more information
+ *
+ **************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mex.h"
+
+/* Input Arguments */
+
+#define	igesfilename	prhs[0]
+
+/* Output Arguments */
+
+#define	parameter_data	plhs[0]
+#define	directory_data	plhs[1]
+#define	hollerith_data	plhs[2]
+#define	start_data	plhs[3]
+
+/* Sub functions (in folder "mexSourceFiles") */
+
+#include "mexSourceFiles/nrbOptions.c"
+#include "mexSourceFiles/igesFileMap.c"
+#include "mexSourceFiles/igesParse.c"
+
+/* Main function */
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]){
+    
+    int e, k, r, c, nargs, numEnt, numThreads, pos;
+    char *filename, msg[256];
+    mwSize dims[2];
+    mxChar *chr;
+    mxArray *strs, *arr;
+    igesFileMap map;
+    igesFile igs;
+    igesEntity *ents;
+    nrbOptions opt;
+    
+    nargs = nrbParseOptions(nrhs, prhs, 1, &opt);
+    if(nargs!=1){
+        mexErrMsgTxt("Number of inputs must be 1.");
+    }
+    if(nlhs>4){
+        mexErrMsgTxt("Number of outputs must be at most 4.");
+    }
+    if(!mxIsChar(igesfilename)){
+        mexErrMsgTxt("igsfile must be a string.");
+    }
+    
+    filename = mxArrayToString(igesfilename);
+    if(!igesMapFile(filename, &map)){
+        sprintf(msg, "Cannot open %.200s.", filename);
+        mxFree(filename);
+        mexErrMsgTxt(msg);
+    }
+    mxFree(filename);
+    
+    if(!igesSections(map.data, map.size, &igs)){
+        igesUnmapFile(&map);
+        mexErrMsgTxt("Input file must be an IGES-file!");
+    }
+    igesDelimiters(&igs);
+    
+    numEnt = igs.numD/2;
+    
+    /* Directory entries and parameter data */
+    
+    directory_data = mxCreateDoubleMatrix(IGES_NUMDFIELDS, numEnt, mxREAL);
+    ents = (igesEntity*) mxMalloc((numEnt>0 ? numEnt : 1)*sizeof(igesEntity));
+    
+    numThreads = nrbNumThreads(&opt, (numEnt+63)/64);
+    if(!igesParseEntities(&igs, numEnt, ents, mxGetPr(directory_data), numThreads)){
+        for (e = 0; e < numEnt; e++){
+            free(ents[e].val);
+            free(ents[e].str);
+            free(ents[e].strLen);
+        }
+        igesUnmapFile(&map);
+        mexErrMsgTxt("Out of memory.");
+    }
+    
+    parameter_data = mxCreateCellMatrix(1, numEnt);
+    hollerith_data = mxCreateCellMatrix(1, numEnt);
+    for (e = 0; e < numEnt; e++){
+        arr = mxCreateDoubleMatrix(1, ents[e].numVal, mxREAL);
+        memcpy(mxGetPr(arr), ents[e].val, ents[e].numVal*sizeof(double));
+        mxSetCell(parameter_data, e, arr);
+        free(ents[e].val);
+        if(ents[e].numStr>0){
+            strs = mxCreateCellMatrix(1, ents[e].numStr);
+            pos = 0;
+            for (k = 0; k < ents[e].numStr; k++){
+                dims[0] = 1;
+                dims[1] = ents[e].strLen[k];
+                arr = mxCreateCharArray(2, dims);
+                chr = mxGetChars(arr);
+                for (c = 0; c < ents[e].strLen[k]; c++){
+                    chr[c] = (mxChar)(unsigned char)ents[e].str[pos+c];
+                }
+                pos += ents[e].strLen[k];
+                mxSetCell(strs, k, arr);
+            }
+            mxSetCell(hollerith_data, e, strs);
+            free(ents[e].str);
+            free(ents[e].strLen);
+        }
+    }
+    mxFree(ents);
+    
+    /* Start section */
+    
+    dims[0] = igs.numS;
+    dims[1] = 72;
+    start_data = mxCreateCharArray(2, dims);
+    chr = mxGetChars(start_data);
+    for (r = 0; r < igs.numS; r++){
+        for (c = 0; c < 72; c++){
+            chr[c*igs.numS+r] = (mxChar)igesRecord(&igs, r)[c];
+        }
+    }
+    
+    igesUnmapFile(&map);
+    
+}
@@ -1,4 +1,4 @@
-function plotIGES(ParameterData,srf,fignr,subd,holdoff_flag,fine_flag)
+function plotIGES(ParameterData,srf,fignr,subd,holdoff_flag,fine_flag,tol)
 % PLOTIGES plots surfaces, curves and points from IGES-file.
 % 
 % Simple usage:
@@ -29,6 +29,10 @@ function plotIGES(ParameterData,srf,fignr,subd,holdoff_flag,fine_flag)
 %                when the plot is done. 1 default.
 % fine_flag - Bolean value (1/0). If 0 the surface will be rough
 %             and if 1 the surface will be finer. 0 default.
+% tol - Chord error tolerance for surfaces. If given, the surfaces are
+%       tessellated adaptively with nrbTessellateIGES, so that the
+%       triangles are within tol from the surfaces, and subd and
+%       fine_flag are only used for curves. [] default.
 %                
 % m-file can be downloaded for free at
 % http://www.mathworks.com/matlabcentral/fileexchange/13253-iges-toolbox
@@ -36,6 +40,9 @@ function plotIGES(ParameterData,srf,fignr,subd,holdoff_flag,fine_flag)
 % written by Per Bergstrm 2009-12-04
 %               
 
+if nargin<7
+    tol=[];
+end
 if nargin<6
     fine_flag=0;
     if nargin<5
@@ -141,9 +148,9 @@ for i=1:siz
         elseif srf0not
             
             if fine_flag
-                [P,isSCP,isSup,TRI]=retSrfCrvPnt(1,ParameterData,1,i,subd,1);
+                [P,isSCP,isSup,TRI]=retSrfCrvPnt(1,ParameterData,1,i,subd,1,tol);
             else
-                [P,isSCP,isSup,TRI]=retSrfCrvPnt(1,ParameterData,1,i,subd);
+                [P,isSCP,isSup,TRI]=retSrfCrvPnt(1,ParameterData,1,i,subd,[],tol);
             end
             
             if and(isSCP,not(isSup))
@@ -1,10 +1,10 @@
-function [model,UV,srfind,srfDerivind,srfDer,numpoints]=projIGES(ParameterData,EntityType,numEntityType,normal,pdir,dp)
+function [model,UV,srfind,srfDerivind,srfDer,numpoints]=projIGES(ParameterData,EntityType,numEntityType,normal,pdir,dp,tol)
 % PROJIGES returns points of projections on surfaces from an IGES-file.
 % 
 % Usage:
 % 
 % [model,UV,srfind,srfDerivind,srfDer,numpoints]=projIGES(ParameterData,...
-%                                  EntityType,numEntityType,normal,pdir,dp)
+%                                  EntityType,numEntityType,normal,pdir,dp,tol)
 % 
 % Input:
 % 
@@ -14,6 +14,9 @@ function [model,UV,srfind,srfDerivind,srfDer,numpoints]=projIGES(ParameterData,E
 % normal - The projection normal. The direction of normal is toward the surface.
 % pdir - The first (primary) direction in which projection points lies.
 % dp - the distance between the projected points.
+% tol - chord error tolerance of the triangulations of the surfaces (optional).
+%       If given, the surfaces are tessellated adaptively with
+%       nrbTessellateIGES instead of with a fixed number of points.
 % 
 % Output:
 % 
@@ -32,6 +35,9 @@ function [model,UV,srfind,srfDerivind,srfDer,numpoints]=projIGES(ParameterData,E
 if nargin<6
    error('projIGES must have 6 input arguments!'); 
 end
+if nargin<7
+    tol=[];
+end
 
 if not(iscell(ParameterData))
     error('ParameterData must be a cell array!');
@@ -89,9 +95,7 @@ for i=1:siz
         
         ii=ii+1;
         
-        [V,U]=meshgrid(linspace(ParameterData{i}.v(1),ParameterData{i}.v(2),nn),linspace(ParameterData{i}.u(1),ParameterData{i}.u(2),nn));
-        UVtemp=[reshape(U,1,nn^2);reshape(V,1,nn^2)];
-        Pp(:,((ii-1)*nn^2+1):(ii*nn^2))=nrbevalIGES(ParameterData{i}.nurbs,UVtemp);
+        Pp(:,((ii-1)*nn^2+1):(ii*nn^2))=nrbevalIGES(ParameterData{i}.nurbs,{linspace(ParameterData{i}.u(1),ParameterData{i}.u(2),nn),linspace(ParameterData{i}.v(1),ParameterData{i}.v(2),nn)});
         
     end
 end                                 
@@ -123,10 +127,10 @@ pvec2=linspace(miPp2_2-dif2,maPp2_2+dif2,np2);
 
 pO=[(miPp2_1-dif1);(miPp2_2-dif2)];
 
-[model,UV,srfind,srfDerivind,srfDer,nmodel]=projIGESsub(ParameterData,normal,pdir,sdir,dp,np1,np2,pO);
+[model,UV,srfind,srfDerivind,srfDer,nmodel]=projIGESsub(ParameterData,normal,pdir,sdir,dp,np1,np2,pO,tol);
 
 
-function [model,UV,srfind,srfDerivind,srfDer,nmodel]=projIGESsub(ParameterData,normal,pdir,sdir,dp,np1,np2,pO)
+function [model,UV,srfind,srfDerivind,srfDer,nmodel]=projIGESsub(ParameterData,normal,pdir,sdir,dp,np1,np2,pO,tol)
 
 nmodel=np1*np2;
 
@@ -143,7 +147,7 @@ normalz=Inf*ones(1,nmodel);
 
 for i=1:length(ParameterData)   % Triangulate each surface and find projection on triangulation
     
-    [PTRI,isSCP,isSup,TRI,UV0,srfind0]=retSrfCrvPnt(1,ParameterData,1,i,200,0);
+    [PTRI,isSCP,isSup,TRI,UV0,srfind0]=retSrfCrvPnt(1,ParameterData,1,i,200,0,tol);
     
     if and(isSCP,not(isSup))
         
@@ -244,10 +248,12 @@ if numbder>0
         srfDer{srfDerind}.dnurbs=ParameterData{soi}.dnurbs;
         srfDer{srfDerind}.d2nurbs=ParameterData{soi}.d2nurbs;
         srfDer{srfDerind}.supind=srfindsup(indsoP(sti));
+        srfCmp=nrbCompileIGES(ParameterData{soi}.nurbs,ParameterData{soi}.dnurbs,ParameterData{soi}.d2nurbs);
     end
 end
 
-for i=sti:nmodel           % For each model point. Find the projection on the corresponding surface.
+i=sti;
+while i<=nmodel           % For each surface. Find the projections of its model points (sorted by surface).
     if sosrfind(i)>soi
         soi=sosrfind(i);
         srfDerind=srfDerind+1;
@@ -258,8 +264,15 @@ for i=sti:nmodel           % For each model point. Find the projection on the co
             srfDer{srfDerind}.dnurbs=ParameterData{soi}.dnurbs;
             srfDer{srfDerind}.d2nurbs=ParameterData{soi}.d2nurbs;
             srfDer{srfDerind}.supind=srfindsup(indsoP(i));
+            srfCmp=nrbCompileIGES(ParameterData{soi}.nurbs,ParameterData{soi}.dnurbs,ParameterData{soi}.d2nurbs);
         end
     end
-    srfDerivind(indsoP(i))=srfDerind;
-    [model(:,indsoP(i)),UV(:,indsoP(i))]=closestNrbLinePointIGES(srfDer{srfDerind}.nurbs,srfDer{srfDerind}.dnurbs,srfDer{srfDerind}.d2nurbs,UV(:,indsoP(i)),model(:,indsoP(i)),normal);
+    j=i;
+    while j<nmodel && sosrfind(j+1)==sosrfind(i)
+        j=j+1;
+    end
+    ind=indsoP(i:j);
+    srfDerivind(ind)=srfDerind;
+    [model(:,ind),UV(:,ind)]=closestNrbLinePointIGES(srfCmp,UV(:,ind),model(:,ind),repmat(normal,1,j-i+1));
+    i=j+1;
 end
\ No newline at end of file
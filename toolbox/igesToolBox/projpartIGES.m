@@ -324,10 +324,12 @@ if numbder>0
         srfDer{srfDerind}.dnurbs=ParameterData{soi}.dnurbs;
         srfDer{srfDerind}.d2nurbs=ParameterData{soi}.d2nurbs;
         srfDer{srfDerind}.supind=srfindsup(indsoP(sti));
+        srfCmp=nrbCompileIGES(ParameterData{soi}.nurbs,ParameterData{soi}.dnurbs,ParameterData{soi}.d2nurbs);
     end
 end
 
-for i=sti:nmodel           % For each model point. Find the projection on the corresponding surface.
+i=sti;
+while i<=nmodel           % For each surface. Find the projections of its model points (sorted by surface).
     if sosrfind(i)>soi
         soi=sosrfind(i);
         srfDerind=srfDerind+1;
@@ -338,8 +340,15 @@ for i=sti:nmodel           % For each model point. Find the projection on the co
             srfDer{srfDerind}.dnurbs=ParameterData{soi}.dnurbs;
             srfDer{srfDerind}.d2nurbs=ParameterData{soi}.d2nurbs;
             srfDer{srfDerind}.supind=srfindsup(indsoP(i));
+            srfCmp=nrbCompileIGES(ParameterData{soi}.nurbs,ParameterData{soi}.dnurbs,ParameterData{soi}.d2nurbs);
         end
     end
-    srfDerivind(indsoP(i))=srfDerind;
-    [model(:,indsoP(i)),UV(:,indsoP(i))]=closestNrbLinePointIGES(srfDer{srfDerind}.nurbs,srfDer{srfDerind}.dnurbs,srfDer{srfDerind}.d2nurbs,UV(:,indsoP(i)),model(:,indsoP(i)),normal);
+    j=i;
+    while j<nmodel && sosrfind(j+1)==sosrfind(i)
+        j=j+1;
+    end
+    ind=indsoP(i:j);
+    srfDerivind(ind)=srfDerind;
+    [model(:,ind),UV(:,ind)]=closestNrbLinePointIGES(srfCmp,UV(:,ind),model(:,ind),repmat(normal,1,j-i+1));
+    i=j+1;
 end
@@ -0,0 +1,124 @@
+/**************************************************************************
+ *
+ * function [ok,data]=readCacheIGES(cachefile,igsfile)
+ *
+ * Reads data from a binary cache file written by writeCacheIGES, if the
+ * IGES-file igsfile is unchanged since the cache file was written. Used
+ * by loadIGES.
+ *
+ * The cache file is mapped into memory and checked before anything is
+ * read: its header, the size of igsfile and the hash (XXH64) of the
+ * contents of igsfile must match. The arrays are then created directly
+ * from the mapped file, one copy per array.
+ *
+ * Usage in Matlab:
+ *
+ * [ok,data]=readCacheIGES(cachefile,igsfile)
+ *
+ * Input:
+ * cachefile - name of the cache file
+ * igsfile - IGES file
+ *
+ * Output:
+ * ok - true if the cache file is valid for igsfile, false if it does not
+ *      exist, is not a cache file (or is damaged) or igsfile has changed.
+ * data - the data given to writeCacheIGES, [] if ok is false.
+ *
+ * c-file can be downloaded for free at
+ *
+ * http://www.mathworks.com/matlabcentral/fileexchange/13253-iges-toolbox
+ *
+ * compile in Matlab by using the command  "mex readCacheIGES.c"
+ *
+ * See "help mex" for more information
+ *
+ **************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mex.h"
+
+/* Input Arguments */
+
+#define	cache_file	prhs[0]
+#define	iges_file	prhs[1]
+
+/* Output Arguments */
+
+#define	cache_ok	plhs[0]
+#define	cache_data	plhs[1]
+
+/* Sub functions (in folder "mexSourceFiles") */
+
+#include "mexSourceFiles/igesFileMap.c"
+#include "mexSourceFiles/igesCache.c"
+#include "mexSourceFiles/igesCacheRead.c"
+
+/* Main function */
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]){
+    
+    int ok;
+    char *filename, msg[256];
+    uint64_t srcSize, srcHash;
+    igesFileMap cache, map;
+    igesCacheReader rd;
+    mxArray *data;
+    
+    if(nrhs!=2){
+        mexErrMsgTxt("Number of inputs must be 2.");
+    }
+    if(nlhs>2){
+        mexErrMsgTxt("Number of outputs must be at most 2.");
+    }
+    if(!mxIsChar(cache_file) || !mxIsChar(iges_file)){
+        mexErrMsgTxt("cachefile and igsfile must be strings.");
+    }
+    
+    data = NULL;
+    
+    filename = mxArrayToString(cache_file);
+    ok = igesMapFile(filename, &cache);
+    mxFree(filename);
+    
+    if(ok){
+        ok = igesCacheOpen(cache.data, cache.size, &rd, &srcSize, &srcHash);
+        
+        /* The IGES-file must be unchanged */
+        
+        if(ok){
+            filename = mxArrayToString(iges_file);
+            if(!igesMapFile(filename, &map)){
+                igesUnmapFile(&cache);
+                sprintf(msg, "Cannot open %.200s.", filename);
+                mxFree(filename);
+                mexErrMsgTxt(msg);
+            }
+            mxFree(filename);
+            ok = (uint64_t)map.size==srcSize && igesHash(map.data, map.size)==srcHash;
+            igesUnmapFile(&map);
+        }
+        
+        if(ok){
+            ok = igesCacheGet(&rd, &data) && rd.pos==rd.numNode;
+            if(!ok && data!=NULL){
+                mxDestroyArray(data);
+                data = NULL;
+            }
+        }
+        igesUnmapFile(&cache);
+    }
+    
+    cache_ok = mxCreateLogicalScalar(ok ? 1 : 0);
+    if(data==NULL){
+        data = mxCreateDoubleMatrix(0, 0, mxREAL);
+    }
+    if(nlhs>1){
+        cache_data = data;
+    }
+    else {
+        mxDestroyArray(data);
+    }
+    
+}
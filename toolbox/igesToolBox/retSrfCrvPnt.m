@@ -1,4 +1,4 @@
-function [P,isSCP,isSup,TRI,UV,srfind]=retSrfCrvPnt(SCP,ParameterData,isSup,ind,n,dim)
+function [P,isSCP,isSup,TRI,UV,srfind]=retSrfCrvPnt(SCP,ParameterData,isSup,ind,n,dim,tol)
 % RETSRFCRVPNT is a subfunction in IGES2MATLAB file collection.
 % No complete documentation is given.
 %
@@ -17,12 +17,22 @@ function [P,isSCP,isSup,TRI,UV,srfind]=retSrfCrvPnt(SCP,ParameterData,isSup,ind,
 %
 % dim - [2,3] 2, curve in domain, 3, curve in space
 %
+% tol - chord error tolerance for surfaces (optional). If given, the surface
+%       is tessellated adaptively with nrbTessellateIGES and n is not used.
+%
 % m-file can be downloaded for free at
 % http://www.mathworks.com/matlabcentral/fileexchange/13253-iges-toolbox
 %
 % written by Per Bergstrm 2009-12-04
 %
 
+if nargin<6
+    dim=[];
+end
+if nargin<7
+    tol=[];
+end
+
 isSCP=0;
 
 if SCP==1           % SURFACE
@@ -39,11 +49,17 @@ if SCP==1           % SURFACE
         else
             
             isSup=0;
+            
+            if not(isempty(tol))
+                [P,TRI,UV]=nrbTessellateIGES(ParameterData{ind}.nurbs,tol);
+                return
+            end
+            
             [V,U]=meshgrid(linspace(ParameterData{ind}.v(1),ParameterData{ind}.v(2),n),linspace(ParameterData{ind}.u(1),ParameterData{ind}.u(2),n));
             
             UV=[reshape(U,1,n^2);reshape(V,1,n^2)];
             
-            P=nrbevalIGES(ParameterData{ind}.nurbs,UV);
+            P=nrbevalIGES(ParameterData{ind}.nurbs,{linspace(ParameterData{ind}.u(1),ParameterData{ind}.u(2),n),linspace(ParameterData{ind}.v(1),ParameterData{ind}.v(2),n)});
             
             TRI=zeros(2*(n-1)^2,3);
             
@@ -67,7 +83,27 @@ if SCP==1           % SURFACE
             n2=ParameterData{ind}.n2;
             NN=ones(1,n2+1);
             
-            if and(nargin==6,ParameterData{ind}.n1)
+            if not(isempty(tol))
+                % Trimming loops in the domain, the triangles are cut at them
+                loops=cell(1,n2+1);
+                if ParameterData{ind}.n1
+                    NO=max(ceil((ParameterData{ParameterData{ind}.pto}.length/ParameterData{ParameterData{ind}.pto}.gdiagonal)*2500),50);
+                    loops{1}=retCrv(ParameterData,ParameterData{ind}.pto,NO,2);
+                else
+                    umin=ParameterData{srfind}.u(1);
+                    umax=ParameterData{srfind}.u(2);
+                    vmin=ParameterData{srfind}.v(1);
+                    vmax=ParameterData{srfind}.v(2);
+                    loops{1}=[umin umax umax umin;vmin vmin vmax vmax];
+                end
+                for j=1:n2
+                    loops{j+1}=retCrv(ParameterData,ParameterData{ind}.pti(j),max(ceil((ParameterData{ParameterData{ind}.pti(j)}.length/ParameterData{ParameterData{ind}.pti(j)}.gdiagonal)*2500),50),2);
+                end
+                [P,TRI,UV]=nrbTessellateIGES(ParameterData{srfind}.nurbs,tol,loops);
+                return
+            end
+            
+            if and(not(isempty(dim)),ParameterData{ind}.n1)
                 NO=max(ceil((ParameterData{ParameterData{ind}.pto}.length/ParameterData{ParameterData{ind}.pto}.gdiagonal)*2500),50);
                 NN(1)=NO;
                 for j=1:n2
@@ -91,7 +127,7 @@ if SCP==1           % SURFACE
             %   options.dhmax  : The maximum allowable (relative) gradient in the size
             %                    function { 0.3, 30.0% }.
             
-            if nargin==6
+            if not(isempty(dim))
                 options.mlim=0.05;
                 options.maxit=5;
                 options.dhmax=0.6;
@@ -447,10 +483,14 @@ elseif ParameterData{ind}.type==110
     
 elseif ParameterData{ind}.type==126
     
-    tvec=zeros(1,n);
-    
-    tst=ParameterData{ind}.v(1);
-    ten=ParameterData{ind}.v(2);
+    if isfield(ParameterData{ind},'arclength')
+        % Points equally spaced along the curve
+        tst=0;
+        ten=nrbArcLengthIGES(ParameterData{ind}.arclength);
+    else
+        tst=ParameterData{ind}.v(1);
+        ten=ParameterData{ind}.v(2);
+    end
     
     if dim==2
         if nargout==1
@@ -463,7 +503,11 @@ elseif ParameterData{ind}.type==126
         tvec=linspace(tst,ten,n);
     end
     
-    p=nrbevalIGES(ParameterData{ind}.nurbs,tvec);
+    if isfield(ParameterData{ind},'arclength')
+        p=nrbArcLengthIGES(ParameterData{ind}.arclength,ParameterData{ind}.nurbs,tvec);
+    else
+        p=nrbevalIGES(ParameterData{ind}.nurbs,tvec);
+    end
     
     rCrv=p(1:dim,:);
     
@@ -0,0 +1,103 @@
+/**************************************************************************
+ *
+ * function writeCacheIGES(cachefile,igsfile,data)
+ *
+ * Writes data to a binary cache file for the IGES-file igsfile, which is
+ * read back with readCacheIGES. Used by loadIGES.
+ *
+ * The cache file holds the size and a hash (XXH64) of the contents of
+ * igsfile, so that readCacheIGES can tell when igsfile has changed. All
+ * numbers and strings in data are stored in one flat, 8-byte aligned
+ * block after a table describing the arrays, the layout is described in
+ * mexSourceFiles/igesCache.c.
+ *
+ * Usage in Matlab:
+ *
+ * writeCacheIGES(cachefile,igsfile,data)
+ *
+ * Input:
+ * cachefile - name of the cache file, overwritten if it exists
+ * igsfile - IGES file that data was read from
+ * data - struct, cell, char, logical or real numeric array, e.g. a cell
+ *        array with the outputs from iges2matlab. Structs and cells can
+ *        be nested. Complex and sparse arrays, function handles and
+ *        objects cannot be cached.
+ *
+ * The cache file is only valid on machines with the same byte order.
+ *
+ * c-file can be downloaded for free at
+ *
+ * http://www.mathworks.com/matlabcentral/fileexchange/13253-iges-toolbox
+ *
+ * compile in Matlab by using the command  "mex writeCacheIGES.c"
+ *
+ * See "help mex" for more information
+ *
+ **************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mex.h"
+
+/* Input Arguments */
+
+#define	cache_file	prhs[0]
+#define	iges_file	prhs[1]
+#define	cache_data	prhs[2]
+
+/* Sub functions (in folder "mexSourceFiles") */
+
+#include "mexSourceFiles/igesFileMap.c"
+#include "mexSourceFiles/igesCache.c"
+#include "mexSourceFiles/igesCacheWrite.c"
+
+/* Main function */
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]){
+    
+    int status;
+    char *filename, msg[256];
+    uint64_t srcSize, srcHash;
+    igesFileMap map;
+    
+    (void)plhs;
+    
+    if(nrhs!=3){
+        mexErrMsgTxt("Number of inputs must be 3.");
+    }
+    if(nlhs>0){
+        mexErrMsgTxt("writeCacheIGES has no outputs.");
+    }
+    if(!mxIsChar(cache_file) || !mxIsChar(iges_file)){
+        mexErrMsgTxt("cachefile and igsfile must be strings.");
+    }
+    
+    /* Hash of the IGES-file */
+    
+    filename = mxArrayToString(iges_file);
+    if(!igesMapFile(filename, &map)){
+        sprintf(msg, "Cannot open %.200s.", filename);
+        mxFree(filename);
+        mexErrMsgTxt(msg);
+    }
+    mxFree(filename);
+    srcSize = (uint64_t)map.size;
+    srcHash = igesHash(map.data, map.size);
+    igesUnmapFile(&map);
+    
+    /* Cache file */
+    
+    filename = mxArrayToString(cache_file);
+    status = igesCacheWrite(filename, cache_data, srcSize, srcHash);
+    if(status<0){
+        sprintf(msg, "Cannot write %.200s.", filename);
+        mxFree(filename);
+        mexErrMsgTxt(msg);
+    }
+    mxFree(filename);
+    if(status==0){
+        mexErrMsgTxt("data can only contain struct, cell, char, logical and real numeric arrays.");
+    }
+    
+}